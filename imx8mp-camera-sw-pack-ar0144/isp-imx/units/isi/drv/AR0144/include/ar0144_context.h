@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __AR0144_CONTEXT_H__
+#define __AR0144_CONTEXT_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "vvsensor_ext.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Preload a second mode into register context B, next to the mode set by
+ * IsiSetSensorModeIss in context A. The mode may only differ in crop,
+ * skipping, frame length, exposure and analog gain; others are refused.
+ * A sensor mode change drops the preloaded context.
+ */
+RESULT AR0144_IsiLoadSensorContextIss(IsiSensorHandle_t handle,
+                                      uint32_t modeIndex);
+
+/*
+ * Make VVCAM_CONTEXT_A or VVCAM_CONTEXT_B active from the next frame on,
+ * without stopping the stream. The cached mode and AE limits switch with
+ * it, and the next AE update writes exposure and gain to the new context.
+ * While streaming, both contexts must have the same output size.
+ */
+RESULT AR0144_IsiSwitchSensorContextIss(IsiSensorHandle_t handle,
+                                        uint32_t context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
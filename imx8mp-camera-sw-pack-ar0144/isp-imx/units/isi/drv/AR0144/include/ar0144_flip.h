@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __AR0144_FLIP_H__
+#define __AR0144_FLIP_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "vvsensor_ext.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Mirror and flip the image at sensor readout, flip being a mask of
+ * VVCAM_FLIP_H and VVCAM_FLIP_V, through the V4L2_CID_HFLIP and
+ * V4L2_CID_VFLIP controls of the subdev. The orientation can only change
+ * while the sensor is not streaming and is kept across sensor mode
+ * changes. On success the sensor mode is re-read, its bayer pattern
+ * follows the flip.
+ */
+RESULT AR0144_IsiSetSensorFlipIss(IsiSensorHandle_t handle, uint32_t flip);
+
+RESULT AR0144_IsiGetSensorFlipIss(IsiSensorHandle_t handle, uint32_t *pFlip);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
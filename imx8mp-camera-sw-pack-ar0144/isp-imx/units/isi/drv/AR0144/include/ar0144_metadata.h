@@ -0,0 +1,50 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __AR0144_METADATA_H__
+#define __AR0144_METADATA_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Settings the sensor actually applied to one frame, decoded from the
+ * embedded data lines of the ar0144_1280_ebd mode.
+ */
+typedef struct AR0144_FrameMetadata_s
+{
+    uint32_t frameCount;                /* FRAME_COUNT, wraps at 16 bits */
+    uint32_t coarseIntegrationLines;    /* COARSE_INTEGRATION_TIME */
+    uint32_t analogGainReg;             /* ANALOG_GAIN, raw register */
+    uint32_t digitalGainReg;            /* GLOBAL_GAIN, raw register */
+    uint32_t integrationTime;           /* same units as IsiSensorIntTime_t */
+    uint32_t gain;                      /* same units as IsiSensorGain_t */
+    uint32_t droppedFrames;             /* frames missing since the last call */
+} AR0144_FrameMetadata_t;
+
+/*
+ * Parse the embedded lines captured above a frame. pData points at the
+ * first embedded line and size covers the top lines reported by
+ * VVSENSORIOC_G_EMBEDDED_INFO. Returns RET_NOTSUPP when the current mode
+ * has no embedded data.
+ */
+RESULT AR0144_IsiGetFrameMetadataIss(IsiSensorHandle_t handle,
+                                     const uint8_t *pData, uint32_t size,
+                                     AR0144_FrameMetadata_t *pMetadata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,37 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __AR0144_REGS_H__
+#define __AR0144_REGS_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "vvsensor_ext.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Run count register reads and writes in order, in as few ioctls as
+ * VVCAM_REG_BATCH_MAX allows; the driver merges runs of consecutive
+ * registers into single I2C transfers. Reads return their value in data.
+ * Every entry gets a status, and entries after a failure are not run and
+ * get -ECANCELED; RET_FAILURE then tells that not all of them succeeded.
+ */
+RESULT AR0144_IsiRegisterBatchIss(IsiSensorHandle_t handle,
+                                  struct vvcam_reg_entry_s *pEntries,
+                                  uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
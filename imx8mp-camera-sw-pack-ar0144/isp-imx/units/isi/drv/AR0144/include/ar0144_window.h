@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __AR0144_WINDOW_H__
+#define __AR0144_WINDOW_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "vvsensor_ext.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Read out only a window of the current mode. The window is given in
+ * output pixels of the mode, with even offsets and sizes, and can only
+ * change while the sensor is not streaming. On success the sensor mode
+ * and AE limits are re-read: the frame length follows the window height
+ * and max_fps rises accordingly. Setting the full mode size restores the
+ * mode. The window is reset by every sensor mode change.
+ */
+RESULT AR0144_IsiSetSensorWindowIss(IsiSensorHandle_t handle,
+                                    const struct vvcam_window_s *pWindow);
+
+RESULT AR0144_IsiGetSensorWindowIss(IsiSensorHandle_t handle,
+                                    struct vvcam_window_s *pWindow);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * ISI core of the vvcam sensor drivers.
+ *
+ * All vvcam sensors are driven through the same VVSENSORIOC_* commands, so
+ * the IsiSensor_t entry points are implemented once, in libvvsensor. A
+ * sensor driver (<sensor>.drv) describes its sensor with a VVSENSOR_Desc_t
+ * and only carries what is specific to that sensor.
+ *
+ * The same directory is shipped in each camera pack; the copies must stay
+ * identical.
+ */
+
+#ifndef __VVSENSOR_ISI_H__
+#define __VVSENSOR_ISI_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "isi_iss.h"
+#include "vvsensor.h"
+#include "vvsensor_ext.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* optional IsiSensor_t entry points, set only for the sensors that have them */
+#define VVSENSOR_CAP_HDR_RATIO      (1U << 0)   /* VVSENSORIOC_S_HDR_RADIO */
+#define VVSENSOR_CAP_BLC            (1U << 1)   /* VVSENSORIOC_S_BLC */
+#define VVSENSOR_CAP_WB             (1U << 2)   /* VVSENSORIOC_S_WB */
+#define VVSENSOR_CAP_EXPAND_CURVE   (1U << 3)   /* VVSENSORIOC_G_EXPAND_CURVE */
+#define VVSENSOR_CAP_COMPRESS_CURVE (1U << 4)   /* 16 to 12 bit, see pCompressY */
+#define VVSENSOR_CAP_FOCUS          (1U << 5)   /* lens from VVSENSORIOC_G_LENS */
+#define VVSENSOR_CAP_TEMPERATURE    (1U << 6)   /* VVSENSORIOC_G_TEMPERATURE */
+
+/* there is no expand curve while the mode does not compress its data */
+#define VVSENSOR_QUIRK_EXPAND_IF_COMPRESSED (1U << 0)
+
+#define VVSENSOR_COMPRESS_POINTS    65
+
+/*
+ * A run of total gains the kernel driver applies exactly, in the ISI fixed
+ * point. Step i applies (again + i * againStep) * (dgain + i * dgainStep),
+ * and is what the kernel driver makes of request + i * requestStep written
+ * with VVSENSORIOC_S_GAIN. The runs of a table are sorted by gain and do
+ * not overlap.
+ */
+typedef struct VVSENSOR_GainRange_s
+{
+    uint32_t again;
+    uint32_t againStep;
+    uint32_t dgain;
+    uint32_t dgainStep;
+    uint32_t count;             /* steps in the run, at least 1 */
+    uint32_t request;
+    uint32_t requestStep;
+} VVSENSOR_GainRange_t;
+
+/* split chosen by VVSENSOR_IsiPlanExposureIss() */
+typedef struct VVSENSOR_ExposurePlan_s
+{
+    uint32_t intLine;           /* lines written with VVSENSORIOC_S_EXP */
+    uint32_t intTime;           /* intLine * oneLineExpTime */
+    uint32_t again;             /* analog gain applied */
+    uint32_t dgain;             /* digital gain applied */
+    uint32_t gain;              /* total gain applied */
+    uint32_t gainRequest;       /* value written with VVSENSORIOC_S_GAIN */
+    uint64_t exposure;          /* intTime * gain */
+} VVSENSOR_ExposurePlan_t;
+
+/*
+ * Frame rate throttling on sensor temperature. At or above tripTemp the
+ * frame rate is capped to maxFps, through the same path as
+ * IsiSetSensorFpsIss(), and the AE sees maxFps as its max and min AFPS.
+ * At or below clearTemp the frame rate from before the trip is restored.
+ */
+typedef struct VVSENSOR_ThermalLimits_s
+{
+    int32_t  tripTemp;          /* millidegrees Celsius */
+    int32_t  clearTemp;         /* millidegrees Celsius, below tripTemp */
+    uint32_t maxFps;            /* fps cap, as ae_info.max_fps */
+} VVSENSOR_ThermalLimits_t;
+
+typedef struct VVSENSOR_Desc_s
+{
+    const char *pszName;
+    uint32_t chipId;            /* as read by VVSENSORIOC_G_CHIP_ID */
+    uint32_t caps;              /* VVSENSOR_CAP_* */
+    uint32_t quirks;            /* VVSENSOR_QUIRK_* */
+    size_t contextSize;         /* driver context, starting with VVSENSOR_Context_t */
+    /* output of the 16 to 12 bit compress curve, NULL for the default knees */
+    const uint32_t *pCompressY;
+    /* gains the kernel driver applies exactly, NULL when not planned */
+    const VVSENSOR_GainRange_t *pGainRanges;
+    uint32_t gainRangeCount;
+
+    /*
+     * Optional hooks, called with the driver context. pfModeUpdated runs
+     * each time the mode is read back after a mode, window or flip change,
+     * pfModeSet after a mode change only.
+     */
+    RESULT (*pfModeUpdated)(IsiSensorHandle_t handle);
+    void (*pfModeSet)(IsiSensorHandle_t handle);
+} VVSENSOR_Desc_t;
+
+typedef struct VVSENSOR_Context_s
+{
+    IsiSensorContext_t  IsiCtx;
+    const VVSENSOR_Desc_t *pDesc;
+    struct vvcam_mode_info_s CurMode;
+    IsiSensorAeInfo_t AeInfo;
+    IsiSensorIntTime_t IntTime;
+    uint32_t LongIntLine;
+    uint32_t IntLine;
+    uint32_t ShortIntLine;
+    IsiSensorGain_t SensorGain;
+    uint32_t minAfps;
+    uint32_t Fps;               /* last fps set, 0 once the mode is read back */
+    uint64_t AEStartExposure;
+    uint32_t FrameGaps;         /* gaps at the last frame stats call */
+    uint32_t MaxIntTime;        /* exposure budget, 0 when not planned */
+    uint32_t PlanIntTime;       /* last integration time the AE set */
+    uint32_t PlanGain;          /* last gain the AE set */
+    uint32_t GainRequest;       /* last value written by the planner */
+    VVSENSOR_ThermalLimits_t ThermalLimits;
+    bool_t ThermalEnabled;
+    bool_t ThermalThrottled;
+    uint32_t ThermalRestoreFps; /* cur_fps when the trip point was crossed */
+    int motor_fd;
+    uint32_t focus_mode;
+} VVSENSOR_Context_t;
+
+/*
+ * Fill the IsiSensor_t table for pDesc, all but pIsiCreateSensorIss: the
+ * driver sets it to a function calling VVSENSOR_IsiCreateSensorIss() with
+ * its descriptor.
+ */
+RESULT VVSENSOR_IsiGetSensorIss(const VVSENSOR_Desc_t *pDesc,
+                                IsiSensor_t *pIsiSensor);
+
+RESULT VVSENSOR_IsiCreateSensorIss(const VVSENSOR_Desc_t *pDesc,
+                                   IsiSensorInstanceConfig_t *pConfig);
+
+RESULT VVSENSOR_IsiHalQuerySensorIss(HalHandle_t HalHandle,
+                                     IsiSensorModeInfoArray_t *pSensorMode);
+
+/* rebuild the AE info from CurMode */
+RESULT VVSENSOR_UpdateIsiAEInfo(IsiSensorHandle_t handle);
+
+/* read the mode back after the kernel changed it */
+RESULT VVSENSOR_UpdateCurMode(IsiSensorHandle_t handle);
+
+RESULT VVSENSOR_IsiSetSensorFpsIss(IsiSensorHandle_t handle, uint32_t fps);
+
+/* entry points behind the <sensor>_window.h, _flip.h, _frames.h, _regs.h, _exposure.h and _thermal.h ones */
+RESULT VVSENSOR_IsiSetSensorWindowIss(IsiSensorHandle_t handle,
+                                      const struct vvcam_window_s *pWindow);
+
+RESULT VVSENSOR_IsiGetSensorWindowIss(IsiSensorHandle_t handle,
+                                      struct vvcam_window_s *pWindow);
+
+RESULT VVSENSOR_IsiSetSensorFlipIss(IsiSensorHandle_t handle, uint32_t flip);
+
+RESULT VVSENSOR_IsiGetSensorFlipIss(IsiSensorHandle_t handle, uint32_t *pFlip);
+
+RESULT VVSENSOR_IsiGetFrameStatsIss(IsiSensorHandle_t handle,
+                                    uint64_t delivered, uint32_t inFlight,
+                                    struct vvcam_frame_stats_s *pStats);
+
+RESULT VVSENSOR_IsiRegisterBatchIss(IsiSensorHandle_t handle,
+                                    struct vvcam_reg_entry_s *pEntries,
+                                    uint32_t count);
+
+/*
+ * Split exposure, an integration time times a gain as in IsiSensorIntTime_t
+ * and IsiSensorGain_t, into a line count and one of the gains of the
+ * descriptor table. The integration time is kept within the exposure
+ * budget and the mode; within those, the longest integration with the
+ * lowest gain that gets closest to exposure wins. Linear modes only, the
+ * sensor is not written.
+ */
+RESULT VVSENSOR_IsiPlanExposureIss(IsiSensorHandle_t handle, uint64_t exposure,
+                                   VVSENSOR_ExposurePlan_t *pPlan);
+
+/*
+ * Bound the integration time to maxIntTime, 0 to stop planning. While set,
+ * the AE info caps its max integration time and gains to what can be
+ * applied, and IsiSetIntegrationTimeIss() and IsiSetGainIss() write the
+ * planned split of the product of the last linear integration time and
+ * gain set.
+ */
+RESULT VVSENSOR_IsiSetExposureBudgetIss(IsiSensorHandle_t handle,
+                                        uint32_t maxIntTime);
+
+/*
+ * Die temperature in millidegrees Celsius. The thermal entry points return
+ * RET_NOTSUPP without VVSENSOR_CAP_TEMPERATURE.
+ */
+RESULT VVSENSOR_IsiGetSensorTemperatureIss(IsiSensorHandle_t handle,
+                                           int32_t *pTemp);
+
+/*
+ * Enable the throttling with pLimits, or disable it with NULL. Disabling
+ * it while throttled restores the frame rate.
+ */
+RESULT VVSENSOR_IsiSetThermalLimitsIss(IsiSensorHandle_t handle,
+                                       const VVSENSOR_ThermalLimits_t *pLimits);
+
+/*
+ * Read the temperature and apply the limits. Call it periodically while
+ * streaming, once a second is plenty; pTemp may be NULL.
+ */
+RESULT VVSENSOR_IsiThermalUpdateIss(IsiSensorHandle_t handle, int32_t *pTemp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,2144 @@
+/****************************************************************************
+ * Copyright (c) 2020 VeriSilicon Holdings Co., Ltd.
+ * Copyright 2023-2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *****************************************************************************/
+
+#include <ebase/types.h>
+#include <ebase/trace.h>
+#include <ebase/builtins.h>
+#include <common/return_codes.h>
+#include <common/misc.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include "isi.h"
+#include "isi_iss.h"
+#include "isi_priv.h"
+#include "vvsensor.h"
+#include "vvsensor_ext.h"
+#include "vvsensor_isi.h"
+
+CREATE_TRACER( VVSENSOR_INFO , "VVSENSOR: ", INFO,    0);
+CREATE_TRACER( VVSENSOR_WARN , "VVSENSOR: ", WARNING, 0);
+CREATE_TRACER( VVSENSOR_ERROR, "VVSENSOR: ", ERROR,   1);
+
+#ifdef SUBDEV_V4L2
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <linux/v4l2-subdev.h>
+#endif
+
+static inline int OpenMotorDevice(const vvcam_lens_t *pfocus_lens)
+{
+    int filep;
+    char szFile[32];
+    struct v4l2_capability caps;
+    for (int i = 0; i < 20; i++) {
+        sprintf(szFile, "/dev/v4l-subdev%d", i);
+        filep = open(szFile, O_RDWR | O_NONBLOCK);
+        if (filep < 0) {
+            continue;
+        }
+
+        if (ioctl(filep, VIDIOC_QUERYCAP, &caps) < 0) {
+            close(filep);
+            continue;
+        }
+
+        if (strcmp((char*) caps.driver, (char*) pfocus_lens->name)
+            || (atoi((char *)caps.bus_info) != pfocus_lens->id)) {
+            close(filep);
+            continue;
+        } else {
+            return filep;
+        }
+    }
+    return -1;
+}
+
+static RESULT VVSENSOR_IsiSensorSetPowerIss(IsiSensorHandle_t handle, bool_t on)
+{
+    int ret = 0;
+
+    TRACE( VVSENSOR_INFO, "%s: (enter)\n", __func__);
+    TRACE( VVSENSOR_INFO, "%s: set power %d\n", __func__,on);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    int32_t power = on;
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_POWER, &power);
+    if (ret != 0){
+        TRACE(VVSENSOR_ERROR, "%s set power %d error\n", __func__,power);
+        return RET_FAILURE;
+    }
+
+    TRACE( VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSensorGetClkIss(IsiSensorHandle_t handle,
+                                          struct vvcam_clk_s *pclk)
+{
+    int ret = 0;
+
+    TRACE( VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (!pclk)
+        return RET_NULL_POINTER;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_G_CLK, pclk);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s get clock error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE( VVSENSOR_INFO, "%s: status:%d sensor_mclk:%ld csi_max_pixel_clk:%ld\n",
+        __func__, pclk->status, pclk->sensor_mclk, pclk->csi_max_pixel_clk);
+    TRACE( VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSensorSetClkIss(IsiSensorHandle_t handle,
+                                          struct vvcam_clk_s *pclk)
+{
+    int ret = 0;
+
+    TRACE( VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pclk == NULL)
+        return RET_NULL_POINTER;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_CLK, &pclk);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s set clk error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE( VVSENSOR_INFO, "%s: status:%d sensor_mclk:%ld csi_max_pixel_clk:%ld\n",
+        __func__, pclk->status, pclk->sensor_mclk, pclk->csi_max_pixel_clk);
+
+    TRACE( VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiResetSensorIss(IsiSensorHandle_t handle)
+{
+    int ret = 0;
+
+    TRACE( VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_RESET, NULL);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s set reset error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE( VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiRegisterReadIss(IsiSensorHandle_t handle,
+                                          const uint32_t address,
+                                          uint32_t * pValue)
+{
+    int32_t ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    struct vvcam_sccb_data_s sccb_data;
+    sccb_data.addr = address;
+    sccb_data.data = 0;
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_READ_REG, &sccb_data);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s: read sensor register error!\n", __func__);
+        return (RET_FAILURE);
+    }
+
+    *pValue = sccb_data.data;
+
+    TRACE(VVSENSOR_INFO, "%s (exit) \n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiRegisterWriteIss(IsiSensorHandle_t handle,
+                                           const uint32_t address,
+                                           const uint32_t value)
+{
+    int ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    struct vvcam_sccb_data_s sccb_data;
+    sccb_data.addr = address;
+    sccb_data.data = value;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_WRITE_REG, &sccb_data);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s: write sensor register error!\n", __func__);
+        return (RET_FAILURE);
+    }
+
+    TRACE(VVSENSOR_INFO, "%s (exit) \n", __func__);
+
+    return RET_SUCCESS;
+}
+
+/* a step of the descriptor gain table */
+typedef struct VVSENSOR_GainPos_s
+{
+    uint32_t range;
+    uint32_t step;
+} VVSENSOR_GainPos_t;
+
+static uint32_t VVSENSOR_GainAt(const VVSENSOR_Desc_t *pDesc, VVSENSOR_GainPos_t pos,
+                                uint32_t *pAgain, uint32_t *pDgain)
+{
+    const VVSENSOR_GainRange_t *pRange = &pDesc->pGainRanges[pos.range];
+    uint32_t again = pRange->again + pos.step * pRange->againStep;
+    uint32_t dgain = pRange->dgain + pos.step * pRange->dgainStep;
+
+    if (pAgain != NULL)
+        *pAgain = again;
+    if (pDgain != NULL)
+        *pDgain = dgain;
+
+    return ((uint64_t)again * dgain) >> ISI_EXPO_PARAS_FIX_FRACBITS;
+}
+
+static bool_t VVSENSOR_PrevGain(const VVSENSOR_Desc_t *pDesc, VVSENSOR_GainPos_t *pPos)
+{
+    if (pPos->step > 0) {
+        pPos->step--;
+    } else if (pPos->range > 0) {
+        pPos->range--;
+        pPos->step = pDesc->pGainRanges[pPos->range].count - 1;
+    } else {
+        return BOOL_FALSE;
+    }
+
+    return BOOL_TRUE;
+}
+
+/*
+ * The lowest step of the gain table at or above gain, or with bUp false the
+ * highest at or below it: a binary search over the runs, then one within
+ * the run.
+ */
+static bool_t VVSENSOR_FindGain(const VVSENSOR_Desc_t *pDesc, uint32_t gain,
+                                bool_t bUp, VVSENSOR_GainPos_t *pPos)
+{
+    const VVSENSOR_GainRange_t *pRanges = pDesc->pGainRanges;
+    VVSENSOR_GainPos_t pos;
+    uint32_t lo = 0, hi = pDesc->gainRangeCount, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        pos.range = mid;
+        pos.step = pRanges[mid].count - 1;
+        if (VVSENSOR_GainAt(pDesc, pos, NULL, NULL) < gain)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == pDesc->gainRangeCount) {
+        if (bUp || lo == 0)
+            return BOOL_FALSE;
+        pPos->range = lo - 1;
+        pPos->step = pRanges[lo - 1].count - 1;
+        return BOOL_TRUE;
+    }
+
+    pos.range = lo;
+    lo = 0;
+    hi = pRanges[pos.range].count - 1;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        pos.step = mid;
+        if (VVSENSOR_GainAt(pDesc, pos, NULL, NULL) < gain)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    pos.step = lo;
+
+    if (!bUp && VVSENSOR_GainAt(pDesc, pos, NULL, NULL) > gain &&
+        !VVSENSOR_PrevGain(pDesc, &pos))
+        return BOOL_FALSE;
+
+    *pPos = pos;
+    return BOOL_TRUE;
+}
+
+/* the steps of the gain table within the mode gain limits */
+static bool_t VVSENSOR_GainBounds(VVSENSOR_Context_t *pSensorCtx,
+                                  VVSENSOR_GainPos_t *pMin, VVSENSOR_GainPos_t *pMax)
+{
+    const VVSENSOR_Desc_t *pDesc = pSensorCtx->pDesc;
+    const struct vvcam_sensor_ae_info_s *pModeAe = &pSensorCtx->CurMode.ae_info;
+    uint32_t minGain, maxGain;
+
+    if (pDesc->pGainRanges == NULL || pDesc->gainRangeCount == 0)
+        return BOOL_FALSE;
+
+    minGain = ((uint64_t)pModeAe->min_again * pModeAe->min_dgain) >> ISI_EXPO_PARAS_FIX_FRACBITS;
+    maxGain = ((uint64_t)pModeAe->max_again * pModeAe->max_dgain) >> ISI_EXPO_PARAS_FIX_FRACBITS;
+    if (!VVSENSOR_FindGain(pDesc, minGain, BOOL_TRUE, pMin) ||
+        !VVSENSOR_FindGain(pDesc, maxGain, BOOL_FALSE, pMax))
+        return BOOL_FALSE;
+
+    return VVSENSOR_GainAt(pDesc, *pMin, NULL, NULL) <=
+           VVSENSOR_GainAt(pDesc, *pMax, NULL, NULL);
+}
+
+/* longest integration, in lines, the mode and the exposure budget allow */
+static uint32_t VVSENSOR_PlanMaxLine(VVSENSOR_Context_t *pSensorCtx)
+{
+    const struct vvcam_sensor_ae_info_s *pModeAe = &pSensorCtx->CurMode.ae_info;
+    uint32_t oneLineTime = pSensorCtx->AeInfo.oneLineExpTime;
+    uint32_t maxLine = pModeAe->max_integration_line;
+
+    if (pSensorCtx->MaxIntTime != 0 && oneLineTime != 0 &&
+        pSensorCtx->MaxIntTime / oneLineTime < maxLine)
+        maxLine = pSensorCtx->MaxIntTime / oneLineTime;
+    if (maxLine < pModeAe->min_integration_line)
+        maxLine = pModeAe->min_integration_line;
+
+    return maxLine;
+}
+
+RESULT VVSENSOR_UpdateIsiAEInfo(IsiSensorHandle_t handle)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    const struct vvcam_sensor_ae_info_s *pModeAe = &pSensorCtx->CurMode.ae_info;
+    VVSENSOR_GainPos_t minGainPos, maxGainPos;
+    uint32_t again, dgain;
+
+    uint32_t exp_line_time = pModeAe->one_line_exp_time_ns;
+
+    IsiSensorAeInfo_t *pAeInfo = &pSensorCtx->AeInfo;
+    pAeInfo->oneLineExpTime = (exp_line_time << ISI_EXPO_PARAS_FIX_FRACBITS) / 1000;
+
+    if (pSensorCtx->CurMode.hdr_mode == SENSOR_MODE_LINEAR) {
+        pAeInfo->maxIntTime.linearInt =
+            pModeAe->max_integration_line * pAeInfo->oneLineExpTime;
+        pAeInfo->minIntTime.linearInt =
+            pModeAe->min_integration_line * pAeInfo->oneLineExpTime;
+        pAeInfo->maxAGain.linearGainParas = pModeAe->max_again;
+        pAeInfo->minAGain.linearGainParas = pModeAe->min_again;
+        pAeInfo->maxDGain.linearGainParas = pModeAe->max_dgain;
+        pAeInfo->minDGain.linearGainParas = pModeAe->min_dgain;
+    } else {
+        switch (pSensorCtx->CurMode.stitching_mode) {
+            case SENSOR_STITCHING_DUAL_DCG:
+            case SENSOR_STITCHING_3DOL:
+            case SENSOR_STITCHING_LINEBYLINE:
+                pAeInfo->maxIntTime.triInt.triSIntTime =
+                    pModeAe->max_vsintegration_line * pAeInfo->oneLineExpTime;
+                pAeInfo->minIntTime.triInt.triSIntTime =
+                    pModeAe->min_vsintegration_line * pAeInfo->oneLineExpTime;
+
+                pAeInfo->maxIntTime.triInt.triIntTime =
+                    pModeAe->max_integration_line * pAeInfo->oneLineExpTime;
+                pAeInfo->minIntTime.triInt.triIntTime =
+                    pModeAe->min_integration_line * pAeInfo->oneLineExpTime;
+
+                if (pSensorCtx->CurMode.stitching_mode == SENSOR_STITCHING_DUAL_DCG) {
+                    pAeInfo->maxIntTime.triInt.triLIntTime = pAeInfo->maxIntTime.triInt.triIntTime;
+                    pAeInfo->minIntTime.triInt.triLIntTime = pAeInfo->minIntTime.triInt.triIntTime;
+                } else {
+                    pAeInfo->maxIntTime.triInt.triLIntTime =
+                        pModeAe->max_longintegration_line * pAeInfo->oneLineExpTime;
+                    pAeInfo->minIntTime.triInt.triLIntTime =
+                        pModeAe->min_longintegration_line * pAeInfo->oneLineExpTime;
+                }
+
+                pAeInfo->maxAGain.triGainParas.triSGain = pModeAe->max_short_again;
+                pAeInfo->minAGain.triGainParas.triSGain = pModeAe->min_short_again;
+                pAeInfo->maxDGain.triGainParas.triSGain = pModeAe->max_short_dgain;
+                pAeInfo->minDGain.triGainParas.triSGain = pModeAe->min_short_dgain;
+
+                pAeInfo->maxAGain.triGainParas.triGain = pModeAe->max_again;
+                pAeInfo->minAGain.triGainParas.triGain = pModeAe->min_again;
+                pAeInfo->maxDGain.triGainParas.triGain = pModeAe->max_dgain;
+                pAeInfo->minDGain.triGainParas.triGain = pModeAe->min_dgain;
+
+                pAeInfo->maxAGain.triGainParas.triLGain = pModeAe->max_long_again;
+                pAeInfo->minAGain.triGainParas.triLGain = pModeAe->min_long_again;
+                pAeInfo->maxDGain.triGainParas.triLGain = pModeAe->max_long_dgain;
+                pAeInfo->minDGain.triGainParas.triLGain = pModeAe->min_long_dgain;
+                break;
+            case SENSOR_STITCHING_DUAL_DCG_NOWAIT:
+            case SENSOR_STITCHING_16BIT_COMPRESS:
+            case SENSOR_STITCHING_L_AND_S:
+            case SENSOR_STITCHING_2DOL:
+                pAeInfo->maxIntTime.dualInt.dualIntTime =
+                    pModeAe->max_integration_line * pAeInfo->oneLineExpTime;
+                pAeInfo->minIntTime.dualInt.dualIntTime =
+                    pModeAe->min_integration_line * pAeInfo->oneLineExpTime;
+
+                if (pSensorCtx->CurMode.stitching_mode == SENSOR_STITCHING_DUAL_DCG_NOWAIT) {
+                    pAeInfo->maxIntTime.dualInt.dualSIntTime = pAeInfo->maxIntTime.dualInt.dualIntTime;
+                    pAeInfo->minIntTime.dualInt.dualSIntTime = pAeInfo->minIntTime.dualInt.dualIntTime;
+                } else {
+                    pAeInfo->maxIntTime.dualInt.dualSIntTime =
+                        pModeAe->max_vsintegration_line * pAeInfo->oneLineExpTime;
+                    pAeInfo->minIntTime.dualInt.dualSIntTime =
+                        pModeAe->min_vsintegration_line * pAeInfo->oneLineExpTime;
+                }
+
+                if (pSensorCtx->CurMode.stitching_mode == SENSOR_STITCHING_DUAL_DCG_NOWAIT) {
+                    pAeInfo->maxAGain.dualGainParas.dualSGain = pModeAe->max_again;
+                    pAeInfo->minAGain.dualGainParas.dualSGain = pModeAe->min_again;
+                    pAeInfo->maxDGain.dualGainParas.dualSGain = pModeAe->max_dgain;
+                    pAeInfo->minDGain.dualGainParas.dualSGain = pModeAe->min_dgain;
+                    pAeInfo->maxAGain.dualGainParas.dualGain  = pModeAe->max_long_again;
+                    pAeInfo->minAGain.dualGainParas.dualGain  = pModeAe->min_long_again;
+                    pAeInfo->maxDGain.dualGainParas.dualGain  = pModeAe->max_long_dgain;
+                    pAeInfo->minDGain.dualGainParas.dualGain  = pModeAe->min_long_dgain;
+                } else {
+                    pAeInfo->maxAGain.dualGainParas.dualSGain = pModeAe->max_short_again;
+                    pAeInfo->minAGain.dualGainParas.dualSGain = pModeAe->min_short_again;
+                    pAeInfo->maxDGain.dualGainParas.dualSGain = pModeAe->max_short_dgain;
+                    pAeInfo->minDGain.dualGainParas.dualSGain = pModeAe->min_short_dgain;
+                    pAeInfo->maxAGain.dualGainParas.dualGain  = pModeAe->max_again;
+                    pAeInfo->minAGain.dualGainParas.dualGain  = pModeAe->min_again;
+                    pAeInfo->maxDGain.dualGainParas.dualGain  = pModeAe->max_dgain;
+                    pAeInfo->minDGain.dualGainParas.dualGain  = pModeAe->min_dgain;
+                }
+
+                break;
+            default:
+                break;
+        }
+    }
+    pAeInfo->gainStep = pModeAe->gain_step;
+    pAeInfo->currFps  = pModeAe->cur_fps;
+    pAeInfo->maxFps   = pModeAe->max_fps;
+    pAeInfo->minFps   = pModeAe->min_fps;
+    pAeInfo->minAfps  = pModeAe->min_afps;
+    pAeInfo->hdrRatio[0] = pModeAe->hdr_ratio.ratio_l_s;
+    pAeInfo->hdrRatio[1] = pModeAe->hdr_ratio.ratio_s_vs;
+
+    pAeInfo->intUpdateDlyFrm = pModeAe->int_update_delay_frm;
+    pAeInfo->gainUpdateDlyFrm = pModeAe->gain_update_delay_frm;
+
+    if (pSensorCtx->minAfps != 0) {
+        pAeInfo->minAfps = pSensorCtx->minAfps;
+    }
+
+    /* let the AE ask only for what the exposure planner can apply */
+    if (pSensorCtx->MaxIntTime != 0 &&
+        pSensorCtx->CurMode.hdr_mode == SENSOR_MODE_LINEAR &&
+        VVSENSOR_GainBounds(pSensorCtx, &minGainPos, &maxGainPos)) {
+        pAeInfo->maxIntTime.linearInt =
+            VVSENSOR_PlanMaxLine(pSensorCtx) * pAeInfo->oneLineExpTime;
+        VVSENSOR_GainAt(pSensorCtx->pDesc, maxGainPos, &again, &dgain);
+        if (pAeInfo->maxAGain.linearGainParas > again)
+            pAeInfo->maxAGain.linearGainParas = again;
+        if (pAeInfo->maxDGain.linearGainParas > dgain)
+            pAeInfo->maxDGain.linearGainParas = dgain;
+    }
+
+    if (pSensorCtx->ThermalThrottled) {
+        uint32_t cap = pSensorCtx->ThermalLimits.maxFps;
+
+        if (pAeInfo->maxFps > cap)
+            pAeInfo->maxFps = cap;
+        if (pAeInfo->minAfps > cap)
+            pAeInfo->minAfps = cap;
+    }
+
+    return RET_SUCCESS;
+}
+
+/* CurMode and the AE info from the kernel, without the driver hooks */
+static RESULT VVSENSOR_ReadMode(IsiSensorHandle_t handle)
+{
+    int ret = 0;
+    struct vvcam_mode_info_s sensor_mode;
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    memset(&sensor_mode, 0, sizeof(struct vvcam_mode_info_s));
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_G_SENSOR_MODE, &sensor_mode);
+    if (ret != 0)
+        return RET_FAILURE;
+    memcpy(&pSensorCtx->CurMode, &sensor_mode, sizeof(struct vvcam_mode_info_s));
+    pSensorCtx->Fps = 0;
+    VVSENSOR_UpdateIsiAEInfo(handle);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_UpdateCurMode(IsiSensorHandle_t handle)
+{
+    RESULT result;
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    result = VVSENSOR_ReadMode(handle);
+    if (result != RET_SUCCESS)
+        return result;
+
+    if (pSensorCtx->pDesc->pfModeUpdated)
+        return pSensorCtx->pDesc->pfModeUpdated(handle);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiGetSensorModeIss(IsiSensorHandle_t handle,
+                                           IsiSensorMode_t *pMode)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    if (pMode == NULL)
+        return (RET_NULL_POINTER);
+
+    memcpy(pMode, &pSensorCtx->CurMode, sizeof(IsiSensorMode_t));
+
+    TRACE(VVSENSOR_INFO, "%s (exit) \n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSetSensorModeIss(IsiSensorHandle_t handle,
+                                           IsiSensorMode_t *pMode)
+{
+    int ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pMode == NULL)
+        return (RET_NULL_POINTER);
+
+    struct vvcam_mode_info_s sensor_mode;
+    memset(&sensor_mode, 0, sizeof(struct vvcam_mode_info_s));
+    sensor_mode.index = pMode->index;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_SENSOR_MODE, &sensor_mode);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s set sensor mode error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    if (VVSENSOR_UpdateCurMode(handle) != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s set sensor mode failed", __func__);
+        return RET_FAILURE;
+    }
+    if (pSensorCtx->pDesc->pfModeSet)
+        pSensorCtx->pDesc->pfModeSet(handle);
+
+    TRACE(VVSENSOR_INFO, "%s (exit) \n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSensorSetStreamingIss(IsiSensorHandle_t handle,
+                                                bool_t on)
+{
+    int ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    uint32_t status = on;
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_STREAM, &status);
+    if (ret != 0){
+        TRACE(VVSENSOR_ERROR, "%s set sensor stream %d error\n", __func__,ret);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: set streaming %d\n", __func__, on);
+    TRACE(VVSENSOR_INFO, "%s (exit) \n", __func__);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiCreateSensorIss(const VVSENSOR_Desc_t *pDesc,
+                                   IsiSensorInstanceConfig_t *pConfig)
+{
+    RESULT result = RET_SUCCESS;
+    VVSENSOR_Context_t *pSensorCtx;
+    struct vvcam_clk_s clk;
+    IsiSensorMode_t SensorMode;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    if (!pDesc || !pConfig || !pConfig->pSensor || !pConfig->HalHandle)
+        return RET_NULL_POINTER;
+    if (pDesc->contextSize < sizeof(VVSENSOR_Context_t))
+        return RET_INVALID_PARM;
+
+    pSensorCtx = (VVSENSOR_Context_t *) malloc(pDesc->contextSize);
+    if (!pSensorCtx)
+        return RET_OUTOFMEM;
+
+    memset(pSensorCtx, 0, pDesc->contextSize);
+    pSensorCtx->IsiCtx.HalHandle = pConfig->HalHandle;
+    pSensorCtx->IsiCtx.pSensor   = pConfig->pSensor;
+    pSensorCtx->pDesc = pDesc;
+    pConfig->hSensor = (IsiSensorHandle_t) pSensorCtx;
+
+    result = VVSENSOR_IsiSensorSetPowerIss(pSensorCtx, BOOL_TRUE);
+    if (result != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s set power error\n", __func__);
+        goto err_free;
+    }
+    memset(&clk, 0, sizeof(struct vvcam_clk_s));
+    result = VVSENSOR_IsiSensorGetClkIss(pSensorCtx, &clk);
+    if (result != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s get clk error\n", __func__);
+        goto err_power;
+    }
+    clk.status = 1;
+    result = VVSENSOR_IsiSensorSetClkIss(pSensorCtx, &clk);
+    if (result != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s set clk error\n", __func__);
+        goto err_power;
+    }
+    result = VVSENSOR_IsiResetSensorIss(pSensorCtx);
+    if (result != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s retset sensor error\n", __func__);
+        goto err_clk;
+    }
+
+    SensorMode.index = pConfig->SensorModeIndex;
+    result = VVSENSOR_IsiSetSensorModeIss(pSensorCtx, &SensorMode);
+    if (result != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s set sensor mode error\n", __func__);
+        goto err_clk;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: %s (exit)\n", __func__, pDesc->pszName);
+
+    return result;
+
+err_clk:
+    clk.status = 0;
+    VVSENSOR_IsiSensorSetClkIss(pSensorCtx, &clk);
+err_power:
+    VVSENSOR_IsiSensorSetPowerIss(pSensorCtx, BOOL_FALSE);
+err_free:
+    free(pSensorCtx);
+    pConfig->hSensor = NULL;
+    return RET_FAILURE;
+}
+
+static RESULT VVSENSOR_IsiReleaseSensorIss(IsiSensorHandle_t handle)
+{
+    TRACE(VVSENSOR_INFO, "%s (enter) \n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL)
+        return (RET_WRONG_HANDLE);
+
+    VVSENSOR_IsiSensorSetStreamingIss(pSensorCtx, BOOL_FALSE);
+    struct vvcam_clk_s clk;
+    memset(&clk, 0, sizeof(struct vvcam_clk_s));
+    VVSENSOR_IsiSensorGetClkIss(pSensorCtx, &clk);
+    clk.status = 0;
+    VVSENSOR_IsiSensorSetClkIss(pSensorCtx, &clk);
+    VVSENSOR_IsiSensorSetPowerIss(pSensorCtx, BOOL_FALSE);
+    free(pSensorCtx);
+    pSensorCtx = NULL;
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiHalQuerySensorIss(HalHandle_t HalHandle,
+                                     IsiSensorModeInfoArray_t *pSensorMode)
+{
+    int ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s (enter) \n", __func__);
+
+    if (HalHandle == NULL || pSensorMode == NULL)
+        return RET_NULL_POINTER;
+
+    HalContext_t *pHalCtx = (HalContext_t *)HalHandle;
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_QUERY, pSensorMode);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s: query sensor mode info error!\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiQuerySensorIss(IsiSensorHandle_t handle,
+                                         IsiSensorModeInfoArray_t *pSensorMode)
+{
+    RESULT result = RET_SUCCESS;
+
+    TRACE(VVSENSOR_INFO, "%s (enter) \n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    result = VVSENSOR_IsiHalQuerySensorIss(pSensorCtx->IsiCtx.HalHandle,
+                                           pSensorMode);
+    if (result != RET_SUCCESS)
+        TRACE(VVSENSOR_ERROR, "%s: query sensor mode info error!\n", __func__);
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return result;
+}
+
+static RESULT VVSENSOR_IsiGetCapsIss(IsiSensorHandle_t handle,
+                                     IsiSensorCaps_t * pIsiSensorCaps)
+{
+    RESULT result = RET_SUCCESS;
+
+    TRACE(VVSENSOR_INFO, "%s (enter) \n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    if (pIsiSensorCaps == NULL)
+        return RET_NULL_POINTER;
+
+    IsiSensorModeInfoArray_t SensorModeInfo;
+    memset(&SensorModeInfo, 0, sizeof(IsiSensorModeInfoArray_t));
+    result = VVSENSOR_IsiQuerySensorIss(handle, &SensorModeInfo);
+    if (result != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s: query sensor mode info error!\n", __func__);
+        return RET_FAILURE;
+    }
+
+    pIsiSensorCaps->FieldSelection    = ISI_FIELDSEL_BOTH;
+    pIsiSensorCaps->YCSequence        = ISI_YCSEQ_YCBYCR;
+    pIsiSensorCaps->Conv422           = ISI_CONV422_NOCOSITED;
+    pIsiSensorCaps->HPol              = ISI_HPOL_REFPOS;
+    pIsiSensorCaps->VPol              = ISI_VPOL_NEG;
+    pIsiSensorCaps->Edge              = ISI_EDGE_RISING;
+    pIsiSensorCaps->supportModeNum    = SensorModeInfo.count;
+    pIsiSensorCaps->currentMode       = pSensorCtx->CurMode.index;
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return result;
+}
+
+static RESULT VVSENSOR_IsiSetupSensorIss(IsiSensorHandle_t handle,
+                                         const IsiSensorCaps_t *pIsiSensorCaps )
+{
+    int ret = 0;
+    RESULT result = RET_SUCCESS;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pIsiSensorCaps == NULL)
+        return RET_NULL_POINTER;
+
+    if (pIsiSensorCaps->currentMode != pSensorCtx->CurMode.index) {
+        IsiSensorMode_t SensorMode;
+        memset(&SensorMode, 0, sizeof(IsiSensorMode_t));
+        SensorMode.index = pIsiSensorCaps->currentMode;
+        result = VVSENSOR_IsiSetSensorModeIss(handle, &SensorMode);
+        if (result != RET_SUCCESS) {
+            TRACE(VVSENSOR_ERROR, "%s:set sensor mode %d failed!\n",
+                  __func__, SensorMode.index);
+            return result;
+        }
+    }
+
+#ifdef SUBDEV_V4L2
+    struct v4l2_subdev_format format;
+    memset(&format, 0, sizeof(struct v4l2_subdev_format));
+    format.format.width  = pSensorCtx->CurMode.size.bounds_width;
+    format.format.height = pSensorCtx->CurMode.size.bounds_height;
+    format.which = V4L2_SUBDEV_FORMAT_ACTIVE;
+    format.pad = 0;
+    ret = ioctl(pHalCtx->sensor_fd, VIDIOC_SUBDEV_S_FMT, &format);
+    if (ret != 0){
+        TRACE(VVSENSOR_ERROR, "%s: sensor set format error!\n", __func__);
+        return RET_FAILURE;
+    }
+#else
+    ret = ioctrl(pHalCtx->sensor_fd, VVSENSORIOC_S_INIT, NULL);
+    if (ret != 0){
+        TRACE(VVSENSOR_ERROR, "%s: sensor init error!\n", __func__);
+        return RET_FAILURE;
+    }
+#endif
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiGetSensorRevisionIss(IsiSensorHandle_t handle, uint32_t *pValue)
+{
+    int ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pValue == NULL)
+        return RET_NULL_POINTER;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_G_CHIP_ID, pValue);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s: get chip id error!\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiCheckSensorConnectionIss(IsiSensorHandle_t handle)
+{
+    RESULT result = RET_SUCCESS;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    uint32_t ChipId = 0;
+    result = VVSENSOR_IsiGetSensorRevisionIss(handle, &ChipId);
+    if (result != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s:get sensor chip id error!\n",__func__);
+        return RET_FAILURE;
+    }
+
+    if (ChipId != pSensorCtx->pDesc->chipId) {
+        TRACE(VVSENSOR_ERROR,
+            "%s:%s ChipID=0x%x,while read sensor Id=0x%x error!\n",
+             __func__, pSensorCtx->pDesc->pszName,
+             pSensorCtx->pDesc->chipId, ChipId);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiGetAeInfoIss(IsiSensorHandle_t handle,
+                                       IsiSensorAeInfo_t *pAeInfo)
+{
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    if (pAeInfo == NULL)
+        return RET_NULL_POINTER;
+
+    memcpy(pAeInfo, &pSensorCtx->AeInfo, sizeof(IsiSensorAeInfo_t));
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSetHdrRatioIss(IsiSensorHandle_t handle,
+                                         uint8_t hdrRatioNum,
+                                         uint32_t HdrRatio[])
+{
+    int ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    struct sensor_hdr_artio_s hdr_ratio;
+    if (hdrRatioNum == 2) {
+        hdr_ratio.ratio_s_vs = HdrRatio[1];
+        hdr_ratio.ratio_l_s = HdrRatio[0];
+    }else {
+        hdr_ratio.ratio_s_vs = HdrRatio[0];
+        hdr_ratio.ratio_l_s = 0;
+    }
+
+    if (hdr_ratio.ratio_s_vs == pSensorCtx->CurMode.ae_info.hdr_ratio.ratio_s_vs &&
+        hdr_ratio.ratio_l_s == pSensorCtx->CurMode.ae_info.hdr_ratio.ratio_l_s)
+        return RET_SUCCESS;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_HDR_RADIO, &hdr_ratio);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR,"%s: set hdr ratio error!\n", __func__);
+        return RET_FAILURE;
+    }
+    if (VVSENSOR_ReadMode(handle) != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR,"%s: get mode info error!\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+/* lines closest to exposure at gain */
+static uint32_t VVSENSOR_PlanLines(uint64_t exposure, uint32_t oneLineTime,
+                                   uint32_t gain, uint32_t minLine, uint32_t maxLine)
+{
+    uint64_t lineExposure = (uint64_t)oneLineTime * gain;
+    uint64_t lines = (exposure + lineExposure / 2) / lineExposure;
+
+    if (lines < minLine)
+        return minLine;
+    if (lines > maxLine)
+        return maxLine;
+
+    return lines;
+}
+
+RESULT VVSENSOR_IsiPlanExposureIss(IsiSensorHandle_t handle, uint64_t exposure,
+                                   VVSENSOR_ExposurePlan_t *pPlan)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    const VVSENSOR_Desc_t *pDesc;
+    const VVSENSOR_GainRange_t *pRange;
+    VVSENSOR_GainPos_t minPos, maxPos, pos, lowerPos;
+    uint32_t oneLineTime, minLine, maxLine, intLine, gain, lowerGain;
+    uint64_t needed, applied, err, lowerErr;
+
+    if (pSensorCtx == NULL || pPlan == NULL)
+        return RET_NULL_POINTER;
+
+    pDesc = pSensorCtx->pDesc;
+    if (pDesc->pGainRanges == NULL || pSensorCtx->CurMode.hdr_mode != SENSOR_MODE_LINEAR)
+        return RET_NOTSUPP;
+
+    oneLineTime = pSensorCtx->AeInfo.oneLineExpTime;
+    if (oneLineTime == 0 || !VVSENSOR_GainBounds(pSensorCtx, &minPos, &maxPos)) {
+        TRACE(VVSENSOR_ERROR, "%s: %s: no gain within the mode limits\n",
+              __func__, pDesc->pszName);
+        return RET_FAILURE;
+    }
+    minLine = pSensorCtx->CurMode.ae_info.min_integration_line;
+    maxLine = VVSENSOR_PlanMaxLine(pSensorCtx);
+    if (maxLine == 0)
+        return RET_FAILURE;
+
+    /* integrate as long as allowed, gain only for what that cannot reach */
+    needed = (exposure + (uint64_t)maxLine * oneLineTime - 1) /
+             ((uint64_t)maxLine * oneLineTime);
+    if (needed <= VVSENSOR_GainAt(pDesc, minPos, NULL, NULL)) {
+        pos = minPos;
+        gain = VVSENSOR_GainAt(pDesc, pos, NULL, NULL);
+        intLine = VVSENSOR_PlanLines(exposure, oneLineTime, gain, minLine, maxLine);
+    } else if (needed > VVSENSOR_GainAt(pDesc, maxPos, NULL, NULL)) {
+        pos = maxPos;
+        gain = VVSENSOR_GainAt(pDesc, pos, NULL, NULL);
+        intLine = maxLine;
+    } else {
+        VVSENSOR_FindGain(pDesc, needed, BOOL_TRUE, &pos);
+        gain = VVSENSOR_GainAt(pDesc, pos, NULL, NULL);
+        intLine = VVSENSOR_PlanLines(exposure, oneLineTime, gain, minLine, maxLine);
+
+        /* one step less gain at the longest integration may be as close */
+        lowerPos = pos;
+        if (VVSENSOR_PrevGain(pDesc, &lowerPos)) {
+            applied = (uint64_t)intLine * oneLineTime * gain;
+            err = applied > exposure ? applied - exposure : exposure - applied;
+            lowerGain = VVSENSOR_GainAt(pDesc, lowerPos, NULL, NULL);
+            lowerErr = exposure - (uint64_t)maxLine * oneLineTime * lowerGain;
+            if (lowerErr <= err) {
+                pos = lowerPos;
+                gain = lowerGain;
+                intLine = maxLine;
+            }
+        }
+    }
+
+    pRange = &pDesc->pGainRanges[pos.range];
+    pPlan->intLine = intLine;
+    pPlan->intTime = intLine * oneLineTime;
+    pPlan->gain = VVSENSOR_GainAt(pDesc, pos, &pPlan->again, &pPlan->dgain);
+    pPlan->gainRequest = pRange->request + pos.step * pRange->requestStep;
+    pPlan->exposure = (uint64_t)pPlan->intTime * pPlan->gain;
+
+    return RET_SUCCESS;
+}
+
+/* write the planned split of exposure, see VVSENSOR_IsiSetExposureBudgetIss() */
+static RESULT VVSENSOR_ApplyExposure(IsiSensorHandle_t handle, uint64_t exposure)
+{
+    int ret = 0;
+    RESULT result;
+    VVSENSOR_ExposurePlan_t plan;
+    uint32_t IntLine;
+    uint32_t Gain;
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    result = VVSENSOR_IsiPlanExposureIss(handle, exposure, &plan);
+    if (result != RET_SUCCESS)
+        return result;
+
+    IntLine = plan.intLine;
+    if (IntLine != pSensorCtx->IntLine) {
+        ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_EXP, &IntLine);
+        if (ret != 0) {
+            TRACE(VVSENSOR_ERROR,"%s:set sensor linear exp error!\n", __func__);
+            return RET_FAILURE;
+        }
+        pSensorCtx->IntLine = IntLine;
+    }
+
+    Gain = plan.gainRequest;
+    if (Gain != pSensorCtx->GainRequest) {
+        ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_GAIN, &Gain);
+        if (ret != 0) {
+            TRACE(VVSENSOR_ERROR,"%s:set sensor linear gain error!\n", __func__);
+            return RET_FAILURE;
+        }
+        pSensorCtx->GainRequest = Gain;
+    }
+
+    pSensorCtx->IntTime.expoFrmType = ISI_EXPO_FRAME_TYPE_1FRAME;
+    pSensorCtx->IntTime.IntegrationTime.linearInt = plan.intTime;
+    pSensorCtx->SensorGain.gain.linearGainParas = plan.gain;
+    TRACE(VVSENSOR_INFO, "%s: exposure %llu as %u lines, again %u dgain %u, %llu applied\n",
+          __func__, (unsigned long long)exposure, plan.intLine, plan.again,
+          plan.dgain, (unsigned long long)plan.exposure);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiGetIntegrationTimeIss(IsiSensorHandle_t handle,
+                                     IsiSensorIntTime_t *pIntegrationTime)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    memcpy(pIntegrationTime, &pSensorCtx->IntTime, sizeof(IsiSensorIntTime_t));
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+
+}
+
+static RESULT VVSENSOR_IsiSetIntegrationTimeIss(IsiSensorHandle_t handle,
+                                     IsiSensorIntTime_t *pIntegrationTime)
+{
+    int ret = 0;
+    uint32_t LongIntLine;
+    uint32_t IntLine;
+    uint32_t ShortIntLine;
+    uint32_t oneLineTime;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pIntegrationTime == NULL)
+        return RET_NULL_POINTER;
+
+    oneLineTime =  pSensorCtx->AeInfo.oneLineExpTime;
+    pSensorCtx->IntTime.expoFrmType = pIntegrationTime->expoFrmType;
+
+    switch (pIntegrationTime->expoFrmType) {
+        case ISI_EXPO_FRAME_TYPE_1FRAME:
+            if (pSensorCtx->MaxIntTime != 0) {
+                /* planned together with the last gain */
+                pSensorCtx->PlanIntTime = pIntegrationTime->IntegrationTime.linearInt;
+                if (VVSENSOR_ApplyExposure(handle, (uint64_t)pSensorCtx->PlanIntTime *
+                                           pSensorCtx->PlanGain) != RET_SUCCESS)
+                    return RET_FAILURE;
+                break;
+            }
+            IntLine = (pIntegrationTime->IntegrationTime.linearInt +
+                       (oneLineTime / 2)) / oneLineTime;
+            if (IntLine != pSensorCtx->IntLine) {
+                ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_EXP, &IntLine);
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor linear exp error!\n", __func__);
+                    return RET_FAILURE;
+                }
+               pSensorCtx->IntLine = IntLine;
+            }
+            TRACE(VVSENSOR_INFO, "%s set linear exp %d \n", __func__,IntLine);
+            pSensorCtx->IntTime.IntegrationTime.linearInt =  IntLine * oneLineTime;
+            break;
+        case ISI_EXPO_FRAME_TYPE_2FRAMES:
+            IntLine = (pIntegrationTime->IntegrationTime.dualInt.dualIntTime +
+                       (oneLineTime / 2)) / oneLineTime;
+            if (IntLine != pSensorCtx->IntLine) {
+                ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_EXP, &IntLine);
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor dual exp error!\n", __func__);
+                    return RET_FAILURE;
+                }
+                pSensorCtx->IntLine = IntLine;
+            }
+
+            if (pSensorCtx->CurMode.stitching_mode != SENSOR_STITCHING_DUAL_DCG_NOWAIT) {
+                ShortIntLine = (pIntegrationTime->IntegrationTime.dualInt.dualSIntTime +
+                               (oneLineTime / 2)) / oneLineTime;
+                if (ShortIntLine != pSensorCtx->ShortIntLine) {
+                    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_VSEXP, &ShortIntLine);
+                    if (ret != 0) {
+                        TRACE(VVSENSOR_ERROR,"%s:set sensor dual vsexp error!\n", __func__);
+                        return RET_FAILURE;
+                    }
+                    pSensorCtx->ShortIntLine = ShortIntLine;
+                }
+            } else {
+                ShortIntLine = IntLine;
+                pSensorCtx->ShortIntLine = ShortIntLine;
+            }
+            TRACE(VVSENSOR_INFO, "%s set dual exp %d short_exp %d\n", __func__, IntLine, ShortIntLine);
+            pSensorCtx->IntTime.IntegrationTime.dualInt.dualIntTime  = IntLine * oneLineTime;
+            pSensorCtx->IntTime.IntegrationTime.dualInt.dualSIntTime = ShortIntLine * oneLineTime;
+            break;
+        case ISI_EXPO_FRAME_TYPE_3FRAMES:
+            if (pSensorCtx->CurMode.stitching_mode != SENSOR_STITCHING_DUAL_DCG_NOWAIT) {
+                LongIntLine = (pIntegrationTime->IntegrationTime.triInt.triLIntTime +
+                        (oneLineTime / 2)) / oneLineTime;
+                if (LongIntLine != pSensorCtx->LongIntLine) {
+                    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_LONG_EXP, &LongIntLine);
+                    if (ret != 0) {
+                        TRACE(VVSENSOR_ERROR,"%s:set sensor tri lexp error!\n", __func__);
+                        return RET_FAILURE;
+                    }
+                    pSensorCtx->LongIntLine = LongIntLine;
+                }
+            } else {
+                LongIntLine = (pIntegrationTime->IntegrationTime.triInt.triIntTime +
+                       (oneLineTime / 2)) / oneLineTime;
+                pSensorCtx->LongIntLine = LongIntLine;
+            }
+
+            IntLine = (pIntegrationTime->IntegrationTime.triInt.triIntTime +
+                       (oneLineTime / 2)) / oneLineTime;
+            if (IntLine != pSensorCtx->IntLine) {
+                ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_EXP, &IntLine);
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor tri exp error!\n", __func__);
+                    return RET_FAILURE;
+                }
+                pSensorCtx->IntLine = IntLine;
+            }
+
+            ShortIntLine = (pIntegrationTime->IntegrationTime.triInt.triSIntTime +
+                       (oneLineTime / 2)) / oneLineTime;
+            if (ShortIntLine != pSensorCtx->ShortIntLine) {
+                ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_VSEXP, &ShortIntLine);
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor tri vsexp error!\n", __func__);
+                    return RET_FAILURE;
+                }
+                pSensorCtx->ShortIntLine = ShortIntLine;
+            }
+            TRACE(VVSENSOR_INFO, "%s set tri long exp %d exp %d short_exp %d\n", __func__, LongIntLine, IntLine, ShortIntLine);
+            pSensorCtx->IntTime.IntegrationTime.triInt.triLIntTime = LongIntLine * oneLineTime;
+            pSensorCtx->IntTime.IntegrationTime.triInt.triIntTime = IntLine * oneLineTime;
+            pSensorCtx->IntTime.IntegrationTime.triInt.triSIntTime = ShortIntLine * oneLineTime;
+            break;
+        default:
+            return RET_FAILURE;
+            break;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiGetGainIss(IsiSensorHandle_t handle, IsiSensorGain_t *pGain)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    if (pGain == NULL)
+        return RET_NULL_POINTER;
+    memcpy(pGain, &pSensorCtx->SensorGain, sizeof(IsiSensorGain_t));
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSetGainIss(IsiSensorHandle_t handle, IsiSensorGain_t *pGain)
+{
+    int ret = 0;
+    uint32_t LongGain;
+    uint32_t Gain;
+    uint32_t ShortGain;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pGain == NULL)
+        return RET_NULL_POINTER;
+
+    pSensorCtx->SensorGain.expoFrmType = pGain->expoFrmType;
+    switch (pGain->expoFrmType) {
+        case ISI_EXPO_FRAME_TYPE_1FRAME:
+            if (pSensorCtx->MaxIntTime != 0) {
+                /* planned together with the last integration time */
+                pSensorCtx->PlanGain = pGain->gain.linearGainParas;
+                if (VVSENSOR_ApplyExposure(handle, (uint64_t)pSensorCtx->PlanIntTime *
+                                           pSensorCtx->PlanGain) != RET_SUCCESS)
+                    return RET_FAILURE;
+                break;
+            }
+            Gain = pGain->gain.linearGainParas;
+            if (pSensorCtx->SensorGain.gain.linearGainParas != Gain) {
+                ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_GAIN, &Gain);
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor linear gain error!\n", __func__);
+                    return RET_FAILURE;
+                }
+            }
+            pSensorCtx->SensorGain.gain.linearGainParas = pGain->gain.linearGainParas;
+            TRACE(VVSENSOR_INFO, "%s set linear gain %d\n", __func__,pGain->gain.linearGainParas);
+            break;
+        case ISI_EXPO_FRAME_TYPE_2FRAMES:
+            Gain = pGain->gain.dualGainParas.dualGain;
+            if (pSensorCtx->SensorGain.gain.dualGainParas.dualGain != Gain) {
+                if (pSensorCtx->CurMode.stitching_mode != SENSOR_STITCHING_DUAL_DCG_NOWAIT) {
+                    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_GAIN, &Gain);
+                } else {
+                    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_LONG_GAIN, &Gain);
+                }
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor dual gain error!\n", __func__);
+                    return RET_FAILURE;
+                }
+            }
+
+            ShortGain = pGain->gain.dualGainParas.dualSGain;
+            if (pSensorCtx->SensorGain.gain.dualGainParas.dualSGain != ShortGain) {
+                if (pSensorCtx->CurMode.stitching_mode != SENSOR_STITCHING_DUAL_DCG_NOWAIT) {
+                    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_VSGAIN, &ShortGain);
+                } else {
+                    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_GAIN, &ShortGain);
+                }
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor dual vs gain error!\n", __func__);
+                    return RET_FAILURE;
+                }
+            }
+            TRACE(VVSENSOR_INFO,"%s:set gain%d short gain %d!\n", __func__,Gain,ShortGain);
+            pSensorCtx->SensorGain.gain.dualGainParas.dualGain = Gain;
+            pSensorCtx->SensorGain.gain.dualGainParas.dualSGain = ShortGain;
+            break;
+        case ISI_EXPO_FRAME_TYPE_3FRAMES:
+            LongGain = pGain->gain.triGainParas.triLGain;
+            if (pSensorCtx->SensorGain.gain.triGainParas.triLGain != LongGain) {
+                ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_LONG_GAIN, &LongGain);
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor tri gain error!\n", __func__);
+                    return RET_FAILURE;
+                }
+            }
+            Gain = pGain->gain.triGainParas.triGain;
+            if (pSensorCtx->SensorGain.gain.triGainParas.triGain != Gain) {
+                ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_GAIN, &Gain);
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor tri gain error!\n", __func__);
+                    return RET_FAILURE;
+                }
+            }
+
+            ShortGain = pGain->gain.triGainParas.triSGain;
+            if (pSensorCtx->SensorGain.gain.triGainParas.triSGain != ShortGain) {
+                ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_VSGAIN, &ShortGain);
+                if (ret != 0) {
+                    TRACE(VVSENSOR_ERROR,"%s:set sensor tri vs gain error!\n", __func__);
+                    return RET_FAILURE;
+                }
+            }
+            TRACE(VVSENSOR_INFO,"%s:set long gain %d gain%d short gain %d!\n", __func__, LongGain, Gain, ShortGain);
+            pSensorCtx->SensorGain.gain.triGainParas.triLGain = LongGain;
+            pSensorCtx->SensorGain.gain.triGainParas.triGain = Gain;
+            pSensorCtx->SensorGain.gain.triGainParas.triSGain = ShortGain;
+            break;
+        default:
+            return RET_FAILURE;
+            break;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiGetSensorFpsIss(IsiSensorHandle_t handle, uint32_t * pfps)
+{
+    TRACE(VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    if (pfps == NULL)
+        return RET_NULL_POINTER;
+
+    *pfps = pSensorCtx->CurMode.ae_info.cur_fps;
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiSetSensorFpsIss(IsiSensorHandle_t handle, uint32_t fps)
+{
+    int ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pSensorCtx->ThermalThrottled && fps > pSensorCtx->ThermalLimits.maxFps)
+        fps = pSensorCtx->ThermalLimits.maxFps;
+
+    /* AFPS repeats the same request; the mode has not moved since */
+    if (fps != 0 && fps == pSensorCtx->Fps)
+        return RET_SUCCESS;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_FPS, &fps);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR,"%s:set sensor fps error!\n", __func__);
+        return RET_FAILURE;
+    }
+    if (VVSENSOR_ReadMode(handle) != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR,"%s:get sensor mode error!\n", __func__);
+        return RET_FAILURE;
+    }
+    pSensorCtx->Fps = fps;
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSetSensorAfpsLimitsIss(IsiSensorHandle_t handle, uint32_t minAfps)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    TRACE(VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    if ((minAfps > pSensorCtx->CurMode.ae_info.max_fps) ||
+        (minAfps < pSensorCtx->CurMode.ae_info.min_fps))
+        return RET_FAILURE;
+    pSensorCtx->minAfps = minAfps;
+    pSensorCtx->CurMode.ae_info.min_afps = minAfps;
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiGetSensorIspStatusIss(IsiSensorHandle_t handle,
+                               IsiSensorIspStatus_t *pSensorIspStatus)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    TRACE(VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    if (pSensorCtx->CurMode.hdr_mode == SENSOR_MODE_HDR_NATIVE) {
+        pSensorIspStatus->useSensorAWB = true;
+        pSensorIspStatus->useSensorBLC = true;
+    } else {
+        pSensorIspStatus->useSensorAWB = false;
+        pSensorIspStatus->useSensorBLC = false;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+#ifndef ISI_LITE
+static RESULT VVSENSOR_IsiSensorSetBlcIss(IsiSensorHandle_t handle, IsiSensorBlc_t * pBlc)
+{
+    int32_t ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pBlc == NULL)
+        return RET_NULL_POINTER;
+
+    struct sensor_blc_s SensorBlc;
+    SensorBlc.red = pBlc->red;
+    SensorBlc.gb = pBlc->gb;
+    SensorBlc.gr = pBlc->gr;
+    SensorBlc.blue = pBlc->blue;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_BLC, &SensorBlc);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s: set blc error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSensorSetWBIss(IsiSensorHandle_t handle, IsiSensorWB_t *pWb)
+{
+    int32_t ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pWb == NULL)
+        return RET_NULL_POINTER;
+
+    struct sensor_white_balance_s SensorWb;
+    SensorWb.r_gain = pWb->r_gain;
+    SensorWb.gr_gain = pWb->gr_gain;
+    SensorWb.gb_gain = pWb->gb_gain;
+    SensorWb.b_gain = pWb->b_gain;
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_WB, &SensorWb);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s: set wb error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSensorGetExpandCurveIss(IsiSensorHandle_t handle, IsiSensorExpandCurve_t *pExpandCurve)
+{
+    int32_t ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (pExpandCurve == NULL)
+        return RET_NULL_POINTER;
+
+    if ((pSensorCtx->pDesc->quirks & VVSENSOR_QUIRK_EXPAND_IF_COMPRESSED) &&
+        !pSensorCtx->CurMode.data_compress.enable)
+        return RET_NOTSUPP;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_G_EXPAND_CURVE, pExpandCurve);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s: get %d to %d bit expand curve error\n",
+              __func__, pExpandCurve->x_bit, pExpandCurve->y_bit);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+/* 16 bit input in 64 segments of 1024, to 12 bit */
+static uint32_t VVSENSOR_CompressKnee(uint32_t x)
+{
+    if (x < 1024)
+        return x / 2;
+    else if (x < 2048)
+        return x / 4 + 256;
+    else if (x < 16384)
+        return x / 8 + 512;
+    else
+        return x / 32 + 2048;
+}
+
+static RESULT VVSENSOR_IsiSensorGetCompressCurveIss(IsiSensorHandle_t handle, IsiSensorCompressCurve_t *pCompressCurve)
+{
+    int i = 0;
+    TRACE(VVSENSOR_INFO, "%s: (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    const uint32_t *pCompressY = pSensorCtx->pDesc->pCompressY;
+
+    if (pCompressCurve == NULL)
+        return RET_NULL_POINTER;
+
+    if ((pCompressCurve->x_bit != 16) || (pCompressCurve->y_bit != 12))
+        return RET_FAILURE;
+
+    pCompressCurve->compress_x_data[0] = 0;
+    pCompressCurve->compress_y_data[0] = 0;
+    for (i = 1; i < VVSENSOR_COMPRESS_POINTS; i++) {
+        pCompressCurve->compress_px[i-1] = 10;
+        pCompressCurve->compress_x_data[i] = pCompressCurve->compress_x_data[i-1] + (1 << 10);
+        if (pCompressY)
+            pCompressCurve->compress_y_data[i] = pCompressY[i];
+        else
+            pCompressCurve->compress_y_data[i] =
+                VVSENSOR_CompressKnee(pCompressCurve->compress_x_data[i]);
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSetTestPatternIss(IsiSensorHandle_t handle,
+                                            IsiSensorTpgMode_e  tpgMode)
+{
+    int32_t ret = 0;
+
+    TRACE( VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    struct sensor_test_pattern_s TestPattern;
+    if (tpgMode == ISI_TPG_DISABLE) {
+        TestPattern.enable = 0;
+        TestPattern.pattern = 0;
+    } else {
+        TestPattern.enable = 1;
+        TestPattern.pattern = (uint32_t)tpgMode - 1;
+    }
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_TEST_PATTERN, &TestPattern);
+    if (ret != 0)
+    {
+        TRACE(VVSENSOR_ERROR, "%s: set test pattern %d error\n", __func__, tpgMode);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: test pattern enable[%d] mode[%d]\n", __func__, TestPattern.enable, TestPattern.pattern);
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+/* without VVSENSOR_CAP_FOCUS the focus entry points do nothing */
+static RESULT VVSENSOR_IsiFocusSetupIss(IsiSensorHandle_t handle)
+{
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+    vvcam_lens_t pfocus_lens;
+
+    if (!(pSensorCtx->pDesc->caps & VVSENSOR_CAP_FOCUS))
+        return RET_SUCCESS;
+
+    if (ioctl(pHalCtx->sensor_fd, VVSENSORIOC_G_LENS, &pfocus_lens) < 0) {
+        TRACE(VVSENSOR_ERROR, "%s  sensor do not have focus-lens \n", __func__);
+        return RET_NOTSUPP;
+    }
+
+    if (pSensorCtx->motor_fd <= 0) {
+        pSensorCtx->motor_fd = OpenMotorDevice(&pfocus_lens);
+        if (pSensorCtx->motor_fd < 0) {
+            TRACE(VVSENSOR_ERROR, "%s open sensor focus-lens fail\n", __func__);
+            return RET_FAILURE;
+        }
+    } else {
+        TRACE(VVSENSOR_INFO, "%s sensor focus-lens already open\n", __func__);
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiFocusReleaseIss(IsiSensorHandle_t handle)
+{
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    if (!(pSensorCtx->pDesc->caps & VVSENSOR_CAP_FOCUS))
+        return RET_SUCCESS;
+
+    if (pSensorCtx->motor_fd <= 0) {
+        return RET_NOTSUPP;
+    }
+
+    if (close(pSensorCtx->motor_fd) < 0) {
+        TRACE(VVSENSOR_ERROR,"%s close motor device failed\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiFocusGetIss(IsiSensorHandle_t handle, IsiFocusPos_t *pPos)
+{
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    struct v4l2_control ctrl;
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    if (!(pSensorCtx->pDesc->caps & VVSENSOR_CAP_FOCUS))
+        return RET_SUCCESS;
+
+    if (pSensorCtx->motor_fd <= 0) {
+        return RET_NOTSUPP;
+    }
+
+    memset(&ctrl, 0, sizeof(ctrl));
+    if (pSensorCtx->focus_mode & (1 << (pPos->mode))) {
+        if (pPos->mode == ISI_FOUCUS_MODE_ABSOLUTE) {
+            ctrl.id = V4L2_CID_FOCUS_ABSOLUTE;
+        } else if (pPos->mode == ISI_FOUCUS_MODE_RELATIVE) {
+            ctrl.id = V4L2_CID_FOCUS_RELATIVE;
+        }
+    } else {
+        TRACE(VVSENSOR_ERROR, "%s invalid Focus mode %d\n", __func__, pPos->mode);
+        return RET_FAILURE;
+    }
+
+    if (ioctl(pSensorCtx->motor_fd, VIDIOC_G_CTRL, &ctrl) < 0) {
+        TRACE(VVSENSOR_ERROR, "%s get moto pos failed\n", __func__);
+        return RET_FAILURE;
+    }
+
+    pPos->Pos = ctrl.value;
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiFocusSetIss(IsiSensorHandle_t handle, IsiFocusPos_t *pPos)
+{
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    struct v4l2_control ctrl;
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    if (!(pSensorCtx->pDesc->caps & VVSENSOR_CAP_FOCUS))
+        return RET_SUCCESS;
+
+    if (pSensorCtx->motor_fd <= 0) {
+        return RET_NOTSUPP;
+    }
+
+    memset(&ctrl, 0, sizeof(ctrl));
+    if (pSensorCtx->focus_mode & (1 << (pPos->mode))) {
+        if (pPos->mode == ISI_FOUCUS_MODE_ABSOLUTE) {
+            ctrl.id = V4L2_CID_FOCUS_ABSOLUTE;
+            ctrl.value = pPos->Pos;
+        } else if (pPos->mode == ISI_FOUCUS_MODE_RELATIVE) {
+            ctrl.id = V4L2_CID_FOCUS_RELATIVE;
+            ctrl.value = pPos->Pos;
+        }
+    } else {
+        TRACE(VVSENSOR_ERROR, "%s invalid Focus mode %d\n", __func__, pPos->mode);
+        return RET_FAILURE;
+    }
+
+    if (ioctl(pSensorCtx->motor_fd, VIDIOC_S_CTRL, &ctrl) < 0) {
+        TRACE(VVSENSOR_ERROR, "%s set moto pos failed\n", __func__);
+        return RET_FAILURE;
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiGetFocusCalibrateIss(IsiSensorHandle_t handle, IsiFoucsCalibAttr_t *pFocusCalib)
+{
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    struct v4l2_queryctrl qctrl;
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    RESULT result = RET_SUCCESS;
+
+    if (!(pSensorCtx->pDesc->caps & VVSENSOR_CAP_FOCUS))
+        return RET_SUCCESS;
+
+    if (pSensorCtx->motor_fd <= 0) {
+        return RET_NOTSUPP;
+    }
+
+    memset(&qctrl, 0, sizeof(qctrl));
+    qctrl.id = V4L2_CID_FOCUS_ABSOLUTE;
+    if (ioctl(pSensorCtx->motor_fd, VIDIOC_QUERYCTRL, &qctrl) >= 0) {
+            pSensorCtx->focus_mode |= 1 << ISI_FOUCUS_MODE_ABSOLUTE;
+            pFocusCalib->minPos = qctrl.minimum;
+            pFocusCalib->maxPos = qctrl.maximum;
+            pFocusCalib->minStep = qctrl.step;
+    } else {
+        qctrl.id = V4L2_CID_FOCUS_RELATIVE;
+        if (ioctl(pSensorCtx->motor_fd, VIDIOC_QUERYCTRL, &qctrl) >= 0) {
+                pSensorCtx->focus_mode |= 1 << ISI_FOUCUS_MODE_RELATIVE;
+                pFocusCalib->minPos = qctrl.minimum;
+                pFocusCalib->maxPos = qctrl.maximum;
+                pFocusCalib->minStep = qctrl.step;
+        } else {
+            result = RET_FAILURE;
+        }
+    }
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+    return result;
+}
+
+static RESULT VVSENSOR_IsiGetAeStartExposureIs(IsiSensorHandle_t handle, uint64_t *pExposure)
+{
+    TRACE( VVSENSOR_INFO, "%s (enter)\n", __func__);
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    if (pSensorCtx->AEStartExposure == 0) {
+        pSensorCtx->AEStartExposure =
+            (uint64_t)pSensorCtx->CurMode.ae_info.start_exposure *
+            pSensorCtx->CurMode.ae_info.one_line_exp_time_ns / 1000;
+
+    }
+    *pExposure =  pSensorCtx->AEStartExposure;
+    TRACE(VVSENSOR_INFO, "%s:get start exposure %llu\n", __func__,
+          (unsigned long long)pSensorCtx->AEStartExposure);
+
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_IsiSetAeStartExposureIs(IsiSensorHandle_t handle, uint64_t exposure)
+{
+    TRACE( VVSENSOR_INFO, "%s (enter)\n", __func__);
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    pSensorCtx->AEStartExposure = exposure;
+    TRACE(VVSENSOR_INFO, "%s set start exposure %llu\n", __func__,
+          (unsigned long long)pSensorCtx->AEStartExposure);
+    TRACE(VVSENSOR_INFO, "%s: (exit)\n", __func__);
+    return RET_SUCCESS;
+}
+#endif
+
+RESULT VVSENSOR_IsiSetSensorWindowIss(IsiSensorHandle_t handle,
+                                      const struct vvcam_window_s *pWindow)
+{
+    int ret = 0;
+    struct vvcam_window_s window;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL || pWindow == NULL)
+        return RET_NULL_POINTER;
+
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    window = *pWindow;
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_WINDOW, &window);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s set window %ux%u@%u,%u error\n", __func__,
+              window.width, window.height, window.left, window.top);
+        return RET_FAILURE;
+    }
+
+    if (VVSENSOR_UpdateCurMode(handle) != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s get sensor mode error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    /* the frame length changed, let the next AE update rewrite exposure */
+    pSensorCtx->IntLine = 0;
+
+    TRACE(VVSENSOR_INFO, "%s: %ux%u max fps %u\n", __func__,
+          pSensorCtx->CurMode.size.bounds_width,
+          pSensorCtx->CurMode.size.bounds_height,
+          pSensorCtx->CurMode.ae_info.max_fps);
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiGetSensorWindowIss(IsiSensorHandle_t handle,
+                                      struct vvcam_window_s *pWindow)
+{
+    int ret = 0;
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL || pWindow == NULL)
+        return RET_NULL_POINTER;
+
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_G_WINDOW, pWindow);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s get window error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiSetSensorFlipIss(IsiSensorHandle_t handle, uint32_t flip)
+{
+    int ret = 0;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL)
+        return RET_NULL_POINTER;
+
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_S_FLIP, &flip);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s set flip 0x%x error\n", __func__, flip);
+        return RET_FAILURE;
+    }
+
+    if (VVSENSOR_UpdateCurMode(handle) != RET_SUCCESS) {
+        TRACE(VVSENSOR_ERROR, "%s get sensor mode error\n", __func__);
+        return RET_FAILURE;
+    }
+    TRACE(VVSENSOR_INFO, "%s: flip 0x%x bayer pattern %u\n", __func__, flip,
+          pSensorCtx->CurMode.bayer_pattern);
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiGetSensorFlipIss(IsiSensorHandle_t handle, uint32_t *pFlip)
+{
+    int ret = 0;
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL || pFlip == NULL)
+        return RET_NULL_POINTER;
+
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_G_FLIP, pFlip);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s get flip error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiGetFrameStatsIss(IsiSensorHandle_t handle,
+                                    uint64_t delivered, uint32_t inFlight,
+                                    struct vvcam_frame_stats_s *pStats)
+{
+    int ret = 0;
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL || pStats == NULL)
+        return RET_NULL_POINTER;
+
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    memset(pStats, 0, sizeof(*pStats));
+    pStats->delivered = delivered;
+    pStats->in_flight = inFlight;
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_FRAME_STATS, pStats);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s get frame stats error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    if (pStats->gaps > pSensorCtx->FrameGaps) {
+        TRACE(VVSENSOR_WARN, "%s: %s: %llu of %llu frames dropped, %u gaps, max %u\n",
+              __func__, pSensorCtx->pDesc->pszName,
+              (unsigned long long)pStats->dropped,
+              (unsigned long long)pStats->frames, pStats->gaps,
+              pStats->max_gap);
+    }
+    pSensorCtx->FrameGaps = pStats->gaps;
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiRegisterBatchIss(IsiSensorHandle_t handle,
+                                    struct vvcam_reg_entry_s *pEntries,
+                                    uint32_t count)
+{
+    int ret = 0;
+    struct vvcam_reg_batch_s batch;
+    uint32_t done, i;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL || (pEntries == NULL && count != 0))
+        return RET_NULL_POINTER;
+
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    /* entries of batches that are never sent keep this */
+    for (i = 0; i < count; i++)
+        pEntries[i].status = -ECANCELED;
+
+    for (done = 0; done < count; done += batch.count) {
+        batch.count = count - done < VVCAM_REG_BATCH_MAX ?
+                      count - done : VVCAM_REG_BATCH_MAX;
+        batch.reserved = 0;
+        batch.entries = (uintptr_t)&pEntries[done];
+        ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_BATCH_REG, &batch);
+        if (ret != 0) {
+            for (i = done; i < done + batch.count - 1 && pEntries[i].status == 0; i++)
+                ;
+            TRACE(VVSENSOR_ERROR, "%s: register 0x%04x error %d, entry %u of %u\n",
+                  __func__, pEntries[i].addr, pEntries[i].status, i, count);
+            return RET_FAILURE;
+        }
+    }
+
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiSetExposureBudgetIss(IsiSensorHandle_t handle,
+                                        uint32_t maxIntTime)
+{
+    const struct vvcam_sensor_ae_info_s *pModeAe;
+
+    TRACE(VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL)
+        return RET_NULL_POINTER;
+
+    pModeAe = &pSensorCtx->CurMode.ae_info;
+    if (maxIntTime != 0) {
+        if (pSensorCtx->pDesc->pGainRanges == NULL)
+            return RET_NOTSUPP;
+        if (maxIntTime < pModeAe->min_integration_line * pSensorCtx->AeInfo.oneLineExpTime) {
+            TRACE(VVSENSOR_ERROR, "%s: %s: budget %u below the min integration time\n",
+                  __func__, pSensorCtx->pDesc->pszName, maxIntTime);
+            return RET_OUTOFRANGE;
+        }
+    }
+
+    if (pSensorCtx->MaxIntTime == 0) {
+        pSensorCtx->PlanIntTime = pSensorCtx->IntTime.IntegrationTime.linearInt;
+        pSensorCtx->PlanGain = pSensorCtx->SensorGain.gain.linearGainParas;
+    }
+    pSensorCtx->MaxIntTime = maxIntTime;
+
+    /* the planner caches requests, the plain path applied values: rewrite both */
+    pSensorCtx->IntLine = 0;
+    pSensorCtx->SensorGain.gain.linearGainParas = 0;
+    pSensorCtx->GainRequest = 0;
+
+    if (VVSENSOR_UpdateIsiAEInfo(handle) != RET_SUCCESS)
+        return RET_FAILURE;
+
+    TRACE(VVSENSOR_INFO, "%s: %s: max integration time %u, %u lines\n", __func__,
+          pSensorCtx->pDesc->pszName, pSensorCtx->AeInfo.maxIntTime.linearInt,
+          VVSENSOR_PlanMaxLine(pSensorCtx));
+    TRACE(VVSENSOR_INFO, "%s (exit)\n", __func__);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiGetSensorTemperatureIss(IsiSensorHandle_t handle,
+                                           int32_t *pTemp)
+{
+    int ret = 0;
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL || pTemp == NULL)
+        return RET_NULL_POINTER;
+
+    HalContext_t *pHalCtx = (HalContext_t *) pSensorCtx->IsiCtx.HalHandle;
+
+    if (!(pSensorCtx->pDesc->caps & VVSENSOR_CAP_TEMPERATURE))
+        return RET_NOTSUPP;
+
+    ret = ioctl(pHalCtx->sensor_fd, VVSENSORIOC_G_TEMPERATURE, pTemp);
+    if (ret != 0) {
+        TRACE(VVSENSOR_ERROR, "%s get temperature error\n", __func__);
+        return RET_FAILURE;
+    }
+
+    return RET_SUCCESS;
+}
+
+static RESULT VVSENSOR_ThermalRestore(IsiSensorHandle_t handle)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+
+    if (!pSensorCtx->ThermalThrottled)
+        return RET_SUCCESS;
+
+    pSensorCtx->ThermalThrottled = BOOL_FALSE;
+    TRACE(VVSENSOR_INFO, "%s: %s: fps restored to %u\n", __func__,
+          pSensorCtx->pDesc->pszName, pSensorCtx->ThermalRestoreFps);
+    return VVSENSOR_IsiSetSensorFpsIss(handle, pSensorCtx->ThermalRestoreFps);
+}
+
+RESULT VVSENSOR_IsiSetThermalLimitsIss(IsiSensorHandle_t handle,
+                                       const VVSENSOR_ThermalLimits_t *pLimits)
+{
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL)
+        return RET_NULL_POINTER;
+
+    if (!(pSensorCtx->pDesc->caps & VVSENSOR_CAP_TEMPERATURE))
+        return RET_NOTSUPP;
+
+    if (pLimits == NULL) {
+        pSensorCtx->ThermalEnabled = BOOL_FALSE;
+        return VVSENSOR_ThermalRestore(handle);
+    }
+
+    if (pLimits->clearTemp >= pLimits->tripTemp ||
+        pLimits->maxFps < pSensorCtx->CurMode.ae_info.min_fps)
+        return RET_OUTOFRANGE;
+
+    pSensorCtx->ThermalLimits = *pLimits;
+    pSensorCtx->ThermalEnabled = BOOL_TRUE;
+    if (pSensorCtx->ThermalThrottled) {
+        /* a new cap applies at once */
+        VVSENSOR_UpdateIsiAEInfo(handle);
+        if (pSensorCtx->CurMode.ae_info.cur_fps > pLimits->maxFps)
+            return VVSENSOR_IsiSetSensorFpsIss(handle, pLimits->maxFps);
+    }
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiThermalUpdateIss(IsiSensorHandle_t handle, int32_t *pTemp)
+{
+    RESULT result;
+    int32_t temp;
+
+    VVSENSOR_Context_t *pSensorCtx = (VVSENSOR_Context_t *) handle;
+    if (pSensorCtx == NULL)
+        return RET_NULL_POINTER;
+
+    result = VVSENSOR_IsiGetSensorTemperatureIss(handle, &temp);
+    if (result != RET_SUCCESS)
+        return result;
+    if (pTemp != NULL)
+        *pTemp = temp;
+
+    if (!pSensorCtx->ThermalEnabled)
+        return RET_SUCCESS;
+
+    if (pSensorCtx->ThermalThrottled) {
+        if (temp <= pSensorCtx->ThermalLimits.clearTemp)
+            return VVSENSOR_ThermalRestore(handle);
+    } else if (temp >= pSensorCtx->ThermalLimits.tripTemp) {
+        pSensorCtx->ThermalThrottled = BOOL_TRUE;
+        pSensorCtx->ThermalRestoreFps = pSensorCtx->CurMode.ae_info.cur_fps;
+        TRACE(VVSENSOR_WARN, "%s: %s: %d mC, fps capped to %u\n", __func__,
+              pSensorCtx->pDesc->pszName, temp,
+              pSensorCtx->ThermalLimits.maxFps);
+        VVSENSOR_UpdateIsiAEInfo(handle);
+    }
+
+    /* also catches a mode change while throttled */
+    if (pSensorCtx->ThermalThrottled &&
+        pSensorCtx->CurMode.ae_info.cur_fps > pSensorCtx->ThermalLimits.maxFps)
+        return VVSENSOR_IsiSetSensorFpsIss(handle,
+                                           pSensorCtx->ThermalLimits.maxFps);
+
+    return RET_SUCCESS;
+}
+
+RESULT VVSENSOR_IsiGetSensorIss(const VVSENSOR_Desc_t *pDesc,
+                                IsiSensor_t *pIsiSensor)
+{
+    TRACE( VVSENSOR_INFO, "%s (enter)\n", __func__);
+
+    if (pDesc == NULL || pIsiSensor == NULL)
+        return RET_NULL_POINTER;
+
+    /* entry points a sensor does not have stay NULL */
+    memset(pIsiSensor, 0, sizeof(IsiSensor_t));
+
+    pIsiSensor->pszName                         = pDesc->pszName;
+    pIsiSensor->pIsiSensorSetPowerIss           = VVSENSOR_IsiSensorSetPowerIss;
+    pIsiSensor->pIsiReleaseSensorIss            = VVSENSOR_IsiReleaseSensorIss;
+    pIsiSensor->pIsiRegisterReadIss             = VVSENSOR_IsiRegisterReadIss;
+    pIsiSensor->pIsiRegisterWriteIss            = VVSENSOR_IsiRegisterWriteIss;
+    pIsiSensor->pIsiGetSensorModeIss            = VVSENSOR_IsiGetSensorModeIss;
+    pIsiSensor->pIsiSetSensorModeIss            = VVSENSOR_IsiSetSensorModeIss;
+    pIsiSensor->pIsiQuerySensorIss              = VVSENSOR_IsiQuerySensorIss;
+    pIsiSensor->pIsiGetCapsIss                  = VVSENSOR_IsiGetCapsIss;
+    pIsiSensor->pIsiSetupSensorIss              = VVSENSOR_IsiSetupSensorIss;
+    pIsiSensor->pIsiGetSensorRevisionIss        = VVSENSOR_IsiGetSensorRevisionIss;
+    pIsiSensor->pIsiCheckSensorConnectionIss    = VVSENSOR_IsiCheckSensorConnectionIss;
+    pIsiSensor->pIsiSensorSetStreamingIss       = VVSENSOR_IsiSensorSetStreamingIss;
+    pIsiSensor->pIsiGetAeInfoIss                = VVSENSOR_IsiGetAeInfoIss;
+    pIsiSensor->pIsiGetIntegrationTimeIss       = VVSENSOR_IsiGetIntegrationTimeIss;
+    pIsiSensor->pIsiSetIntegrationTimeIss       = VVSENSOR_IsiSetIntegrationTimeIss;
+    pIsiSensor->pIsiGetGainIss                  = VVSENSOR_IsiGetGainIss;
+    pIsiSensor->pIsiSetGainIss                  = VVSENSOR_IsiSetGainIss;
+    pIsiSensor->pIsiGetSensorFpsIss             = VVSENSOR_IsiGetSensorFpsIss;
+    pIsiSensor->pIsiSetSensorFpsIss             = VVSENSOR_IsiSetSensorFpsIss;
+    pIsiSensor->pIsiSetSensorAfpsLimitsIss      = VVSENSOR_IsiSetSensorAfpsLimitsIss;
+    pIsiSensor->pIsiGetSensorIspStatusIss       = VVSENSOR_IsiGetSensorIspStatusIss;
+    if (pDesc->caps & VVSENSOR_CAP_HDR_RATIO)
+        pIsiSensor->pIsiSetHdrRatioIss          = VVSENSOR_IsiSetHdrRatioIss;
+#ifndef ISI_LITE
+    if (pDesc->caps & VVSENSOR_CAP_BLC)
+        pIsiSensor->pIsiSensorSetBlcIss         = VVSENSOR_IsiSensorSetBlcIss;
+    if (pDesc->caps & VVSENSOR_CAP_WB)
+        pIsiSensor->pIsiSensorSetWBIss          = VVSENSOR_IsiSensorSetWBIss;
+    if (pDesc->caps & VVSENSOR_CAP_EXPAND_CURVE)
+        pIsiSensor->pIsiSensorGetExpandCurveIss = VVSENSOR_IsiSensorGetExpandCurveIss;
+    if (pDesc->caps & VVSENSOR_CAP_COMPRESS_CURVE)
+        pIsiSensor->pIsiSensorGetCompressCurveIss = VVSENSOR_IsiSensorGetCompressCurveIss;
+    pIsiSensor->pIsiActivateTestPatternIss      = VVSENSOR_IsiSetTestPatternIss;
+    pIsiSensor->pIsiFocusSetupIss               = VVSENSOR_IsiFocusSetupIss;
+    pIsiSensor->pIsiFocusReleaseIss             = VVSENSOR_IsiFocusReleaseIss;
+    pIsiSensor->pIsiFocusSetIss                 = VVSENSOR_IsiFocusSetIss;
+    pIsiSensor->pIsiFocusGetIss                 = VVSENSOR_IsiFocusGetIss;
+    pIsiSensor->pIsiGetFocusCalibrateIss        = VVSENSOR_IsiGetFocusCalibrateIss;
+    pIsiSensor->pIsiSetAeStartExposureIss       = VVSENSOR_IsiSetAeStartExposureIs;
+    pIsiSensor->pIsiGetAeStartExposureIss       = VVSENSOR_IsiGetAeStartExposureIs;
+#endif
+    TRACE( VVSENSOR_INFO, "%s: %s (exit)\n", __func__, pDesc->pszName);
+    return RET_SUCCESS;
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: (GPL-2.0-only OR MIT)
+ */
+
+/*
+ * Generated by tools/sensor-modes/gen_sensor_modes.py from
+ * modes/ar0144.json. Do not edit.
+ */
+
+#ifndef _VVCAM_AR0144_MODES_H_
+#define _VVCAM_AR0144_MODES_H_
+
+#include "vvsensor.h"
+
+#define AR0144_CSI_MAX_PIXEL_CLK	266000000
+
+/* single ar0144 camera on MIPI-CSI1, 1280x800 */
+static struct vvcam_sccb_data_s ar0144_1280x800_60fps[] = {
+	{0x301A, 0x3058}, // RESET_REGISTER
+	{0x3F4C, 0x003F}, // PIX_DEF_1D_DDC_LO_DEF
+	{0x3F4E, 0x0018}, // PIX_DEF_1D_DDC_HI_DEF
+	{0x3F50, 0x17DF}, // PIX_DEF_1D_DDC_EDGE
+	{0x30B0, 0x0028}, // DIGITAL_TEST
+	{0x3060, 0x000D}, // ANALOG_GAIN
+	{0x30FE, 0x00A8}, // NOISE_PEDESTAL
+	{0x306E, 0x4810}, // DATAPATH_SELECT
+	{0x3064, 0x1802}, // SMIA_TEST
+	{0x302A, 0x0006}, // VT_PIX_CLK_DIV
+	{0x302C, 0x0001}, // VT_SYS_CLK_DIV
+	{0x302E, 0x0004}, // PRE_PLL_CLK_DIV
+	{0x3030, 0x0042}, // PLL_MULTIPLIER
+	{0x3036, 0x000C}, // OP_PIX_CLK_DIV
+	{0x3038, 0x0001}, // OP_SYS_CLK_DIV
+	{0x30B0, 0x0028}, // DIGITAL_TEST
+	{0x31B0, 0x005A}, // FRAME_PREAMBLE
+	{0x31B2, 0x002E}, // LINE_PREAMBLE
+	{0x31B4, 0x2633}, // MIPI_TIMING_0
+	{0x31B6, 0x210E}, // MIPI_TIMING_1
+	{0x31B8, 0x20C7}, // MIPI_TIMING_2
+	{0x31BA, 0x0105}, // MIPI_TIMING_3
+	{0x31BC, 0x0004}, // MIPI_TIMING_4
+	{0x3354, 0x002C}, // MIPI_CNTRL
+	{0x31AE, 0x0202}, // SERIAL_FORMAT
+	{0x3002, 0x0000}, // Y_ADDR_START
+	{0x3004, 0x0004}, // X_ADDR_START
+	{0x3006, 0x031F}, // Y_ADDR_END
+	{0x3008, 0x0503}, // X_ADDR_END
+	{0x300A, 0x033B}, // FRAME_LENGTH_LINES
+	{0x300C, 0x05D0}, // LINE_LENGTH_PCK
+	{0x3012, 0x033A}, // COARSE_INTEGRATION_TIME
+	{0x31AC, 0x0C0C}, // DATA_FORMAT_BITS
+	{0x306E, 0x9010}, // DATAPATH_SELECT
+	{0x30A2, 0x0001}, // X_ODD_INC
+	{0x30A6, 0x0001}, // Y_ODD_INC
+	{0x3082, 0x0003}, // OPERATION_MODE_CTRL
+	{0x3040, 0x0000}, // READ_MODE
+	{0x31D0, 0x0000}, // COMPANDING
+	{0x301A, 0x005C}, // RESET_REGISTER
+	{0x311C, 0x033B}, // AE_MAX_EXPOSURE_REG
+	{0x3060, 0x0030}, // gain
+};
+
+/* single ar0144 camera on MIPI-CSI1, 1280x800, embedded data rows */
+static struct vvcam_sccb_data_s ar0144_1280x800_60fps_ebd[] = {
+	{0x301A, 0x3058}, // RESET_REGISTER
+	{0x3F4C, 0x003F}, // PIX_DEF_1D_DDC_LO_DEF
+	{0x3F4E, 0x0018}, // PIX_DEF_1D_DDC_HI_DEF
+	{0x3F50, 0x17DF}, // PIX_DEF_1D_DDC_EDGE
+	{0x30B0, 0x0028}, // DIGITAL_TEST
+	{0x3060, 0x000D}, // ANALOG_GAIN
+	{0x30FE, 0x00A8}, // NOISE_PEDESTAL
+	{0x306E, 0x4810}, // DATAPATH_SELECT
+	{0x3064, 0x1982}, // SMIA_TEST: embedded register and statistics rows
+	{0x302A, 0x0006}, // VT_PIX_CLK_DIV
+	{0x302C, 0x0001}, // VT_SYS_CLK_DIV
+	{0x302E, 0x0004}, // PRE_PLL_CLK_DIV
+	{0x3030, 0x0042}, // PLL_MULTIPLIER
+	{0x3036, 0x000C}, // OP_PIX_CLK_DIV
+	{0x3038, 0x0001}, // OP_SYS_CLK_DIV
+	{0x30B0, 0x0028}, // DIGITAL_TEST
+	{0x31B0, 0x005A}, // FRAME_PREAMBLE
+	{0x31B2, 0x002E}, // LINE_PREAMBLE
+	{0x31B4, 0x2633}, // MIPI_TIMING_0
+	{0x31B6, 0x210E}, // MIPI_TIMING_1
+	{0x31B8, 0x20C7}, // MIPI_TIMING_2
+	{0x31BA, 0x0105}, // MIPI_TIMING_3
+	{0x31BC, 0x0004}, // MIPI_TIMING_4
+	{0x3354, 0x002C}, // MIPI_CNTRL
+	{0x31AE, 0x0202}, // SERIAL_FORMAT
+	{0x3002, 0x0000}, // Y_ADDR_START
+	{0x3004, 0x0004}, // X_ADDR_START
+	{0x3006, 0x031F}, // Y_ADDR_END
+	{0x3008, 0x0503}, // X_ADDR_END
+	{0x300A, 0x033B}, // FRAME_LENGTH_LINES
+	{0x300C, 0x05D0}, // LINE_LENGTH_PCK
+	{0x3012, 0x033A}, // COARSE_INTEGRATION_TIME
+	{0x31AC, 0x0C0C}, // DATA_FORMAT_BITS
+	{0x306E, 0x9010}, // DATAPATH_SELECT
+	{0x30A2, 0x0001}, // X_ODD_INC
+	{0x30A6, 0x0001}, // Y_ODD_INC
+	{0x3082, 0x0003}, // OPERATION_MODE_CTRL
+	{0x3040, 0x0000}, // READ_MODE
+	{0x31D0, 0x0000}, // COMPANDING
+	{0x301A, 0x005C}, // RESET_REGISTER
+	{0x311C, 0x033B}, // AE_MAX_EXPOSURE_REG
+	{0x3060, 0x0030}, // gain
+};
+
+/* single ar0144 camera on MIPI-CSI1, 1280x800, 12 bit A-law companded to 10 bit */
+static struct vvcam_sccb_data_s ar0144_1280x800_60fps_compand[] = {
+	{0x301A, 0x3058}, // RESET_REGISTER
+	{0x3F4C, 0x003F}, // PIX_DEF_1D_DDC_LO_DEF
+	{0x3F4E, 0x0018}, // PIX_DEF_1D_DDC_HI_DEF
+	{0x3F50, 0x17DF}, // PIX_DEF_1D_DDC_EDGE
+	{0x30B0, 0x0028}, // DIGITAL_TEST
+	{0x3060, 0x000D}, // ANALOG_GAIN
+	{0x30FE, 0x00A8}, // NOISE_PEDESTAL
+	{0x306E, 0x4810}, // DATAPATH_SELECT
+	{0x3064, 0x1802}, // SMIA_TEST
+	{0x302A, 0x0006}, // VT_PIX_CLK_DIV
+	{0x302C, 0x0001}, // VT_SYS_CLK_DIV
+	{0x302E, 0x0004}, // PRE_PLL_CLK_DIV
+	{0x3030, 0x0042}, // PLL_MULTIPLIER
+	{0x3036, 0x000A}, // OP_PIX_CLK_DIV: one op clock per output bit
+	{0x3038, 0x0001}, // OP_SYS_CLK_DIV
+	{0x30B0, 0x0028}, // DIGITAL_TEST
+	{0x31B0, 0x005A}, // FRAME_PREAMBLE
+	{0x31B2, 0x002E}, // LINE_PREAMBLE
+	{0x31B4, 0x2633}, // MIPI_TIMING_0
+	{0x31B6, 0x210E}, // MIPI_TIMING_1
+	{0x31B8, 0x20C7}, // MIPI_TIMING_2
+	{0x31BA, 0x0105}, // MIPI_TIMING_3
+	{0x31BC, 0x0004}, // MIPI_TIMING_4
+	{0x3354, 0x002C}, // MIPI_CNTRL
+	{0x31AE, 0x0202}, // SERIAL_FORMAT
+	{0x3002, 0x0000}, // Y_ADDR_START
+	{0x3004, 0x0004}, // X_ADDR_START
+	{0x3006, 0x031F}, // Y_ADDR_END
+	{0x3008, 0x0503}, // X_ADDR_END
+	{0x300A, 0x033B}, // FRAME_LENGTH_LINES
+	{0x300C, 0x05D0}, // LINE_LENGTH_PCK
+	{0x3012, 0x033A}, // COARSE_INTEGRATION_TIME
+	{0x31AC, 0x0C0A}, // DATA_FORMAT_BITS: 12 bit ADC, 10 bit output
+	{0x306E, 0x9010}, // DATAPATH_SELECT
+	{0x30A2, 0x0001}, // X_ODD_INC
+	{0x30A6, 0x0001}, // Y_ODD_INC
+	{0x3082, 0x0003}, // OPERATION_MODE_CTRL
+	{0x3040, 0x0000}, // READ_MODE
+	{0x31D0, 0x0001}, // COMPANDING: A-law 12 to 10 bit
+	{0x301A, 0x005C}, // RESET_REGISTER
+	{0x311C, 0x033B}, // AE_MAX_EXPOSURE_REG
+	{0x3060, 0x0030}, // gain
+};
+
+static struct vvcam_mode_info_s par0144_mode_info[] = {
+	{
+		.index          = 0,
+		.size           = {
+			.bounds_width  = 1280,
+			.bounds_height = 800,
+			.top           = 0,
+			.left          = 0,
+			.width         = 1280,
+			.height        = 800,
+		},
+		.hdr_mode       = SENSOR_MODE_LINEAR,
+		.bit_width      = 12,
+		.data_compress  = {
+			.enable = 0,
+		},
+		.bayer_pattern  = BAYER_GRBG,
+		.ae_info = {
+			/*
+			line time = 20190 ns
+			frame time = 827 lines * 20190 ns -> 60 fps
+			*/
+			.def_frm_len_lines     = 0x33B,
+			.curr_frm_len_lines    = 0x33A,
+			.one_line_exp_time_ns  = 20190,
+			.max_integration_line  = 0x33A,
+			.min_integration_line  = 8,
+			.max_again             = 8 * (1 << SENSOR_FIX_FRACBITS),
+			.min_again             = 2 * (1 << SENSOR_FIX_FRACBITS),
+			.max_dgain             = 2 * (1 << SENSOR_FIX_FRACBITS),
+			.min_dgain             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.gain_step             = 1,
+			.start_exposure        = 300 * (1 << SENSOR_FIX_FRACBITS),
+			.cur_fps               = 60 * (1 << SENSOR_FIX_FRACBITS),
+			.max_fps               = 60 * (1 << SENSOR_FIX_FRACBITS),
+			.min_fps               = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.min_afps              = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.int_update_delay_frm  = 1,
+			.gain_update_delay_frm = 1,
+		},
+		.mipi_info = {
+			.mipi_lane = 2,
+		},
+		.preg_data      = ar0144_1280x800_60fps,
+		.reg_data_count = ARRAY_SIZE(ar0144_1280x800_60fps),
+	},
+	{
+		.index          = 1,
+		.size           = {
+			.bounds_width  = 1280,
+			.bounds_height = 800,
+			.top           = 0,
+			.left          = 0,
+			.width         = 1280,
+			.height        = 800,
+		},
+		.hdr_mode       = SENSOR_MODE_LINEAR,
+		.bit_width      = 12,
+		.data_compress  = {
+			.enable = 0,
+		},
+		.bayer_pattern  = BAYER_GRBG,
+		.ae_info = {
+			/*
+			line time = 20190 ns
+			frame time = 827 lines * 20190 ns -> 60 fps
+			*/
+			.def_frm_len_lines     = 0x33B,
+			.curr_frm_len_lines    = 0x33A,
+			.one_line_exp_time_ns  = 20190,
+			.max_integration_line  = 0x33A,
+			.min_integration_line  = 8,
+			.max_again             = 8 * (1 << SENSOR_FIX_FRACBITS),
+			.min_again             = 2 * (1 << SENSOR_FIX_FRACBITS),
+			.max_dgain             = 2 * (1 << SENSOR_FIX_FRACBITS),
+			.min_dgain             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.gain_step             = 1,
+			.start_exposure        = 300 * (1 << SENSOR_FIX_FRACBITS),
+			.cur_fps               = 60 * (1 << SENSOR_FIX_FRACBITS),
+			.max_fps               = 60 * (1 << SENSOR_FIX_FRACBITS),
+			.min_fps               = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.min_afps              = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.int_update_delay_frm  = 1,
+			.gain_update_delay_frm = 1,
+		},
+		.mipi_info = {
+			.mipi_lane = 2,
+		},
+		.preg_data      = ar0144_1280x800_60fps_ebd,
+		.reg_data_count = ARRAY_SIZE(ar0144_1280x800_60fps_ebd),
+	},
+	{
+		.index          = 2,
+		.size           = {
+			.bounds_width  = 1280,
+			.bounds_height = 800,
+			.top           = 0,
+			.left          = 0,
+			.width         = 1280,
+			.height        = 800,
+		},
+		.hdr_mode       = SENSOR_MODE_LINEAR,
+		.bit_width      = 10,
+		.data_compress  = {
+			.enable = 1,
+			.x_bit = 12,
+			.y_bit = 10,
+		},
+		.bayer_pattern  = BAYER_GRBG,
+		.ae_info = {
+			/*
+			line time = 20190 ns
+			frame time = 827 lines * 20190 ns -> 60 fps
+			*/
+			.def_frm_len_lines     = 0x33B,
+			.curr_frm_len_lines    = 0x33A,
+			.one_line_exp_time_ns  = 20190,
+			.max_integration_line  = 0x33A,
+			.min_integration_line  = 8,
+			.max_again             = 8 * (1 << SENSOR_FIX_FRACBITS),
+			.min_again             = 2 * (1 << SENSOR_FIX_FRACBITS),
+			.max_dgain             = 2 * (1 << SENSOR_FIX_FRACBITS),
+			.min_dgain             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.gain_step             = 1,
+			.start_exposure        = 300 * (1 << SENSOR_FIX_FRACBITS),
+			.cur_fps               = 60 * (1 << SENSOR_FIX_FRACBITS),
+			.max_fps               = 60 * (1 << SENSOR_FIX_FRACBITS),
+			.min_fps               = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.min_afps              = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.int_update_delay_frm  = 1,
+			.gain_update_delay_frm = 1,
+		},
+		.mipi_info = {
+			.mipi_lane = 2,
+		},
+		.preg_data      = ar0144_1280x800_60fps_compand,
+		.reg_data_count = ARRAY_SIZE(ar0144_1280x800_60fps_compand),
+	},
+};
+
+#endif
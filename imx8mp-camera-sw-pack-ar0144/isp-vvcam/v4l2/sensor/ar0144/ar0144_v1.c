@@ -14,11 +14,17 @@
 #include <linux/ctype.h>
 #include <linux/types.h>
 #include <linux/delay.h>
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/mm.h>
 #include <linux/clk.h>
 #include <linux/of_device.h>
 #include <linux/of_gpio.h>
 #include <linux/pinctrl/consumer.h>
 #include <linux/regulator/consumer.h>
+#include <linux/seq_file.h>
+#include <linux/seqlock.h>
 #include <linux/i2c.h>
 #include <linux/v4l2-mediabus.h>
 #include <media/v4l2-async.h>
@@ -26,7 +32,15 @@
 #include <media/v4l2-event.h>
 #include <media/v4l2-fwnode.h>
 #include <media/v4l2-subdev.h>
+#include <media/mipi-csi2.h>
 #include "vvsensor.h"
+#include "vvsensor_ext.h"
+#include "vvsensor_uarg.h"
+#include "vvsensor_fcnt.h"
+#include "vvsensor_window.h"
+#include "vvsensor_temp.h"
+#include "vvsensor_flip.h"
+#include "ar0144_modes.h"
 
 #define DEFAULT_WIDTH                   1280
 #define DEFAULT_HEIGHT                  800
@@ -41,115 +55,49 @@
 #define AR0144_X_ADDR_START     		0x3004
 #define AR0144_Y_ADDR_END       		0x3006
 #define AR0144_X_ADDR_END       		0x3008
+#define AR0144_READ_MODE                0x3040
 #define AR0144_SERIAL_FORMAT            0x31AE
 #define AR0144_DATA_FORMAT_BITS         0x31AC
+#define AR0144_FRAME_LENGTH_LINES       0x300A
+#define AR0144_FRAME_COUNT              0x303A
+#define AR0144_COARSE_INTEGRATION_TIME  0x3012
+#define AR0144_ANALOG_GAIN              0x3060
+#define AR0144_SMIA_TEST                0x3064
+#define AR0144_X_ODD_INC                0x30A2
+#define AR0144_Y_ODD_INC                0x30A6
+#define AR0144_DIGITAL_TEST             0x30B0
+#define AR0144_AE_MAX_EXPOSURE          0x311C
+#define AR0144_COMPANDING               0x31D0
+#define AR0144_TEMPSENS_DATA            0x30B2
+#define AR0144_TEMPSENS_CTRL            0x30B4
+#define AR0144_TEMPSENS_CALIB1          0x30C6	/* reading at 55 C */
+#define AR0144_TEMPSENS_CALIB2          0x30C8	/* reading at 70 C */
+
+#define AR0144_CONTEXT_B_SELECT         BIT(13)	/* DIGITAL_TEST */
+#define AR0144_READ_MODE_HORIZ_MIRROR   BIT(14)
+#define AR0144_READ_MODE_VERT_FLIP      BIT(15)
+#define AR0144_ANALOG_GAIN_CB_SHIFT     8
+#define AR0144_TEMPSENS_POWER_ON        BIT(0)
+#define AR0144_TEMPSENS_START           BIT(4)
+#define AR0144_TEMPSENS_MASK            0x03FF
+#define AR0144_TEMPSENS_CALIB1_MC       55000
+#define AR0144_TEMPSENS_CALIB2_MC       70000
+
+#define AR0144_EMBEDDED_DATA            BIT(8)
+#define AR0144_EMBEDDED_STATS           BIT(7)
+#define AR0144_EBD_TOP_LINES            2
+#define AR0144_EBD_BOTTOM_LINES         2
+
+#define AR0144_COMPAND_X_BIT            10
+#define AR0144_COMPAND_Y_BIT            12
+#define AR0144_EXPAND_SEGMENTS          64
+#define AR0144_EXPAND_PX                4	/* log2(1024 / 64) */
+
+#define AR0144_WINDOW_MIN_WIDTH         64
+#define AR0144_WINDOW_MIN_HEIGHT        16
+
+#define AR0144_BURST_MAX                64	/* registers per batch I2C transfer */
 
-//#define TEST_EBD
-
-static struct vvcam_sccb_data_s ar0144_1280x800_60fps[] = {
-	//{0x301A, 0x00D9, 0}, // RESET_REGISTER
-	{0x301A, 0x3058}, // RESET_REGISTER
-	{0x3F4C, 0x003F}, // PIX_DEF_1D_DDC_LO_DEF
-	{0x3F4E, 0x0018}, // PIX_DEF_1D_DDC_HI_DEF
-	{0x3F50, 0x17DF}, // PIX_DEF_1D_DDC_EDGE
-	{0x30B0, 0x0028}, // DIGITAL_TEST
-	{0x3060, 0x000D}, // ANALOG_GAIN
-	{0x30FE, 0x00A8}, // NOISE_PEDESTAL
-	{0x306E, 0x4810}, // DATAPATH_SELECT
-	{0x3064, 0x1802}, // SMIA_TEST
-	{0x302A, 0x0006}, // VT_PIX_CLK_DIV
-	{0x302C, 0x0001}, // VT_SYS_CLK_DIV
-	{0x302E, 0x0004}, // PRE_PLL_CLK_DIV
-	{0x3030, 0x0042}, // PLL_MULTIPLIER
-	{0x3036, 0x000C}, // OP_PIX_CLK_DIV
-	{0x3038, 0x0001}, // OP_SYS_CLK_DIV
-	{0x30B0, 0x0028}, // DIGITAL_TEST
-	{0x31B0, 0x005A}, // FRAME_PREAMBLE
-	{0x31B2, 0x002E}, // LINE_PREAMBLE
-	{0x31B4, 0x2633}, // MIPI_TIMING_0
-	{0x31B6, 0x210E}, // MIPI_TIMING_1
-	{0x31B8, 0x20C7}, // MIPI_TIMING_2
-	{0x31BA, 0x0105}, // MIPI_TIMING_3
-	{0x31BC, 0x0004}, // MIPI_TIMING_4
-	{0x3354, 0x002C}, // MIPI_CNTRL
-	{0x31AE, 0x0202}, // SERIAL_FORMAT
-	{0x3002, 0x0000}, // Y_ADDR_START
-	{0x3004, 0x0004}, // X_ADDR_START
-	{0x3006, 0x031F}, // Y_ADDR_END
-	{0x3008, 0x0503}, // X_ADDR_END
-	{0x300A, 0x033B}, // FRAME_LENGTH_LINES
-	{0x300C, 0x05D0}, // LINE_LENGTH_PCK
-	{0x3012, 0x033A}, // COARSE_INTEGRATION_TIME
-	{0x31AC, 0x0C0C}, // DATA_FORMAT_BITS
-	{0x306E, 0x9010}, // DATAPATH_SELECT
-	{0x30A2, 0x0001}, // X_ODD_INC
-	{0x30A6, 0x0001}, // Y_ODD_INC
-	{0x3082, 0x0003}, // OPERATION_MODE_CTRL
-	{0x3040, 0x0000}, // READ_MODE
-	{0x31D0, 0x0000}, // COMPANDING
-	{0x301A, 0x005C}, // RESET_REGISTER
-	{0x311C, 0x033B}, // AE_MAX_EXPOSURE_REG
-	{0x3060, 0x0030}, //gain
-#if 1
-	{0x3070, 0x1}, //test_pattern_mode, solid color
-	{0x3072, 0x111}, //test_data_red GRBG
-	{0x3074, 0x222}, //test_data_greenr
-	{0x3076, 0x333}, //test_data_blue
-	{0x3078, 0x444}, //test_data_greenb
-#endif
-};
-
-struct ar0144_datafmt {
-	u32						code;
-	enum v4l2_colorspace	colorspace;
-};
-
-static struct vvcam_mode_info_s par0144_mode_info[] = {
-	{
-		.index          = 0,
-		.size           = {
-			.bounds_width  = 1280,
-			.bounds_height = 800,
-			.top           = 0,
-			.left          = 0,
-			.width         = 1280,
-			.height        = 800,
-		},
-		.hdr_mode       = SENSOR_MODE_LINEAR,
-		.bit_width      = 12,
-		.data_compress  = {
-			.enable = 0,
-		},
-		.bayer_pattern = BAYER_GRBG,
-		.ae_info = {
-			.def_frm_len_lines     = 0x33B,
-			.curr_frm_len_lines    = 0x33B - 1,
-			.one_line_exp_time_ns  = 20190,
-
-			.max_integration_line  = 0x33B - 1,
-			.min_integration_line  = 8,
-
-			.max_again             = 8 * (1 << SENSOR_FIX_FRACBITS),
-			.min_again             = 2 * (1 << SENSOR_FIX_FRACBITS),
-			.max_dgain             = 2 * (1 << SENSOR_FIX_FRACBITS),
-			.min_dgain             = 1 * (1 << SENSOR_FIX_FRACBITS),
-			.gain_step             = 1,
-
-			.start_exposure        = 3 * 100 * (1 << SENSOR_FIX_FRACBITS),
-			.cur_fps               = 60 * (1 << SENSOR_FIX_FRACBITS),
-			.max_fps               = 60 * (1 << SENSOR_FIX_FRACBITS),
-			.min_fps               = 5 * (1 << SENSOR_FIX_FRACBITS),
-			.min_afps              = 5 * (1 << SENSOR_FIX_FRACBITS),
-			.int_update_delay_frm  = 1,
-			.gain_update_delay_frm = 1,
-		},
-		.mipi_info = {
-			.mipi_lane = 2,
-		},
-		.preg_data      = ar0144_1280x800_60fps,
-		.reg_data_count = ARRAY_SIZE(ar0144_1280x800_60fps),
-	},
-};
 
 struct ar0144 {
 	struct i2c_client *i2c_client;
@@ -160,12 +108,43 @@ struct ar0144 {
 	struct gpio_desc *reset;
 	struct gpio_desc *isp_en;
 	vvcam_mode_info_t cur_mode;
+	struct vvcam_window window;
+	struct vvcam_exposure_s exposure;
+	u32 flip;			/* VVCAM_FLIP_* */
+	u32 context;
+	vvcam_mode_info_t ctx_mode;	/* mode held by the inactive context */
+	bool ctx_loaded;
+	u16 ana_gain[2];		/* per context, they share ANALOG_GAIN */
 	vvcam_lens_t focus_lens;
 
 	struct v4l2_subdev subdev;
 	struct media_pad pads[AR0144_SENS_PADS_NUM];
 
 	struct mutex lock;
+	struct vvcam_arg_scratch_s *scratch;
+	/*
+	 * cur_mode, window, exposure, flip and context are changed with lock
+	 * held and published under state_seq, so the getters read them
+	 * without waiting for register writes in flight
+	 */
+	seqlock_t state_seq;
+	/*
+	 * The chip ID is checked on first open or stream on, not at probe.
+	 * chip_status is -EAGAIN until then, 0 or -ENODEV after; chip_id is
+	 * valid once it reads 0.
+	 */
+	int chip_status;
+	u16 chip_id;
+	/* FRAME_COUNT sampled with lock held, every fcnt_period while streaming */
+	struct vvcam_fcnt fcnt;
+	struct delayed_work fcnt_work;
+	unsigned long fcnt_period;
+	struct dentry *debugfs;
+	/* controls, sharing lock */
+	struct v4l2_ctrl_handler ctrls;
+	struct vvcam_temp temp;
+	struct vvcam_flip orient;
+	u16 temp_calib[2];		/* TEMPSENS_CALIB1/2, 0 until read */
 	bool mode_change;
 	u32 resume_status;
 	u32 stream_status;
@@ -178,8 +157,22 @@ static const char * const ar0144_supply_name[] = {
 	"VDDIO",
 };
 
-static const struct ar0144_datafmt ar0144_colour_fmts[] = {
-	{MEDIA_BUS_FMT_SGRBG12_1X12, V4L2_COLORSPACE_RAW},
+/* bit width of the media bus codes, in order of enumeration */
+static const u32 ar0144_bit_widths[] = { 12, 10 };
+
+/* context A registers and their context B copy */
+static const struct {
+	u16 reg_a;
+	u16 reg_b;
+} ar0144_context_regs[] = {
+	{ AR0144_Y_ADDR_START,            0x308C },
+	{ AR0144_X_ADDR_START,            0x308A },
+	{ AR0144_Y_ADDR_END,              0x3090 },
+	{ AR0144_X_ADDR_END,              0x308E },
+	{ AR0144_FRAME_LENGTH_LINES,      0x30AA },
+	{ AR0144_COARSE_INTEGRATION_TIME, 0x3016 },
+	{ AR0144_X_ODD_INC,               0x30AE },
+	{ AR0144_Y_ODD_INC,               0x30A8 },
 };
 
 static inline struct ar0144 *to_ar0144_device(const struct i2c_client *client)
@@ -245,7 +238,237 @@ static int ar0144_write_array(struct ar0144 *sensor,
 			msleep(100);
 	}
 
-	return 0;
+	return retval;
+}
+
+/*
+ * One I2C transfer for a run of entries of one op at consecutive 16 bit
+ * registers, which the sensor auto-increments over.
+ */
+static int ar0144_reg_burst(struct ar0144 *sensor,
+			    struct vvcam_reg_entry_s *entry, u32 n, u8 *buf)
+{
+	struct i2c_client *client = sensor->i2c_client;
+	struct i2c_msg msg[2];
+	u32 i;
+	int num = 1, ret;
+
+	buf[0] = (entry[0].addr >> 8) & 0xff;
+	buf[1] = entry[0].addr & 0xff;
+	msg[0].addr = client->addr;
+	msg[0].flags = client->flags;
+	msg[0].buf = buf;
+	msg[0].len = 2;
+	if (entry[0].op == VVCAM_REG_WRITE) {
+		for (i = 0; i < n; i++) {
+			buf[2 + 2 * i] = (entry[i].data >> 8) & 0xff;
+			buf[3 + 2 * i] = entry[i].data & 0xff;
+		}
+		msg[0].len += 2 * n;
+	} else {
+		msg[1].addr = client->addr;
+		msg[1].flags = client->flags | I2C_M_RD;
+		msg[1].buf = buf + 2;
+		msg[1].len = 2 * n;
+		num = 2;
+	}
+
+	ret = __i2c_transfer(client->adapter, msg, num);
+	ret = ret < 0 ? ret : (ret == num ? 0 : -EIO);
+	for (i = 0; i < n; i++) {
+		if (ret == 0 && entry[i].op == VVCAM_REG_READ)
+			entry[i].data = ((u32)buf[2 + 2 * i] << 8) | buf[3 + 2 * i];
+		entry[i].status = ret;
+	}
+	return ret;
+}
+
+static int ar0144_batch_reg(struct ar0144 *sensor, void *arg)
+{
+	struct i2c_adapter *adapter = sensor->i2c_client->adapter;
+	struct vvcam_reg_batch_s batch;
+	struct vvcam_reg_entry_s *entry = sensor->scratch->reg_entry;
+	u8 buf[2 + 2 * AR0144_BURST_MAX];
+	u32 i, n;
+	int ret = 0;
+
+	if (vvcam_arg_in(&batch, arg))
+		return -EFAULT;
+	if (batch.count == 0)
+		return 0;
+	if (batch.count > VVCAM_REG_BATCH_MAX)
+		return -EINVAL;
+
+	if (copy_from_user(entry, u64_to_user_ptr(batch.entries),
+			   batch.count * sizeof(*entry)))
+		return -EFAULT;
+	for (i = 0; i < batch.count; i++) {
+		if (entry[i].addr > 0xffff || entry[i].op > VVCAM_REG_READ ||
+		    (entry[i].op == VVCAM_REG_WRITE && entry[i].data > 0xffff))
+			return -EINVAL;
+		entry[i].status = -ECANCELED;
+	}
+
+	i2c_lock_bus(adapter, I2C_LOCK_SEGMENT);
+	for (i = 0; i < batch.count && ret == 0; i += n) {
+		for (n = 1; i + n < batch.count && n < AR0144_BURST_MAX &&
+		     entry[i + n].op == entry[i].op &&
+		     entry[i + n].addr == entry[i].addr + 2 * n; n++)
+			;
+		ret = ar0144_reg_burst(sensor, &entry[i], n, buf);
+	}
+	i2c_unlock_bus(adapter, I2C_LOCK_SEGMENT);
+
+	if (copy_to_user(u64_to_user_ptr(batch.entries), entry,
+			 batch.count * sizeof(*entry)))
+		ret = -EFAULT;
+	return ret;
+}
+
+static const struct vvcam_mode_info_s *ar0144_find_mode(u32 index)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(par0144_mode_info); i++) {
+		if (par0144_mode_info[i].index == index)
+			return &par0144_mode_info[i];
+	}
+	return NULL;
+}
+
+/* value the mode table leaves in a register, 0 if it never writes it */
+static u16 ar0144_mode_reg(const struct vvcam_mode_info_s *mode, u16 addr)
+{
+	const struct vvcam_sccb_data_s *reg = mode->preg_data;
+	u16 val = 0;
+	int i;
+
+	for (i = 0; i < mode->reg_data_count; i++) {
+		if (reg[i].addr == addr)
+			val = reg[i].data;
+	}
+	return val;
+}
+
+/*
+ * Embedded data is enabled by the mode table itself, through the last
+ * SMIA_TEST write of the sequence.
+ */
+static u16 ar0144_mode_smia_test(const struct vvcam_mode_info_s *mode)
+{
+	return ar0144_mode_reg(mode, AR0144_SMIA_TEST);
+}
+
+static u32 ar0144_mode_ebd_lines(const struct vvcam_mode_info_s *mode,
+				 u32 *top, u32 *bottom)
+{
+	u16 smia_test = ar0144_mode_smia_test(mode);
+
+	*top = 0;
+	*bottom = 0;
+	if (smia_test & AR0144_EMBEDDED_DATA) {
+		*top = AR0144_EBD_TOP_LINES;
+		if (smia_test & AR0144_EMBEDDED_STATS)
+			*bottom = AR0144_EBD_BOTTOM_LINES;
+	}
+	return *top + *bottom;
+}
+
+static bool ar0144_is_context_reg(u16 addr)
+{
+	int i;
+
+	if (addr == AR0144_ANALOG_GAIN)
+		return true;
+	for (i = 0; i < ARRAY_SIZE(ar0144_context_regs); i++) {
+		if (ar0144_context_regs[i].reg_a == addr)
+			return true;
+	}
+	return false;
+}
+
+/* copy of a context A register that the active context uses */
+static u16 ar0144_ctx_reg(struct ar0144 *sensor, u16 reg_a)
+{
+	int i;
+
+	if (sensor->context == VVCAM_CONTEXT_A)
+		return reg_a;
+	for (i = 0; i < ARRAY_SIZE(ar0144_context_regs); i++) {
+		if (ar0144_context_regs[i].reg_a == reg_a)
+			return ar0144_context_regs[i].reg_b;
+	}
+	return reg_a;
+}
+
+/*
+ * A mode fits in context B when it only differs from the context A mode
+ * in registers that have a context B copy: crop, skipping, frame length,
+ * integration time and analog gain. The on-chip AE limit follows the
+ * frame length in the tables but the on-chip AE is not used.
+ */
+static bool ar0144_context_compatible(const struct vvcam_mode_info_s *a,
+				      const struct vvcam_mode_info_s *b)
+{
+	const struct vvcam_mode_info_s *modes[] = { a, b };
+	const struct vvcam_sccb_data_s *reg;
+	u16 addr;
+	int m, i;
+
+	if (a->bit_width != b->bit_width || a->bayer_pattern != b->bayer_pattern)
+		return false;
+
+	for (m = 0; m < ARRAY_SIZE(modes); m++) {
+		reg = modes[m]->preg_data;
+		for (i = 0; i < modes[m]->reg_data_count; i++) {
+			addr = reg[i].addr;
+			if (!ar0144_is_context_reg(addr) &&
+			    addr != AR0144_AE_MAX_EXPOSURE &&
+			    ar0144_mode_reg(a, addr) != ar0144_mode_reg(b, addr))
+				return false;
+		}
+	}
+	return true;
+}
+
+static u8 ar0144_csi2_dt(const struct vvcam_mode_info_s *mode)
+{
+	return mode->bit_width == 10 ? MIPI_CSI2_DT_RAW10 : MIPI_CSI2_DT_RAW12;
+}
+
+/* bayer is one of BAYER_*, as read out */
+static u32 ar0144_mbus_code(u32 bit_width, u32 bayer)
+{
+	static const u32 raw10[] = {
+		MEDIA_BUS_FMT_SRGGB10_1X10, MEDIA_BUS_FMT_SGRBG10_1X10,
+		MEDIA_BUS_FMT_SGBRG10_1X10, MEDIA_BUS_FMT_SBGGR10_1X10,
+	};
+	static const u32 raw12[] = {
+		MEDIA_BUS_FMT_SRGGB12_1X12, MEDIA_BUS_FMT_SGRBG12_1X12,
+		MEDIA_BUS_FMT_SGBRG12_1X12, MEDIA_BUS_FMT_SBGGR12_1X12,
+	};
+
+	bayer &= 3;
+	return bit_width == 10 ? raw10[bayer] : raw12[bayer];
+}
+
+/*
+ * Inverse of the sensor 12 to 10 bit A-law (COMPANDING = 1), which maps
+ *   0..255 -> 0..255, 256..511 -> 256..383, 512..1023 -> 384..511,
+ *   1024..2047 -> 512..767, 2048..4095 -> 768..1023
+ */
+static u32 ar0144_alaw_expand(u32 code)
+{
+	if (code < 256)
+		return code;
+	if (code < 384)
+		return 256 + (code - 256) * 2;
+	if (code < 512)
+		return 512 + (code - 384) * 4;
+	if (code < 768)
+		return 1024 + (code - 512) * 4;
+	return min_t(u32, 2048 + (code - 768) * 8,
+		     (1 << AR0144_COMPAND_Y_BIT) - 1);
 }
 
 static int ar0144_stream_on(struct ar0144 *sensor)
@@ -278,31 +501,321 @@ static int ar0144_s_power(struct v4l2_subdev *sd, int on)
 	return 0;
 }
 
+/*
+ * Probe does not touch the bus, so several cameras power up side by side
+ * instead of one after the other. The ID is read on the first open or
+ * stream on and the answer kept; a bus error is not kept, the next call
+ * retries. Called with lock held.
+ */
+static int ar0144_check_chip_id(struct ar0144 *sensor)
+{
+	struct device *dev = &sensor->i2c_client->dev;
+	u16 val = 0;
+	int ret;
+
+	if (sensor->chip_status != -EAGAIN)
+		return sensor->chip_status;
+
+	ret = ar0144_read_reg(sensor, AR0144_CHIP_VERSION_REG, &val);
+	if (ret < 0)
+		return -EIO;
+
+	if (val == AR0144_CHIP_ID) {
+		sensor->chip_id = val;
+		dev_info(dev, "Sensor AR0144 is found\n");
+		ret = 0;
+	} else {
+		dev_err(dev, "Sensor AR0144 is not found, id 0x%04x\n", val);
+		ret = -ENODEV;
+	}
+	/* pairs with the acquire in ar0144_priv_get() */
+	smp_store_release(&sensor->chip_status, ret);
+	return ret;
+}
+
+/*
+ * Die temperature in millidegrees Celsius, interpolated between the two
+ * factory calibration points. The sensor is powered on at each reading,
+ * as a soft reset in a mode change powers it down. Called with lock held.
+ */
+static int ar0144_read_temp(struct ar0144 *sensor, s32 *temp)
+{
+	u16 *calib = sensor->temp_calib;
+	u16 val;
+	int ret;
+
+	if (!calib[0]) {
+		ret = ar0144_read_reg(sensor, AR0144_TEMPSENS_CALIB1,
+				      &calib[0]);
+		if (ret == 0)
+			ret = ar0144_read_reg(sensor, AR0144_TEMPSENS_CALIB2,
+					      &calib[1]);
+		if (ret == 0 && calib[0] == calib[1])
+			ret = -EIO;
+		if (ret) {
+			calib[0] = 0;
+			return ret;
+		}
+	}
+
+	ret = ar0144_write_reg(sensor, AR0144_TEMPSENS_CTRL,
+			       AR0144_TEMPSENS_POWER_ON);
+	if (ret == 0)
+		ret = ar0144_write_reg(sensor, AR0144_TEMPSENS_CTRL,
+				       AR0144_TEMPSENS_POWER_ON |
+				       AR0144_TEMPSENS_START);
+	if (ret)
+		return ret;
+	usleep_range(1000, 1500);
+	ret = ar0144_read_reg(sensor, AR0144_TEMPSENS_DATA, &val);
+	if (ret)
+		return ret;
+
+	*temp = AR0144_TEMPSENS_CALIB1_MC +
+		((s32)(val & AR0144_TEMPSENS_MASK) - calib[0]) *
+		(AR0144_TEMPSENS_CALIB2_MC - AR0144_TEMPSENS_CALIB1_MC) /
+		((s32)calib[1] - calib[0]);
+	return 0;
+}
+
+static int ar0144_fcnt_sample(struct ar0144 *sensor)
+{
+	u16 val;
+	int ret;
+
+	ret = ar0144_read_reg(sensor, AR0144_FRAME_COUNT, &val);
+	if (!ret)
+		vvcam_fcnt_sample(&sensor->fcnt, val);
+	return ret;
+}
+
+static void ar0144_fcnt_work(struct work_struct *work)
+{
+	struct ar0144 *sensor = container_of(to_delayed_work(work),
+					     struct ar0144, fcnt_work);
+
+	mutex_lock(&sensor->lock);
+	if (sensor->stream_status) {
+		ar0144_fcnt_sample(sensor);
+		schedule_delayed_work(&sensor->fcnt_work, sensor->fcnt_period);
+	}
+	mutex_unlock(&sensor->lock);
+}
+
+static void ar0144_fcnt_start(struct ar0144 *sensor)
+{
+	u16 val = 0;
+
+	ar0144_read_reg(sensor, AR0144_FRAME_COUNT, &val);
+	vvcam_fcnt_start(&sensor->fcnt, val);
+	sensor->fcnt_period = vvcam_fcnt_period(&sensor->fcnt,
+				sensor->cur_mode.ae_info.max_fps);
+	schedule_delayed_work(&sensor->fcnt_work, sensor->fcnt_period);
+}
+
+/* stream_status is already clear, a work waiting for lock sees it and stops */
+static void ar0144_fcnt_stop(struct ar0144 *sensor)
+{
+	cancel_delayed_work(&sensor->fcnt_work);
+	ar0144_fcnt_sample(sensor);
+	vvcam_fcnt_stop(&sensor->fcnt);
+}
+
+static int ar0144_get_frame_stats(struct ar0144 *sensor, void *arg)
+{
+	struct vvcam_frame_stats_s stats;
+	int ret;
+
+	ret = vvcam_arg_in(&stats, arg);
+	if (ret)
+		return ret;
+	if (sensor->stream_status) {
+		ret = ar0144_fcnt_sample(sensor);
+		if (ret)
+			return ret;
+	}
+	vvcam_fcnt_report(&sensor->fcnt, &stats);
+	return vvcam_arg_out(arg, &stats);
+}
+
 static int ar0144_s_stream(struct v4l2_subdev *sd, int enable)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	struct ar0144 *sensor = to_ar0144_device(client);
+	int ret;
 
+	if (enable) {
+		ret = ar0144_stream_on(sensor);
+		if (ret == 0 && !sensor->stream_status) {
+			sensor->stream_status = 1;
+			ar0144_fcnt_start(sensor);
+		}
+	} else {
+		/* a failed stream off leaves the sensor and its counter running */
+		ret = ar0144_stream_off(sensor);
+		if (ret == 0 && sensor->stream_status) {
+			sensor->stream_status = 0;
+			ar0144_fcnt_stop(sensor);
+		}
+	}
+	return ret;
+}
+
+static int ar0144_video_s_stream(struct v4l2_subdev *sd, int enable)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct ar0144 *sensor = to_ar0144_device(client);
+	int ret = 0;
+
+	mutex_lock(&sensor->lock);
 	if (enable)
-		return ar0144_stream_on(sensor);
-	else
-		return ar0144_stream_off(sensor);
+		ret = ar0144_check_chip_id(sensor);
+	if (!ret)
+		ret = ar0144_s_stream(sd, enable);
+	mutex_unlock(&sensor->lock);
+	return ret;
+}
+
+/*
+ * Program the readout window on top of the mode table. The window is
+ * relative to the analog crop of the mode and the vertical blanking of
+ * the mode is kept, so the frame length shrinks with the window height.
+ * The on-chip AE exposure limit follows the frame length, as in the mode
+ * tables.
+ */
+static int ar0144_write_window(struct ar0144 *sensor)
+{
+	const struct vvcam_mode_info_s *base;
+	struct vvcam_window_s *win = &sensor->window.rect;
+	u32 fll = sensor->cur_mode.ae_info.def_frm_len_lines;
+	u16 x_start, y_start;
+	int ret;
+
+	base = ar0144_find_mode(sensor->cur_mode.index);
+	if (!base)
+		return -EINVAL;
+
+	x_start = ar0144_mode_reg(base, AR0144_X_ADDR_START) + win->left;
+	y_start = ar0144_mode_reg(base, AR0144_Y_ADDR_START) + win->top;
+
+	ret  = ar0144_write_reg(sensor, AR0144_Y_ADDR_START, y_start);
+	ret |= ar0144_write_reg(sensor, AR0144_X_ADDR_START, x_start);
+	ret |= ar0144_write_reg(sensor, AR0144_Y_ADDR_END,
+				y_start + win->height - 1);
+	ret |= ar0144_write_reg(sensor, AR0144_X_ADDR_END,
+				x_start + win->width - 1);
+	ret |= ar0144_write_reg(sensor, AR0144_FRAME_LENGTH_LINES, fll);
+	ret |= ar0144_write_reg(sensor, AR0144_AE_MAX_EXPOSURE, fll);
+	return ret;
+}
+
+static int ar0144_write_ana_gain(struct ar0144 *sensor)
+{
+	u16 gain_a = sensor->ana_gain[VVCAM_CONTEXT_A] & 0xff;
+	u16 gain_b = sensor->ana_gain[VVCAM_CONTEXT_B] & 0xff;
+
+	return ar0144_write_reg(sensor, AR0144_ANALOG_GAIN,
+				(gain_b << AR0144_ANALOG_GAIN_CB_SHIFT) | gain_a);
+}
+
+/* preload the context B registers from the table of the inactive mode */
+static int ar0144_write_context_b(struct ar0144 *sensor)
+{
+	const struct vvcam_mode_info_s *mode;
+	int i, ret = 0;
+
+	mode = ar0144_find_mode(sensor->ctx_mode.index);
+	if (!mode)
+		return -EINVAL;
+
+	for (i = 0; i < ARRAY_SIZE(ar0144_context_regs); i++)
+		ret |= ar0144_write_reg(sensor, ar0144_context_regs[i].reg_b,
+			ar0144_mode_reg(mode, ar0144_context_regs[i].reg_a));
+
+	sensor->ana_gain[VVCAM_CONTEXT_B] =
+		ar0144_mode_reg(mode, AR0144_ANALOG_GAIN);
+	ret |= ar0144_write_ana_gain(sensor);
+	return ret;
+}
+
+/*
+ * consistent copy of cur_mode, for callers that do not hold lock, with
+ * the bayer pattern as read out
+ */
+static void ar0144_read_mode(struct ar0144 *sensor,
+			     struct vvcam_mode_info_s *mode)
+{
+	unsigned int seq;
+
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		*mode = sensor->cur_mode;
+		mode->bayer_pattern ^= sensor->flip;
+	} while (read_seqretry(&sensor->state_seq, seq));
 }
 
 static int ar0144_enum_mbus_code(struct v4l2_subdev *sd,
 				struct v4l2_subdev_state *sd_state,
 				struct v4l2_subdev_mbus_code_enum *code)
 {
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct ar0144 *sensor = to_ar0144_device(client);
+	struct vvcam_mode_info_s mode;
 
-
-	if (code->pad || code->index >= ARRAY_SIZE(ar0144_colour_fmts))
+	if (code->pad || code->index >= ARRAY_SIZE(ar0144_bit_widths))
 		return -EINVAL;
 
-	code->code = ar0144_colour_fmts[code->index].code;
+	ar0144_read_mode(sensor, &mode);
+	code->code = ar0144_mbus_code(ar0144_bit_widths[code->index],
+				      mode.bayer_pattern);
 
 	return 0;
 }
 
+/* READ_MODE is shared by both contexts and left at 0 by the mode tables */
+static int ar0144_write_flip(struct ar0144 *sensor, u32 flip)
+{
+	u16 val;
+	int ret;
+
+	ret = ar0144_read_reg(sensor, AR0144_READ_MODE, &val);
+	if (ret < 0)
+		return ret;
+	val &= ~(AR0144_READ_MODE_HORIZ_MIRROR | AR0144_READ_MODE_VERT_FLIP);
+	if (flip & VVCAM_FLIP_H)
+		val |= AR0144_READ_MODE_HORIZ_MIRROR;
+	if (flip & VVCAM_FLIP_V)
+		val |= AR0144_READ_MODE_VERT_FLIP;
+	return ar0144_write_reg(sensor, AR0144_READ_MODE, val);
+}
+
+/* V4L2_CID_HFLIP and V4L2_CID_VFLIP, with lock held */
+static int ar0144_set_flip(struct vvcam_flip *vf, u32 flip)
+{
+	struct ar0144 *sensor = container_of(vf, struct ar0144, orient);
+	int ret;
+
+	if (flip == sensor->flip)
+		return 0;
+	/* the bayer order changes with it */
+	if (sensor->stream_status)
+		return -EBUSY;
+
+	ret = ar0144_check_chip_id(sensor);
+	if (ret)
+		return ret;
+	ret = ar0144_write_flip(sensor, flip);
+	if (ret < 0)
+		return ret;
+
+	write_seqlock(&sensor->state_seq);
+	sensor->flip = flip;
+	write_sequnlock(&sensor->state_seq);
+	sensor->fmt.code = ar0144_mbus_code(sensor->cur_mode.bit_width,
+					    sensor->cur_mode.bayer_pattern ^ flip);
+	return 0;
+}
+
 static int ar0144_set_fmt(struct v4l2_subdev *sd,
 			struct v4l2_subdev_state *sd_state,
 			struct v4l2_subdev_format *fmt)
@@ -324,18 +837,27 @@ static int ar0144_set_fmt(struct v4l2_subdev *sd,
 
 	if (sensor->mode_change) {
 		//ar0144_init(sensor);
-		ret |= ar0144_write_array(sensor,
+		ret = ar0144_write_array(sensor,
 			sensor->cur_mode.preg_data,
 			sensor->cur_mode.reg_data_count);
 	
+		sensor->ana_gain[VVCAM_CONTEXT_A] =
+			ar0144_mode_reg(&sensor->cur_mode, AR0144_ANALOG_GAIN);
+		if (ret == 0 && sensor->window.active)
+			ret = ar0144_write_window(sensor);
+		if (ret == 0 && sensor->ctx_loaded)
+			ret = ar0144_write_context_b(sensor);
+		if (ret == 0 && sensor->flip)
+			ret = ar0144_write_flip(sensor, sensor->flip);
 		if (ret < 0) {
 			pr_err("%s:ar0144_write_reg_arry error\n",__func__);
 			mutex_unlock(&sensor->lock);
-			return -EINVAL;
+			return ret;
 		}
 		sensor->mode_change = 0;
 	}
-	fmt->format.code = MEDIA_BUS_FMT_SGBRG12_1X12;
+	fmt->format.code = ar0144_mbus_code(sensor->cur_mode.bit_width,
+			sensor->cur_mode.bayer_pattern ^ sensor->flip);
 	fmt->format.field = V4L2_FIELD_NONE;
 	sensor->fmt = fmt->format;
 	mutex_unlock(&sensor->lock);
@@ -363,10 +885,44 @@ static int ar0144_get_fmt(struct v4l2_subdev *sd,
 	return 0;
 }
 
+static int ar0144_get_frame_desc(struct v4l2_subdev *sd, unsigned int pad,
+				 struct v4l2_mbus_frame_desc *fd)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct ar0144 *sensor = to_ar0144_device(client);
+	struct vvcam_mode_info_s *mode = &sensor->cur_mode;
+	struct v4l2_mbus_frame_desc_entry *entry;
+	u32 top, bottom, lines;
+
+	if (pad)
+		return -EINVAL;
+
+	memset(fd, 0, sizeof(*fd));
+	fd->type = V4L2_MBUS_FRAME_DESC_TYPE_CSI2;
+
+	mutex_lock(&sensor->lock);
+	entry = &fd->entry[fd->num_entries++];
+	entry->pixelcode = sensor->fmt.code;
+	entry->bus.csi2.dt = ar0144_csi2_dt(mode);
+
+	/* register values above the image, statistics below it, on VC 0 */
+	lines = ar0144_mode_ebd_lines(mode, &top, &bottom);
+	if (lines) {
+		entry = &fd->entry[fd->num_entries++];
+		entry->flags = V4L2_MBUS_FRAME_DESC_FL_LEN_MAX;
+		entry->pixelcode = MEDIA_BUS_FMT_SENSOR_DATA;
+		entry->length = lines * mode->size.bounds_width * mode->bit_width / 8;
+		entry->bus.csi2.dt = MIPI_CSI2_DT_EMBEDDED_8B;
+	}
+	mutex_unlock(&sensor->lock);
+
+	return 0;
+}
+
 static void ar0144_reset(struct ar0144 *sensor)
 {
 	gpiod_set_value_cansleep(sensor->reset, 1);
-	udelay(5000);
+	usleep_range(5000, 6000);
 
 	gpiod_set_value_cansleep(sensor->reset, 0);
 	msleep(20);
@@ -387,10 +943,8 @@ int ar0144_get_clk(struct ar0144 *sensor, void *clk)
 	struct vvcam_clk_s vvcam_clk;
 	int ret = 0;
 	vvcam_clk.sensor_mclk = 24000000;
-	vvcam_clk.csi_max_pixel_clk = 266000000;
-	ret = copy_to_user(clk, &vvcam_clk, sizeof(struct vvcam_clk_s));
-	if (ret != 0)
-		ret = -EINVAL;
+	vvcam_clk.csi_max_pixel_clk = AR0144_CSI_MAX_PIXEL_CLK;
+	ret = vvcam_arg_out(clk, &vvcam_clk);
 	return ret;
 }
 static int ar0144_query_capability(struct ar0144 *sensor, void *arg)
@@ -410,44 +964,37 @@ static int ar0144_query_capability(struct ar0144 *sensor, void *arg)
 
 static int ar0144_query_supports(struct ar0144 *sensor, void* parry)
 {
-	int ret = 0;
-	struct vvcam_mode_info_array_s *psensor_mode_arry = parry;
+	struct vvcam_mode_info_array_s __user *psensor_mode_arry = parry;
 	uint32_t support_counts = ARRAY_SIZE(par0144_mode_info);
 
-	ret = copy_to_user(&psensor_mode_arry->count, &support_counts, sizeof(support_counts));
-	ret |= copy_to_user(&psensor_mode_arry->modes, par0144_mode_info,
-			   sizeof(par0144_mode_info));
-	if (ret != 0)
-		ret = -ENOMEM;
-	return ret;
+	if (vvcam_arg_put_u32(support_counts, &psensor_mode_arry->count) ||
+	    copy_to_user(&psensor_mode_arry->modes, par0144_mode_info,
+			 sizeof(par0144_mode_info)))
+		return -EFAULT;
+	return 0;
 }
 static int ar0144_get_sensor_id(struct ar0144 *sensor, void* pchip_id)
 {
 	int ret = 0;
-	u16 chip_id;
 
-	ret = ar0144_read_reg(sensor, 0x3000, &chip_id);
-	ret = copy_to_user(pchip_id, &chip_id, sizeof(u16));
-	if (ret != 0)
-		ret = -ENOMEM;
+	/* checked once and does not change */
+	ret = vvcam_arg_out(pchip_id, &sensor->chip_id);
 	return ret;
 }
 static int ar0144_get_reserve_id(struct ar0144 *sensor, void* preserve_id)
 {
 	int ret = 0;
 	u16 reserve_id = 0x2770;
-	ret = copy_to_user(preserve_id, &reserve_id, sizeof(u16));
-	if (ret != 0)
-		ret = -ENOMEM;
+	ret = vvcam_arg_out(preserve_id, &reserve_id);
 	return ret;
 }
 static int ar0144_get_sensor_mode(struct ar0144 *sensor, void* pmode)
 {
 	int ret = 0;
-	ret = copy_to_user(pmode, &sensor->cur_mode,
-		sizeof(struct vvcam_mode_info_s));
-	if (ret != 0)
-		ret = -ENOMEM;
+	struct vvcam_mode_info_s mode;
+
+	ar0144_read_mode(sensor, &mode);
+	ret = vvcam_arg_out(pmode, &mode);
 	return ret;
 }
 
@@ -457,25 +1004,220 @@ static int ar0144_set_sensor_mode(struct ar0144 *sensor, void* pmode)
 	int i = 0;
 	struct vvcam_mode_info_s sensor_mode;
 
-	ret = copy_from_user(&sensor_mode, pmode,
-		sizeof(struct vvcam_mode_info_s));
+	ret = vvcam_arg_in(&sensor_mode, pmode);
 	if (ret != 0)
-		return -ENOMEM;
+		return ret;
 	for (i = 0; i < ARRAY_SIZE(par0144_mode_info); i++) 
     {
 		if (par0144_mode_info[i].index == sensor_mode.index) 
         {
+			write_seqlock(&sensor->state_seq);
 			memcpy(&sensor->cur_mode, &par0144_mode_info[i],sizeof(struct vvcam_mode_info_s));
+			vvcam_window_reset(&sensor->window);
+			sensor->context = VVCAM_CONTEXT_A;
+			write_sequnlock(&sensor->state_seq);
+			sensor->ctx_loaded = false;
+			sensor->mode_change = true;
 			return 0;
 		}
 	}
 	return -ENXIO;
 }
 
+static int ar0144_get_embedded_info(struct ar0144 *sensor, void *arg)
+{
+	struct vvcam_embedded_info_s info;
+	struct vvcam_mode_info_s mode;
+	int ret;
+
+	ar0144_read_mode(sensor, &mode);
+	memset(&info, 0, sizeof(info));
+	if (ar0144_mode_ebd_lines(&mode,
+				  &info.top_lines, &info.bottom_lines)) {
+		info.enable = 1;
+		info.data_type = MIPI_CSI2_DT_EMBEDDED_8B;
+		info.bit_width = mode.bit_width;
+		info.line_bytes = mode.size.bounds_width *
+				  mode.bit_width / 8;
+	}
+
+	ret = vvcam_arg_out(arg, &info);
+	return ret;
+}
+
+/*
+ * The ISP expands companded modes back to data_compress.x_bit with this
+ * curve: 64 equal segments of compressed codes, all knees of the A-law
+ * falling on a segment boundary.
+ */
+static int ar0144_get_expand_curve(struct ar0144 *sensor, void *arg)
+{
+	sensor_expand_curve_t curve;
+	struct vvcam_mode_info_s mode;
+	int i;
+
+	if (vvcam_arg_in(&curve, arg))
+		return -EFAULT;
+
+	ar0144_read_mode(sensor, &mode);
+	if (!ar0144_mode_reg(&mode, AR0144_COMPANDING) ||
+	    curve.x_bit != AR0144_COMPAND_X_BIT ||
+	    curve.y_bit != AR0144_COMPAND_Y_BIT)
+		return -EINVAL;
+
+	curve.expand_x_data[0] = 0;
+	curve.expand_y_data[0] = 0;
+	for (i = 1; i <= AR0144_EXPAND_SEGMENTS; i++) {
+		curve.expand_px[i - 1] = AR0144_EXPAND_PX;
+		curve.expand_x_data[i] = curve.expand_x_data[i - 1] +
+					 (1 << curve.expand_px[i - 1]);
+		curve.expand_y_data[i] =
+			ar0144_alaw_expand(curve.expand_x_data[i]);
+	}
+
+	return vvcam_arg_out(arg, &curve);
+}
+
+static int ar0144_set_window(struct ar0144 *sensor, void *arg)
+{
+	const struct vvcam_mode_info_s *base;
+	struct vvcam_window_s win;
+	int ret;
+
+	ret = vvcam_arg_in(&win, arg);
+	if (ret != 0)
+		return ret;
+
+	base = ar0144_find_mode(sensor->cur_mode.index);
+	if (!base)
+		return -EINVAL;
+
+	ret = vvcam_window_set(&sensor->window, &sensor->cur_mode, base, &win,
+			       AR0144_WINDOW_MIN_WIDTH, AR0144_WINDOW_MIN_HEIGHT,
+			       sensor->stream_status ||
+			       sensor->context != VVCAM_CONTEXT_A,
+			       &sensor->state_seq, &sensor->fmt);
+	if (ret != 0)
+		return ret;
+
+	/* a pending mode change writes the window along with the table */
+	if (sensor->mode_change)
+		return 0;
+	return ar0144_write_window(sensor);
+}
+
+static int ar0144_get_window(struct ar0144 *sensor, void *arg)
+{
+	struct vvcam_window_s win;
+
+	vvcam_window_get(&sensor->window, &sensor->cur_mode,
+			 &sensor->state_seq, &win);
+	return vvcam_arg_out(arg, &win);
+}
+
+static int ar0144_get_exposure(struct ar0144 *sensor, void *arg)
+{
+	struct vvcam_exposure_s exposure;
+	unsigned int seq;
+	int ret;
+
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		exposure = sensor->exposure;
+	} while (read_seqretry(&sensor->state_seq, seq));
+
+	ret = vvcam_arg_out(arg, &exposure);
+	return ret;
+}
+
+static int ar0144_set_context_mode(struct ar0144 *sensor, void *arg)
+{
+	const struct vvcam_mode_info_s *base, *mode;
+	struct vvcam_context_mode_s ctx;
+	int ret;
+
+	ret = vvcam_arg_in(&ctx, arg);
+	if (ret != 0)
+		return ret;
+
+	/* context A always holds the mode of VVSENSORIOC_S_SENSOR_MODE */
+	if (ctx.context != VVCAM_CONTEXT_B)
+		return -EINVAL;
+	if (sensor->context != VVCAM_CONTEXT_A || sensor->window.active)
+		return -EBUSY;
+
+	base = ar0144_find_mode(sensor->cur_mode.index);
+	mode = ar0144_find_mode(ctx.index);
+	if (!base || !mode || !ar0144_context_compatible(base, mode))
+		return -EINVAL;
+
+	memcpy(&sensor->ctx_mode, mode, sizeof(struct vvcam_mode_info_s));
+	sensor->ctx_loaded = true;
+
+	/* a pending mode change loads context B along with the table */
+	if (sensor->mode_change)
+		return 0;
+	return ar0144_write_context_b(sensor);
+}
+
+/*
+ * Flip the context select bit. The sensor applies it at the next frame
+ * start, so the frame in flight keeps the old context and the caller gets
+ * the new mode and ae_info right away.
+ */
+static int ar0144_set_context(struct ar0144 *sensor, u32 context)
+{
+	vvcam_mode_info_t mode;
+	u16 val;
+	int ret;
+
+	if (context > VVCAM_CONTEXT_B)
+		return -EINVAL;
+	if (context == sensor->context)
+		return 0;
+	if (!sensor->ctx_loaded || sensor->mode_change)
+		return -EINVAL;
+
+	/* the ISP buffers are sized at stream on */
+	if (sensor->stream_status &&
+	    (sensor->ctx_mode.size.bounds_width !=
+	     sensor->cur_mode.size.bounds_width ||
+	     sensor->ctx_mode.size.bounds_height !=
+	     sensor->cur_mode.size.bounds_height))
+		return -EBUSY;
+
+	ret = ar0144_read_reg(sensor, AR0144_DIGITAL_TEST, &val);
+	if (ret < 0)
+		return ret;
+	if (context == VVCAM_CONTEXT_B)
+		val |= AR0144_CONTEXT_B_SELECT;
+	else
+		val &= ~AR0144_CONTEXT_B_SELECT;
+	ret = ar0144_write_reg(sensor, AR0144_DIGITAL_TEST, val);
+	if (ret < 0)
+		return ret;
+
+	mode = sensor->cur_mode;
+	write_seqlock(&sensor->state_seq);
+	sensor->cur_mode = sensor->ctx_mode;
+	sensor->context = context;
+	write_sequnlock(&sensor->state_seq);
+	sensor->ctx_mode = mode;
+	sensor->fmt.width = sensor->cur_mode.size.bounds_width;
+	sensor->fmt.height = sensor->cur_mode.size.bounds_height;
+	return 0;
+}
+
 static int ar0144_set_exp(struct ar0144 *sensor, u32 exp)
 {
 	int ret = 0;
-	ret |= ar0144_write_reg(sensor, 0x3012, exp);
+	ret |= ar0144_write_reg(sensor,
+		ar0144_ctx_reg(sensor, AR0144_COARSE_INTEGRATION_TIME), exp);
+	if (!ret) {
+		write_seqlock(&sensor->state_seq);
+		sensor->exposure.integration_line = exp;
+		write_sequnlock(&sensor->state_seq);
+	}
 	return ret;
 }
 //TBD
@@ -499,15 +1241,21 @@ static int ar0144_set_gain(struct ar0144 *sensor, u32 gain)
 	dig_gain_hi = (gain/1024) <<7;
 	dig_gain_lo = (gain%1024)/8;
 	new_dig_gain = dig_gain_hi + dig_gain_lo;
-	ret = ar0144_write_reg(sensor, 0x3060, new_ana_gain);
+	sensor->ana_gain[sensor->context] = new_ana_gain;
+	ret = ar0144_write_ana_gain(sensor);
 	//ret = ar0144_write_reg(sensor, 0x305E, new_dig_gain);
-    return ret;
+	if (!ret) {
+		write_seqlock(&sensor->state_seq);
+		sensor->exposure.gain = gain;
+		write_sequnlock(&sensor->state_seq);
+	}
+	return ret;
 }
 
 static int ar0144_set_fps(struct ar0144 *sensor, u32 fps)
 {
 	u32 vts;
-	int ret = 0;
+	int ret;
 
 	if (fps > sensor->cur_mode.ae_info.max_fps) {
 		fps = sensor->cur_mode.ae_info.max_fps;
@@ -518,7 +1266,12 @@ static int ar0144_set_fps(struct ar0144 *sensor, u32 fps)
 	vts = sensor->cur_mode.ae_info.max_fps *
 	      sensor->cur_mode.ae_info.def_frm_len_lines / fps;
 
-	ret |= ar0144_write_reg(sensor, 0x3012, vts);
+	ret = ar0144_write_reg(sensor,
+		ar0144_ctx_reg(sensor, AR0144_FRAME_LENGTH_LINES), vts);
+	if (ret != 0)
+		return ret;
+
+	write_seqlock(&sensor->state_seq);
 	sensor->cur_mode.ae_info.cur_fps = fps;
 
 	if (sensor->cur_mode.hdr_mode == SENSOR_MODE_LINEAR) {
@@ -534,12 +1287,18 @@ static int ar0144_set_fps(struct ar0144 *sensor, u32 fps)
 		}
 	}
 	sensor->cur_mode.ae_info.curr_frm_len_lines = vts;
+	write_sequnlock(&sensor->state_seq);
 	return ret;
 }
 
 static int ar0144_get_fps(struct ar0144 *sensor, u32 *pfps)
 {
-	*pfps = sensor->cur_mode.ae_info.cur_fps;
+	unsigned int seq;
+
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		*pfps = sensor->cur_mode.ae_info.cur_fps;
+	} while (read_seqretry(&sensor->state_seq, seq));
 	return 0;
 }
 
@@ -549,9 +1308,9 @@ static int ar0144_set_test_pattern(struct ar0144 *sensor, void * arg)
 	int ret;
 	struct sensor_test_pattern_s test_pattern;
 
-	ret = copy_from_user(&test_pattern, arg, sizeof(test_pattern));
+	ret = vvcam_arg_in(&test_pattern, arg);
 	if (ret != 0)
-		return -ENOMEM;
+		return ret;
 	if (test_pattern.enable) {
 		switch (test_pattern.pattern) {
 		case 0:
@@ -572,16 +1331,60 @@ static int ar0144_set_test_pattern(struct ar0144 *sensor, void * arg)
 }
 static int ar0144_get_lens(struct ar0144 *sensor, void * arg) {
 
-	vvcam_lens_t *pfocus_lens = (vvcam_lens_t *)arg;
-
 	if (!arg)
-		return -ENOMEM;
+		return -EFAULT;
 
 	if (strlen(sensor->focus_lens.name) == 0)
 		return -1;
 
-	return copy_to_user(pfocus_lens, &sensor->focus_lens, sizeof(vvcam_lens_t));
+	return vvcam_arg_out(arg, &sensor->focus_lens);
 }
+/*
+ * Commands that only read driver state. They do not take lock, so a
+ * poll of the mode or exposure is not held up by a register upload.
+ * Returns -ENOIOCTLCMD for the commands that need lock.
+ */
+static long ar0144_priv_get(struct ar0144 *sensor, unsigned int cmd,
+			    void *arg)
+{
+	u32 fps;
+
+	switch (cmd) {
+	case VVSENSORIOC_G_CLK:
+		return ar0144_get_clk(sensor, arg);
+	case VIDIOC_QUERYCAP:
+		return ar0144_query_capability(sensor, arg);
+	case VVSENSORIOC_QUERY:
+		return ar0144_query_supports(sensor, arg);
+	case VVSENSORIOC_G_CHIP_ID:
+		/* not checked yet, go through lock */
+		if (smp_load_acquire(&sensor->chip_status))
+			return -ENOIOCTLCMD;
+		return ar0144_get_sensor_id(sensor, arg);
+	case VVSENSORIOC_G_RESERVE_ID:
+		return ar0144_get_reserve_id(sensor, arg);
+	case VVSENSORIOC_G_SENSOR_MODE:
+		return ar0144_get_sensor_mode(sensor, arg);
+	case VVSENSORIOC_G_FPS:
+		ar0144_get_fps(sensor, &fps);
+		return vvcam_arg_put_u32(fps, arg);
+	case VVSENSORIOC_G_LENS:
+		return ar0144_get_lens(sensor, arg);
+	case VVSENSORIOC_G_EXPAND_CURVE:
+		return ar0144_get_expand_curve(sensor, arg);
+	case VVSENSORIOC_G_EMBEDDED_INFO:
+		return ar0144_get_embedded_info(sensor, arg);
+	case VVSENSORIOC_G_WINDOW:
+		return ar0144_get_window(sensor, arg);
+	case VVSENSORIOC_G_EXPOSURE:
+		return ar0144_get_exposure(sensor, arg);
+	case VVSENSORIOC_G_FLIP:
+		return vvcam_arg_put_u32(READ_ONCE(sensor->flip), arg);
+	default:
+		return -ENOIOCTLCMD;
+	}
+}
+
 static long ar0144_priv_ioctl(struct v4l2_subdev *sd,
                               unsigned int cmd,
                               void *arg)
@@ -591,75 +1394,101 @@ static long ar0144_priv_ioctl(struct v4l2_subdev *sd,
 	long ret = 0;
 	struct vvcam_sccb_data_s sensor_reg;
 	uint32_t value = 0;
+	u16 val;
+	s32 temp;
+
+	ret = ar0144_priv_get(sensor, cmd, arg);
+	if (ret != -ENOIOCTLCMD)
+		return ret;
+	ret = 0;
 
 	mutex_lock(&sensor->lock);
+	ret = ar0144_check_chip_id(sensor);
+	if (ret) {
+		mutex_unlock(&sensor->lock);
+		return ret;
+	}
+
 	switch (cmd){
+	case VVSENSORIOC_G_CHIP_ID:
+		ret = ar0144_get_sensor_id(sensor, arg);
+		break;
 	case VVSENSORIOC_S_POWER:
 		ret = 0;
 		break;
 	case VVSENSORIOC_S_CLK:
 		ret = 0;
 		break;
-	case VVSENSORIOC_G_CLK:
-		ret = ar0144_get_clk(sensor,arg);
-		break;
 	case VVSENSORIOC_RESET:
 		ret = 0;
 		break;
-	case VIDIOC_QUERYCAP:
-		ret = ar0144_query_capability(sensor, arg);
-		break;
-	case VVSENSORIOC_QUERY:
-		ret = ar0144_query_supports(sensor, arg);
-		break;
-	case VVSENSORIOC_G_CHIP_ID:
-		ret = ar0144_get_sensor_id(sensor, arg);
-		break;
-	case VVSENSORIOC_G_RESERVE_ID:
-		ret = ar0144_get_reserve_id(sensor, arg);
-		break;
-	case VVSENSORIOC_G_SENSOR_MODE:
-		ret = ar0144_get_sensor_mode(sensor, arg);
-		break;
 	case VVSENSORIOC_S_SENSOR_MODE:
 		ret = ar0144_set_sensor_mode(sensor, arg);
 		break;
 	case VVSENSORIOC_S_STREAM:
-		ret = copy_from_user(&value, arg, sizeof(value));
-		ret |= ar0144_s_stream(&sensor->subdev, value);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ar0144_s_stream(&sensor->subdev, value);
 		break;
 	case VVSENSORIOC_WRITE_REG:
-		ret = copy_from_user(&sensor_reg, arg,
-			sizeof(struct vvcam_sccb_data_s));
-		ret |= ar0144_write_reg(sensor, sensor_reg.addr,
-			sensor_reg.data);
+		ret = vvcam_arg_in(&sensor_reg, arg);
+		if (!ret)
+			ret = ar0144_write_reg(sensor, sensor_reg.addr,
+				sensor_reg.data);
 		break;
 	case VVSENSORIOC_READ_REG:
-		ret = copy_from_user(&sensor_reg, arg, sizeof(struct vvcam_sccb_data_s));
-		ret |= ar0144_read_reg(sensor, (u16)sensor_reg.addr, (u16 *)&sensor_reg.data);
-		ret |= copy_to_user(arg, &sensor_reg, sizeof(struct vvcam_sccb_data_s));
+		ret = vvcam_arg_in(&sensor_reg, arg);
+		if (!ret)
+			ret = ar0144_read_reg(sensor, (u16)sensor_reg.addr, &val);
+		if (!ret) {
+			sensor_reg.data = val;
+			ret = vvcam_arg_out(arg, &sensor_reg);
+		}
 		break;
 	case VVSENSORIOC_S_EXP:
-		ret = copy_from_user(&value, arg, sizeof(value));
-		ret |= ar0144_set_exp(sensor, value);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ar0144_set_exp(sensor, value);
 		break;
 	case VVSENSORIOC_S_GAIN:
-		ret = copy_from_user(&value, arg, sizeof(value));
-		ret |= ar0144_set_gain(sensor, value);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ar0144_set_gain(sensor, value);
 		break;
 	case VVSENSORIOC_S_FPS:
-		ret = copy_from_user(&value, arg, sizeof(value));
-		ret |= ar0144_set_fps(sensor, value);
-		break;
-	case VVSENSORIOC_G_FPS:
-		ret = ar0144_get_fps(sensor, &value);
-		ret |= copy_to_user(arg, &value, sizeof(value));
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ar0144_set_fps(sensor, value);
 		break;
 	case VVSENSORIOC_S_TEST_PATTERN:
 		ret= ar0144_set_test_pattern(sensor, arg);
 		break;
-	case VVSENSORIOC_G_LENS:
-		ret = ar0144_get_lens(sensor, arg);
+	case VVSENSORIOC_S_WINDOW:
+		ret = ar0144_set_window(sensor, arg);
+		break;
+	case VVSENSORIOC_S_CONTEXT_MODE:
+		ret = ar0144_set_context_mode(sensor, arg);
+		break;
+	case VVSENSORIOC_S_CONTEXT:
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ar0144_set_context(sensor, value);
+		break;
+	case VVSENSORIOC_BATCH_REG:
+		ret = ar0144_batch_reg(sensor, arg);
+		break;
+	case VVSENSORIOC_S_FLIP:
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = vvcam_flip_set(&sensor->orient, value);
+		break;
+	case VVSENSORIOC_FRAME_STATS:
+		ret = ar0144_get_frame_stats(sensor, arg);
+		break;
+	case VVSENSORIOC_G_TEMPERATURE:
+		ret = ar0144_read_temp(sensor, &temp);
+		if (!ret)
+			ret = vvcam_arg_out(arg, &temp);
 		break;
 	default:
 		break;
@@ -670,13 +1499,14 @@ static long ar0144_priv_ioctl(struct v4l2_subdev *sd,
 }
 
 static const struct v4l2_subdev_video_ops ar0144_video_ops = {
-	.s_stream = ar0144_s_stream,
+	.s_stream = ar0144_video_s_stream,
 };
 
 static const struct v4l2_subdev_pad_ops ar0144_pad_ops = {
 	.enum_mbus_code = ar0144_enum_mbus_code,
 	.get_fmt = ar0144_get_fmt,
 	.set_fmt = ar0144_set_fmt,
+	.get_frame_desc = ar0144_get_frame_desc,
 };
 
 static const struct v4l2_subdev_core_ops ar0144_core_ops = {
@@ -690,20 +1520,48 @@ static const struct v4l2_subdev_ops ar0144_subdev_ops = {
 	.pad = &ar0144_pad_ops,
 };
 
-static int ar0144_check_chip_id(struct ar0144 *sensor)
+static int ar0144_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh)
 {
-	struct device *dev = &sensor->i2c_client->dev;
-	u16 val;
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct ar0144 *sensor = to_ar0144_device(client);
 	int ret;
-	ret = ar0144_read_reg(sensor, AR0144_CHIP_VERSION_REG, &val);
-	if ((ret < 0) | (val != AR0144_CHIP_ID)) {
-		dev_err(dev, "Sensor AR0144 is not found\n");
-        return -ENODEV;
-    }
 
-	dev_info(dev, "Sensor AR0144 is found\n");
+	mutex_lock(&sensor->lock);
+	ret = ar0144_check_chip_id(sensor);
+	mutex_unlock(&sensor->lock);
+	return ret;
+}
+
+static const struct v4l2_subdev_internal_ops ar0144_internal_ops = {
+	.open = ar0144_open,
+};
+
+static int ar0144_frames_show(struct seq_file *m, void *v)
+{
+	struct ar0144 *sensor = m->private;
+	struct vvcam_fcnt fcnt;
+
+	mutex_lock(&sensor->lock);
+	if (sensor->stream_status)
+		ar0144_fcnt_sample(sensor);
+	fcnt = sensor->fcnt;
+	mutex_unlock(&sensor->lock);
+
+	vvcam_fcnt_show(m, &fcnt);
 	return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(ar0144_frames);
+
+static int ar0144_temp_read(struct vvcam_temp *vt, s32 *temp)
+{
+	struct ar0144 *sensor = container_of(vt, struct ar0144, temp);
+	int ret;
+
+	ret = ar0144_check_chip_id(sensor);
+	if (!ret)
+		ret = ar0144_read_temp(sensor, temp);
+	return ret;
+}
 
 static int ar0144_link_setup(struct media_entity *entity,
 			   const struct media_pad *local,
@@ -716,6 +1574,19 @@ static const struct media_entity_operations ar0144_sd_media_ops = {
 	.link_setup = ar0144_link_setup,
 };
 
+static int ar0144_power_off(struct ar0144 *sensor)
+{
+	struct device *dev = &sensor->i2c_client->dev;
+	int ret;
+	pr_debug("enter %s\n", __func__);
+	ret = regulator_bulk_disable(AR0144_NUM_CONSUMERS, sensor->supplies);
+	if (ret) {
+		dev_err(dev, "Fail to enable regulators for AR0144\n");
+		return ret;
+	}
+	return 0;
+}
+
 static int ar0144_probe(struct i2c_client *client)
 {
 	struct device *dev = &client->dev;
@@ -723,6 +1594,8 @@ static int ar0144_probe(struct i2c_client *client)
 	//struct v4l2_mbus_framefmt *fmt;
 	int ret;
 	struct v4l2_subdev *sd;
+	char name[32];
+	ktime_t start = ktime_get();
 
 	sensor = devm_kmalloc(dev, sizeof(*sensor), GFP_KERNEL);
 	if (!sensor)
@@ -731,6 +1604,10 @@ static int ar0144_probe(struct i2c_client *client)
 
 	sensor->i2c_client = client;
 
+	sensor->scratch = devm_vvcam_arg_scratch_alloc(dev);
+	if (!sensor->scratch)
+		return -ENOMEM;
+
 	/* request reset pin */
 	sensor->reset = devm_gpiod_get_optional(dev, "reset", GPIOD_OUT_HIGH);
 	if (IS_ERR(sensor->reset)) {
@@ -762,12 +1639,19 @@ static int ar0144_probe(struct i2c_client *client)
 
 	ar0144_reset(sensor);
 
-	ret = ar0144_check_chip_id(sensor);
-	if (ret < 0)
-		return ret;
+	memcpy(&sensor->cur_mode, &par0144_mode_info[0],
+			sizeof(struct vvcam_mode_info_s));
+	sensor->chip_status = -EAGAIN;
+
+	/* the subdev can be opened as soon as it is registered */
+	mutex_init(&sensor->lock);
+	seqlock_init(&sensor->state_seq);
+	vvcam_fcnt_init(&sensor->fcnt, 0xffff, false);
+	INIT_DELAYED_WORK(&sensor->fcnt_work, ar0144_fcnt_work);
 
 	sd= &sensor->subdev;
 	v4l2_i2c_subdev_init(sd, client, &ar0144_subdev_ops);
+	sd->internal_ops = &ar0144_internal_ops;
 	sd->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE;
 	sd->dev = &client->dev;
 	sd->entity.ops = &ar0144_sd_media_ops;
@@ -777,31 +1661,43 @@ static int ar0144_probe(struct i2c_client *client)
 				1,
 				sensor->pads);
 	if (ret < 0)
-		return ret;
+		goto probe_err_power_off;
+
+	v4l2_ctrl_handler_init(&sensor->ctrls, 3);
+	sensor->ctrls.lock = &sensor->lock;
+	vvcam_flip_init(&sensor->orient, &sensor->ctrls, ar0144_set_flip);
+	ret = vvcam_temp_init(&sensor->temp, &sensor->ctrls, dev,
+			      &sensor->lock, "ar0144", ar0144_temp_read);
+	if (ret < 0)
+		goto probe_err_free_ctrls;
+	sd->ctrl_handler = &sensor->ctrls;
 
 	ret = v4l2_async_register_subdev_sensor(sd);
 	if (ret < 0) {
 		dev_err(&client->dev,"%s--Async register failed, ret=%d\n",
 			__func__,ret);
-		return ret;
-	}
-	
-	memcpy(&sensor->cur_mode, &par0144_mode_info[0],
-			sizeof(struct vvcam_mode_info_s));
-	mutex_init(&sensor->lock);
-	return ret;
-}
-static int ar0144_power_off(struct ar0144 *sensor)
-{
-	struct device *dev = &sensor->i2c_client->dev;
-	int ret;
-	pr_debug("enter %s\n", __func__);
-	ret = regulator_bulk_disable(AR0144_NUM_CONSUMERS, sensor->supplies);
-	if (ret) {
-		dev_err(dev, "Fail to enable regulators for AR0144\n");
-		return ret;
+		goto probe_err_free_ctrls;
 	}
+
+	snprintf(name, sizeof(name), "ar0144-%s", dev_name(dev));
+	sensor->debugfs = debugfs_create_dir(name, NULL);
+	debugfs_create_file("frames", 0444, sensor->debugfs, sensor,
+			    &ar0144_frames_fops);
+
+	dev_info(dev, "registered in %lld us\n",
+		 ktime_us_delta(ktime_get(), start));
 	return 0;
+
+probe_err_free_ctrls:
+	vvcam_temp_cleanup(&sensor->temp);
+	v4l2_ctrl_handler_free(&sensor->ctrls);
+	media_entity_cleanup(&sd->entity);
+
+probe_err_power_off:
+	ar0144_power_off(sensor);
+	mutex_destroy(&sensor->lock);
+
+	return ret;
 }
 static void ar0144_remove(struct i2c_client *client)
 {
@@ -810,7 +1706,11 @@ static void ar0144_remove(struct i2c_client *client)
 
 	pr_info("enter %s, %d\n", __func__, __LINE__);
 
+	debugfs_remove_recursive(sensor->debugfs);
 	v4l2_async_unregister_subdev(sd);
+	cancel_delayed_work_sync(&sensor->fcnt_work);
+	vvcam_temp_cleanup(&sensor->temp);
+	v4l2_ctrl_handler_free(&sensor->ctrls);
 	media_entity_cleanup(&sd->entity);
 	ar0144_power_off(sensor);
 	regulator_bulk_free(AR0144_NUM_CONSUMERS, sensor->supplies);
@@ -822,10 +1722,12 @@ static int __maybe_unused ar0144_suspend(struct device *dev)
 	struct i2c_client *client = to_i2c_client(dev);
 	struct ar0144 *sensor = to_ar0144_device(client);
 
+	mutex_lock(&sensor->lock);
 	sensor->resume_status = sensor->stream_status;
 	if (sensor->resume_status) {
 		ar0144_s_stream(&sensor->subdev,0);
 	}
+	mutex_unlock(&sensor->lock);
 
 	return 0;
 }
@@ -835,9 +1737,11 @@ static int __maybe_unused ar0144_resume(struct device *dev)
 	struct i2c_client *client = to_i2c_client(dev);
 	struct ar0144 *sensor = to_ar0144_device(client);
 
+	mutex_lock(&sensor->lock);
 	if (sensor->resume_status) {
 		ar0144_s_stream(&sensor->subdev,1);
 	}
+	mutex_unlock(&sensor->lock);
 
 	return 0;
 }
@@ -862,6 +1766,7 @@ static struct i2c_driver ar0144_i2c_driver = {
 		.name  = "ar0144",
 		.pm = &ar0144_pm_ops,
 		.of_match_table	= ar0144_dt_ids,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.id_table = ar0144_id,
 	.probe = ar0144_probe,
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * Sensor die temperature as the V4L2_CID_VVCAM_TEMPERATURE control of the
+ * subdev and as a hwmon temp1_input, which also backs a thermal zone when
+ * the device tree has one for the sensor. Both go through the driver's
+ * read callback, the same reading VVSENSORIOC_G_TEMPERATURE returns, and
+ * call it with the device lock held: the driver's control handler shares
+ * that lock.
+ *
+ * The same file is shipped next to each sensor driver with a temperature
+ * sensor; the copies must stay identical.
+ */
+
+#ifndef _VVSENSOR_TEMP_H_
+#define _VVSENSOR_TEMP_H_
+
+#include <linux/device.h>
+#include <linux/hwmon.h>
+#include <linux/mutex.h>
+#include <media/v4l2-ctrls.h>
+#include "vvsensor_ext.h"
+
+#define VVCAM_TEMP_MIN		(-40000)	/* millidegrees Celsius */
+#define VVCAM_TEMP_MAX		125000
+
+struct vvcam_temp {
+	struct device *hwmon;	/* NULL without a hwmon device */
+	struct mutex *lock;
+	/* millidegrees Celsius, called with lock held */
+	int (*read)(struct vvcam_temp *vt, s32 *temp);
+};
+
+static int vvcam_temp_g_volatile_ctrl(struct v4l2_ctrl *ctrl)
+{
+	struct vvcam_temp *vt = ctrl->priv;
+	s32 temp;
+	int ret;
+
+	ret = vt->read(vt, &temp);
+	if (!ret)
+		ctrl->val = temp;
+	return ret;
+}
+
+static const struct v4l2_ctrl_ops vvcam_temp_ctrl_ops = {
+	.g_volatile_ctrl = vvcam_temp_g_volatile_ctrl,
+};
+
+static const struct v4l2_ctrl_config vvcam_temp_ctrl = {
+	.ops = &vvcam_temp_ctrl_ops,
+	.id = V4L2_CID_VVCAM_TEMPERATURE,
+	.name = "Temperature",
+	.type = V4L2_CTRL_TYPE_INTEGER,
+	.flags = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+	.min = VVCAM_TEMP_MIN,
+	.max = VVCAM_TEMP_MAX,
+	.step = 1,
+};
+
+#if IS_REACHABLE(CONFIG_HWMON)
+static umode_t vvcam_temp_hwmon_is_visible(const void *data,
+					   enum hwmon_sensor_types type,
+					   u32 attr, int channel)
+{
+	return 0444;
+}
+
+static int vvcam_temp_hwmon_read(struct device *dev,
+				 enum hwmon_sensor_types type,
+				 u32 attr, int channel, long *val)
+{
+	struct vvcam_temp *vt = dev_get_drvdata(dev);
+	s32 temp;
+	int ret;
+
+	mutex_lock(vt->lock);
+	ret = vt->read(vt, &temp);
+	mutex_unlock(vt->lock);
+	if (!ret)
+		*val = temp;
+	return ret;
+}
+
+/* temp1_input, and a thermal zone when the device tree has one for us */
+static const struct hwmon_channel_info *vvcam_temp_hwmon_info[] = {
+	HWMON_CHANNEL_INFO(chip, HWMON_C_REGISTER_TZ),
+	HWMON_CHANNEL_INFO(temp, HWMON_T_INPUT),
+	NULL
+};
+
+static const struct hwmon_ops vvcam_temp_hwmon_ops = {
+	.is_visible = vvcam_temp_hwmon_is_visible,
+	.read = vvcam_temp_hwmon_read,
+};
+
+static const struct hwmon_chip_info vvcam_temp_hwmon_chip_info = {
+	.ops = &vvcam_temp_hwmon_ops,
+	.info = vvcam_temp_hwmon_info,
+};
+#endif
+
+/*
+ * Add the temperature control to hdl, whose lock is lock, and register the
+ * hwmon device of dev as name, a hwmon name without dashes. Call it before
+ * the subdev is registered. It fails with the error of hdl, the controls
+ * added before included, and then registers nothing; a missing hwmon
+ * device is only warned about. The hwmon device is not device managed:
+ * vvcam_temp_cleanup() removes it while the lock and the client are still
+ * alive.
+ */
+static inline int vvcam_temp_init(struct vvcam_temp *vt,
+				  struct v4l2_ctrl_handler *hdl,
+				  struct device *dev, struct mutex *lock,
+				  const char *name,
+				  int (*read)(struct vvcam_temp *, s32 *))
+{
+	vt->lock = lock;
+	vt->read = read;
+	vt->hwmon = NULL;
+	v4l2_ctrl_new_custom(hdl, &vvcam_temp_ctrl, vt);
+	if (hdl->error)
+		return hdl->error;
+
+#if IS_REACHABLE(CONFIG_HWMON)
+	{
+		struct device *hwmon;
+
+		hwmon = hwmon_device_register_with_info(dev, name, vt,
+					&vvcam_temp_hwmon_chip_info, NULL);
+		if (IS_ERR(hwmon))
+			dev_warn(dev, "no hwmon device, %ld\n",
+				 PTR_ERR(hwmon));
+		else
+			vt->hwmon = hwmon;
+	}
+#endif
+	return 0;
+}
+
+/* before the device lock is destroyed; the driver frees its handler */
+static inline void vvcam_temp_cleanup(struct vvcam_temp *vt)
+{
+#if IS_REACHABLE(CONFIG_HWMON)
+	if (vt->hwmon)
+		hwmon_device_unregister(vt->hwmon);
+	vt->hwmon = NULL;
+#endif
+}
+
+#endif
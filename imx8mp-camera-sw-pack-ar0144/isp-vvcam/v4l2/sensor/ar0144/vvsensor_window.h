@@ -0,0 +1,122 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * Readout window for VVSENSORIOC_S_WINDOW and VVSENSORIOC_G_WINDOW.
+ *
+ * The window is given in output pixels of a mode of the driver table, the
+ * base mode, and keeps its bayer phase. The vertical blanking of the base
+ * mode is kept, so the frame length, and with it max_fps, follows the
+ * window height. These helpers keep the mode size, the AE limits and the
+ * format in step; the driver programs the registers from rect and the
+ * def_frm_len_lines of the mode, after the mode table whenever that is
+ * written. vvcam_window_get() only needs the state seqlock, the other
+ * calls are made with the device lock held.
+ *
+ * The same file is shipped next to each sensor driver; the copies must
+ * stay identical.
+ */
+
+#ifndef _VVSENSOR_WINDOW_H_
+#define _VVSENSOR_WINDOW_H_
+
+#include <linux/errno.h>
+#include <linux/math64.h>
+#include <linux/seqlock.h>
+#include <linux/v4l2-mediabus.h>
+#include "vvsensor.h"
+#include "vvsensor_ext.h"
+
+struct vvcam_window {
+	struct vvcam_window_s rect;
+	bool active;		/* rect is smaller than the base mode */
+};
+
+/* back to the full base mode, on a mode change */
+static inline void vvcam_window_reset(struct vvcam_window *vw)
+{
+	vw->active = false;
+}
+
+/*
+ * Window mode, which is base or a window of it, to win. The output size
+ * changes with the window, which needs the ISP pipeline reconfigured, so
+ * it fails with -EBUSY while busy, that is while streaming. The update is
+ * published under seq along with the width and height of fmt.
+ */
+static inline int vvcam_window_set(struct vvcam_window *vw,
+				   struct vvcam_mode_info_s *mode,
+				   const struct vvcam_mode_info_s *base,
+				   const struct vvcam_window_s *win,
+				   u32 min_width, u32 min_height, bool busy,
+				   seqlock_t *seq,
+				   struct v4l2_mbus_framefmt *fmt)
+{
+	const struct vvcam_sensor_ae_info_s *base_ae = &base->ae_info;
+	struct vvcam_sensor_ae_info_s *ae = &mode->ae_info;
+	u32 vblank, margin, fll;
+
+	if (busy)
+		return -EBUSY;
+
+	/* keep the bayer phase of the mode */
+	if ((win->left | win->top | win->width | win->height) & 1)
+		return -EINVAL;
+	if (win->width < min_width || win->height < min_height ||
+	    win->left + win->width > base->size.bounds_width ||
+	    win->top + win->height > base->size.bounds_height)
+		return -EINVAL;
+
+	vblank = base_ae->def_frm_len_lines - base->size.bounds_height;
+	margin = base_ae->def_frm_len_lines - base_ae->max_integration_line;
+	fll = win->height + vblank;
+
+	write_seqlock(seq);
+	mode->size = base->size;
+	mode->size.bounds_width = win->width;
+	mode->size.bounds_height = win->height;
+	mode->size.width = win->width;
+	mode->size.height = win->height;
+
+	*ae = *base_ae;
+	ae->def_frm_len_lines = fll;
+	ae->curr_frm_len_lines = fll -
+		(base_ae->def_frm_len_lines - base_ae->curr_frm_len_lines);
+	ae->max_integration_line = fll - margin;
+	ae->max_fps = div_u64((u64)base_ae->max_fps *
+			      base_ae->def_frm_len_lines, fll);
+	ae->cur_fps = ae->max_fps;
+
+	vw->rect = *win;
+	vw->active = win->width != base->size.bounds_width ||
+		     win->height != base->size.bounds_height;
+	fmt->width = win->width;
+	fmt->height = win->height;
+	write_sequnlock(seq);
+	return 0;
+}
+
+/* the current window, the whole mode when none is set; without the lock */
+static inline void vvcam_window_get(const struct vvcam_window *vw,
+				    const struct vvcam_mode_info_s *mode,
+				    seqlock_t *seq, struct vvcam_window_s *win)
+{
+	unsigned int s;
+
+	do {
+		s = read_seqbegin(seq);
+		if (vw->active) {
+			*win = vw->rect;
+		} else {
+			win->left = 0;
+			win->top = 0;
+			win->width = mode->size.bounds_width;
+			win->height = mode->size.bounds_height;
+		}
+	} while (read_seqretry(seq, s));
+}
+
+#endif
@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __IMX219_FRAMES_H__
+#define __IMX219_FRAMES_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "vvsensor_ext.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Compare the frames the sensor sent since stream on with the buffers the
+ * pipeline delivered. delivered is the count of buffers handed to the
+ * consumer since stream on, inFlight the frames that may be queued between
+ * the sensor and the consumer. pStats returns the sensor frame count and
+ * the frames dropped, see struct vvcam_frame_stats_s. Call it at buffer
+ * rate or slower; each call at which frames were lost counts as one gap.
+ */
+RESULT IMX219_IsiGetFrameStatsIss(IsiSensorHandle_t handle, uint64_t delivered,
+                                  uint32_t inFlight,
+                                  struct vvcam_frame_stats_s *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __IMX219_THERMAL_H__
+#define __IMX219_THERMAL_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "vvsensor_isi.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* see VVSENSOR_ThermalLimits_t, the throttling is done by the ISI core */
+typedef VVSENSOR_ThermalLimits_t IMX219_ThermalLimits_t;
+
+/* die temperature in millidegrees Celsius */
+RESULT IMX219_IsiGetSensorTemperatureIss(IsiSensorHandle_t handle,
+                                         int32_t *pTemp);
+
+/*
+ * Enable the throttling with pLimits, or disable it with NULL. Disabling
+ * it while throttled restores the frame rate.
+ */
+RESULT IMX219_IsiSetThermalLimitsIss(IsiSensorHandle_t handle,
+                                     const IMX219_ThermalLimits_t *pLimits);
+
+/*
+ * Read the temperature and apply the limits. Call it periodically while
+ * streaming, once a second is plenty; pTemp may be NULL. The IMX219 only
+ * measures during readout, the read fails while the sensor is stopped.
+ */
+RESULT IMX219_IsiThermalUpdateIss(IsiSensorHandle_t handle, int32_t *pTemp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
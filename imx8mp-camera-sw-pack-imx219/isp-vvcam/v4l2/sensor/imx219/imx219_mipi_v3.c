@@ -7,16 +7,22 @@
  */
 
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/of_graph.h>
 #include <linux/device.h>
 #include <linux/i2c.h>
 #include <linux/init.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/of_device.h>
 #include <linux/of_gpio.h>
 #include <linux/pinctrl/consumer.h>
 #include <linux/regulator/consumer.h>
+#include <linux/seq_file.h>
+#include <linux/seqlock.h>
 #include <linux/v4l2-mediabus.h>
 #include <media/v4l2-device.h>
 #include <media/v4l2-ctrls.h>
@@ -24,8 +30,14 @@
 #include <linux/uaccess.h>
 #include <linux/version.h>
 #include "vvsensor.h"
+#include "vvsensor_ext.h"
+#include "vvsensor_uarg.h"
+#include "vvsensor_fcnt.h"
+#include "vvsensor_window.h"
+#include "vvsensor_temp.h"
+#include "vvsensor_flip.h"
 
-#include "imx219_regs_1080p.h"
+#include "imx219_modes.h"
 
 #define IMX219_VOLTAGE_ANALOG			2800000
 #define IMX219_VOLTAGE_DIGITAL_CORE		1500000
@@ -37,51 +49,21 @@
 #define IMX219_SENS_PAD_SOURCE	0
 #define IMX219_SENS_PADS_NUM	1
 
-#define client_to_imx219(client)\
-	container_of(i2c_get_clientdata(client), struct imx219, subdev)
+#define IMX219_FRM_CNT		0x0018	/* 8 bit, counts frames out */
+#define IMX219_FRM_LENGTH_A	0x0160
+#define IMX219_IMG_ORIENTATION_A	0x0172	/* bit 0 mirror, bit 1 flip */
+#define IMX219_X_ADD_STA_A	0x0164
+#define IMX219_Y_ADD_STA_A	0x0168
+#define IMX219_TEMP_SENS_CTL	0x0138	/* bit 0 enables the sensor */
+#define IMX219_TEMP_SENS_OUT	0x013A	/* degrees Celsius, two's complement */
 
-/*
-Use USER_TO_KERNEL/KERNEL_TO_USER to fix "uaccess" exception on run time.
-Also, use "copy_ret" to fix the build issue as below.
-error: ignoring return value of function declared with 'warn_unused_result' attribute.
-*/
-
-#ifdef CONFIG_HARDENED_USERCOPY
-#define USER_TO_KERNEL(TYPE) \
-	do {\
-		TYPE tmp; \
-		unsigned long copy_ret; \
-		arg = (void *)(&tmp); \
-		copy_ret = copy_from_user(arg, arg_user, sizeof(TYPE));\
-	} while (0)
-
-#define KERNEL_TO_USER(TYPE) \
-	do {\
-		unsigned long copy_ret; \
-		copy_ret = copy_to_user(arg_user, arg, sizeof(TYPE));\
-	} while (0)
-
-#define USER_TO_KERNEL_VMALLOC(TYPE) \
-	do {\
-		unsigned long copy_ret; \
-		arg = vmalloc(sizeof(TYPE)); \
-		copy_ret = copy_from_user(arg, arg_user, sizeof(TYPE));\
-	} while (0)
-
-#define KERNEL_TO_USER_VMALLOC(TYPE) \
-	do {\
-		unsigned long copy_ret; \
-		copy_ret = copy_to_user(arg_user, arg, sizeof(TYPE));\
-		vfree(arg); \
-	} while (0)
+#define IMX219_WINDOW_MIN_WIDTH		64
+#define IMX219_WINDOW_MIN_HEIGHT	16
 
-#else
-#define USER_TO_KERNEL(TYPE)
-#define KERNEL_TO_USER(TYPE)
-#define USER_TO_KERNEL_VMALLOC(TYPE)
-#define KERNEL_TO_USER_VMALLOC(TYPE)
-#endif
+#define IMX219_BURST_MAX	128	/* registers per batch I2C transfer */
 
+#define client_to_imx219(client)\
+	container_of(i2c_get_clientdata(client), struct imx219, subdev)
 
 struct imx219_capture_properties {
 	__u64 max_lane_frequency;
@@ -108,69 +90,38 @@ struct imx219 {
 
 	struct v4l2_mbus_framefmt format;
 	vvcam_mode_info_t cur_mode;
+	struct vvcam_window window;
+	struct vvcam_exposure_s exposure;
+	u32 flip;			/* VVCAM_FLIP_* */
 	sensor_blc_t blc;
 	sensor_white_balance_t wb;
 	struct mutex lock;
+	struct vvcam_arg_scratch_s *scratch;
+	/*
+	 * cur_mode, window, exposure and flip are changed with lock held
+	 * and published under state_seq, so the getters read them without
+	 * waiting for register writes in flight
+	 */
+	seqlock_t state_seq;
+	/*
+	 * The model ID is checked on first open or stream on, not at probe.
+	 * chip_status is -EAGAIN until then, 0 or -ENODEV after.
+	 */
+	int chip_status;
+	u32 chip_id;			/* 0 until read once */
+	/* FRM_CNT sampled with lock held, every fcnt_period while streaming */
+	struct vvcam_fcnt fcnt;
+	struct delayed_work fcnt_work;
+	unsigned long fcnt_period;
+	struct dentry *debugfs;
+	/* controls, sharing lock */
+	struct v4l2_ctrl_handler ctrls;
+	struct vvcam_temp temp;
+	struct vvcam_flip orient;
 	u32 stream_status;
 	u32 resume_status;
 };
 
-static struct vvcam_mode_info_s pimx219_mode_info[] = {
-	{
-		.index	        = 0,
-		.size           = {
-			.bounds_width  = 1920,
-			.bounds_height = 1080,
-			.top           = 0,
-			.left          = 0,
-			.width         = 1920,
-			.height        = 1080,
-		},
-		.hdr_mode       = SENSOR_MODE_LINEAR,
-		.bit_width      = 10,
-		.data_compress  = {
-			.enable = 0,
-		},
-		.bayer_pattern  = BAYER_RGGB,
-		.ae_info = {
-			/*
-			PIX_CLK = INCK * Pre-Div1 * PLL * DIV1
-			        = 0x18(24) * 1/3 * 0x39(57) * 1/5
-					= 91.2 MHz
-
-			Time Per Line [sec] = 0xd78 / (2* 91.2 * 1000 *1000 )
-			                    = 1.8903e-5
-								= 18903 ns
-
-			(Frame Length)  = 1/ Time per Line[sec] * Frame rate [frame/s] 
-                            = 1/ (1.8903508771929824e-05 * 30)
-                            = 0x6e4   // IMX219_VTS_30FPS_1080P
-			*/
-			.def_frm_len_lines     = 0x6e4,
-			.curr_frm_len_lines    = 0x6e4,
-			.one_line_exp_time_ns  = 18903,
-			.max_integration_line  = 0x6a4 - 4,
-			.min_integration_line  = 1,
-			.max_again             = 10.66 * (1 << SENSOR_FIX_FRACBITS),
-			.min_again             = 1     * (1 << SENSOR_FIX_FRACBITS),
-			.max_dgain             = 15.85 * (1 << SENSOR_FIX_FRACBITS),
-			.min_dgain             = 1     * (1 << SENSOR_FIX_FRACBITS),
-			.start_exposure        = 3 * 400 * (1 << SENSOR_FIX_FRACBITS), // why
-			.cur_fps               = 30   * (1 << SENSOR_FIX_FRACBITS),
-			.max_fps               = 30   * (1 << SENSOR_FIX_FRACBITS),
-			.min_fps               = 5    * (1 << SENSOR_FIX_FRACBITS),
-			.min_afps              = 5    * (1 << SENSOR_FIX_FRACBITS),
-			.int_update_delay_frm  = 1,
-			.gain_update_delay_frm = 1,
-		},
-		.mipi_info = {
-			.mipi_lane = 2, 
-		},
-		.preg_data      = imx219_init_setting_1080p,
-		.reg_data_count = ARRAY_SIZE(imx219_init_setting_1080p),
-	},
-};
-
 static int imx219_power_on(struct imx219 *sensor)
 {
 	int ret;
@@ -216,9 +167,7 @@ static int imx219_get_clk(struct imx219 *sensor, void *clk)
 	int ret = 0;
 	vvcam_clk.sensor_mclk = clk_get_rate(sensor->sensor_clk);
 	vvcam_clk.csi_max_pixel_clk = sensor->ocp.max_pixel_frequency;
-	ret = copy_to_user(clk, &vvcam_clk, sizeof(struct vvcam_clk_s));
-	if (ret != 0)
-		ret = -EINVAL;
+	ret = vvcam_arg_out(clk, &vvcam_clk);
 	return ret;
 }
 
@@ -270,19 +219,19 @@ static int imx219_write_reg_arry(struct imx219 *sensor,
 	int i = 0;
 	int ret = 0;
 	struct i2c_msg msg;
-	u8 *send_buf;
+	u8 *send_buf = sensor->scratch->sccb_burst;
 	u32 send_buf_len = 0;
 	struct i2c_client *i2c_client = sensor->i2c_client;
 
-	send_buf = (u8 *)kmalloc(size + 2, GFP_KERNEL);
-	if (!send_buf)
-		return -ENOMEM;
+	if (size == 0)
+		return 0;
 
 	send_buf[send_buf_len++] = (reg_arry[0].addr >> 8) & 0xff;
 	send_buf[send_buf_len++] = reg_arry[0].addr & 0xff;
 	send_buf[send_buf_len++] = reg_arry[0].data & 0xff;
 	for (i=1; i < size; i++) {
-		if (reg_arry[i].addr == (reg_arry[i-1].addr + 1)){
+		if (reg_arry[i].addr == (reg_arry[i-1].addr + 1) &&
+		    send_buf_len < sizeof(sensor->scratch->sccb_burst)) {
 			send_buf[send_buf_len++] = reg_arry[i].data & 0xff;
 		} else {
 			msg.addr  = i2c_client->addr;
@@ -292,7 +241,6 @@ static int imx219_write_reg_arry(struct imx219 *sensor,
 			ret = i2c_transfer(i2c_client->adapter, &msg, 1);
 			if (ret < 0) {
 				pr_err("%s:i2c transfer error\n",__func__);
-				kfree(send_buf);
 				return ret;
 			}
 			send_buf_len = 0;
@@ -317,7 +265,85 @@ static int imx219_write_reg_arry(struct imx219 *sensor,
 			ret = 0;
 
 	}
-	kfree(send_buf);
+	return ret;
+}
+
+/* one I2C transfer for a run of entries of one op at consecutive registers */
+static int imx219_reg_burst(struct imx219 *sensor,
+			    struct vvcam_reg_entry_s *entry, u32 n, u8 *buf)
+{
+	struct i2c_client *client = sensor->i2c_client;
+	struct i2c_msg msg[2];
+	u32 i;
+	int num = 1, ret;
+
+	buf[0] = (entry[0].addr >> 8) & 0xff;
+	buf[1] = entry[0].addr & 0xff;
+	msg[0].addr = client->addr;
+	msg[0].flags = client->flags;
+	msg[0].buf = buf;
+	msg[0].len = 2;
+	if (entry[0].op == VVCAM_REG_WRITE) {
+		for (i = 0; i < n; i++)
+			buf[2 + i] = entry[i].data & 0xff;
+		msg[0].len += n;
+	} else {
+		msg[1].addr = client->addr;
+		msg[1].flags = client->flags | I2C_M_RD;
+		msg[1].buf = buf + 2;
+		msg[1].len = n;
+		num = 2;
+	}
+
+	ret = __i2c_transfer(client->adapter, msg, num);
+	ret = ret < 0 ? ret : (ret == num ? 0 : -EIO);
+	for (i = 0; i < n; i++) {
+		if (ret == 0 && entry[i].op == VVCAM_REG_READ)
+			entry[i].data = buf[2 + i];
+		entry[i].status = ret;
+	}
+	return ret;
+}
+
+static int imx219_batch_reg(struct imx219 *sensor, void *arg)
+{
+	struct i2c_adapter *adapter = sensor->i2c_client->adapter;
+	struct vvcam_reg_batch_s batch;
+	struct vvcam_reg_entry_s *entry = sensor->scratch->reg_entry;
+	u8 buf[2 + IMX219_BURST_MAX];
+	u32 i, n;
+	int ret = 0;
+
+	if (vvcam_arg_in(&batch, arg))
+		return -EFAULT;
+	if (batch.count == 0)
+		return 0;
+	if (batch.count > VVCAM_REG_BATCH_MAX)
+		return -EINVAL;
+
+	if (copy_from_user(entry, u64_to_user_ptr(batch.entries),
+			   batch.count * sizeof(*entry)))
+		return -EFAULT;
+	for (i = 0; i < batch.count; i++) {
+		if (entry[i].addr > 0xffff || entry[i].op > VVCAM_REG_READ ||
+		    (entry[i].op == VVCAM_REG_WRITE && entry[i].data > 0xff))
+			return -EINVAL;
+		entry[i].status = -ECANCELED;
+	}
+
+	i2c_lock_bus(adapter, I2C_LOCK_SEGMENT);
+	for (i = 0; i < batch.count && ret == 0; i += n) {
+		for (n = 1; i + n < batch.count && n < IMX219_BURST_MAX &&
+		     entry[i + n].op == entry[i].op &&
+		     entry[i + n].addr == entry[i].addr + n; n++)
+			;
+		ret = imx219_reg_burst(sensor, &entry[i], n, buf);
+	}
+	i2c_unlock_bus(adapter, I2C_LOCK_SEGMENT);
+
+	if (copy_to_user(u64_to_user_ptr(batch.entries), entry,
+			 batch.count * sizeof(*entry)))
+		ret = -EFAULT;
 	return ret;
 }
 
@@ -339,12 +365,48 @@ static int imx219_query_capability(struct imx219 *sensor, void *arg)
 
 static int imx219_query_supports(struct imx219 *sensor, void* parry)
 {
-	struct vvcam_mode_info_array_s *psensor_mode_arry = parry;
+	struct vvcam_mode_info_array_s __user *psensor_mode_arry = parry;
+	u32 count = ARRAY_SIZE(pimx219_mode_info);
+
+	/* only the modes there are, not the whole array */
+	if (vvcam_arg_put_u32(count, &psensor_mode_arry->count) ||
+	    copy_to_user(&psensor_mode_arry->modes, pimx219_mode_info,
+			 sizeof(pimx219_mode_info)))
+		return -EFAULT;
+	return 0;
+}
 
-	psensor_mode_arry->count = ARRAY_SIZE(pimx219_mode_info);
-	memcpy((void *)&psensor_mode_arry->modes, (void *)pimx219_mode_info, sizeof(pimx219_mode_info));
+/*
+ * Probe does not touch the bus, so several cameras power up side by side
+ * instead of one after the other. The model ID is read on the first open
+ * or stream on and the answer kept; a bus error is not kept, the next
+ * call retries. Called with lock held.
+ */
+static int imx219_check_chip_id(struct imx219 *sensor)
+{
+	struct device *dev = &sensor->i2c_client->dev;
+	u8 id_high = 0;
+	u8 id_low = 0;
+	u32 model_id;
+	int ret;
 
-	return 0;
+	if (sensor->chip_status != -EAGAIN)
+		return sensor->chip_status;
+
+	ret  = imx219_read_reg(sensor, 0x0000, &id_high);
+	ret |= imx219_read_reg(sensor, 0x0001, &id_low);
+	if (ret)
+		return -EIO;
+
+	model_id = (id_high << 8) | id_low;
+	if (model_id == 0x0219) {
+		ret = 0;
+	} else {
+		dev_err(dev, "camera imx219 is not found, id 0x%04x\n", model_id);
+		ret = -ENODEV;
+	}
+	sensor->chip_status = ret;
+	return ret;
 }
 
 static int imx219_get_sensor_id(struct imx219 *sensor, void* pchip_id)
@@ -353,14 +415,29 @@ static int imx219_get_sensor_id(struct imx219 *sensor, void* pchip_id)
 	u32 chip_id;
 	u8 chip_id_high = 0;
 	u8 chip_id_low = 0;
-	ret  = imx219_read_reg(sensor, 0x000d, &chip_id_high);
-	ret |= imx219_read_reg(sensor, 0x000e, &chip_id_low);
 
-	chip_id = ((chip_id_high & 0xff) << 8) | (chip_id_low & 0xff);
+	/* the ID does not change, only the first call goes to the bus */
+	chip_id = READ_ONCE(sensor->chip_id);
+	if (!chip_id) {
+		mutex_lock(&sensor->lock);
+		ret = imx219_check_chip_id(sensor);
+		if (ret) {
+			mutex_unlock(&sensor->lock);
+			return ret;
+		}
+		ret = imx219_read_reg(sensor, 0x000d, &chip_id_high);
+		if (!ret)
+			ret = imx219_read_reg(sensor, 0x000e, &chip_id_low);
+		if (ret) {
+			mutex_unlock(&sensor->lock);
+			return ret;
+		}
+		chip_id = ((chip_id_high & 0xff) << 8) | (chip_id_low & 0xff);
+		WRITE_ONCE(sensor->chip_id, chip_id);
+		mutex_unlock(&sensor->lock);
+	}
 
-	ret = copy_to_user(pchip_id, &chip_id, sizeof(u32));
-	if (ret != 0)
-		ret = -ENOMEM;
+	ret = vvcam_arg_put_u32(chip_id, pchip_id);
 	return ret;
 }
 
@@ -368,19 +445,24 @@ static int imx219_get_reserve_id(struct imx219 *sensor, void* preserve_id)
 {
 	int ret = 0;
 	u32 reserve_id = 0x0219;
-	ret = copy_to_user(preserve_id, &reserve_id, sizeof(u32));
-	if (ret != 0)
-		ret = -ENOMEM;
+	ret = vvcam_arg_put_u32(reserve_id, preserve_id);
 	return ret;
 }
 
 static int imx219_get_sensor_mode(struct imx219 *sensor, void* pmode)
 {
 	int ret = 0;
-	ret = copy_to_user(pmode, &sensor->cur_mode,
-		sizeof(struct vvcam_mode_info_s));
-	if (ret != 0)
-		ret = -ENOMEM;
+	struct vvcam_mode_info_s mode;
+	unsigned int seq;
+
+	/* the pattern as read out */
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		mode = sensor->cur_mode;
+		mode.bayer_pattern ^= sensor->flip;
+	} while (read_seqretry(&sensor->state_seq, seq));
+
+	ret = vvcam_arg_out(pmode, &mode);
 	return ret;
 }
 
@@ -389,14 +471,16 @@ static int imx219_set_sensor_mode(struct imx219 *sensor, void* pmode)
 	int ret = 0;
 	int i = 0;
 	struct vvcam_mode_info_s sensor_mode;
-	ret = copy_from_user(&sensor_mode, pmode,
-		sizeof(struct vvcam_mode_info_s));
+	ret = vvcam_arg_in(&sensor_mode, pmode);
 	if (ret != 0)
-		return -ENOMEM;
+		return ret;
 	for (i = 0; i < ARRAY_SIZE(pimx219_mode_info); i++) {
 		if (pimx219_mode_info[i].index == sensor_mode.index) {
+			write_seqlock(&sensor->state_seq);
 			memcpy(&sensor->cur_mode, &pimx219_mode_info[i],
 				sizeof(struct vvcam_mode_info_s));
+			vvcam_window_reset(&sensor->window);
+			write_sequnlock(&sensor->state_seq);
 			return 0;
 		}
 	}
@@ -404,6 +488,123 @@ static int imx219_set_sensor_mode(struct imx219 *sensor, void* pmode)
 	return -ENXIO;
 }
 
+static const struct vvcam_mode_info_s *imx219_find_mode(u32 index)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pimx219_mode_info); i++) {
+		if (pimx219_mode_info[i].index == index)
+			return &pimx219_mode_info[i];
+	}
+	return NULL;
+}
+
+/* 16 bit value the mode table leaves in a high/low register pair */
+static u16 imx219_mode_reg16(const struct vvcam_mode_info_s *mode, u16 addr)
+{
+	const struct vvcam_sccb_data_s *reg = mode->preg_data;
+	u16 val = 0;
+	int i;
+
+	for (i = 0; i < mode->reg_data_count; i++) {
+		if (reg[i].addr == addr)
+			val = (val & 0x00ff) | ((reg[i].data & 0xff) << 8);
+		else if (reg[i].addr == addr + 1)
+			val = (val & 0xff00) | (reg[i].data & 0xff);
+	}
+	return val;
+}
+
+/*
+ * Program the readout window on top of the mode table. The window is
+ * relative to the analog crop of the mode and the vertical blanking of
+ * the mode is kept, so the frame length shrinks with the window height.
+ * The crop and output size registers are contiguous and go out as one
+ * burst.
+ */
+static int imx219_write_window(struct imx219 *sensor)
+{
+	const struct vvcam_mode_info_s *base;
+	struct vvcam_window_s *win = &sensor->window.rect;
+	struct vvcam_sccb_data_s regs[14];
+	u16 val[6];
+	u32 fll = sensor->cur_mode.ae_info.def_frm_len_lines;
+	int i, ret;
+
+	base = imx219_find_mode(sensor->cur_mode.index);
+	if (!base)
+		return -EINVAL;
+
+	val[0] = imx219_mode_reg16(base, IMX219_X_ADD_STA_A) + win->left;
+	val[1] = val[0] + win->width - 1;
+	val[2] = imx219_mode_reg16(base, IMX219_Y_ADD_STA_A) + win->top;
+	val[3] = val[2] + win->height - 1;
+	val[4] = win->width;
+	val[5] = win->height;
+
+	for (i = 0; i < ARRAY_SIZE(val); i++) {
+		regs[2 * i].addr = IMX219_X_ADD_STA_A + 2 * i;
+		regs[2 * i].data = val[i] >> 8;
+		regs[2 * i + 1].addr = IMX219_X_ADD_STA_A + 2 * i + 1;
+		regs[2 * i + 1].data = val[i] & 0xff;
+	}
+	regs[12].addr = IMX219_FRM_LENGTH_A;
+	regs[12].data = fll >> 8;
+	regs[13].addr = IMX219_FRM_LENGTH_A + 1;
+	regs[13].data = fll & 0xff;
+
+	ret = imx219_write_reg_arry(sensor, regs, ARRAY_SIZE(regs));
+	return ret < 0 ? ret : 0;
+}
+
+static int imx219_set_window(struct imx219 *sensor, void *arg)
+{
+	const struct vvcam_mode_info_s *base;
+	struct vvcam_window_s win;
+	int ret;
+
+	ret = vvcam_arg_in(&win, arg);
+	if (ret != 0)
+		return ret;
+
+	base = imx219_find_mode(sensor->cur_mode.index);
+	if (!base)
+		return -EINVAL;
+
+	ret = vvcam_window_set(&sensor->window, &sensor->cur_mode, base, &win,
+			       IMX219_WINDOW_MIN_WIDTH, IMX219_WINDOW_MIN_HEIGHT,
+			       sensor->stream_status,
+			       &sensor->state_seq, &sensor->format);
+	if (ret != 0)
+		return ret;
+
+	return imx219_write_window(sensor);
+}
+
+static int imx219_get_window(struct imx219 *sensor, void *arg)
+{
+	struct vvcam_window_s win;
+
+	vvcam_window_get(&sensor->window, &sensor->cur_mode,
+			 &sensor->state_seq, &win);
+	return vvcam_arg_out(arg, &win);
+}
+
+static int imx219_get_exposure(struct imx219 *sensor, void *arg)
+{
+	struct vvcam_exposure_s exposure;
+	unsigned int seq;
+	int ret;
+
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		exposure = sensor->exposure;
+	} while (read_seqretry(&sensor->state_seq, seq));
+
+	ret = vvcam_arg_out(arg, &exposure);
+	return ret;
+}
+
 static int imx219_set_exp(struct imx219 *sensor, u32 exp)
 {
 	int ret = 0;
@@ -411,6 +612,11 @@ static int imx219_set_exp(struct imx219 *sensor, u32 exp)
 	ret |= imx219_write_reg(sensor, 0x015a, (exp >> 8) & 0xff);
 	ret |= imx219_write_reg(sensor, 0x015b, exp & 0xff);
 
+	if (!ret) {
+		write_seqlock(&sensor->state_seq);
+		sensor->exposure.integration_line = exp;
+		write_sequnlock(&sensor->state_seq);
+	}
 	return ret;
 }
 
@@ -450,6 +656,11 @@ static int imx219_set_gain(struct imx219 *sensor, u32 total_gain)
 	*/
 	imx219_write_reg(sensor, 0x0157, (256 -( 256 / (again / (1 << SENSOR_FIX_FRACBITS)))) & 0xff);
 
+	if (!ret) {
+		write_seqlock(&sensor->state_seq);
+		sensor->exposure.gain = total_gain;
+		write_sequnlock(&sensor->state_seq);
+	}
 	return ret;
 }
 
@@ -461,7 +672,12 @@ static int imx219_set_vsgain(struct imx219 *sensor, u32 total_gain)
 
 static int imx219_get_fps(struct imx219 *sensor, u32 *pfps)
 {
-	*pfps = sensor->cur_mode.ae_info.cur_fps;
+	unsigned int seq;
+
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		*pfps = sensor->cur_mode.ae_info.cur_fps;
+	} while (read_seqretry(&sensor->state_seq, seq));
 	return 0;
 }
 
@@ -470,9 +686,9 @@ static int imx219_set_test_pattern(struct imx219 *sensor, void * arg)
 	int ret;
 	struct sensor_test_pattern_s test_pattern;
 
-	ret = copy_from_user(&test_pattern, arg, sizeof(test_pattern));
+	ret = vvcam_arg_in(&test_pattern, arg);
 	if (ret != 0)
-		return -ENOMEM;
+		return ret;
 	if (test_pattern.enable) {
 		switch (test_pattern.pattern) {
 		case 0:
@@ -500,23 +716,135 @@ static int imx219_set_test_pattern(struct imx219 *sensor, void * arg)
 	return ret;
 }
 
+static int imx219_fcnt_sample(struct imx219 *sensor)
+{
+	u8 val;
+	int ret;
+
+	ret = imx219_read_reg(sensor, IMX219_FRM_CNT, &val);
+	if (!ret)
+		vvcam_fcnt_sample(&sensor->fcnt, val);
+	return ret;
+}
+
+static void imx219_fcnt_work(struct work_struct *work)
+{
+	struct imx219 *sensor = container_of(to_delayed_work(work),
+					     struct imx219, fcnt_work);
+
+	mutex_lock(&sensor->lock);
+	if (sensor->stream_status) {
+		imx219_fcnt_sample(sensor);
+		schedule_delayed_work(&sensor->fcnt_work, sensor->fcnt_period);
+	}
+	mutex_unlock(&sensor->lock);
+}
+
+static void imx219_fcnt_start(struct imx219 *sensor)
+{
+	u8 val = 0;
+
+	imx219_read_reg(sensor, IMX219_FRM_CNT, &val);
+	vvcam_fcnt_start(&sensor->fcnt, val);
+	sensor->fcnt_period = vvcam_fcnt_period(&sensor->fcnt,
+				sensor->cur_mode.ae_info.max_fps);
+	schedule_delayed_work(&sensor->fcnt_work, sensor->fcnt_period);
+}
+
+static void imx219_fcnt_stop(struct imx219 *sensor)
+{
+	/* a work waiting for lock sees stream_status clear and stops */
+	cancel_delayed_work(&sensor->fcnt_work);
+	imx219_fcnt_sample(sensor);
+	vvcam_fcnt_stop(&sensor->fcnt);
+}
+
+static int imx219_get_frame_stats(struct imx219 *sensor, void *arg)
+{
+	struct vvcam_frame_stats_s stats;
+	int ret;
+
+	ret = vvcam_arg_in(&stats, arg);
+	if (ret)
+		return ret;
+	if (sensor->stream_status) {
+		ret = imx219_fcnt_sample(sensor);
+		if (ret)
+			return ret;
+	}
+	vvcam_fcnt_report(&sensor->fcnt, &stats);
+	return vvcam_arg_out(arg, &stats);
+}
+
+/*
+ * Die temperature in millidegrees Celsius, from the SMIA++ temperature
+ * sensor. The sensor measures during frame readout, so there is a reading
+ * only while streaming; -EAGAIN otherwise, which the thermal core polls
+ * through quietly. Called with lock held.
+ */
+static int imx219_read_temp(struct imx219 *sensor, s32 *temp)
+{
+	u8 val;
+
+	if (!sensor->stream_status)
+		return -EAGAIN;
+	if (imx219_read_reg(sensor, IMX219_TEMP_SENS_OUT, &val))
+		return -EIO;
+
+	*temp = (s8)val * 1000;
+	return 0;
+}
+
+static int imx219_temp_read(struct vvcam_temp *vt, s32 *temp)
+{
+	struct imx219 *sensor = container_of(vt, struct imx219, temp);
+	int ret;
+
+	ret = imx219_check_chip_id(sensor);
+	if (!ret)
+		ret = imx219_read_temp(sensor, temp);
+	return ret;
+}
+
 static int imx219_s_stream(struct v4l2_subdev *sd, int enable)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	struct imx219 *sensor = client_to_imx219(client);
 
-	if (enable)
+	if (enable) {
+		/* set at each stream on, the mode tables do not */
+		imx219_write_reg(sensor, IMX219_TEMP_SENS_CTL, 0x01);
 		imx219_write_reg(sensor, 0x0100, 0x01);
-	else
+		if (!sensor->stream_status)
+			imx219_fcnt_start(sensor);
+	} else {
+		if (sensor->stream_status)
+			imx219_fcnt_stop(sensor);
 		imx219_write_reg(sensor, 0x0100, 0x00);
+	}
 
 	sensor->stream_status = enable;
 	return 0;
 }
 
+static int imx219_video_s_stream(struct v4l2_subdev *sd, int enable)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct imx219 *sensor = client_to_imx219(client);
+	int ret = 0;
+
+	mutex_lock(&sensor->lock);
+	if (enable)
+		ret = imx219_check_chip_id(sensor);
+	if (!ret)
+		ret = imx219_s_stream(sd, enable);
+	mutex_unlock(&sensor->lock);
+	return ret;
+}
+
 static int imx219_get_format_code(struct imx219 *sensor, u32 *code)
 {
-	switch (sensor->cur_mode.bayer_pattern) {
+	switch (sensor->cur_mode.bayer_pattern ^ sensor->flip) {
 	case BAYER_RGGB:
 		if (sensor->cur_mode.bit_width == 8) {
 			*code = MEDIA_BUS_FMT_SRGGB8_1X8;
@@ -559,6 +887,42 @@ static int imx219_get_format_code(struct imx219 *sensor, u32 *code)
 	}
 	return 0;
 }
+
+/* the VVCAM_FLIP_* bits are those of IMAGE_ORIENTATION */
+static int imx219_write_flip(struct imx219 *sensor, u32 flip)
+{
+	int ret;
+
+	ret = imx219_write_reg(sensor, IMX219_IMG_ORIENTATION_A, flip);
+	return ret ? -EIO : 0;
+}
+
+/* V4L2_CID_HFLIP and V4L2_CID_VFLIP, with lock held */
+static int imx219_set_flip(struct vvcam_flip *vf, u32 flip)
+{
+	struct imx219 *sensor = container_of(vf, struct imx219, orient);
+	int ret;
+
+	if (flip == sensor->flip)
+		return 0;
+	/* the bayer order changes with it */
+	if (sensor->stream_status)
+		return -EBUSY;
+
+	ret = imx219_check_chip_id(sensor);
+	if (ret)
+		return ret;
+	ret = imx219_write_flip(sensor, flip);
+	if (ret)
+		return ret;
+
+	write_seqlock(&sensor->state_seq);
+	sensor->flip = flip;
+	write_sequnlock(&sensor->state_seq);
+	imx219_get_format_code(sensor, &sensor->format.code);
+	return 0;
+}
+
 #if LINUX_VERSION_CODE > KERNEL_VERSION(5, 12, 0)
 static int imx219_enum_mbus_code(struct v4l2_subdev *sd,
 				struct v4l2_subdev_state *state,
@@ -611,6 +975,10 @@ static int imx219_set_fmt(struct v4l2_subdev *sd,
 	ret = imx219_write_reg_arry(sensor,
 		(struct vvcam_sccb_data_s *)sensor->cur_mode.preg_data,
 		sensor->cur_mode.reg_data_count);
+	if (ret >= 0 && sensor->window.active)
+		ret = imx219_write_window(sensor);
+	if (ret >= 0 && sensor->flip)
+		ret = imx219_write_flip(sensor, sensor->flip);
 	if (ret < 0) {
 		pr_err("%s:imx219_write_reg_arry error\n",__func__);
 		mutex_unlock(&sensor->lock);
@@ -642,17 +1010,67 @@ static int imx219_get_fmt(struct v4l2_subdev *sd,
 	return 0;
 }
 
+/*
+ * Commands that only read driver state. They do not take lock, so a
+ * poll of the mode or exposure is not held up by a register upload.
+ * Returns -ENOIOCTLCMD for the commands that need lock.
+ */
+static long imx219_priv_get(struct imx219 *sensor, unsigned int cmd,
+			    void *arg)
+{
+	u32 fps;
+
+	switch (cmd) {
+	case VVSENSORIOC_G_CLK:
+		return imx219_get_clk(sensor, arg);
+	case VIDIOC_QUERYCAP:
+		return imx219_query_capability(sensor, arg);
+	case VVSENSORIOC_QUERY:
+		return imx219_query_supports(sensor, arg);
+	case VVSENSORIOC_G_CHIP_ID:
+		return imx219_get_sensor_id(sensor, arg);
+	case VVSENSORIOC_G_RESERVE_ID:
+		return imx219_get_reserve_id(sensor, arg);
+	case VVSENSORIOC_G_SENSOR_MODE:
+		return imx219_get_sensor_mode(sensor, arg);
+	case VVSENSORIOC_G_FPS:
+		imx219_get_fps(sensor, &fps);
+		return vvcam_arg_put_u32(fps, arg);
+	case VVSENSORIOC_G_WINDOW:
+		return imx219_get_window(sensor, arg);
+	case VVSENSORIOC_G_EXPOSURE:
+		return imx219_get_exposure(sensor, arg);
+	case VVSENSORIOC_G_FLIP:
+		return vvcam_arg_put_u32(READ_ONCE(sensor->flip), arg);
+	default:
+		return -ENOIOCTLCMD;
+	}
+}
+
 static long imx219_priv_ioctl(struct v4l2_subdev *sd,
                               unsigned int cmd,
-                              void *arg_user)
+                              void *arg)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	struct imx219 *sensor = client_to_imx219(client);
 	long ret = 0;
 	struct vvcam_sccb_data_s sensor_reg;
-	void *arg = arg_user;
+	u32 value;
+	s32 temp;
+	u8 val;
+
+	ret = imx219_priv_get(sensor, cmd, arg);
+	if (ret != -ENOIOCTLCMD)
+		return ret;
+	ret = 0;
 
 	mutex_lock(&sensor->lock);
+	ret = imx219_check_chip_id(sensor);
+	if (ret) {
+		mutex_unlock(&sensor->lock);
+		return ret;
+	}
+
 	switch (cmd){
 	case VVSENSORIOC_S_POWER:
 		ret = 0;
@@ -660,81 +1078,80 @@ static long imx219_priv_ioctl(struct v4l2_subdev *sd,
 	case VVSENSORIOC_S_CLK:
 		ret = 0;
 		break;
-	case VVSENSORIOC_G_CLK:
-		ret = imx219_get_clk(sensor,arg);
-		break;
 	case VVSENSORIOC_RESET:
 		ret = 0;
 		break;
-	case VIDIOC_QUERYCAP:
-		ret = imx219_query_capability(sensor, arg);
-		break;
-	case VVSENSORIOC_QUERY:
-		USER_TO_KERNEL(struct vvcam_mode_info_array_s);
-		ret = imx219_query_supports(sensor, arg);
-		KERNEL_TO_USER(struct vvcam_mode_info_array_s);
-		break;
-	case VVSENSORIOC_G_CHIP_ID:
-		ret = imx219_get_sensor_id(sensor, arg);
-		break;
-	case VVSENSORIOC_G_RESERVE_ID:
-		ret = imx219_get_reserve_id(sensor, arg);
-		break;
-	case VVSENSORIOC_G_SENSOR_MODE:
-		ret = imx219_get_sensor_mode(sensor, arg);
-		break;
 	case VVSENSORIOC_S_SENSOR_MODE:
 		ret = imx219_set_sensor_mode(sensor, arg);
 		break;
 	case VVSENSORIOC_S_STREAM:
-		USER_TO_KERNEL(int);
-		ret = imx219_s_stream(&sensor->subdev, *(int *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = imx219_s_stream(&sensor->subdev, value);
 		break;
 	case VVSENSORIOC_WRITE_REG:
-		ret = copy_from_user(&sensor_reg, arg,
-			sizeof(struct vvcam_sccb_data_s));
-		ret |= imx219_write_reg(sensor, sensor_reg.addr,
-			sensor_reg.data);
+		ret = vvcam_arg_in(&sensor_reg, arg);
+		if (!ret)
+			ret = imx219_write_reg(sensor, sensor_reg.addr,
+				sensor_reg.data);
 		break;
 	case VVSENSORIOC_READ_REG:
-		ret = copy_from_user(&sensor_reg, arg,
-			sizeof(struct vvcam_sccb_data_s));
-		ret |= imx219_read_reg(sensor, sensor_reg.addr,
-			(u8 *)&sensor_reg.data);
-		ret |= copy_to_user(arg, &sensor_reg,
-			sizeof(struct vvcam_sccb_data_s));
+		ret = vvcam_arg_in(&sensor_reg, arg);
+		if (!ret)
+			ret = imx219_read_reg(sensor, sensor_reg.addr, &val);
+		if (!ret) {
+			sensor_reg.data = val;
+			ret = vvcam_arg_out(arg, &sensor_reg);
+		}
 		break;
 	case VVSENSORIOC_S_EXP:
-		USER_TO_KERNEL(u32);
-		ret = imx219_set_exp(sensor, *(u32 *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = imx219_set_exp(sensor, value);
 		break;
 	case VVSENSORIOC_S_VSEXP:
-		USER_TO_KERNEL(u32);
-		ret = imx219_set_vsexp(sensor, *(u32 *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = imx219_set_vsexp(sensor, value);
 		break;
 	case VVSENSORIOC_S_GAIN:
-		USER_TO_KERNEL(u32);
-		ret = imx219_set_gain(sensor, *(u32 *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = imx219_set_gain(sensor, value);
 		break;
 	case VVSENSORIOC_S_VSGAIN:
-		USER_TO_KERNEL(u32);
-		ret = imx219_set_vsgain(sensor, *(u32 *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = imx219_set_vsgain(sensor, value);
 		break;
 	case VVSENSORIOC_S_FPS:
-		USER_TO_KERNEL(u32);
 		// ret = imx219_set_fps(sensor, *(u32 *)arg); //imx219 not support
 		break;
-	case VVSENSORIOC_G_FPS:
-		USER_TO_KERNEL(u32);
-		ret = imx219_get_fps(sensor, (u32 *)arg);
-		KERNEL_TO_USER(u32);
-		break;
 	case VVSENSORIOC_S_HDR_RADIO:
 		// ret = imx219_set_ratio(sensor, arg); //imx219 not support
 		break;
 	case VVSENSORIOC_S_TEST_PATTERN:
 		ret= imx219_set_test_pattern(sensor, arg);
 		break;
+	case VVSENSORIOC_S_WINDOW:
+		ret = imx219_set_window(sensor, arg);
+		break;
+	case VVSENSORIOC_BATCH_REG:
+		ret = imx219_batch_reg(sensor, arg);
+		break;
+	case VVSENSORIOC_S_FLIP:
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = vvcam_flip_set(&sensor->orient, value);
+		break;
+	case VVSENSORIOC_FRAME_STATS:
+		ret = imx219_get_frame_stats(sensor, arg);
+		break;
+	case VVSENSORIOC_G_TEMPERATURE:
+		ret = imx219_read_temp(sensor, &temp);
+		if (!ret)
+			ret = vvcam_arg_out(arg, &temp);
+		break;
 	default:
 		break;
 	}
@@ -744,7 +1161,7 @@ static long imx219_priv_ioctl(struct v4l2_subdev *sd,
 }
 
 static struct v4l2_subdev_video_ops imx219_subdev_video_ops = {
-	.s_stream = imx219_s_stream,
+	.s_stream = imx219_video_s_stream,
 };
 
 static const struct v4l2_subdev_pad_ops imx219_subdev_pad_ops = {
@@ -764,6 +1181,38 @@ static struct v4l2_subdev_ops imx219_subdev_ops = {
 	.pad   = &imx219_subdev_pad_ops,
 };
 
+static int imx219_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct imx219 *sensor = client_to_imx219(client);
+	int ret;
+
+	mutex_lock(&sensor->lock);
+	ret = imx219_check_chip_id(sensor);
+	mutex_unlock(&sensor->lock);
+	return ret;
+}
+
+static const struct v4l2_subdev_internal_ops imx219_internal_ops = {
+	.open = imx219_open,
+};
+
+static int imx219_frames_show(struct seq_file *m, void *v)
+{
+	struct imx219 *sensor = m->private;
+	struct vvcam_fcnt fcnt;
+
+	mutex_lock(&sensor->lock);
+	if (sensor->stream_status)
+		imx219_fcnt_sample(sensor);
+	fcnt = sensor->fcnt;
+	mutex_unlock(&sensor->lock);
+
+	vvcam_fcnt_show(m, &fcnt);
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(imx219_frames);
+
 static int imx219_link_setup(struct media_entity *entity,
 			     const struct media_pad *local,
 			     const struct media_pad *remote, u32 flags)
@@ -801,8 +1250,8 @@ static int imx219_probe(struct i2c_client *client,
 	struct device *dev = &client->dev;
 	struct v4l2_subdev *sd;
 	struct imx219 *sensor;
-	u32 chip_id = 0;
-	u8 reg_val = 0;
+	char name[32];
+	ktime_t start = ktime_get();
 
 	pr_info("enter %s\n", __func__);
 
@@ -811,6 +1260,10 @@ static int imx219_probe(struct i2c_client *client,
 		return -ENOMEM;
 	memset(sensor, 0, sizeof(*sensor));
 
+	sensor->scratch = devm_vvcam_arg_scratch_alloc(dev);
+	if (!sensor->scratch)
+		return -ENOMEM;
+
 	sensor->i2c_client = client;
 
 	sensor->pwn_gpio = of_get_named_gpio(dev->of_node, "pwn-gpios", 0);
@@ -867,18 +1320,20 @@ static int imx219_probe(struct i2c_client *client,
 
 	imx219_reset(sensor);
 
-	imx219_read_reg(sensor, 0x0000, &reg_val);
-	chip_id |= reg_val << 8;
-	imx219_read_reg(sensor, 0x0001, &reg_val);
-	chip_id |= reg_val;
-	if (chip_id != 0x0219) {
-		pr_warn("camera imx219 is not found\n");
-		retval = -ENODEV;
-		goto probe_err_power_off;
-	}
+	memcpy(&sensor->cur_mode, &pimx219_mode_info[0],
+			sizeof(struct vvcam_mode_info_s));
+	sensor->ocp.max_pixel_frequency = IMX219_CSI_MAX_PIXEL_CLK;
+	sensor->chip_status = -EAGAIN;
+
+	/* the subdev can be opened as soon as it is registered */
+	mutex_init(&sensor->lock);
+	seqlock_init(&sensor->state_seq);
+	vvcam_fcnt_init(&sensor->fcnt, 0xff, false);
+	INIT_DELAYED_WORK(&sensor->fcnt_work, imx219_fcnt_work);
 
 	sd = &sensor->subdev;
 	v4l2_i2c_subdev_init(sd, client, &imx219_subdev_ops);
+	sd->internal_ops = &imx219_internal_ops;
 	sd->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE;
 	sd->dev = &client->dev;
 	sd->entity.ops = &imx219_sd_media_ops;
@@ -889,6 +1344,14 @@ static int imx219_probe(struct i2c_client *client,
 				sensor->pads);
 	if (retval < 0)
 		goto probe_err_power_off;
+	v4l2_ctrl_handler_init(&sensor->ctrls, 3);
+	sensor->ctrls.lock = &sensor->lock;
+	vvcam_flip_init(&sensor->orient, &sensor->ctrls, imx219_set_flip);
+	retval = vvcam_temp_init(&sensor->temp, &sensor->ctrls, dev,
+				 &sensor->lock, "imx219", imx219_temp_read);
+	if (retval < 0)
+		goto probe_err_free_ctrls;
+	sd->ctrl_handler = &sensor->ctrls;
 #if LINUX_VERSION_CODE > KERNEL_VERSION(5, 12, 0)
 	retval = v4l2_async_register_subdev_sensor(sd);
 #else
@@ -897,22 +1360,27 @@ static int imx219_probe(struct i2c_client *client,
 	if (retval < 0) {
 		dev_err(&client->dev,"%s--Async register failed, ret=%d\n",
 			__func__,retval);
-		goto probe_err_free_entiny;
+		goto probe_err_free_ctrls;
 	}
 
-	memcpy(&sensor->cur_mode, &pimx219_mode_info[0],
-			sizeof(struct vvcam_mode_info_s));
+	snprintf(name, sizeof(name), "imx219-%s", dev_name(dev));
+	sensor->debugfs = debugfs_create_dir(name, NULL);
+	debugfs_create_file("frames", 0444, sensor->debugfs, sensor,
+			    &imx219_frames_fops);
 
-	mutex_init(&sensor->lock);
-	pr_info("%s camera mipi imx219, is found\n", __func__);
+	pr_info("%s camera mipi imx219 registered in %lld us\n", __func__,
+		ktime_us_delta(ktime_get(), start));
 
 	return 0;
 
-probe_err_free_entiny:
+probe_err_free_ctrls:
+	vvcam_temp_cleanup(&sensor->temp);
+	v4l2_ctrl_handler_free(&sensor->ctrls);
 	media_entity_cleanup(&sd->entity);
 
 probe_err_power_off:
 	imx219_power_off(sensor);
+	mutex_destroy(&sensor->lock);
 
 	return retval;
 }
@@ -928,7 +1396,11 @@ static void imx219_remove(struct i2c_client *client)
 
 	pr_info("enter %s\n", __func__);
 
+	debugfs_remove_recursive(sensor->debugfs);
 	v4l2_async_unregister_subdev(sd);
+	cancel_delayed_work_sync(&sensor->fcnt_work);
+	vvcam_temp_cleanup(&sensor->temp);
+	v4l2_ctrl_handler_free(&sensor->ctrls);
 	media_entity_cleanup(&sd->entity);
 	imx219_power_off(sensor);
 	mutex_destroy(&sensor->lock);
@@ -944,10 +1416,12 @@ static int __maybe_unused imx219_suspend(struct device *dev)
 	struct i2c_client *client = to_i2c_client(dev);
 	struct imx219 *sensor = client_to_imx219(client);
 
+	mutex_lock(&sensor->lock);
 	sensor->resume_status = sensor->stream_status;
 	if (sensor->resume_status) {
 		imx219_s_stream(&sensor->subdev,0);
 	}
+	mutex_unlock(&sensor->lock);
 
 	return 0;
 }
@@ -957,9 +1431,11 @@ static int __maybe_unused imx219_resume(struct device *dev)
 	struct i2c_client *client = to_i2c_client(dev);
 	struct imx219 *sensor = client_to_imx219(client);
 
+	mutex_lock(&sensor->lock);
 	if (sensor->resume_status) {
 		imx219_s_stream(&sensor->subdev,1);
 	}
+	mutex_unlock(&sensor->lock);
 
 	return 0;
 }
@@ -986,6 +1462,7 @@ static struct i2c_driver imx219_i2c_driver = {
 		.name  = "imx219",
 		.pm = &imx219_pm_ops,
 		.of_match_table	= imx219_of_match,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.probe	= imx219_probe,
 	.remove = imx219_remove,
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: (GPL-2.0-only OR MIT)
+ */
+
+/*
+ * Generated by tools/sensor-modes/gen_sensor_modes.py from
+ * modes/imx219.json. Do not edit.
+ */
+
+#ifndef _VVCAM_IMX219_MODES_H_
+#define _VVCAM_IMX219_MODES_H_
+
+#include "vvsensor.h"
+
+#define IMX219_CSI_MAX_PIXEL_CLK	266000000
+
+/* single imx219 camera on MIPI-CSI1, 1920x1080, 30 fps */
+static struct vvcam_sccb_data_s imx219_init_setting_1080p[] = {
+	{0x0100, 0x00}, // mode_select: standby
+	{0x30eb, 0x05},
+	{0x30eb, 0x0c},
+	{0x300a, 0xff},
+	{0x300b, 0xff},
+	{0x30eb, 0x05},
+	{0x30eb, 0x09},
+	{0x0114, 0x01}, // CSI_LANE_MODE
+	{0x0128, 0x00}, // DPHY_CTRL
+	{0x012a, 0x18}, // EXCK_FREQ[15:8]
+	{0x012b, 0x00}, // EXCK_FREQ[7:0]
+	{0x018c, 0x0a}, // CSI_DATA_FORMAT_A[15:8]
+	{0x018d, 0x0a}, // CSI_DATA_FORMAT_A[7:0]
+	{0x0160, 0x06}, // FRM_LENGTH_A[15:8]
+	{0x0161, 0xe4}, // FRM_LENGTH_A[7:0]
+	{0x0162, 0x0d}, // LINE_LENGTH_A[15:8]
+	{0x0163, 0x78}, // LINE_LENGTH_A[7:0]
+	{0x0164, 0x02}, // X_ADD_STA_A[11:8]
+	{0x0165, 0xa8}, // X_ADD_STA_A[7:0]
+	{0x0166, 0x0a}, // X_ADD_END_A[11:8]
+	{0x0167, 0x27}, // X_ADD_END_A[7:0]
+	{0x0168, 0x02}, // Y_ADD_STA_A[11:8]
+	{0x0169, 0xb4}, // Y_ADD_STA_A[7:0]
+	{0x016a, 0x06}, // Y_ADD_END_A[11:8]
+	{0x016b, 0xeb}, // Y_ADD_END_A[7:0]
+	{0x016c, 0x07}, // x_output_size[11:8]
+	{0x016d, 0x80}, // x_output_size[7:0]
+	{0x016e, 0x04}, // y_output_size[11:8]
+	{0x016f, 0x38}, // y_output_size[7:0]
+	{0x0170, 0x01}, // X_ODD_INC_A
+	{0x0171, 0x01}, // Y_ODD_INC_A
+	{0x0174, 0x00}, // BINNING_MODE_H_A
+	{0x0175, 0x00}, // BINNING_MODE_V_A
+	{0x0301, 0x05}, // VTPXCK_DIV
+	{0x0303, 0x01}, // VTSYCK_DIV
+	{0x0309, 0x0a}, // OPPXCK_DIV
+	{0x0304, 0x03}, // PREPLLCK_VT_DIV
+	{0x0305, 0x03}, // PREPLLCK_OP_DIV
+	{0x0306, 0x00}, // PLL_VT_MPY[10:8]
+	{0x0307, 0x39}, // PLL_VT_MPY[7:0]
+	{0x030b, 0x01}, // OPSYCK_DIV
+	{0x030c, 0x00}, // PLL_OP_MPY[10:8]
+	{0x030d, 0x72}, // PLL_OP_MPY[7:0]
+	{0x0624, 0x07}, // TP_WINDOW_WIDTH[11:8]
+	{0x0625, 0x80}, // TP_WINDOW_WIDTH[7:0]
+	{0x0626, 0x04}, // TP_WINDOW_HEIGHT[11:8]
+	{0x0627, 0x38}, // TP_WINDOW_HEIGHT[7:0]
+	{0x455e, 0x00},
+	{0x471e, 0x4b},
+	{0x4767, 0x0f},
+	{0x4750, 0x14},
+	{0x4540, 0x00},
+	{0x47b4, 0x14},
+	{0x4713, 0x30},
+	{0x478b, 0x10},
+	{0x478f, 0x10},
+	{0x4793, 0x10},
+	{0x4797, 0x0e},
+	{0x479b, 0x0e},
+	{0x0160, 0x06}, // FRM_LENGTH_A[15:8]
+	{0x0161, 0xe4}, // FRM_LENGTH_A[7:0]
+	{0x0162, 0x0d}, // LINE_LENGTH_A[15:8]
+	{0x0163, 0x78}, // LINE_LENGTH_A[7:0]
+	{0xffff, 0x00}, // end of table
+};
+
+/* single imx219 camera on MIPI-CSI1, 1920x1080, 30 fps, RAW8 */
+static struct vvcam_sccb_data_s imx219_init_setting_1080p_raw8[] = {
+	{0x0100, 0x00}, // mode_select: standby
+	{0x30eb, 0x05},
+	{0x30eb, 0x0c},
+	{0x300a, 0xff},
+	{0x300b, 0xff},
+	{0x30eb, 0x05},
+	{0x30eb, 0x09},
+	{0x0114, 0x01}, // CSI_LANE_MODE
+	{0x0128, 0x00}, // DPHY_CTRL
+	{0x012a, 0x18}, // EXCK_FREQ[15:8]
+	{0x012b, 0x00}, // EXCK_FREQ[7:0]
+	{0x018c, 0x08}, // CSI_DATA_FORMAT_A[15:8]
+	{0x018d, 0x08}, // CSI_DATA_FORMAT_A[7:0]
+	{0x0160, 0x06}, // FRM_LENGTH_A[15:8]
+	{0x0161, 0xe4}, // FRM_LENGTH_A[7:0]
+	{0x0162, 0x0d}, // LINE_LENGTH_A[15:8]
+	{0x0163, 0x78}, // LINE_LENGTH_A[7:0]
+	{0x0164, 0x02}, // X_ADD_STA_A[11:8]
+	{0x0165, 0xa8}, // X_ADD_STA_A[7:0]
+	{0x0166, 0x0a}, // X_ADD_END_A[11:8]
+	{0x0167, 0x27}, // X_ADD_END_A[7:0]
+	{0x0168, 0x02}, // Y_ADD_STA_A[11:8]
+	{0x0169, 0xb4}, // Y_ADD_STA_A[7:0]
+	{0x016a, 0x06}, // Y_ADD_END_A[11:8]
+	{0x016b, 0xeb}, // Y_ADD_END_A[7:0]
+	{0x016c, 0x07}, // x_output_size[11:8]
+	{0x016d, 0x80}, // x_output_size[7:0]
+	{0x016e, 0x04}, // y_output_size[11:8]
+	{0x016f, 0x38}, // y_output_size[7:0]
+	{0x0170, 0x01}, // X_ODD_INC_A
+	{0x0171, 0x01}, // Y_ODD_INC_A
+	{0x0174, 0x00}, // BINNING_MODE_H_A
+	{0x0175, 0x00}, // BINNING_MODE_V_A
+	{0x0301, 0x05}, // VTPXCK_DIV
+	{0x0303, 0x01}, // VTSYCK_DIV
+	{0x0309, 0x08}, // OPPXCK_DIV
+	{0x0304, 0x03}, // PREPLLCK_VT_DIV
+	{0x0305, 0x03}, // PREPLLCK_OP_DIV
+	{0x0306, 0x00}, // PLL_VT_MPY[10:8]
+	{0x0307, 0x39}, // PLL_VT_MPY[7:0]
+	{0x030b, 0x01}, // OPSYCK_DIV
+	{0x030c, 0x00}, // PLL_OP_MPY[10:8]
+	{0x030d, 0x72}, // PLL_OP_MPY[7:0]
+	{0x0624, 0x07}, // TP_WINDOW_WIDTH[11:8]
+	{0x0625, 0x80}, // TP_WINDOW_WIDTH[7:0]
+	{0x0626, 0x04}, // TP_WINDOW_HEIGHT[11:8]
+	{0x0627, 0x38}, // TP_WINDOW_HEIGHT[7:0]
+	{0x455e, 0x00},
+	{0x471e, 0x4b},
+	{0x4767, 0x0f},
+	{0x4750, 0x14},
+	{0x4540, 0x00},
+	{0x47b4, 0x14},
+	{0x4713, 0x30},
+	{0x478b, 0x10},
+	{0x478f, 0x10},
+	{0x4793, 0x10},
+	{0x4797, 0x0e},
+	{0x479b, 0x0e},
+	{0x0160, 0x06}, // FRM_LENGTH_A[15:8]
+	{0x0161, 0xe4}, // FRM_LENGTH_A[7:0]
+	{0x0162, 0x0d}, // LINE_LENGTH_A[15:8]
+	{0x0163, 0x78}, // LINE_LENGTH_A[7:0]
+	{0xffff, 0x00}, // end of table
+};
+
+static struct vvcam_mode_info_s pimx219_mode_info[] = {
+	{
+		.index          = 0,
+		.size           = {
+			.bounds_width  = 1920,
+			.bounds_height = 1080,
+			.top           = 0,
+			.left          = 0,
+			.width         = 1920,
+			.height        = 1080,
+		},
+		.hdr_mode       = SENSOR_MODE_LINEAR,
+		.bit_width      = 10,
+		.data_compress  = {
+			.enable = 0,
+		},
+		.bayer_pattern  = BAYER_RGGB,
+		.ae_info = {
+			/*
+			PIX_CLK = 24000000 * 57 / (3 * 1 * 5) = 91.2 MHz
+			line time = 3448 / (2 * PIX_CLK) = 18903 ns
+			frame time = 1764 lines * 18903 ns -> 30 fps
+			*/
+			.def_frm_len_lines     = 0x6e4,
+			.curr_frm_len_lines    = 0x6e4,
+			.one_line_exp_time_ns  = 18903,
+			.max_integration_line  = 0x6a4 - 4,
+			.min_integration_line  = 1,
+			.max_again             = 10.66 * (1 << SENSOR_FIX_FRACBITS),
+			.min_again             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.max_dgain             = 15.85 * (1 << SENSOR_FIX_FRACBITS),
+			.min_dgain             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.start_exposure        = 1200 * (1 << SENSOR_FIX_FRACBITS),
+			.cur_fps               = 30 * (1 << SENSOR_FIX_FRACBITS),
+			.max_fps               = 30 * (1 << SENSOR_FIX_FRACBITS),
+			.min_fps               = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.min_afps              = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.int_update_delay_frm  = 1,
+			.gain_update_delay_frm = 1,
+		},
+		.mipi_info = {
+			.mipi_lane = 2,
+		},
+		.preg_data      = imx219_init_setting_1080p,
+		.reg_data_count = ARRAY_SIZE(imx219_init_setting_1080p),
+	},
+	{
+		.index          = 1,
+		.size           = {
+			.bounds_width  = 1920,
+			.bounds_height = 1080,
+			.top           = 0,
+			.left          = 0,
+			.width         = 1920,
+			.height        = 1080,
+		},
+		.hdr_mode       = SENSOR_MODE_LINEAR,
+		.bit_width      = 8,
+		.data_compress  = {
+			.enable = 0,
+		},
+		.bayer_pattern  = BAYER_RGGB,
+		.ae_info = {
+			/*
+			PIX_CLK = 24000000 * 57 / (3 * 1 * 5) = 91.2 MHz
+			line time = 3448 / (2 * PIX_CLK) = 18903 ns
+			frame time = 1764 lines * 18903 ns -> 30 fps
+			*/
+			.def_frm_len_lines     = 0x6e4,
+			.curr_frm_len_lines    = 0x6e4,
+			.one_line_exp_time_ns  = 18903,
+			.max_integration_line  = 0x6a4 - 4,
+			.min_integration_line  = 1,
+			.max_again             = 10.66 * (1 << SENSOR_FIX_FRACBITS),
+			.min_again             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.max_dgain             = 15.85 * (1 << SENSOR_FIX_FRACBITS),
+			.min_dgain             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.start_exposure        = 1200 * (1 << SENSOR_FIX_FRACBITS),
+			.cur_fps               = 30 * (1 << SENSOR_FIX_FRACBITS),
+			.max_fps               = 30 * (1 << SENSOR_FIX_FRACBITS),
+			.min_fps               = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.min_afps              = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.int_update_delay_frm  = 1,
+			.gain_update_delay_frm = 1,
+		},
+		.mipi_info = {
+			.mipi_lane = 2,
+		},
+		.preg_data      = imx219_init_setting_1080p_raw8,
+		.reg_data_count = ARRAY_SIZE(imx219_init_setting_1080p_raw8),
+	},
+};
+
+#endif
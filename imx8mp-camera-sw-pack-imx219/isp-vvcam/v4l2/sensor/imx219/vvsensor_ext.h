@@ -0,0 +1,161 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: (GPL-2.0-only OR MIT)
+ */
+
+/*
+ * Sensor ioctls added by the camera packs on top of vvsensor.h.
+ *
+ * The same file is shipped next to the kernel driver and in the include
+ * directory of the ISI sensor core; both copies must stay identical.
+ */
+
+#ifndef _VVSENSOR_EXT_H_
+#define _VVSENSOR_EXT_H_
+
+#include <linux/types.h>
+
+/* numbered clear of the VVSENSORIOC_* range of vvsensor.h */
+#define VVSENSORIOC_EXT_BASE	0x1000
+
+enum {
+	VVSENSORIOC_G_EMBEDDED_INFO = VVSENSORIOC_EXT_BASE,
+	VVSENSORIOC_S_WINDOW,
+	VVSENSORIOC_G_WINDOW,
+	VVSENSORIOC_S_CONTEXT_MODE,
+	VVSENSORIOC_S_CONTEXT,
+	VVSENSORIOC_G_EXPOSURE,
+	VVSENSORIOC_BATCH_REG,
+	VVSENSORIOC_S_FLIP,
+	VVSENSORIOC_G_FLIP,
+	VVSENSORIOC_FRAME_STATS,
+	VVSENSORIOC_G_TEMPERATURE,
+};
+
+/* layout of the embedded data lines of the current mode */
+struct vvcam_embedded_info_s {
+	__u32 enable;
+	__u32 data_type;	/* CSI-2 data type of the embedded lines */
+	__u32 top_lines;	/* register value lines before the image */
+	__u32 bottom_lines;	/* statistics lines after the image */
+	__u32 line_bytes;	/* bytes per embedded line */
+	__u32 bit_width;	/* packing of the lines, as the image data */
+};
+
+/*
+ * Readout window in output pixels of the current mode, (0, 0) being the
+ * top left pixel of the full mode. Setting it resizes the mode: the
+ * frame length, max_fps and ae_info reported by VVSENSORIOC_G_SENSOR_MODE
+ * follow the window, and a window equal to the full mode restores it.
+ */
+struct vvcam_window_s {
+	__u32 left;
+	__u32 top;
+	__u32 width;
+	__u32 height;
+};
+
+/*
+ * Register contexts of sensors with two register banks. Context A holds
+ * the mode set by VVSENSORIOC_S_SENSOR_MODE. VVSENSORIOC_S_CONTEXT_MODE
+ * preloads another mode into context B, VVSENSORIOC_S_CONTEXT (a __u32
+ * context) makes a context active from the next frame on. The mode and
+ * ae_info reported by VVSENSORIOC_G_SENSOR_MODE are those of the active
+ * context, and S_EXP, S_GAIN and S_FPS act on it.
+ */
+#define VVCAM_CONTEXT_A		0
+#define VVCAM_CONTEXT_B		1
+
+struct vvcam_context_mode_s {
+	__u32 context;
+	__u32 index;		/* mode index, as for VVSENSORIOC_S_SENSOR_MODE */
+};
+
+/* last values programmed through VVSENSORIOC_S_EXP and VVSENSORIOC_S_GAIN */
+struct vvcam_exposure_s {
+	__u32 integration_line;
+	__u32 gain;		/* SENSOR_FIX_FRACBITS fixed point */
+};
+
+/*
+ * Batched register access. The entries run in order in one ioctl, with the
+ * sensor lock and the I2C bus held throughout; runs of entries of the same
+ * op at consecutive registers go out as one I2C transfer. Each entry gets
+ * its status, 0 or a negative errno: after a failed transfer the entries
+ * left are not run and get -ECANCELED, and the ioctl returns the error.
+ * Register width (8 bit, or 16 bit on AR0144) applies to data as it does to
+ * VVSENSORIOC_WRITE_REG and VVSENSORIOC_READ_REG.
+ */
+#define VVCAM_REG_WRITE		0
+#define VVCAM_REG_READ		1
+
+#define VVCAM_REG_BATCH_MAX	4096	/* entries per ioctl */
+
+struct vvcam_reg_entry_s {
+	__u32 addr;
+	__u32 data;		/* written, or read back */
+	__u32 op;		/* VVCAM_REG_WRITE or VVCAM_REG_READ */
+	__s32 status;
+};
+
+struct vvcam_reg_batch_s {
+	__u32 count;
+	__u32 reserved;
+	__u64 entries;		/* user pointer to count vvcam_reg_entry_s */
+};
+
+/*
+ * Readout orientation, a __u32 of VVCAM_FLIP_* bits relative to the
+ * orientation of the mode tables. The sensor mirrors and flips at
+ * readout. VVCAM_FLIP_H swaps the columns of the bayer cell and
+ * VVCAM_FLIP_V its rows: with the BAYER_* order of vvsensor.h, the pattern
+ * read out is bayer_pattern ^ flip, and VVSENSORIOC_G_SENSOR_MODE and the
+ * media bus code report that pattern. The orientation is kept across mode
+ * changes and can only change while the sensor is not streaming. The
+ * subdev has it as the V4L2_CID_HFLIP and V4L2_CID_VFLIP controls too,
+ * VVSENSORIOC_S_FLIP sets both.
+ */
+#define VVCAM_FLIP_H		(1 << 0)	/* mirror left to right */
+#define VVCAM_FLIP_V		(1 << 1)	/* upside down */
+#define VVCAM_FLIP_MASK		(VVCAM_FLIP_H | VVCAM_FLIP_V)
+
+/*
+ * Frame counter of the sensor. The caller of VVSENSORIOC_FRAME_STATS sets
+ * delivered, the buffers the pipeline delivered since stream on, and
+ * in_flight, the frames it may hold between the sensor and the consumer.
+ * The driver samples the sensor's frame counter and returns the frames
+ * sent since stream on; those neither delivered nor in flight are
+ * dropped. A call at which dropped grew counts as a gap. idle_us is the
+ * time the counter has not moved for, a sensor side stall when streaming.
+ * The counts stay readable after stream off and restart at stream on.
+ * A sensor without a readable counter returns the frames expected from
+ * the stream time and frame period, and sets VVCAM_FRAME_COUNT_ESTIMATED.
+ */
+#define VVCAM_FRAME_COUNT_STREAMING	(1 << 0)
+#define VVCAM_FRAME_COUNT_ESTIMATED	(1 << 1)
+
+struct vvcam_frame_stats_s {
+	__u64 delivered;	/* in */
+	__u32 in_flight;	/* in */
+	__u32 flags;		/* VVCAM_FRAME_COUNT_* */
+	__u64 frames;
+	__u64 dropped;
+	__u32 gaps;
+	__u32 max_gap;		/* most frames dropped between two calls */
+	__u64 stream_us;	/* since stream on, or stream on to off */
+	__u64 idle_us;
+};
+
+/*
+ * VVSENSORIOC_G_TEMPERATURE reads the die temperature of the sensor, a
+ * __s32 in millidegrees Celsius. Sensors without a temperature sensor
+ * fail it with -ENOTTY, sensors that only measure while streaming with
+ * -EAGAIN when stopped. The subdev of a sensor with a temperature sensor
+ * also has it as a read-only, volatile control, V4L2_CID_VVCAM_TEMPERATURE.
+ * The ID is V4L2_CID_USER_BASE | 0x1f00, clear of the driver private
+ * ranges of v4l2-controls.h.
+ */
+#define V4L2_CID_VVCAM_TEMPERATURE	(0x00980900 | 0x1f00)
+
+#endif
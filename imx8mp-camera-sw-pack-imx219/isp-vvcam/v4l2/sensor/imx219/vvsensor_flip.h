@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * Readout orientation as the V4L2_CID_HFLIP and V4L2_CID_VFLIP controls of
+ * the subdev. The two are a cluster: the driver's set callback gets the
+ * VVCAM_FLIP_* mask of both, with the device lock held, as the control
+ * handler shares that lock. It writes the sensor and updates the bayer
+ * pattern and the media bus code. VVSENSORIOC_S_FLIP sets the controls
+ * with vvcam_flip_set(), so the ioctl and the controls always agree.
+ *
+ * The same file is shipped next to each sensor driver; the copies must
+ * stay identical.
+ */
+
+#ifndef _VVSENSOR_FLIP_H_
+#define _VVSENSOR_FLIP_H_
+
+#include <linux/errno.h>
+#include <media/v4l2-ctrls.h>
+#include "vvsensor_ext.h"
+
+struct vvcam_flip {
+	/* a cluster, hflip first */
+	struct v4l2_ctrl *hflip;
+	struct v4l2_ctrl *vflip;
+	/* VVCAM_FLIP_* to the sensor, called with lock held */
+	int (*set)(struct vvcam_flip *vf, u32 flip);
+};
+
+static int vvcam_flip_s_ctrl(struct v4l2_ctrl *ctrl)
+{
+	struct vvcam_flip *vf = ctrl->priv;
+	u32 flip = 0;
+
+	if (vf->hflip->val)
+		flip |= VVCAM_FLIP_H;
+	if (vf->vflip->val)
+		flip |= VVCAM_FLIP_V;
+	return vf->set(vf, flip);
+}
+
+static const struct v4l2_ctrl_ops vvcam_flip_ctrl_ops = {
+	.s_ctrl = vvcam_flip_s_ctrl,
+};
+
+/* add the controls to hdl, errors are left in hdl->error */
+static inline void vvcam_flip_init(struct vvcam_flip *vf,
+				   struct v4l2_ctrl_handler *hdl,
+				   int (*set)(struct vvcam_flip *, u32))
+{
+	vf->set = set;
+	vf->hflip = v4l2_ctrl_new_std(hdl, &vvcam_flip_ctrl_ops,
+				      V4L2_CID_HFLIP, 0, 1, 1, 0);
+	vf->vflip = v4l2_ctrl_new_std(hdl, &vvcam_flip_ctrl_ops,
+				      V4L2_CID_VFLIP, 0, 1, 1, 0);
+	if (hdl->error)
+		return;
+
+	/* the bayer order changes with them */
+	vf->hflip->flags |= V4L2_CTRL_FLAG_MODIFY_LAYOUT;
+	vf->vflip->flags |= V4L2_CTRL_FLAG_MODIFY_LAYOUT;
+	vf->hflip->priv = vf;
+	vf->vflip->priv = vf;
+	v4l2_ctrl_cluster(2, &vf->hflip);
+}
+
+/* VVSENSORIOC_S_FLIP, with lock held */
+static inline int vvcam_flip_set(struct vvcam_flip *vf, u32 flip)
+{
+	int ret;
+
+	if (flip & ~VVCAM_FLIP_MASK)
+		return -EINVAL;
+
+	ret = __v4l2_ctrl_s_ctrl(vf->hflip, !!(flip & VVCAM_FLIP_H));
+	if (!ret)
+		ret = __v4l2_ctrl_s_ctrl(vf->vflip, !!(flip & VVCAM_FLIP_V));
+	return ret;
+}
+
+#endif
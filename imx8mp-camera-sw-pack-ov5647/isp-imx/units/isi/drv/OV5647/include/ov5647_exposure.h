@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __OV5647_EXPOSURE_H__
+#define __OV5647_EXPOSURE_H__
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "vvsensor_isi.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Bound the integration time to maxIntTime, in IsiSensorIntTime_t units,
+ * for scenes where motion blur matters more than noise; 0 lifts the bound.
+ * While bound, the AE info max integration time and gains shrink to what
+ * the sensor applies, and each linear IsiSetIntegrationTimeIss() or
+ * IsiSetGainIss() writes the split chosen by OV5647_IsiPlanExposureIss()
+ * of the product of the last integration time and gain set.
+ */
+RESULT OV5647_IsiSetExposureBudgetIss(IsiSensorHandle_t handle,
+                                      uint32_t maxIntTime);
+
+/*
+ * Split exposure, integration time times gain, into lines and a gain the
+ * sensor applies exactly, without writing the sensor.
+ */
+RESULT OV5647_IsiPlanExposureIss(IsiSensorHandle_t handle, uint64_t exposure,
+                                 VVSENSOR_ExposurePlan_t *pPlan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -7,16 +7,22 @@
  */
 
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/of_graph.h>
 #include <linux/device.h>
 #include <linux/i2c.h>
 #include <linux/init.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/of_device.h>
 #include <linux/of_gpio.h>
 #include <linux/pinctrl/consumer.h>
 #include <linux/regulator/consumer.h>
+#include <linux/seq_file.h>
+#include <linux/seqlock.h>
 #include <linux/v4l2-mediabus.h>
 #include <media/v4l2-device.h>
 #include <media/v4l2-ctrls.h>
@@ -24,8 +30,13 @@
 #include <linux/uaccess.h>
 #include <linux/version.h>
 #include "vvsensor.h"
+#include "vvsensor_ext.h"
+#include "vvsensor_uarg.h"
+#include "vvsensor_fcnt.h"
+#include "vvsensor_window.h"
+#include "vvsensor_flip.h"
 
-#include "ov5647_regs_1080p.h"
+#include "ov5647_modes.h"
 
 #define OV5647_VOLTAGE_ANALOG			2800000
 #define OV5647_VOLTAGE_DIGITAL_CORE		1500000
@@ -37,34 +48,22 @@
 #define OV5647_SENS_PAD_SOURCE	0
 #define OV5647_SENS_PADS_NUM	1
 
-#define client_to_ov5647(client)\
-	container_of(i2c_get_clientdata(client), struct ov5647, subdev)
+#define OV5647_TIMING_X_ADDR_START	0x3800
+#define OV5647_TIMING_Y_ADDR_START	0x3802
+#define OV5647_TIMING_X_ADDR_END	0x3804
+#define OV5647_TIMING_Y_ADDR_END	0x3806
+#define OV5647_TIMING_HTS		0x380c
+#define OV5647_TIMING_TC_REG20		0x3820	/* vertical flip */
+#define OV5647_TIMING_TC_REG21		0x3821	/* horizontal mirror */
+#define OV5647_FLIP_BITS		0x06	/* sensor and ISP flip */
 
-/*
-Use USER_TO_KERNEL/KERNEL_TO_USER to fix "uaccess" exception on run time.
-Also, use "copy_ret" to fix the build issue as below.
-error: ignoring return value of function declared with 'warn_unused_result' attribute.
-*/
-
-#ifdef CONFIG_HARDENED_USERCOPY
-#define USER_TO_KERNEL(TYPE) \
-	do {\
-		TYPE tmp; \
-		unsigned long copy_ret; \
-		arg = (void *)(&tmp); \
-		copy_ret = copy_from_user(arg, arg_user, sizeof(TYPE));\
-	} while (0)
-
-#define KERNEL_TO_USER(TYPE) \
-	do {\
-		unsigned long copy_ret; \
-		copy_ret = copy_to_user(arg_user, arg, sizeof(TYPE));\
-	} while (0)
-#else
-#define USER_TO_KERNEL(TYPE)
-#define KERNEL_TO_USER(TYPE)
-#endif
+#define OV5647_WINDOW_MIN_WIDTH		64
+#define OV5647_WINDOW_MIN_HEIGHT	16
+
+#define OV5647_BURST_MAX	128	/* registers per batch I2C transfer */
 
+#define client_to_ov5647(client)\
+	container_of(i2c_get_clientdata(client), struct ov5647, subdev)
 
 struct ov5647_capture_properties {
 	__u64 max_lane_frequency;
@@ -91,56 +90,39 @@ struct ov5647 {
 
 	struct v4l2_mbus_framefmt format;
 	vvcam_mode_info_t cur_mode;
+	struct vvcam_window window;
+	struct vvcam_exposure_s exposure;
+	u32 flip;			/* VVCAM_FLIP_* */
 	sensor_blc_t blc;
 	sensor_white_balance_t wb;
 	struct mutex lock;
+	struct vvcam_arg_scratch_s *scratch;
+	/*
+	 * cur_mode, window, exposure and flip are changed with lock held
+	 * and published under state_seq, so the getters read them without
+	 * waiting for register writes in flight
+	 */
+	seqlock_t state_seq;
+	/*
+	 * The chip ID is checked on first open or stream on, not at probe.
+	 * chip_status is -EAGAIN until then, 0 or -ENODEV after; chip_id is
+	 * valid once it reads 0.
+	 */
+	int chip_status;
+	u32 chip_id;
+	/*
+	 * The OV5647 has no frame counter register; frames are counted from
+	 * the stream time at the frame rate of the mode
+	 */
+	struct vvcam_fcnt fcnt;
+	struct dentry *debugfs;
+	/* controls, sharing lock */
+	struct v4l2_ctrl_handler ctrls;
+	struct vvcam_flip orient;
 	u32 stream_status;
 	u32 resume_status;
 };
 
-static struct vvcam_mode_info_s pov5647_mode_info[] = {
-	{
-		.index	        = 0,
-		.size           = {
-			.bounds_width  = 1920,
-			.bounds_height = 1080,
-			.top           = 0,
-			.left          = 0,
-			.width         = 1920,
-			.height        = 1080,
-		},
-		.hdr_mode       = SENSOR_MODE_LINEAR,
-		.bit_width      = 10,
-		.data_compress  = {
-			.enable = 0,
-		},
-		.bayer_pattern  = BAYER_BGGR,
-		.ae_info = {
-			.def_frm_len_lines     = 0x450,
-			.curr_frm_len_lines    = 0x450,
-			.one_line_exp_time_ns  = 30193,
-			.max_integration_line  = 0x450 - 16,
-			.min_integration_line  = 16,
-			.max_again             = 63.5 * (1 << SENSOR_FIX_FRACBITS),
-			.min_again             = 1    * (1 << SENSOR_FIX_FRACBITS),
-			.max_dgain             = 1    * (1 << SENSOR_FIX_FRACBITS), 
-			.min_dgain             = 1    * (1 << SENSOR_FIX_FRACBITS),
-			.start_exposure        = 2 * 100 * (1 << SENSOR_FIX_FRACBITS),
-			.cur_fps               = 30   * (1 << SENSOR_FIX_FRACBITS),
-			.max_fps               = 30   * (1 << SENSOR_FIX_FRACBITS),
-			.min_fps               = 1    * (1 << SENSOR_FIX_FRACBITS),
-			.min_afps              = 5    * (1 << SENSOR_FIX_FRACBITS),
-			.int_update_delay_frm  = 1,
-			.gain_update_delay_frm = 1,
-		},
-		.mipi_info = {
-			.mipi_lane = 2,
-		},
-		.preg_data      = ov5647_init_setting_1080p,
-		.reg_data_count = ARRAY_SIZE(ov5647_init_setting_1080p),
-	},
-};
-
 static int ov5647_power_on(struct ov5647 *sensor)
 {
 	int ret;
@@ -186,9 +168,7 @@ static int ov5647_get_clk(struct ov5647 *sensor, void *clk)
 	int ret = 0;
 	vvcam_clk.sensor_mclk = clk_get_rate(sensor->sensor_clk);
 	vvcam_clk.csi_max_pixel_clk = sensor->ocp.max_pixel_frequency;
-	ret = copy_to_user(clk, &vvcam_clk, sizeof(struct vvcam_clk_s));
-	if (ret != 0)
-		ret = -EINVAL;
+	ret = vvcam_arg_out(clk, &vvcam_clk);
 	return ret;
 }
 
@@ -240,19 +220,19 @@ static int ov5647_write_reg_arry(struct ov5647 *sensor,
 	int i = 0;
 	int ret = 0;
 	struct i2c_msg msg;
-	u8 *send_buf;
+	u8 *send_buf = sensor->scratch->sccb_burst;
 	u32 send_buf_len = 0;
 	struct i2c_client *i2c_client = sensor->i2c_client;
 
-	send_buf = (u8 *)kmalloc(size + 2, GFP_KERNEL);
-	if (!send_buf)
-		return -ENOMEM;
+	if (size == 0)
+		return 0;
 
 	send_buf[send_buf_len++] = (reg_arry[0].addr >> 8) & 0xff;
 	send_buf[send_buf_len++] = reg_arry[0].addr & 0xff;
 	send_buf[send_buf_len++] = reg_arry[0].data & 0xff;
 	for (i=1; i < size; i++) {
-		if (reg_arry[i].addr == (reg_arry[i-1].addr + 1)){
+		if (reg_arry[i].addr == (reg_arry[i-1].addr + 1) &&
+		    send_buf_len < sizeof(sensor->scratch->sccb_burst)) {
 			send_buf[send_buf_len++] = reg_arry[i].data & 0xff;
 		} else {
 			msg.addr  = i2c_client->addr;
@@ -262,7 +242,6 @@ static int ov5647_write_reg_arry(struct ov5647 *sensor,
 			ret = i2c_transfer(i2c_client->adapter, &msg, 1);
 			if (ret < 0) {
 				pr_err("%s:i2c transfer error\n",__func__);
-				kfree(send_buf);
 				return ret;
 			}
 			send_buf_len = 0;
@@ -287,7 +266,85 @@ static int ov5647_write_reg_arry(struct ov5647 *sensor,
 			ret = 0;
 
 	}
-	kfree(send_buf);
+	return ret;
+}
+
+/* one I2C transfer for a run of entries of one op at consecutive registers */
+static int ov5647_reg_burst(struct ov5647 *sensor,
+			    struct vvcam_reg_entry_s *entry, u32 n, u8 *buf)
+{
+	struct i2c_client *client = sensor->i2c_client;
+	struct i2c_msg msg[2];
+	u32 i;
+	int num = 1, ret;
+
+	buf[0] = (entry[0].addr >> 8) & 0xff;
+	buf[1] = entry[0].addr & 0xff;
+	msg[0].addr = client->addr;
+	msg[0].flags = client->flags;
+	msg[0].buf = buf;
+	msg[0].len = 2;
+	if (entry[0].op == VVCAM_REG_WRITE) {
+		for (i = 0; i < n; i++)
+			buf[2 + i] = entry[i].data & 0xff;
+		msg[0].len += n;
+	} else {
+		msg[1].addr = client->addr;
+		msg[1].flags = client->flags | I2C_M_RD;
+		msg[1].buf = buf + 2;
+		msg[1].len = n;
+		num = 2;
+	}
+
+	ret = __i2c_transfer(client->adapter, msg, num);
+	ret = ret < 0 ? ret : (ret == num ? 0 : -EIO);
+	for (i = 0; i < n; i++) {
+		if (ret == 0 && entry[i].op == VVCAM_REG_READ)
+			entry[i].data = buf[2 + i];
+		entry[i].status = ret;
+	}
+	return ret;
+}
+
+static int ov5647_batch_reg(struct ov5647 *sensor, void *arg)
+{
+	struct i2c_adapter *adapter = sensor->i2c_client->adapter;
+	struct vvcam_reg_batch_s batch;
+	struct vvcam_reg_entry_s *entry = sensor->scratch->reg_entry;
+	u8 buf[2 + OV5647_BURST_MAX];
+	u32 i, n;
+	int ret = 0;
+
+	if (vvcam_arg_in(&batch, arg))
+		return -EFAULT;
+	if (batch.count == 0)
+		return 0;
+	if (batch.count > VVCAM_REG_BATCH_MAX)
+		return -EINVAL;
+
+	if (copy_from_user(entry, u64_to_user_ptr(batch.entries),
+			   batch.count * sizeof(*entry)))
+		return -EFAULT;
+	for (i = 0; i < batch.count; i++) {
+		if (entry[i].addr > 0xffff || entry[i].op > VVCAM_REG_READ ||
+		    (entry[i].op == VVCAM_REG_WRITE && entry[i].data > 0xff))
+			return -EINVAL;
+		entry[i].status = -ECANCELED;
+	}
+
+	i2c_lock_bus(adapter, I2C_LOCK_SEGMENT);
+	for (i = 0; i < batch.count && ret == 0; i += n) {
+		for (n = 1; i + n < batch.count && n < OV5647_BURST_MAX &&
+		     entry[i + n].op == entry[i].op &&
+		     entry[i + n].addr == entry[i].addr + n; n++)
+			;
+		ret = ov5647_reg_burst(sensor, &entry[i], n, buf);
+	}
+	i2c_unlock_bus(adapter, I2C_LOCK_SEGMENT);
+
+	if (copy_to_user(u64_to_user_ptr(batch.entries), entry,
+			 batch.count * sizeof(*entry)))
+		ret = -EFAULT;
 	return ret;
 }
 
@@ -309,29 +366,23 @@ static int ov5647_query_capability(struct ov5647 *sensor, void *arg)
 
 static int ov5647_query_supports(struct ov5647 *sensor, void* parry)
 {
-	struct vvcam_mode_info_array_s *psensor_mode_arry = parry;
-
-	psensor_mode_arry->count = ARRAY_SIZE(pov5647_mode_info);
-	memcpy((void *)&psensor_mode_arry->modes, (void *)pov5647_mode_info, sizeof(pov5647_mode_info));
-
+	struct vvcam_mode_info_array_s __user *psensor_mode_arry = parry;
+	u32 count = ARRAY_SIZE(pov5647_mode_info);
+
+	/* only the modes there are, not the whole array */
+	if (vvcam_arg_put_u32(count, &psensor_mode_arry->count) ||
+	    copy_to_user(&psensor_mode_arry->modes, pov5647_mode_info,
+			 sizeof(pov5647_mode_info)))
+		return -EFAULT;
 	return 0;
 }
 
 static int ov5647_get_sensor_id(struct ov5647 *sensor, void* pchip_id)
 {
 	int ret = 0;
-	u32 chip_id;
-	u8 chip_id_high = 0;
-	u8 chip_id_low = 0;
-	ret  = ov5647_read_reg(sensor, 0x300a, &chip_id_high);
-	ret |= ov5647_read_reg(sensor, 0x300b, &chip_id_low);
-
-	chip_id = ((chip_id_high & 0xff) << 8) | 
-	        (chip_id_low & 0xff);
 
-	ret = copy_to_user(pchip_id, &chip_id, sizeof(u32));
-	if (ret != 0)
-		ret = -ENOMEM;
+	/* checked once and does not change */
+	ret = vvcam_arg_put_u32(sensor->chip_id, pchip_id);
 	return ret;
 }
 
@@ -339,19 +390,24 @@ static int ov5647_get_reserve_id(struct ov5647 *sensor, void* preserve_id)
 {
 	int ret = 0;
 	u32 reserve_id = 0x5647;
-	ret = copy_to_user(preserve_id, &reserve_id, sizeof(u32));
-	if (ret != 0)
-		ret = -ENOMEM;
+	ret = vvcam_arg_put_u32(reserve_id, preserve_id);
 	return ret;
 }
 
 static int ov5647_get_sensor_mode(struct ov5647 *sensor, void* pmode)
 {
 	int ret = 0;
-	ret = copy_to_user(pmode, &sensor->cur_mode,
-		sizeof(struct vvcam_mode_info_s));
-	if (ret != 0)
-		ret = -ENOMEM;
+	struct vvcam_mode_info_s mode;
+	unsigned int seq;
+
+	/* the pattern as read out */
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		mode = sensor->cur_mode;
+		mode.bayer_pattern ^= sensor->flip;
+	} while (read_seqretry(&sensor->state_seq, seq));
+
+	ret = vvcam_arg_out(pmode, &mode);
 	return ret;
 }
 
@@ -360,14 +416,16 @@ static int ov5647_set_sensor_mode(struct ov5647 *sensor, void* pmode)
 	int ret = 0;
 	int i = 0;
 	struct vvcam_mode_info_s sensor_mode;
-	ret = copy_from_user(&sensor_mode, pmode,
-		sizeof(struct vvcam_mode_info_s));
+	ret = vvcam_arg_in(&sensor_mode, pmode);
 	if (ret != 0)
-		return -ENOMEM;
+		return ret;
 	for (i = 0; i < ARRAY_SIZE(pov5647_mode_info); i++) {
 		if (pov5647_mode_info[i].index == sensor_mode.index) {
+			write_seqlock(&sensor->state_seq);
 			memcpy(&sensor->cur_mode, &pov5647_mode_info[i],
 				sizeof(struct vvcam_mode_info_s));
+			vvcam_window_reset(&sensor->window);
+			write_sequnlock(&sensor->state_seq);
 			return 0;
 		}
 	}
@@ -375,6 +433,143 @@ static int ov5647_set_sensor_mode(struct ov5647 *sensor, void* pmode)
 	return -ENXIO;
 }
 
+static const struct vvcam_mode_info_s *ov5647_find_mode(u32 index)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pov5647_mode_info); i++) {
+		if (pov5647_mode_info[i].index == index)
+			return &pov5647_mode_info[i];
+	}
+	return NULL;
+}
+
+/* 16 bit value the mode table leaves in a high/low register pair */
+static u16 ov5647_mode_reg16(const struct vvcam_mode_info_s *mode, u16 addr)
+{
+	const struct vvcam_sccb_data_s *reg = mode->preg_data;
+	u16 val = 0;
+	int i;
+
+	for (i = 0; i < mode->reg_data_count; i++) {
+		if (reg[i].addr == addr)
+			val = (val & 0x00ff) | ((reg[i].data & 0xff) << 8);
+		else if (reg[i].addr == addr + 1)
+			val = (val & 0xff00) | (reg[i].data & 0xff);
+	}
+	return val;
+}
+
+/* value the mode table leaves in a register, 0 if it has none */
+static u8 ov5647_mode_reg(const struct vvcam_mode_info_s *mode, u16 addr)
+{
+	const struct vvcam_sccb_data_s *reg = mode->preg_data;
+	u8 val = 0;
+	int i;
+
+	for (i = 0; i < mode->reg_data_count; i++) {
+		if (reg[i].addr == addr)
+			val = reg[i].data;
+	}
+	return val;
+}
+
+/*
+ * Program the readout window on top of the mode table. The window is
+ * relative to the output of the mode: the analog crop keeps the margin
+ * the mode has around its output for the ISP window, and the vertical
+ * blanking of the mode is kept, so the frame length shrinks with the
+ * window height. The whole 0x3800-0x380f timing block goes out as one
+ * burst.
+ */
+static int ov5647_write_window(struct ov5647 *sensor)
+{
+	const struct vvcam_mode_info_s *base;
+	struct vvcam_window_s *win = &sensor->window.rect;
+	struct vvcam_sccb_data_s regs[16];
+	u16 x_start, y_start, x_margin, y_margin;
+	u16 val[8];
+	int i, ret;
+
+	base = ov5647_find_mode(sensor->cur_mode.index);
+	if (!base)
+		return -EINVAL;
+
+	x_start = ov5647_mode_reg16(base, OV5647_TIMING_X_ADDR_START);
+	y_start = ov5647_mode_reg16(base, OV5647_TIMING_Y_ADDR_START);
+	x_margin = ov5647_mode_reg16(base, OV5647_TIMING_X_ADDR_END) + 1 -
+		   x_start - base->size.bounds_width;
+	y_margin = ov5647_mode_reg16(base, OV5647_TIMING_Y_ADDR_END) + 1 -
+		   y_start - base->size.bounds_height;
+
+	val[0] = x_start + win->left;
+	val[1] = y_start + win->top;
+	val[2] = val[0] + win->width + x_margin - 1;
+	val[3] = val[1] + win->height + y_margin - 1;
+	val[4] = win->width;
+	val[5] = win->height;
+	val[6] = ov5647_mode_reg16(base, OV5647_TIMING_HTS);
+	val[7] = sensor->cur_mode.ae_info.def_frm_len_lines;
+
+	for (i = 0; i < ARRAY_SIZE(val); i++) {
+		regs[2 * i].addr = OV5647_TIMING_X_ADDR_START + 2 * i;
+		regs[2 * i].data = val[i] >> 8;
+		regs[2 * i + 1].addr = OV5647_TIMING_X_ADDR_START + 2 * i + 1;
+		regs[2 * i + 1].data = val[i] & 0xff;
+	}
+
+	ret = ov5647_write_reg_arry(sensor, regs, ARRAY_SIZE(regs));
+	return ret < 0 ? ret : 0;
+}
+
+static int ov5647_set_window(struct ov5647 *sensor, void *arg)
+{
+	const struct vvcam_mode_info_s *base;
+	struct vvcam_window_s win;
+	int ret;
+
+	ret = vvcam_arg_in(&win, arg);
+	if (ret != 0)
+		return ret;
+
+	base = ov5647_find_mode(sensor->cur_mode.index);
+	if (!base)
+		return -EINVAL;
+
+	ret = vvcam_window_set(&sensor->window, &sensor->cur_mode, base, &win,
+			       OV5647_WINDOW_MIN_WIDTH, OV5647_WINDOW_MIN_HEIGHT,
+			       sensor->stream_status,
+			       &sensor->state_seq, &sensor->format);
+	if (ret != 0)
+		return ret;
+
+	return ov5647_write_window(sensor);
+}
+
+static int ov5647_get_window(struct ov5647 *sensor, void *arg)
+{
+	struct vvcam_window_s win;
+
+	vvcam_window_get(&sensor->window, &sensor->cur_mode,
+			 &sensor->state_seq, &win);
+	return vvcam_arg_out(arg, &win);
+}
+
+static int ov5647_get_exposure(struct ov5647 *sensor, void *arg)
+{
+	struct vvcam_exposure_s exposure;
+	unsigned int seq;
+	int ret;
+
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		exposure = sensor->exposure;
+	} while (read_seqretry(&sensor->state_seq, seq));
+
+	ret = vvcam_arg_out(arg, &exposure);
+	return ret;
+}
+
 static int ov5647_set_exp(struct ov5647 *sensor, u32 exp)
 {
 	int ret = 0;
@@ -387,6 +582,11 @@ static int ov5647_set_exp(struct ov5647 *sensor, u32 exp)
 	ret |= ov5647_write_reg(sensor, 0x3502, val_exp & 0xff);
 
 
+	if (!ret) {
+		write_seqlock(&sensor->state_seq);
+		sensor->exposure.integration_line = exp;
+		write_sequnlock(&sensor->state_seq);
+	}
 	return ret;
 }
 
@@ -414,6 +614,11 @@ static int ov5647_set_gain(struct ov5647 *sensor, u32 total_gain)
 	ret |= ov5647_write_reg(sensor, 0x350a, (again >> 8) & 0xff);
 	ret |= ov5647_write_reg(sensor, 0x350b, again & 0xff);
 
+	if (!ret) {
+		write_seqlock(&sensor->state_seq);
+		sensor->exposure.gain = total_gain;
+		write_sequnlock(&sensor->state_seq);
+	}
 	return ret;
 }
 
@@ -432,7 +637,12 @@ static int ov5647_set_vsgain(struct ov5647 *sensor, u32 total_gain)
 
 static int ov5647_get_fps(struct ov5647 *sensor, u32 *pfps)
 {
-	*pfps = sensor->cur_mode.ae_info.cur_fps;
+	unsigned int seq;
+
+	do {
+		seq = read_seqbegin(&sensor->state_seq);
+		*pfps = sensor->cur_mode.ae_info.cur_fps;
+	} while (read_seqretry(&sensor->state_seq, seq));
 	return 0;
 }
 
@@ -441,9 +651,9 @@ static int ov5647_set_test_pattern(struct ov5647 *sensor, void * arg)
 	int ret;
 	struct sensor_test_pattern_s test_pattern;
 
-	ret = copy_from_user(&test_pattern, arg, sizeof(test_pattern));
+	ret = vvcam_arg_in(&test_pattern, arg);
 	if (ret != 0)
-		return -ENOMEM;
+		return ret;
 	if (test_pattern.enable) {
 		switch (test_pattern.pattern) {
 		case 0:
@@ -471,23 +681,99 @@ static int ov5647_set_test_pattern(struct ov5647 *sensor, void * arg)
 	return ret;
 }
 
+static int ov5647_get_frame_stats(struct ov5647 *sensor, void *arg)
+{
+	struct vvcam_frame_stats_s stats;
+	int ret;
+
+	ret = vvcam_arg_in(&stats, arg);
+	if (ret)
+		return ret;
+	if (sensor->stream_status)
+		vvcam_fcnt_sample(&sensor->fcnt,
+				  vvcam_fcnt_estimate(&sensor->fcnt));
+	vvcam_fcnt_report(&sensor->fcnt, &stats);
+	return vvcam_arg_out(arg, &stats);
+}
+
 static int ov5647_s_stream(struct v4l2_subdev *sd, int enable)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	struct ov5647 *sensor = client_to_ov5647(client);
+	struct vvcam_fcnt *fcnt = &sensor->fcnt;
 
-	if (enable)
+	if (enable) {
 		ov5647_write_reg(sensor, 0x0100, 0x01);
-	else
+		if (!sensor->stream_status) {
+			vvcam_fcnt_set_fps(fcnt,
+					   sensor->cur_mode.ae_info.cur_fps);
+			vvcam_fcnt_start(fcnt, vvcam_fcnt_estimate(fcnt));
+		}
+	} else {
+		if (sensor->stream_status) {
+			vvcam_fcnt_sample(fcnt, vvcam_fcnt_estimate(fcnt));
+			vvcam_fcnt_stop(fcnt);
+		}
 		ov5647_write_reg(sensor, 0x0100, 0x00);
+	}
 
 	sensor->stream_status = enable;
 	return 0;
 }
 
+/*
+ * Probe does not touch the bus, so several cameras power up side by side
+ * instead of one after the other. The ID is read on the first open or
+ * stream on and the answer kept; a bus error is not kept, the next call
+ * retries. Called with lock held.
+ */
+static int ov5647_check_chip_id(struct ov5647 *sensor)
+{
+	struct device *dev = &sensor->i2c_client->dev;
+	u8 id_high = 0;
+	u8 id_low = 0;
+	u32 chip_id;
+	int ret;
+
+	if (sensor->chip_status != -EAGAIN)
+		return sensor->chip_status;
+
+	ret  = ov5647_read_reg(sensor, 0x300a, &id_high);
+	ret |= ov5647_read_reg(sensor, 0x300b, &id_low);
+	if (ret)
+		return -EIO;
+
+	chip_id = (id_high << 8) | id_low;
+	if (chip_id == 0x5647) {
+		sensor->chip_id = chip_id;
+		ret = 0;
+	} else {
+		dev_err(dev, "camera ov5647 is not found, id 0x%04x\n", chip_id);
+		ret = -ENODEV;
+	}
+	/* pairs with the acquire in ov5647_priv_get() */
+	smp_store_release(&sensor->chip_status, ret);
+	return ret;
+}
+
+static int ov5647_video_s_stream(struct v4l2_subdev *sd, int enable)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct ov5647 *sensor = client_to_ov5647(client);
+	int ret = 0;
+
+	mutex_lock(&sensor->lock);
+	if (enable)
+		ret = ov5647_check_chip_id(sensor);
+	if (!ret)
+		ret = ov5647_s_stream(sd, enable);
+	mutex_unlock(&sensor->lock);
+	return ret;
+}
+
 static int ov5647_get_format_code(struct ov5647 *sensor, u32 *code)
 {
-	switch (sensor->cur_mode.bayer_pattern) {
+	switch (sensor->cur_mode.bayer_pattern ^ sensor->flip) {
 	case BAYER_RGGB:
 		if (sensor->cur_mode.bit_width == 8) {
 			*code = MEDIA_BUS_FMT_SRGGB8_1X8;
@@ -530,6 +816,53 @@ static int ov5647_get_format_code(struct ov5647 *sensor, u32 *code)
 	}
 	return 0;
 }
+
+/*
+ * The mode tables already set the mirror bits for an upright image on
+ * the module, so the orientation toggles the flip bits the table leaves.
+ */
+static int ov5647_write_flip(struct ov5647 *sensor, u32 flip)
+{
+	u8 reg20 = ov5647_mode_reg(&sensor->cur_mode, OV5647_TIMING_TC_REG20);
+	u8 reg21 = ov5647_mode_reg(&sensor->cur_mode, OV5647_TIMING_TC_REG21);
+	int ret;
+
+	if (flip & VVCAM_FLIP_V)
+		reg20 ^= OV5647_FLIP_BITS;
+	if (flip & VVCAM_FLIP_H)
+		reg21 ^= OV5647_FLIP_BITS;
+
+	ret  = ov5647_write_reg(sensor, OV5647_TIMING_TC_REG20, reg20);
+	ret |= ov5647_write_reg(sensor, OV5647_TIMING_TC_REG21, reg21);
+	return ret ? -EIO : 0;
+}
+
+/* V4L2_CID_HFLIP and V4L2_CID_VFLIP, with lock held */
+static int ov5647_set_flip(struct vvcam_flip *vf, u32 flip)
+{
+	struct ov5647 *sensor = container_of(vf, struct ov5647, orient);
+	int ret;
+
+	if (flip == sensor->flip)
+		return 0;
+	/* the bayer order changes with it */
+	if (sensor->stream_status)
+		return -EBUSY;
+
+	ret = ov5647_check_chip_id(sensor);
+	if (ret)
+		return ret;
+	ret = ov5647_write_flip(sensor, flip);
+	if (ret)
+		return ret;
+
+	write_seqlock(&sensor->state_seq);
+	sensor->flip = flip;
+	write_sequnlock(&sensor->state_seq);
+	ov5647_get_format_code(sensor, &sensor->format.code);
+	return 0;
+}
+
 #if LINUX_VERSION_CODE > KERNEL_VERSION(5, 12, 0)
 static int ov5647_enum_mbus_code(struct v4l2_subdev *sd,
 				struct v4l2_subdev_state *state,
@@ -582,6 +915,10 @@ static int ov5647_set_fmt(struct v4l2_subdev *sd,
 	ret = ov5647_write_reg_arry(sensor,
 		(struct vvcam_sccb_data_s *)sensor->cur_mode.preg_data,
 		sensor->cur_mode.reg_data_count);
+	if (ret >= 0 && sensor->window.active)
+		ret = ov5647_write_window(sensor);
+	if (ret >= 0 && sensor->flip)
+		ret = ov5647_write_flip(sensor, sensor->flip);
 	if (ret < 0) {
 		pr_err("%s:ov5647_write_reg_arry error\n",__func__);
 		mutex_unlock(&sensor->lock);
@@ -613,99 +950,156 @@ static int ov5647_get_fmt(struct v4l2_subdev *sd,
 	return 0;
 }
 
+/*
+ * Commands that only read driver state. They do not take lock, so a
+ * poll of the mode or exposure is not held up by a register upload.
+ * Returns -ENOIOCTLCMD for the commands that need lock.
+ */
+static long ov5647_priv_get(struct ov5647 *sensor, unsigned int cmd,
+			    void *arg)
+{
+	u32 fps;
+
+	switch (cmd) {
+	case VVSENSORIOC_G_CLK:
+		return ov5647_get_clk(sensor, arg);
+	case VIDIOC_QUERYCAP:
+		return ov5647_query_capability(sensor, arg);
+	case VVSENSORIOC_QUERY:
+		return ov5647_query_supports(sensor, arg);
+	case VVSENSORIOC_G_CHIP_ID:
+		/* not checked yet, go through lock */
+		if (smp_load_acquire(&sensor->chip_status))
+			return -ENOIOCTLCMD;
+		return ov5647_get_sensor_id(sensor, arg);
+	case VVSENSORIOC_G_RESERVE_ID:
+		return ov5647_get_reserve_id(sensor, arg);
+	case VVSENSORIOC_G_SENSOR_MODE:
+		return ov5647_get_sensor_mode(sensor, arg);
+	case VVSENSORIOC_G_FPS:
+		ov5647_get_fps(sensor, &fps);
+		return vvcam_arg_put_u32(fps, arg);
+	case VVSENSORIOC_G_WINDOW:
+		return ov5647_get_window(sensor, arg);
+	case VVSENSORIOC_G_EXPOSURE:
+		return ov5647_get_exposure(sensor, arg);
+	case VVSENSORIOC_G_FLIP:
+		return vvcam_arg_put_u32(READ_ONCE(sensor->flip), arg);
+	default:
+		return -ENOIOCTLCMD;
+	}
+}
+
 static long ov5647_priv_ioctl(struct v4l2_subdev *sd,
                               unsigned int cmd,
-                              void *arg_user)
+                              void *arg)
 {
 	struct i2c_client *client = v4l2_get_subdevdata(sd);
 	struct ov5647 *sensor = client_to_ov5647(client);
 	long ret = 0;
 	struct vvcam_sccb_data_s sensor_reg;
-	void *arg = arg_user;
+	u32 value;
+	u8 val;
+
+	ret = ov5647_priv_get(sensor, cmd, arg);
+	if (ret != -ENOIOCTLCMD)
+		return ret;
+	ret = 0;
 
 	mutex_lock(&sensor->lock);
+	ret = ov5647_check_chip_id(sensor);
+	if (ret) {
+		mutex_unlock(&sensor->lock);
+		return ret;
+	}
+
 	switch (cmd){
+	case VVSENSORIOC_G_CHIP_ID:
+		ret = ov5647_get_sensor_id(sensor, arg);
+		break;
 	case VVSENSORIOC_S_POWER:
 		ret = 0;
 		break;
 	case VVSENSORIOC_S_CLK:
 		ret = 0;
 		break;
-	case VVSENSORIOC_G_CLK:
-		ret = ov5647_get_clk(sensor,arg);
-		break;
 	case VVSENSORIOC_RESET:
 		ret = 0;
 		break;
-	case VIDIOC_QUERYCAP:
-		ret = ov5647_query_capability(sensor, arg);
-		break;
-	case VVSENSORIOC_QUERY:
-		USER_TO_KERNEL(struct vvcam_mode_info_array_s);
-		ret = ov5647_query_supports(sensor, arg);
-		KERNEL_TO_USER(struct vvcam_mode_info_array_s);
-		break;
-	case VVSENSORIOC_G_CHIP_ID:
-		ret = ov5647_get_sensor_id(sensor, arg);
-		break;
-	case VVSENSORIOC_G_RESERVE_ID:
-		ret = ov5647_get_reserve_id(sensor, arg);
-		break;
-	case VVSENSORIOC_G_SENSOR_MODE:
-		ret = ov5647_get_sensor_mode(sensor, arg);
-		break;
 	case VVSENSORIOC_S_SENSOR_MODE:
 		ret = ov5647_set_sensor_mode(sensor, arg);
 		break;
 	case VVSENSORIOC_S_STREAM:
-		USER_TO_KERNEL(int);
-		ret = ov5647_s_stream(&sensor->subdev, *(int *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ov5647_s_stream(&sensor->subdev, value);
 		break;
 	case VVSENSORIOC_WRITE_REG:
-		ret = copy_from_user(&sensor_reg, arg,
-			sizeof(struct vvcam_sccb_data_s));
-		ret |= ov5647_write_reg(sensor, sensor_reg.addr,
-			sensor_reg.data);
+		ret = vvcam_arg_in(&sensor_reg, arg);
+		if (!ret)
+			ret = ov5647_write_reg(sensor, sensor_reg.addr,
+				sensor_reg.data);
 		break;
 	case VVSENSORIOC_READ_REG:
-		ret = copy_from_user(&sensor_reg, arg,
-			sizeof(struct vvcam_sccb_data_s));
-		ret |= ov5647_read_reg(sensor, sensor_reg.addr,
-			(u8 *)&sensor_reg.data);
-		ret |= copy_to_user(arg, &sensor_reg,
-			sizeof(struct vvcam_sccb_data_s));
+		ret = vvcam_arg_in(&sensor_reg, arg);
+		if (!ret)
+			ret = ov5647_read_reg(sensor, sensor_reg.addr, &val);
+		if (!ret) {
+			sensor_reg.data = val;
+			ret = vvcam_arg_out(arg, &sensor_reg);
+		}
 		break;
 	case VVSENSORIOC_S_EXP:
-		USER_TO_KERNEL(u32);
-		ret = ov5647_set_exp(sensor, *(u32 *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ov5647_set_exp(sensor, value);
 		break;
 	case VVSENSORIOC_S_VSEXP:
-		USER_TO_KERNEL(u32);
-		ret = ov5647_set_vsexp(sensor, *(u32 *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ov5647_set_vsexp(sensor, value);
 		break;
 	case VVSENSORIOC_S_GAIN:
-		USER_TO_KERNEL(u32);
-		ret = ov5647_set_gain(sensor, *(u32 *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ov5647_set_gain(sensor, value);
 		break;
 	case VVSENSORIOC_S_VSGAIN:
-		USER_TO_KERNEL(u32);
-		ret = ov5647_set_vsgain(sensor, *(u32 *)arg);
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = ov5647_set_vsgain(sensor, value);
 		break;
 	case VVSENSORIOC_S_FPS:
-		USER_TO_KERNEL(u32);
 		//ret = ov5647_set_fps(sensor, *(u32 *)arg);
 		break;
-	case VVSENSORIOC_G_FPS:
-		USER_TO_KERNEL(u32);
-		ret = ov5647_get_fps(sensor, (u32 *)arg);
-		KERNEL_TO_USER(u32);
-		break;
 	case VVSENSORIOC_S_HDR_RADIO:
 		//ret = ov5647_set_ratio(sensor, arg);
 		break;
 	case VVSENSORIOC_S_TEST_PATTERN:
 		ret= ov5647_set_test_pattern(sensor, arg);
 		break;
+	case VVSENSORIOC_S_WINDOW:
+		ret = ov5647_set_window(sensor, arg);
+		break;
+	case VVSENSORIOC_BATCH_REG:
+		ret = ov5647_batch_reg(sensor, arg);
+		break;
+	case VVSENSORIOC_S_FLIP:
+		ret = vvcam_arg_get_u32(value, arg);
+		if (!ret)
+			ret = vvcam_flip_set(&sensor->orient, value);
+		break;
+	case VVSENSORIOC_FRAME_STATS:
+		ret = ov5647_get_frame_stats(sensor, arg);
+		break;
+	case VVSENSORIOC_G_TEMPERATURE:
+		/*
+		 * Neither the functional description nor the register tables
+		 * of the OV5647 datasheet have a temperature sensor, unlike
+		 * the later OmniVision parts with a temperature monitor block
+		 */
+		ret = -ENOTTY;
+		break;
 	default:
 		break;
 	}
@@ -715,7 +1109,7 @@ static long ov5647_priv_ioctl(struct v4l2_subdev *sd,
 }
 
 static struct v4l2_subdev_video_ops ov5647_subdev_video_ops = {
-	.s_stream = ov5647_s_stream,
+	.s_stream = ov5647_video_s_stream,
 };
 
 static const struct v4l2_subdev_pad_ops ov5647_subdev_pad_ops = {
@@ -735,6 +1129,39 @@ static struct v4l2_subdev_ops ov5647_subdev_ops = {
 	.pad   = &ov5647_subdev_pad_ops,
 };
 
+static int ov5647_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh)
+{
+	struct i2c_client *client = v4l2_get_subdevdata(sd);
+	struct ov5647 *sensor = client_to_ov5647(client);
+	int ret;
+
+	mutex_lock(&sensor->lock);
+	ret = ov5647_check_chip_id(sensor);
+	mutex_unlock(&sensor->lock);
+	return ret;
+}
+
+static const struct v4l2_subdev_internal_ops ov5647_internal_ops = {
+	.open = ov5647_open,
+};
+
+static int ov5647_frames_show(struct seq_file *m, void *v)
+{
+	struct ov5647 *sensor = m->private;
+	struct vvcam_fcnt fcnt;
+
+	mutex_lock(&sensor->lock);
+	if (sensor->stream_status)
+		vvcam_fcnt_sample(&sensor->fcnt,
+				  vvcam_fcnt_estimate(&sensor->fcnt));
+	fcnt = sensor->fcnt;
+	mutex_unlock(&sensor->lock);
+
+	vvcam_fcnt_show(m, &fcnt);
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(ov5647_frames);
+
 static int ov5647_link_setup(struct media_entity *entity,
 			     const struct media_pad *local,
 			     const struct media_pad *remote, u32 flags)
@@ -772,8 +1199,8 @@ static int ov5647_probe(struct i2c_client *client,
 	struct device *dev = &client->dev;
 	struct v4l2_subdev *sd;
 	struct ov5647 *sensor;
-	u32 chip_id = 0;
-	u8 reg_val = 0;
+	char name[32];
+	ktime_t start = ktime_get();
 
 	pr_info("enter %s\n", __func__);
 
@@ -782,6 +1209,10 @@ static int ov5647_probe(struct i2c_client *client,
 		return -ENOMEM;
 	memset(sensor, 0, sizeof(*sensor));
 
+	sensor->scratch = devm_vvcam_arg_scratch_alloc(dev);
+	if (!sensor->scratch)
+		return -ENOMEM;
+
 	sensor->i2c_client = client;
 
 	sensor->pwn_gpio = of_get_named_gpio(dev->of_node, "pwn-gpios", 0);
@@ -838,18 +1269,19 @@ static int ov5647_probe(struct i2c_client *client,
 
 	ov5647_reset(sensor);
 
-	ov5647_read_reg(sensor, 0x300a, &reg_val);
-	chip_id |= reg_val << 8;
-	ov5647_read_reg(sensor, 0x300b, &reg_val);
-	chip_id |= reg_val;
-	if (chip_id != 0x5647) {
-		pr_warn("camera ov5647 is not found\n");
-		retval = -ENODEV;
-		goto probe_err_power_off;
-	}
+	memcpy(&sensor->cur_mode, &pov5647_mode_info[0],
+			sizeof(struct vvcam_mode_info_s));
+	sensor->ocp.max_pixel_frequency = OV5647_CSI_MAX_PIXEL_CLK;
+	sensor->chip_status = -EAGAIN;
+
+	/* the subdev can be opened as soon as it is registered */
+	mutex_init(&sensor->lock);
+	seqlock_init(&sensor->state_seq);
+	vvcam_fcnt_init(&sensor->fcnt, 0xffffffff, true);
 
 	sd = &sensor->subdev;
 	v4l2_i2c_subdev_init(sd, client, &ov5647_subdev_ops);
+	sd->internal_ops = &ov5647_internal_ops;
 	sd->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE;
 	sd->dev = &client->dev;
 	sd->entity.ops = &ov5647_sd_media_ops;
@@ -860,6 +1292,13 @@ static int ov5647_probe(struct i2c_client *client,
 				sensor->pads);
 	if (retval < 0)
 		goto probe_err_power_off;
+	v4l2_ctrl_handler_init(&sensor->ctrls, 2);
+	sensor->ctrls.lock = &sensor->lock;
+	vvcam_flip_init(&sensor->orient, &sensor->ctrls, ov5647_set_flip);
+	retval = sensor->ctrls.error;
+	if (retval < 0)
+		goto probe_err_free_ctrls;
+	sd->ctrl_handler = &sensor->ctrls;
 #if LINUX_VERSION_CODE > KERNEL_VERSION(5, 12, 0)
 	retval = v4l2_async_register_subdev_sensor(sd);
 #else
@@ -868,22 +1307,26 @@ static int ov5647_probe(struct i2c_client *client,
 	if (retval < 0) {
 		dev_err(&client->dev,"%s--Async register failed, ret=%d\n",
 			__func__,retval);
-		goto probe_err_free_entiny;
+		goto probe_err_free_ctrls;
 	}
 
-	memcpy(&sensor->cur_mode, &pov5647_mode_info[0],
-			sizeof(struct vvcam_mode_info_s));
+	snprintf(name, sizeof(name), "ov5647-%s", dev_name(dev));
+	sensor->debugfs = debugfs_create_dir(name, NULL);
+	debugfs_create_file("frames", 0444, sensor->debugfs, sensor,
+			    &ov5647_frames_fops);
 
-	mutex_init(&sensor->lock);
-	pr_info("%s camera mipi ov5647, is found\n", __func__);
+	pr_info("%s camera mipi ov5647 registered in %lld us\n", __func__,
+		ktime_us_delta(ktime_get(), start));
 
 	return 0;
 
-probe_err_free_entiny:
+probe_err_free_ctrls:
+	v4l2_ctrl_handler_free(&sensor->ctrls);
 	media_entity_cleanup(&sd->entity);
 
 probe_err_power_off:
 	ov5647_power_off(sensor);
+	mutex_destroy(&sensor->lock);
 
 	return retval;
 }
@@ -899,7 +1342,9 @@ static void ov5647_remove(struct i2c_client *client)
 
 	pr_info("enter %s\n", __func__);
 
+	debugfs_remove_recursive(sensor->debugfs);
 	v4l2_async_unregister_subdev(sd);
+	v4l2_ctrl_handler_free(&sensor->ctrls);
 	media_entity_cleanup(&sd->entity);
 	ov5647_power_off(sensor);
 	mutex_destroy(&sensor->lock);
@@ -915,10 +1360,12 @@ static int __maybe_unused ov5647_suspend(struct device *dev)
 	struct i2c_client *client = to_i2c_client(dev);
 	struct ov5647 *sensor = client_to_ov5647(client);
 
+	mutex_lock(&sensor->lock);
 	sensor->resume_status = sensor->stream_status;
 	if (sensor->resume_status) {
 		ov5647_s_stream(&sensor->subdev,0);
 	}
+	mutex_unlock(&sensor->lock);
 
 	return 0;
 }
@@ -928,9 +1375,11 @@ static int __maybe_unused ov5647_resume(struct device *dev)
 	struct i2c_client *client = to_i2c_client(dev);
 	struct ov5647 *sensor = client_to_ov5647(client);
 
+	mutex_lock(&sensor->lock);
 	if (sensor->resume_status) {
 		ov5647_s_stream(&sensor->subdev,1);
 	}
+	mutex_unlock(&sensor->lock);
 
 	return 0;
 }
@@ -957,6 +1406,7 @@ static struct i2c_driver ov5647_i2c_driver = {
 		.name  = "ov5647",
 		.pm = &ov5647_pm_ops,
 		.of_match_table	= ov5647_of_match,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.probe	= ov5647_probe,
 	.remove = ov5647_remove,
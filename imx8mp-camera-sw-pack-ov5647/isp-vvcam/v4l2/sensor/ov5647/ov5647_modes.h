@@ -0,0 +1,158 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: (GPL-2.0-only OR MIT)
+ */
+
+/*
+ * Generated by tools/sensor-modes/gen_sensor_modes.py from
+ * modes/ov5647.json. Do not edit.
+ */
+
+#ifndef _VVCAM_OV5647_MODES_H_
+#define _VVCAM_OV5647_MODES_H_
+
+#include "vvsensor.h"
+
+#define OV5647_CSI_MAX_PIXEL_CLK	266000000
+
+/* single ov5647 camera on MIPI-CSI1, 1920x1080, 30 fps */
+static struct vvcam_sccb_data_s ov5647_init_setting_1080p[] = {
+	{0x0100, 0x00}, // mode_select: standby
+	{0x0103, 0x01}, // software reset
+	{0x3034, 0x1a},
+	{0x3035, 0x21},
+	{0x3036, 0x62},
+	{0x303c, 0x11},
+	{0x3106, 0xf5},
+	{0x3821, 0x06},
+	{0x3820, 0x00},
+	{0x3827, 0xec},
+	{0x370c, 0x03},
+	{0x3612, 0x5b},
+	{0x3618, 0x04},
+	{0x5000, 0x06},
+	{0x5002, 0x41},
+	{0x5003, 0x08},
+	{0x5a00, 0x08},
+	{0x3000, 0x00},
+	{0x3001, 0x00},
+	{0x3002, 0x00},
+	{0x3016, 0x08},
+	{0x3017, 0xe0},
+	{0x3018, 0x44},
+	{0x301c, 0xf8},
+	{0x301d, 0xf0},
+	{0x3a18, 0x00},
+	{0x3a19, 0xf8},
+	{0x3c01, 0x80},
+	{0x3b07, 0x0c},
+	{0x380c, 0x09}, // TIMING_HTS[12:8]
+	{0x380d, 0x70}, // TIMING_HTS[7:0]
+	{0x3814, 0x11},
+	{0x3815, 0x11},
+	{0x3708, 0x64},
+	{0x3709, 0x12},
+	{0x3808, 0x07}, // TIMING_X_OUTPUT_SIZE[11:8]
+	{0x3809, 0x80}, // TIMING_X_OUTPUT_SIZE[7:0]
+	{0x380a, 0x04}, // TIMING_Y_OUTPUT_SIZE[10:8]
+	{0x380b, 0x38}, // TIMING_Y_OUTPUT_SIZE[7:0]
+	{0x3800, 0x01}, // TIMING_X_ADDR_START[11:8]
+	{0x3801, 0x5c}, // TIMING_X_ADDR_START[7:0]
+	{0x3802, 0x01}, // TIMING_Y_ADDR_START[10:8]
+	{0x3803, 0xb2}, // TIMING_Y_ADDR_START[7:0]
+	{0x3804, 0x08}, // TIMING_X_ADDR_END[11:8]
+	{0x3805, 0xe3}, // TIMING_X_ADDR_END[7:0]
+	{0x3806, 0x05}, // TIMING_Y_ADDR_END[10:8]
+	{0x3807, 0xf1}, // TIMING_Y_ADDR_END[7:0]
+	{0x3811, 0x04},
+	{0x3813, 0x02},
+	{0x3630, 0x2e},
+	{0x3632, 0xe2},
+	{0x3633, 0x23},
+	{0x3634, 0x44},
+	{0x3636, 0x06},
+	{0x3620, 0x64},
+	{0x3621, 0xe0},
+	{0x3600, 0x37},
+	{0x3704, 0xa0},
+	{0x3703, 0x5a},
+	{0x3715, 0x78},
+	{0x3717, 0x01},
+	{0x3731, 0x02},
+	{0x370b, 0x60},
+	{0x3705, 0x1a},
+	{0x3f05, 0x02},
+	{0x3f06, 0x10},
+	{0x3f01, 0x0a},
+	{0x3a08, 0x01},
+	{0x3a09, 0x4b},
+	{0x3a0a, 0x01},
+	{0x3a0b, 0x13},
+	{0x3a0d, 0x04},
+	{0x3a0e, 0x03},
+	{0x3a0f, 0x58},
+	{0x3a10, 0x50},
+	{0x3a1b, 0x58},
+	{0x3a1e, 0x50},
+	{0x3a11, 0x60},
+	{0x3a1f, 0x28},
+	{0x4001, 0x02},
+	{0x4004, 0x04},
+	{0x4000, 0x09},
+	{0x4837, 0x19},
+	{0x4800, 0x34},
+	{0x3503, 0x03},
+	{0x380e, 0x04}, // TIMING_VTS[9:8]
+	{0x380f, 0x50}, // TIMING_VTS[7:0]
+	{0x0100, 0x01}, // mode_select: streaming
+};
+
+static struct vvcam_mode_info_s pov5647_mode_info[] = {
+	{
+		.index          = 0,
+		.size           = {
+			.bounds_width  = 1920,
+			.bounds_height = 1080,
+			.top           = 0,
+			.left          = 0,
+			.width         = 1920,
+			.height        = 1080,
+		},
+		.hdr_mode       = SENSOR_MODE_LINEAR,
+		.bit_width      = 10,
+		.data_compress  = {
+			.enable = 0,
+		},
+		.bayer_pattern  = BAYER_BGGR,
+		.ae_info = {
+			/*
+			line time = 30193 ns
+			frame time = 1104 lines * 30193 ns -> 30 fps
+			*/
+			.def_frm_len_lines     = 0x450,
+			.curr_frm_len_lines    = 0x450,
+			.one_line_exp_time_ns  = 30193,
+			.max_integration_line  = 0x440,
+			.min_integration_line  = 16,
+			.max_again             = 63.5 * (1 << SENSOR_FIX_FRACBITS),
+			.min_again             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.max_dgain             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.min_dgain             = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.start_exposure        = 200 * (1 << SENSOR_FIX_FRACBITS),
+			.cur_fps               = 30 * (1 << SENSOR_FIX_FRACBITS),
+			.max_fps               = 30 * (1 << SENSOR_FIX_FRACBITS),
+			.min_fps               = 1 * (1 << SENSOR_FIX_FRACBITS),
+			.min_afps              = 5 * (1 << SENSOR_FIX_FRACBITS),
+			.int_update_delay_frm  = 1,
+			.gain_update_delay_frm = 1,
+		},
+		.mipi_info = {
+			.mipi_lane = 2,
+		},
+		.preg_data      = ov5647_init_setting_1080p,
+		.reg_data_count = ARRAY_SIZE(ov5647_init_setting_1080p),
+	},
+};
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * Frame counting for VVSENSORIOC_FRAME_STATS and the "frames" debugfs file.
+ *
+ * While the sensor streams the driver samples its hardware frame counter,
+ * at least twice per counter wrap at the mode's max_fps, and these helpers
+ * extend it to 64 bit. A sensor without a readable counter feeds the count
+ * expected from the stream time and frame period instead, as returned by
+ * vvcam_fcnt_estimate(). All calls are made with the device lock held.
+ *
+ * The same file is shipped next to each sensor driver; the copies must
+ * stay identical.
+ */
+
+#ifndef _VVSENSOR_FCNT_H_
+#define _VVSENSOR_FCNT_H_
+
+#include <linux/jiffies.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/seq_file.h>
+#include <linux/string.h>
+#include "vvsensor.h"
+#include "vvsensor_ext.h"
+
+#define VVCAM_FCNT_PERIOD_MAX_MS	1000	/* sample period cap */
+
+struct vvcam_fcnt {
+	u32 mask;		/* counter range minus one */
+	u32 flags;		/* VVCAM_FRAME_COUNT_* */
+	u32 last_raw;
+	u64 frames;
+	u64 delivered;		/* as of the last VVSENSORIOC_FRAME_STATS */
+	u64 dropped;
+	u32 gaps;
+	u32 max_gap;
+	ktime_t start;		/* stream on */
+	ktime_t sampled;
+	ktime_t moved;		/* last sample at which the counter moved */
+	/* estimated counters: frames at the last fps change, and its time */
+	u64 est_frames;
+	ktime_t est_time;
+	u64 frame_ns;
+};
+
+static inline void vvcam_fcnt_init(struct vvcam_fcnt *fc, u32 mask,
+				   bool estimated)
+{
+	memset(fc, 0, sizeof(*fc));
+	fc->mask = mask;
+	if (estimated)
+		fc->flags = VVCAM_FRAME_COUNT_ESTIMATED;
+}
+
+/* jiffies between two samples: half a wrap at max_fps, capped */
+static inline unsigned long vvcam_fcnt_period(const struct vvcam_fcnt *fc,
+					      u32 max_fps)
+{
+	u64 ms = VVCAM_FCNT_PERIOD_MAX_MS;
+
+	if (max_fps)
+		ms = div_u64(((u64)fc->mask + 1) * 500 << SENSOR_FIX_FRACBITS,
+			     max_fps);
+	return msecs_to_jiffies(clamp_t(u64, ms, 1, VVCAM_FCNT_PERIOD_MAX_MS));
+}
+
+static inline u64 vvcam_fcnt_estimate64(const struct vvcam_fcnt *fc,
+					ktime_t now)
+{
+	if (!fc->frame_ns)
+		return fc->est_frames;
+	return fc->est_frames +
+	       div64_u64(ktime_to_ns(ktime_sub(now, fc->est_time)),
+			 fc->frame_ns);
+}
+
+/* raw count of an estimated counter */
+static inline u32 vvcam_fcnt_estimate(const struct vvcam_fcnt *fc)
+{
+	return (u32)vvcam_fcnt_estimate64(fc, ktime_get());
+}
+
+/* frame rate of an estimated counter, SENSOR_FIX_FRACBITS fixed point */
+static inline void vvcam_fcnt_set_fps(struct vvcam_fcnt *fc, u32 fps)
+{
+	ktime_t now = ktime_get();
+
+	fc->est_frames = vvcam_fcnt_estimate64(fc, now);
+	fc->est_time = now;
+	fc->frame_ns = fps ? div_u64((u64)NSEC_PER_SEC << SENSOR_FIX_FRACBITS,
+				     fps) : 0;
+}
+
+static inline void vvcam_fcnt_start(struct vvcam_fcnt *fc, u32 raw)
+{
+	fc->last_raw = raw & fc->mask;
+	fc->frames = 0;
+	fc->delivered = 0;
+	fc->dropped = 0;
+	fc->gaps = 0;
+	fc->max_gap = 0;
+	fc->start = ktime_get();
+	fc->sampled = fc->start;
+	fc->moved = fc->start;
+	fc->flags |= VVCAM_FRAME_COUNT_STREAMING;
+}
+
+static inline void vvcam_fcnt_stop(struct vvcam_fcnt *fc)
+{
+	fc->flags &= ~VVCAM_FRAME_COUNT_STREAMING;
+}
+
+static inline void vvcam_fcnt_sample(struct vvcam_fcnt *fc, u32 raw)
+{
+	u32 delta = (raw - fc->last_raw) & fc->mask;
+
+	fc->sampled = ktime_get();
+	if (delta) {
+		fc->frames += delta;
+		fc->moved = fc->sampled;
+	}
+	fc->last_raw = raw & fc->mask;
+}
+
+/* account the delivered buffers of *stats and fill in the rest */
+static inline void vvcam_fcnt_report(struct vvcam_fcnt *fc,
+				     struct vvcam_frame_stats_s *stats)
+{
+	u64 held = stats->delivered + stats->in_flight;
+	u64 dropped = fc->frames > held ? fc->frames - held : 0;
+
+	if (dropped > fc->dropped) {
+		fc->gaps++;
+		fc->max_gap = max_t(u32, fc->max_gap,
+				    min_t(u64, dropped - fc->dropped, U32_MAX));
+	}
+	fc->dropped = dropped;
+	fc->delivered = stats->delivered;
+
+	stats->flags = fc->flags;
+	stats->frames = fc->frames;
+	stats->dropped = fc->dropped;
+	stats->gaps = fc->gaps;
+	stats->max_gap = fc->max_gap;
+	stats->stream_us = ktime_us_delta(fc->sampled, fc->start);
+	stats->idle_us = ktime_us_delta(fc->sampled, fc->moved);
+}
+
+static inline void vvcam_fcnt_show(struct seq_file *m,
+				   const struct vvcam_fcnt *fc)
+{
+	seq_printf(m, "streaming:    %s\n",
+		   fc->flags & VVCAM_FRAME_COUNT_STREAMING ? "yes" : "no");
+	seq_printf(m, "counter:      %s\n",
+		   fc->flags & VVCAM_FRAME_COUNT_ESTIMATED ?
+		   "estimated" : "sensor");
+	seq_printf(m, "frames:       %llu\n", fc->frames);
+	seq_printf(m, "delivered:    %llu\n", fc->delivered);
+	seq_printf(m, "dropped:      %llu\n", fc->dropped);
+	seq_printf(m, "gaps:         %u\n", fc->gaps);
+	seq_printf(m, "max gap:      %u\n", fc->max_gap);
+	seq_printf(m, "stream time:  %lld ms\n",
+		   ktime_ms_delta(fc->sampled, fc->start));
+	seq_printf(m, "idle time:    %lld ms\n",
+		   ktime_ms_delta(fc->sampled, fc->moved));
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * Argument copies of the sensor private ioctls.
+ *
+ * The VVSENSORIOC_* commands carry no size in their number, so the V4L2
+ * core hands the user pointer through untouched and every driver copies
+ * its own arguments. These helpers copy exactly the size of the kernel
+ * object and turn a fault into -EFAULT. Scalars go through get_user() and
+ * put_user(). Arguments too big for the stack use a scratch area that is
+ * allocated once at probe, so no ioctl allocates memory.
+ *
+ * The same file is shipped next to each sensor driver; the copies must
+ * stay identical.
+ */
+
+#ifndef _VVSENSOR_UARG_H_
+#define _VVSENSOR_UARG_H_
+
+#include <linux/device.h>
+#include <linux/mm.h>
+#include <linux/uaccess.h>
+#include "vvsensor_ext.h"
+
+/* copy *kobj from or to the user argument, 0 or -EFAULT */
+#define vvcam_arg_in(kobj, uarg) \
+	(copy_from_user(kobj, (const void __user *)(uarg), \
+			sizeof(*(kobj))) ? -EFAULT : 0)
+#define vvcam_arg_out(uarg, kobj) \
+	(copy_to_user((void __user *)(uarg), kobj, \
+		      sizeof(*(kobj))) ? -EFAULT : 0)
+
+/* u32 arguments of the exposure, gain and fps commands */
+#define vvcam_arg_get_u32(val, uarg) get_user(val, (u32 __user *)(uarg))
+#define vvcam_arg_put_u32(val, uarg) put_user(val, (u32 __user *)(uarg))
+
+#define VVCAM_SCCB_BURST_MAX	256	/* data bytes per register burst */
+
+/*
+ * Per device scratch, used by the ioctls and register writes that run
+ * with the device lock held.
+ */
+struct vvcam_arg_scratch_s {
+	struct vvcam_reg_entry_s reg_entry[VVCAM_REG_BATCH_MAX];
+	/* 16 bit start address, then the data */
+	u8 sccb_burst[2 + VVCAM_SCCB_BURST_MAX];
+};
+
+static inline void vvcam_arg_scratch_free(void *scratch)
+{
+	kvfree(scratch);
+}
+
+/* freed with the device, NULL if out of memory */
+static inline struct vvcam_arg_scratch_s *
+devm_vvcam_arg_scratch_alloc(struct device *dev)
+{
+	struct vvcam_arg_scratch_s *scratch;
+
+	scratch = kvmalloc(sizeof(*scratch), GFP_KERNEL);
+	if (!scratch)
+		return NULL;
+	if (devm_add_action_or_reset(dev, vvcam_arg_scratch_free, scratch))
+		return NULL;
+	return scratch;
+}
+
+#endif
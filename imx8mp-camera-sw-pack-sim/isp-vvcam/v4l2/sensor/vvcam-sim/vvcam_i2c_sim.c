@@ -0,0 +1,550 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * I2C register emulators for the AR0144, IMX219 and OV5647 sensors.
+ *
+ * Each emulated sensor gets its own I2C adapter answering at the sensor's
+ * address with 16-bit register addressing, so the unmodified sensor drivers
+ * probe and run on top of it. Registers are kept as a byte array with
+ * auto-increment on reads and writes, which covers both the 8-bit register
+ * maps (imx219, ov5647) and the 16-bit big-endian one (ar0144). Chip ID,
+ * soft reset, streaming and group hold registers are modelled.
+ *
+ * Every transfer is accounted: transfers, messages, bytes and bus clock
+ * cycles, reported as bus time at 100 kHz, 400 kHz and 1 MHz in
+ * /sys/kernel/debug/vvcam-i2c-sim/<sensor>/stats. Writing to the stats
+ * file clears it.
+ *
+ * Without device tree the adapters are created from the "sensor" parameter:
+ *   insmod vvcam-i2c-sim.ko sensor=ar0144,ov5647 instantiate=1
+ * With device tree a "nxp,vvcam-i2c-sim" node with a "sensor" property
+ * becomes the adapter and its child nodes the sensor clients.
+ */
+
+#include <linux/bitmap.h>
+#include <linux/debugfs.h>
+#include <linux/delay.h>
+#include <linux/i2c.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/version.h>
+#include <linux/vmalloc.h>
+
+#define VVI2C_NAME		"vvcam-i2c-sim"
+#define VVI2C_REG_SPACE		0x10000
+#define VVI2C_MAX_SENSORS	4
+
+static char *sensor = "ar0144";
+module_param(sensor, charp, 0444);
+MODULE_PARM_DESC(sensor, "comma separated emulated sensors: ar0144, imx219, ov5647");
+
+static bool instantiate = true;
+module_param(instantiate, bool, 0444);
+MODULE_PARM_DESC(instantiate, "create the sensor i2c client on adapters without device tree");
+
+static unsigned int bus_khz;
+module_param(bus_khz, uint, 0644);
+MODULE_PARM_DESC(bus_khz, "delay each transfer by its bus time at this clock in kHz, 0 disables");
+
+/* flag bit inside one register byte */
+struct vvi2c_bit {
+	u16 addr;
+	u8 mask;
+};
+
+struct vvi2c_sensor_desc {
+	const char *name;
+	u16 i2c_addr;
+	u16 chip_id_reg;
+	u8 chip_id_len;
+	u32 chip_id;
+	struct vvi2c_bit stream;
+	struct vvi2c_bit reset;
+	struct vvi2c_bit hold;
+	/* OV style group hold: 0x0n starts, 0xan launches group n */
+	bool ov_group_hold;
+};
+
+/* 16-bit ar0144 registers are two bytes, most significant first */
+static const struct vvi2c_sensor_desc vvi2c_sensors[] = {
+	{
+		.name        = "ar0144",
+		.i2c_addr    = 0x10,
+		.chip_id_reg = 0x3000,
+		.chip_id_len = 2,
+		.chip_id     = 0x0356,
+		.stream      = { 0x301B, 0x04 },
+		.reset       = { 0x301B, 0x01 },
+		.hold        = { 0x3022, 0x01 },
+	},
+	{
+		.name        = "imx219",
+		.i2c_addr    = 0x10,
+		.chip_id_reg = 0x0000,
+		.chip_id_len = 2,
+		.chip_id     = 0x0219,
+		.stream      = { 0x0100, 0x01 },
+		.reset       = { 0x0103, 0x01 },
+		.hold        = { 0x0104, 0x01 },
+	},
+	{
+		.name          = "ov5647",
+		.i2c_addr      = 0x36,
+		.chip_id_reg   = 0x300a,
+		.chip_id_len   = 2,
+		.chip_id       = 0x5647,
+		.stream        = { 0x0100, 0x01 },
+		.reset         = { 0x0103, 0x01 },
+		.hold          = { 0x3208, 0xff },
+		.ov_group_hold = true,
+	},
+};
+
+struct vvi2c_stats {
+	u64 transfers;
+	u64 messages;
+	u64 write_bytes;
+	u64 read_bytes;
+	u64 nacks;
+	u64 held_writes;
+	u64 group_launches;
+	u64 stream_switches;
+	u64 resets;
+	u64 cycles;
+};
+
+struct vvi2c {
+	const struct vvi2c_sensor_desc *desc;
+	struct i2c_adapter adap;
+	struct i2c_client *client;
+	struct dentry *debugfs;
+	struct debugfs_blob_wrapper regs_blob;
+
+	struct mutex lock;
+	u8 *regs;
+	u8 *shadow;
+	unsigned long *dirty;
+	u16 ptr;
+	bool held;
+	bool streaming;
+	struct vvi2c_stats stats;
+};
+
+static struct dentry *vvi2c_debugfs_root;
+
+static const struct vvi2c_sensor_desc *vvi2c_find_sensor(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(vvi2c_sensors); i++) {
+		if (sysfs_streq(vvi2c_sensors[i].name, name))
+			return &vvi2c_sensors[i];
+	}
+	return NULL;
+}
+
+static void vvi2c_reset(struct vvi2c *sim)
+{
+	const struct vvi2c_sensor_desc *desc = sim->desc;
+	int i;
+
+	memset(sim->regs, 0, VVI2C_REG_SPACE);
+	bitmap_zero(sim->dirty, VVI2C_REG_SPACE);
+	for (i = 0; i < desc->chip_id_len; i++)
+		sim->regs[desc->chip_id_reg + i] =
+			desc->chip_id >> (8 * (desc->chip_id_len - 1 - i));
+	sim->held = false;
+	sim->streaming = false;
+}
+
+static void vvi2c_store(struct vvi2c *sim, u16 addr, u8 val)
+{
+	const struct vvi2c_sensor_desc *desc = sim->desc;
+	bool on;
+
+	sim->regs[addr] = val;
+
+	if (addr == desc->reset.addr && (val & desc->reset.mask)) {
+		sim->stats.resets++;
+		vvi2c_reset(sim);
+		return;
+	}
+
+	if (addr == desc->stream.addr) {
+		on = !!(val & desc->stream.mask);
+		if (on != sim->streaming)
+			sim->stats.stream_switches++;
+		sim->streaming = on;
+	}
+}
+
+static void vvi2c_launch_group(struct vvi2c *sim)
+{
+	unsigned long addr;
+
+	sim->held = false;
+	for_each_set_bit(addr, sim->dirty, VVI2C_REG_SPACE)
+		vvi2c_store(sim, addr, sim->shadow[addr]);
+	bitmap_zero(sim->dirty, VVI2C_REG_SPACE);
+	sim->stats.group_launches++;
+}
+
+static void vvi2c_write_hold(struct vvi2c *sim, u8 val)
+{
+	const struct vvi2c_sensor_desc *desc = sim->desc;
+
+	sim->regs[desc->hold.addr] = val;
+
+	if (desc->ov_group_hold) {
+		/* 0x0n: record group n, 0x1n: end recording, 0xan: launch */
+		if ((val & 0xf0) == 0x00)
+			sim->held = true;
+		else if ((val & 0xf0) == 0xa0 && sim->held)
+			vvi2c_launch_group(sim);
+		return;
+	}
+
+	if (val & desc->hold.mask)
+		sim->held = true;
+	else if (sim->held)
+		vvi2c_launch_group(sim);
+}
+
+static void vvi2c_write_byte(struct vvi2c *sim, u16 addr, u8 val)
+{
+	const struct vvi2c_sensor_desc *desc = sim->desc;
+
+	/* chip id is read only */
+	if (addr >= desc->chip_id_reg &&
+	    addr < desc->chip_id_reg + desc->chip_id_len)
+		return;
+
+	if (addr == desc->hold.addr) {
+		vvi2c_write_hold(sim, val);
+		return;
+	}
+
+	if (sim->held) {
+		sim->shadow[addr] = val;
+		set_bit(addr, sim->dirty);
+		sim->stats.held_writes++;
+		return;
+	}
+
+	vvi2c_store(sim, addr, val);
+}
+
+static u64 vvi2c_bus_ns(u64 cycles, unsigned int khz)
+{
+	return div_u64(cycles * 1000000, khz);
+}
+
+static int vvi2c_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs, int num)
+{
+	struct vvi2c *sim = i2c_get_adapdata(adap);
+	u64 cycles = 0;
+	int i, j, ret = num;
+	u64 ns;
+
+	mutex_lock(&sim->lock);
+	for (i = 0; i < num; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		/* start or repeated start, then 9 clocks per byte with ack */
+		cycles += 1 + 9;
+		if (msg->addr != sim->desc->i2c_addr) {
+			sim->stats.nacks++;
+			ret = -ENXIO;
+			break;
+		}
+		cycles += 9 * msg->len;
+
+		if (msg->flags & I2C_M_RD) {
+			for (j = 0; j < msg->len; j++)
+				msg->buf[j] = sim->regs[sim->ptr++];
+			sim->stats.read_bytes += msg->len;
+			continue;
+		}
+
+		sim->stats.write_bytes += msg->len;
+		if (msg->len < 2)
+			continue;
+		sim->ptr = (msg->buf[0] << 8) | msg->buf[1];
+		for (j = 2; j < msg->len; j++)
+			vvi2c_write_byte(sim, sim->ptr++, msg->buf[j]);
+	}
+	/* stop */
+	cycles += 1;
+
+	sim->stats.transfers++;
+	sim->stats.messages += i;
+	sim->stats.cycles += cycles;
+	mutex_unlock(&sim->lock);
+
+	if (bus_khz) {
+		ns = vvi2c_bus_ns(cycles, bus_khz);
+		if (ns >= 20000)
+			usleep_range(div_u64(ns, 1000), div_u64(ns, 1000) + 10);
+		else
+			ndelay(ns);
+	}
+
+	return ret;
+}
+
+static u32 vvi2c_func(struct i2c_adapter *adap)
+{
+	return I2C_FUNC_I2C;
+}
+
+static const struct i2c_algorithm vvi2c_algo = {
+	.master_xfer   = vvi2c_xfer,
+	.functionality = vvi2c_func,
+};
+
+static int vvi2c_stats_show(struct seq_file *m, void *v)
+{
+	struct vvi2c *sim = m->private;
+	struct vvi2c_stats s;
+
+	mutex_lock(&sim->lock);
+	s = sim->stats;
+	mutex_unlock(&sim->lock);
+
+	seq_printf(m, "sensor:           %s@0x%02x\n",
+		   sim->desc->name, sim->desc->i2c_addr);
+	seq_printf(m, "transfers:        %llu\n", s.transfers);
+	seq_printf(m, "messages:         %llu\n", s.messages);
+	seq_printf(m, "write bytes:      %llu\n", s.write_bytes);
+	seq_printf(m, "read bytes:       %llu\n", s.read_bytes);
+	seq_printf(m, "nacks:            %llu\n", s.nacks);
+	seq_printf(m, "held writes:      %llu\n", s.held_writes);
+	seq_printf(m, "group launches:   %llu\n", s.group_launches);
+	seq_printf(m, "stream switches:  %llu\n", s.stream_switches);
+	seq_printf(m, "soft resets:      %llu\n", s.resets);
+	seq_printf(m, "bus cycles:       %llu\n", s.cycles);
+	seq_printf(m, "bus time 100kHz:  %llu us\n",
+		   div_u64(vvi2c_bus_ns(s.cycles, 100), 1000));
+	seq_printf(m, "bus time 400kHz:  %llu us\n",
+		   div_u64(vvi2c_bus_ns(s.cycles, 400), 1000));
+	seq_printf(m, "bus time 1MHz:    %llu us\n",
+		   div_u64(vvi2c_bus_ns(s.cycles, 1000), 1000));
+	return 0;
+}
+
+static int vvi2c_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, vvi2c_stats_show, inode->i_private);
+}
+
+static ssize_t vvi2c_stats_write(struct file *file, const char __user *buf,
+				 size_t count, loff_t *ppos)
+{
+	struct vvi2c *sim = file_inode(file)->i_private;
+
+	mutex_lock(&sim->lock);
+	memset(&sim->stats, 0, sizeof(sim->stats));
+	mutex_unlock(&sim->lock);
+	return count;
+}
+
+static const struct file_operations vvi2c_stats_fops = {
+	.owner   = THIS_MODULE,
+	.open    = vvi2c_stats_open,
+	.read    = seq_read,
+	.write   = vvi2c_stats_write,
+	.llseek  = seq_lseek,
+	.release = single_release,
+};
+
+static int vvi2c_probe(struct platform_device *pdev)
+{
+	struct device *dev = &pdev->dev;
+	struct i2c_board_info info = { };
+	const char *name = NULL;
+	struct vvi2c *sim;
+	int ret;
+
+	if (dev->of_node)
+		of_property_read_string(dev->of_node, "sensor", &name);
+	else
+		name = dev_get_platdata(dev);
+
+	sim = devm_kzalloc(dev, sizeof(*sim), GFP_KERNEL);
+	if (!sim)
+		return -ENOMEM;
+	sim->desc = name ? vvi2c_find_sensor(name) : NULL;
+	if (!sim->desc) {
+		dev_err(dev, "unknown sensor %s\n", name ? name : "(none)");
+		return -EINVAL;
+	}
+
+	sim->regs = vzalloc(VVI2C_REG_SPACE);
+	sim->shadow = vzalloc(VVI2C_REG_SPACE);
+	sim->dirty = bitmap_zalloc(VVI2C_REG_SPACE, GFP_KERNEL);
+	if (!sim->regs || !sim->shadow || !sim->dirty) {
+		ret = -ENOMEM;
+		goto probe_err_free;
+	}
+	mutex_init(&sim->lock);
+	vvi2c_reset(sim);
+
+	sim->adap.owner = THIS_MODULE;
+	sim->adap.algo = &vvi2c_algo;
+	sim->adap.dev.parent = dev;
+	sim->adap.dev.of_node = dev->of_node;
+	snprintf(sim->adap.name, sizeof(sim->adap.name), "%s %s",
+		 VVI2C_NAME, sim->desc->name);
+	i2c_set_adapdata(&sim->adap, sim);
+	ret = i2c_add_adapter(&sim->adap);
+	if (ret < 0)
+		goto probe_err_free;
+
+	sim->debugfs = debugfs_create_dir(dev_name(dev), vvi2c_debugfs_root);
+	debugfs_create_file("stats", 0644, sim->debugfs, sim,
+			    &vvi2c_stats_fops);
+	sim->regs_blob.data = sim->regs;
+	sim->regs_blob.size = VVI2C_REG_SPACE;
+	debugfs_create_blob("regs", 0444, sim->debugfs, &sim->regs_blob);
+
+	/* with device tree the child nodes are the clients */
+	if (!dev->of_node && instantiate) {
+		strscpy(info.type, sim->desc->name, sizeof(info.type));
+		info.addr = sim->desc->i2c_addr;
+		sim->client = i2c_new_client_device(&sim->adap, &info);
+		if (IS_ERR(sim->client)) {
+			dev_warn(dev, "failed to create %s client\n",
+				 sim->desc->name);
+			sim->client = NULL;
+		}
+	}
+
+	platform_set_drvdata(pdev, sim);
+	dev_info(dev, "emulating %s on %s\n", sim->desc->name,
+		 dev_name(&sim->adap.dev));
+	return 0;
+
+probe_err_free:
+	bitmap_free(sim->dirty);
+	vfree(sim->shadow);
+	vfree(sim->regs);
+	return ret;
+}
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6, 11, 0)
+static int vvi2c_remove(struct platform_device *pdev)
+#else
+static void vvi2c_remove(struct platform_device *pdev)
+#endif
+{
+	struct vvi2c *sim = platform_get_drvdata(pdev);
+
+	debugfs_remove_recursive(sim->debugfs);
+	if (sim->client)
+		i2c_unregister_device(sim->client);
+	i2c_del_adapter(&sim->adap);
+	mutex_destroy(&sim->lock);
+	bitmap_free(sim->dirty);
+	vfree(sim->shadow);
+	vfree(sim->regs);
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6, 11, 0)
+	return 0;
+#endif
+}
+
+static const struct of_device_id vvi2c_of_match[] = {
+	{ .compatible = "nxp,vvcam-i2c-sim" },
+	{ /* sentinel */ }
+};
+MODULE_DEVICE_TABLE(of, vvi2c_of_match);
+
+static struct platform_driver vvi2c_driver = {
+	.driver = {
+		.name = VVI2C_NAME,
+		.of_match_table = vvi2c_of_match,
+	},
+	.probe  = vvi2c_probe,
+	.remove = vvi2c_remove,
+};
+
+static struct platform_device *vvi2c_pdevs[VVI2C_MAX_SENSORS];
+
+static void vvi2c_unregister_devices(void)
+{
+	int i;
+
+	for (i = 0; i < VVI2C_MAX_SENSORS; i++) {
+		if (vvi2c_pdevs[i])
+			platform_device_unregister(vvi2c_pdevs[i]);
+		vvi2c_pdevs[i] = NULL;
+	}
+}
+
+static int __init vvi2c_init(void)
+{
+	char *list, *cur, *name;
+	int i = 0, ret;
+
+	vvi2c_debugfs_root = debugfs_create_dir(VVI2C_NAME, NULL);
+
+	ret = platform_driver_register(&vvi2c_driver);
+	if (ret < 0)
+		goto init_err_debugfs;
+
+	list = kstrdup(sensor, GFP_KERNEL);
+	if (!list) {
+		ret = -ENOMEM;
+		goto init_err_driver;
+	}
+
+	cur = list;
+	while ((name = strsep(&cur, ",")) && i < VVI2C_MAX_SENSORS) {
+		if (!*name)
+			continue;
+		if (!vvi2c_find_sensor(name)) {
+			pr_err("%s: unknown sensor %s\n", VVI2C_NAME, name);
+			ret = -EINVAL;
+			break;
+		}
+		vvi2c_pdevs[i] = platform_device_register_data(NULL,
+				VVI2C_NAME, i, name, strlen(name) + 1);
+		if (IS_ERR(vvi2c_pdevs[i])) {
+			ret = PTR_ERR(vvi2c_pdevs[i]);
+			vvi2c_pdevs[i] = NULL;
+			break;
+		}
+		i++;
+	}
+	kfree(list);
+	if (ret < 0)
+		goto init_err_devices;
+	return 0;
+
+init_err_devices:
+	vvi2c_unregister_devices();
+init_err_driver:
+	platform_driver_unregister(&vvi2c_driver);
+init_err_debugfs:
+	debugfs_remove_recursive(vvi2c_debugfs_root);
+	return ret;
+}
+
+static void __exit vvi2c_exit(void)
+{
+	vvi2c_unregister_devices();
+	platform_driver_unregister(&vvi2c_driver);
+	debugfs_remove_recursive(vvi2c_debugfs_root);
+}
+
+module_init(vvi2c_init);
+module_exit(vvi2c_exit);
+MODULE_DESCRIPTION("I2C register emulators for vvcam sensors");
+MODULE_LICENSE("GPL");
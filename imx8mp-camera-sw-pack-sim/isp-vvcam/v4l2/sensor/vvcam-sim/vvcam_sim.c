@@ -0,0 +1,1140 @@
+/*
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+/*
+ * Simulated vvcam sensor.
+ *
+ * Registers a vvcam sensor subdev that answers the same VVSENSORIOC_*
+ * ioctls as the ar0144, imx219 and ov5647 drivers, using their generated
+ * mode tables. Sensor registers are kept in a register file; frame length,
+ * exposure and streaming registers drive a frame clock that emits
+ * V4L2_EVENT_FRAME_SYNC on the subdev node and, when enabled, fills
+ * synthetic RAW frames on a video capture node.
+ *
+ * No hardware is needed, so the ISI drivers and latency tests run on any
+ * machine:
+ *   insmod vvcam-sim.ko sensor=imx219 capture=1
+ */
+
+#include <linux/delay.h>
+#include <linux/hrtimer.h>
+#include <linux/kthread.h>
+#include <linux/module.h>
+#include <linux/platform_device.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/version.h>
+#include <linux/vmalloc.h>
+#include <media/v4l2-device.h>
+#include <media/v4l2-event.h>
+#include <media/v4l2-ioctl.h>
+#include <media/v4l2-subdev.h>
+#include <media/videobuf2-v4l2.h>
+#include <media/videobuf2-vmalloc.h>
+#include "vvsensor.h"
+
+#include "ar0144_modes.h"
+#include "imx219_modes.h"
+#include "ov5647_modes.h"
+
+#define VVSIM_NAME		"vvcam-sim"
+#define VVSIM_REG_COUNT		0x10000
+#define VVSIM_SENS_PADS_NUM	1
+#define VVSIM_MCLK		24000000
+
+static char *sensor = "ar0144";
+module_param(sensor, charp, 0444);
+MODULE_PARM_DESC(sensor, "emulated sensor: ar0144, imx219 or ov5647");
+
+static bool capture = true;
+module_param(capture, bool, 0444);
+MODULE_PARM_DESC(capture, "register a capture node with synthetic RAW frames");
+
+/* value spread over one or more registers, most significant first */
+struct vvsim_reg_field {
+	u16 addr;
+	u8 count;
+	u8 shift;	/* fractional bits below the value */
+};
+
+struct vvsim_sensor_desc {
+	const char *name;
+	u32 chip_id;
+	struct vvsim_reg_field chip_id_reg;
+	u8 id_size;	/* bytes returned by G_CHIP_ID/G_RESERVE_ID */
+	u32 reserve_id;
+	u8 data_bytes;	/* register width */
+	struct vvcam_mode_info_s *modes;
+	u32 mode_count;
+	u64 csi_max_pixel_clk;
+	struct vvsim_reg_field frame_length;
+	struct vvsim_reg_field exposure;
+	u16 stream_reg;
+	u16 stream_mask;
+};
+
+static const struct vvsim_sensor_desc vvsim_sensors[] = {
+	{
+		.name              = "ar0144",
+		.chip_id           = 0x0356,
+		.chip_id_reg       = { 0x3000, 1, 0 },
+		.id_size           = 2,
+		.reserve_id        = 0x2770,
+		.data_bytes        = 2,
+		.modes             = par0144_mode_info,
+		.mode_count        = ARRAY_SIZE(par0144_mode_info),
+		.csi_max_pixel_clk = AR0144_CSI_MAX_PIXEL_CLK,
+		.frame_length      = { 0x300A, 1, 0 },
+		.exposure          = { 0x3012, 1, 0 },
+		.stream_reg        = 0x301A,
+		.stream_mask       = 0x0004,
+	},
+	{
+		.name              = "imx219",
+		.chip_id           = 0x0219,
+		.chip_id_reg       = { 0x0000, 2, 0 },
+		.id_size           = 4,
+		.reserve_id        = 0x0219,
+		.data_bytes        = 1,
+		.modes             = pimx219_mode_info,
+		.mode_count        = ARRAY_SIZE(pimx219_mode_info),
+		.csi_max_pixel_clk = IMX219_CSI_MAX_PIXEL_CLK,
+		.frame_length      = { 0x0160, 2, 0 },
+		.exposure          = { 0x015a, 2, 0 },
+		.stream_reg        = 0x0100,
+		.stream_mask       = 0x01,
+	},
+	{
+		.name              = "ov5647",
+		.chip_id           = 0x5647,
+		.chip_id_reg       = { 0x300a, 2, 0 },
+		.id_size           = 4,
+		.reserve_id        = 0x5647,
+		.data_bytes        = 1,
+		.modes             = pov5647_mode_info,
+		.mode_count        = ARRAY_SIZE(pov5647_mode_info),
+		.csi_max_pixel_clk = OV5647_CSI_MAX_PIXEL_CLK,
+		.frame_length      = { 0x380e, 2, 0 },
+		.exposure          = { 0x3500, 3, 4 },
+		.stream_reg        = 0x0100,
+		.stream_mask       = 0x01,
+	},
+};
+
+struct vvsim_format {
+	u32 bayer_pattern;
+	u32 bit_width;
+	u32 code;
+	u32 fourcc;
+};
+
+static const struct vvsim_format vvsim_formats[] = {
+	{BAYER_RGGB,  8, MEDIA_BUS_FMT_SRGGB8_1X8,   V4L2_PIX_FMT_SRGGB8},
+	{BAYER_RGGB, 10, MEDIA_BUS_FMT_SRGGB10_1X10, V4L2_PIX_FMT_SRGGB10},
+	{BAYER_RGGB, 12, MEDIA_BUS_FMT_SRGGB12_1X12, V4L2_PIX_FMT_SRGGB12},
+	{BAYER_GRBG,  8, MEDIA_BUS_FMT_SGRBG8_1X8,   V4L2_PIX_FMT_SGRBG8},
+	{BAYER_GRBG, 10, MEDIA_BUS_FMT_SGRBG10_1X10, V4L2_PIX_FMT_SGRBG10},
+	{BAYER_GRBG, 12, MEDIA_BUS_FMT_SGRBG12_1X12, V4L2_PIX_FMT_SGRBG12},
+	{BAYER_GBRG,  8, MEDIA_BUS_FMT_SGBRG8_1X8,   V4L2_PIX_FMT_SGBRG8},
+	{BAYER_GBRG, 10, MEDIA_BUS_FMT_SGBRG10_1X10, V4L2_PIX_FMT_SGBRG10},
+	{BAYER_GBRG, 12, MEDIA_BUS_FMT_SGBRG12_1X12, V4L2_PIX_FMT_SGBRG12},
+	{BAYER_BGGR,  8, MEDIA_BUS_FMT_SBGGR8_1X8,   V4L2_PIX_FMT_SBGGR8},
+	{BAYER_BGGR, 10, MEDIA_BUS_FMT_SBGGR10_1X10, V4L2_PIX_FMT_SBGGR10},
+	{BAYER_BGGR, 12, MEDIA_BUS_FMT_SBGGR12_1X12, V4L2_PIX_FMT_SBGGR12},
+};
+
+/* colour bars: white, yellow, cyan, green, magenta, red, blue, black */
+static const u8 vvsim_bars[8][3] = {
+	{1, 1, 1}, {1, 1, 0}, {0, 1, 1}, {0, 1, 0},
+	{1, 0, 1}, {1, 0, 0}, {0, 0, 1}, {0, 0, 0},
+};
+
+struct vvsim_buffer {
+	struct vb2_v4l2_buffer vb;
+	struct list_head list;
+};
+
+struct vvsim {
+	const struct vvsim_sensor_desc *desc;
+	struct v4l2_device v4l2_dev;
+	struct v4l2_subdev subdev;
+	struct media_pad pads[VVSIM_SENS_PADS_NUM];
+	struct v4l2_mbus_framefmt format;
+	vvcam_mode_info_t cur_mode;
+	struct mutex lock;
+	u32 stream_status;
+	u32 gain;
+	u32 test_pattern;
+
+	/* register file, accessed by the frame thread as well */
+	spinlock_t reg_lock;
+	u16 *regs;
+
+	/* frame clock */
+	struct task_struct *frame_thread;
+	u32 sequence;
+
+	/* capture node */
+	struct video_device vdev;
+	struct vb2_queue queue;
+	struct mutex queue_lock;
+	spinlock_t buf_lock;
+	struct list_head buf_list;
+	const struct vvsim_format *fmt;
+	u32 bytesperline;
+	u32 sizeimage;
+	u8 *row_buf;
+};
+
+static inline struct vvsim *to_vvsim(struct v4l2_subdev *sd)
+{
+	return container_of(sd, struct vvsim, subdev);
+}
+
+static const struct vvsim_format *vvsim_find_format(
+	const struct vvcam_mode_info_s *mode)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(vvsim_formats); i++) {
+		if (vvsim_formats[i].bayer_pattern == mode->bayer_pattern &&
+		    vvsim_formats[i].bit_width == mode->bit_width)
+			return &vvsim_formats[i];
+	}
+	return NULL;
+}
+
+/* colour channel (0 R, 1 G, 2 B) of a pixel in the mode's bayer pattern */
+static u32 vvsim_cfa(u32 bayer_pattern, u32 y, u32 x)
+{
+	u32 pos = ((y & 1) << 1) | (x & 1);
+
+	switch (bayer_pattern) {
+	case BAYER_RGGB:
+		return pos == 0 ? 0 : (pos == 3 ? 2 : 1);
+	case BAYER_GRBG:
+		return pos == 1 ? 0 : (pos == 2 ? 2 : 1);
+	case BAYER_GBRG:
+		return pos == 2 ? 0 : (pos == 1 ? 2 : 1);
+	case BAYER_BGGR:
+	default:
+		return pos == 3 ? 0 : (pos == 0 ? 2 : 1);
+	}
+}
+
+/* caller holds reg_lock */
+static u32 vvsim_read_field(struct vvsim *sim, const struct vvsim_reg_field *f)
+{
+	u32 val = 0;
+	int i;
+
+	for (i = 0; i < f->count; i++)
+		val = (val << (8 * sim->desc->data_bytes)) |
+		      sim->regs[(u16)(f->addr + i)];
+	return val >> f->shift;
+}
+
+/* caller holds reg_lock */
+static void vvsim_write_field(struct vvsim *sim,
+			      const struct vvsim_reg_field *f, u32 val)
+{
+	u32 bits = 8 * sim->desc->data_bytes;
+	u32 mask = (1 << bits) - 1;
+	int i;
+
+	val <<= f->shift;
+	for (i = f->count - 1; i >= 0; i--) {
+		sim->regs[(u16)(f->addr + i)] = val & mask;
+		val >>= bits;
+	}
+}
+
+static void vvsim_reset_regs(struct vvsim *sim)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&sim->reg_lock, flags);
+	memset(sim->regs, 0, VVSIM_REG_COUNT * sizeof(u16));
+	vvsim_write_field(sim, &sim->desc->chip_id_reg, sim->desc->chip_id);
+	vvsim_write_field(sim, &sim->desc->frame_length,
+			  sim->cur_mode.ae_info.def_frm_len_lines);
+	spin_unlock_irqrestore(&sim->reg_lock, flags);
+}
+
+static void vvsim_fill_frame(struct vvsim *sim, u32 exp_lines)
+{
+	const struct vvcam_mode_info_s *mode = &sim->cur_mode;
+	u32 width = mode->size.width;
+	u32 height = mode->size.height;
+	u32 bpl = sim->bytesperline;
+	u32 max_val = (1 << mode->bit_width) - 1;
+	u32 max_int = max_t(u32, mode->ae_info.max_integration_line, 1);
+	struct vvsim_buffer *buf;
+	unsigned long flags;
+	u64 level;
+	u32 x, y, v;
+	u8 *vaddr;
+
+	spin_lock_irqsave(&sim->buf_lock, flags);
+	buf = list_first_entry_or_null(&sim->buf_list,
+				       struct vvsim_buffer, list);
+	if (buf)
+		list_del(&buf->list);
+	spin_unlock_irqrestore(&sim->buf_lock, flags);
+	if (!buf)
+		return;
+
+	/* half scale at full integration time and unity gain */
+	if (sim->test_pattern) {
+		level = max_val;
+	} else {
+		level = div64_u64((u64)max_val * exp_lines * sim->gain,
+				  ((u64)2 * max_int) << SENSOR_FIX_FRACBITS);
+		level = min_t(u64, level, max_val);
+	}
+
+	for (y = 0; y < 2; y++) {
+		u8 *row = sim->row_buf + y * bpl;
+
+		for (x = 0; x < width; x++) {
+			v = vvsim_bars[x * 8 / width]
+				[vvsim_cfa(mode->bayer_pattern, y, x)] ?
+				level : 0;
+			if (mode->bit_width == 8)
+				row[x] = v;
+			else
+				((__le16 *)row)[x] = cpu_to_le16(v);
+		}
+	}
+
+	vaddr = vb2_plane_vaddr(&buf->vb.vb2_buf, 0);
+	for (y = 0; y < height; y++)
+		memcpy(vaddr + y * bpl, sim->row_buf + (y & 1) * bpl, bpl);
+
+	vb2_set_plane_payload(&buf->vb.vb2_buf, 0, sim->sizeimage);
+	buf->vb.sequence = sim->sequence;
+	buf->vb.field = V4L2_FIELD_NONE;
+	buf->vb.vb2_buf.timestamp = ktime_get_ns();
+	vb2_buffer_done(&buf->vb.vb2_buf, VB2_BUF_STATE_DONE);
+}
+
+/*
+ * Start of a frame: latch frame length and exposure as the sensor does at
+ * the frame boundary, signal frame sync and fill a capture buffer.
+ * Returns the frame time in ns.
+ */
+static u64 vvsim_frame_start(struct vvsim *sim)
+{
+	struct vvcam_sensor_ae_info_s *ae = &sim->cur_mode.ae_info;
+	struct v4l2_event ev = {
+		.type = V4L2_EVENT_FRAME_SYNC,
+	};
+	u32 margin = ae->def_frm_len_lines - ae->max_integration_line;
+	u32 frame_lines, exp_lines;
+	unsigned long flags;
+
+	spin_lock_irqsave(&sim->reg_lock, flags);
+	frame_lines = vvsim_read_field(sim, &sim->desc->frame_length);
+	exp_lines = vvsim_read_field(sim, &sim->desc->exposure);
+	spin_unlock_irqrestore(&sim->reg_lock, flags);
+
+	if (frame_lines == 0)
+		frame_lines = ae->def_frm_len_lines;
+	/* a long exposure stretches the frame */
+	frame_lines = max(frame_lines, exp_lines + margin);
+
+	ev.u.frame_sync.frame_sequence = sim->sequence;
+	v4l2_event_queue(sim->subdev.devnode, &ev);
+
+	if (capture)
+		vvsim_fill_frame(sim, exp_lines);
+	sim->sequence++;
+
+	return (u64)frame_lines * ae->one_line_exp_time_ns;
+}
+
+static int vvsim_frame_thread(void *data)
+{
+	struct vvsim *sim = data;
+	ktime_t next = ktime_get();
+	u64 frame_ns;
+
+	while (!kthread_should_stop()) {
+		frame_ns = vvsim_frame_start(sim);
+		next = ktime_add_ns(next, frame_ns);
+		/* resync when more than a frame late */
+		if (ktime_before(ktime_add_ns(next, frame_ns), ktime_get()))
+			next = ktime_get();
+
+		set_current_state(TASK_INTERRUPTIBLE);
+		if (!kthread_should_stop())
+			schedule_hrtimeout(&next, HRTIMER_MODE_ABS);
+		__set_current_state(TASK_RUNNING);
+	}
+
+	return 0;
+}
+
+/* start/stop the frame clock following the stream register, under lock */
+static int vvsim_update_stream(struct vvsim *sim)
+{
+	unsigned long flags;
+	u32 on;
+
+	spin_lock_irqsave(&sim->reg_lock, flags);
+	on = !!(sim->regs[sim->desc->stream_reg] & sim->desc->stream_mask);
+	spin_unlock_irqrestore(&sim->reg_lock, flags);
+
+	if (on && !sim->frame_thread) {
+		sim->sequence = 0;
+		sim->frame_thread = kthread_run(vvsim_frame_thread, sim,
+						"%s-sim", sim->desc->name);
+		if (IS_ERR(sim->frame_thread)) {
+			int ret = PTR_ERR(sim->frame_thread);
+
+			sim->frame_thread = NULL;
+			return ret;
+		}
+	} else if (!on && sim->frame_thread) {
+		kthread_stop(sim->frame_thread);
+		sim->frame_thread = NULL;
+	}
+
+	sim->stream_status = on;
+	return 0;
+}
+
+static int vvsim_write_reg(struct vvsim *sim, u16 reg, u32 val)
+{
+	const struct vvsim_reg_field *id = &sim->desc->chip_id_reg;
+	u32 mask = sim->desc->data_bytes == 1 ? 0xff : 0xffff;
+	unsigned long flags;
+
+	/* chip id registers are read only */
+	if (reg >= id->addr && reg < id->addr + id->count)
+		return 0;
+
+	spin_lock_irqsave(&sim->reg_lock, flags);
+	sim->regs[reg] = val & mask;
+	spin_unlock_irqrestore(&sim->reg_lock, flags);
+
+	if (reg == sim->desc->stream_reg)
+		return vvsim_update_stream(sim);
+	return 0;
+}
+
+static u32 vvsim_read_reg(struct vvsim *sim, u16 reg)
+{
+	unsigned long flags;
+	u32 val;
+
+	spin_lock_irqsave(&sim->reg_lock, flags);
+	val = sim->regs[reg];
+	spin_unlock_irqrestore(&sim->reg_lock, flags);
+	return val;
+}
+
+static int vvsim_write_array(struct vvsim *sim,
+			     struct vvcam_sccb_data_s *reg_arry, u32 size)
+{
+	int ret;
+	u32 i;
+
+	for (i = 0; i < size; i++) {
+		/* table terminator */
+		if (reg_arry[i].addr == 0xffff)
+			break;
+		ret = vvsim_write_reg(sim, reg_arry[i].addr, reg_arry[i].data);
+		if (ret < 0)
+			return ret;
+	}
+	return 0;
+}
+
+static void vvsim_update_format(struct vvsim *sim)
+{
+	const struct vvcam_mode_info_s *mode = &sim->cur_mode;
+
+	sim->fmt = vvsim_find_format(mode);
+	sim->bytesperline = mode->size.width * (mode->bit_width > 8 ? 2 : 1);
+	sim->sizeimage = sim->bytesperline * mode->size.height;
+
+	sim->format.width = mode->size.bounds_width;
+	sim->format.height = mode->size.bounds_height;
+	sim->format.code = sim->fmt ? sim->fmt->code : 0;
+	sim->format.field = V4L2_FIELD_NONE;
+	sim->format.colorspace = V4L2_COLORSPACE_RAW;
+}
+
+static int vvsim_get_clk(struct vvsim *sim, void *clk)
+{
+	struct vvcam_clk_s vvcam_clk;
+
+	vvcam_clk.sensor_mclk = VVSIM_MCLK;
+	vvcam_clk.csi_max_pixel_clk = sim->desc->csi_max_pixel_clk;
+	if (copy_to_user(clk, &vvcam_clk, sizeof(struct vvcam_clk_s)))
+		return -EINVAL;
+	return 0;
+}
+
+static int vvsim_query_capability(struct vvsim *sim, void *arg)
+{
+	struct v4l2_capability *pcap = (struct v4l2_capability *)arg;
+
+	strscpy((char *)pcap->driver, sim->desc->name, sizeof(pcap->driver));
+	sprintf((char *)pcap->bus_info, "csi%d", 0);
+	pcap->bus_info[VVCAM_CAP_BUS_INFO_I2C_ADAPTER_NR_POS] = 0xFF;
+	return 0;
+}
+
+static int vvsim_query_supports(struct vvsim *sim, void *parry)
+{
+	struct vvcam_mode_info_array_s *psensor_mode_arry = parry;
+	u32 count = sim->desc->mode_count;
+	int ret;
+
+	ret = copy_to_user(&psensor_mode_arry->count, &count, sizeof(count));
+	ret |= copy_to_user(&psensor_mode_arry->modes, sim->desc->modes,
+			    count * sizeof(struct vvcam_mode_info_s));
+	if (ret != 0)
+		return -ENOMEM;
+	return 0;
+}
+
+static int vvsim_get_id(struct vvsim *sim, void *pid, u32 id)
+{
+	if (copy_to_user(pid, &id, sim->desc->id_size))
+		return -ENOMEM;
+	return 0;
+}
+
+static int vvsim_get_sensor_mode(struct vvsim *sim, void *pmode)
+{
+	if (copy_to_user(pmode, &sim->cur_mode,
+			 sizeof(struct vvcam_mode_info_s)))
+		return -ENOMEM;
+	return 0;
+}
+
+static int vvsim_set_sensor_mode(struct vvsim *sim, void *pmode)
+{
+	struct vvcam_mode_info_s sensor_mode;
+	u32 i;
+
+	if (copy_from_user(&sensor_mode, pmode,
+			   sizeof(struct vvcam_mode_info_s)))
+		return -ENOMEM;
+
+	if (sim->stream_status || vb2_is_busy(&sim->queue))
+		return -EBUSY;
+
+	for (i = 0; i < sim->desc->mode_count; i++) {
+		if (sim->desc->modes[i].index == sensor_mode.index) {
+			memcpy(&sim->cur_mode, &sim->desc->modes[i],
+			       sizeof(struct vvcam_mode_info_s));
+			vvsim_update_format(sim);
+			return 0;
+		}
+	}
+	return -ENXIO;
+}
+
+static int vvsim_set_exp(struct vvsim *sim, u32 exp)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&sim->reg_lock, flags);
+	vvsim_write_field(sim, &sim->desc->exposure, exp);
+	spin_unlock_irqrestore(&sim->reg_lock, flags);
+	return 0;
+}
+
+static int vvsim_set_fps(struct vvsim *sim, u32 fps)
+{
+	struct vvcam_sensor_ae_info_s *ae = &sim->cur_mode.ae_info;
+	u32 margin = ae->def_frm_len_lines - ae->max_integration_line;
+	unsigned long flags;
+	u32 vts;
+
+	fps = clamp(fps, ae->min_fps, ae->max_fps);
+	if (fps == 0)
+		return -EINVAL;
+	vts = ae->max_fps * ae->def_frm_len_lines / fps;
+
+	spin_lock_irqsave(&sim->reg_lock, flags);
+	vvsim_write_field(sim, &sim->desc->frame_length, vts);
+	spin_unlock_irqrestore(&sim->reg_lock, flags);
+
+	ae->cur_fps = fps;
+	ae->curr_frm_len_lines = vts;
+	ae->max_integration_line = vts - margin;
+	return 0;
+}
+
+static int vvsim_set_test_pattern(struct vvsim *sim, void *arg)
+{
+	struct sensor_test_pattern_s test_pattern;
+
+	if (copy_from_user(&test_pattern, arg, sizeof(test_pattern)))
+		return -ENOMEM;
+	sim->test_pattern = test_pattern.enable;
+	return 0;
+}
+
+static int vvsim_set_stream(struct vvsim *sim, int enable)
+{
+	u32 val = vvsim_read_reg(sim, sim->desc->stream_reg);
+
+	if (enable)
+		val |= sim->desc->stream_mask;
+	else
+		val &= ~sim->desc->stream_mask;
+	return vvsim_write_reg(sim, sim->desc->stream_reg, val);
+}
+
+static int vvsim_s_stream(struct v4l2_subdev *sd, int enable)
+{
+	struct vvsim *sim = to_vvsim(sd);
+	int ret;
+
+	mutex_lock(&sim->lock);
+	ret = vvsim_set_stream(sim, enable);
+	mutex_unlock(&sim->lock);
+	return ret;
+}
+
+static int vvsim_s_power(struct v4l2_subdev *sd, int on)
+{
+	return 0;
+}
+
+static long vvsim_priv_ioctl(struct v4l2_subdev *sd,
+			     unsigned int cmd,
+			     void *arg)
+{
+	struct vvsim *sim = to_vvsim(sd);
+	struct vvcam_sccb_data_s sensor_reg;
+	u32 value = 0;
+	long ret = 0;
+
+	mutex_lock(&sim->lock);
+	switch (cmd) {
+	case VVSENSORIOC_S_POWER:
+	case VVSENSORIOC_S_CLK:
+	case VVSENSORIOC_S_HDR_RADIO:
+		break;
+	case VVSENSORIOC_RESET:
+		vvsim_set_stream(sim, 0);
+		vvsim_reset_regs(sim);
+		break;
+	case VVSENSORIOC_G_CLK:
+		ret = vvsim_get_clk(sim, arg);
+		break;
+	case VIDIOC_QUERYCAP:
+		ret = vvsim_query_capability(sim, arg);
+		break;
+	case VVSENSORIOC_QUERY:
+		ret = vvsim_query_supports(sim, arg);
+		break;
+	case VVSENSORIOC_G_CHIP_ID:
+		ret = vvsim_get_id(sim, arg, sim->desc->chip_id);
+		break;
+	case VVSENSORIOC_G_RESERVE_ID:
+		ret = vvsim_get_id(sim, arg, sim->desc->reserve_id);
+		break;
+	case VVSENSORIOC_G_SENSOR_MODE:
+		ret = vvsim_get_sensor_mode(sim, arg);
+		break;
+	case VVSENSORIOC_S_SENSOR_MODE:
+		ret = vvsim_set_sensor_mode(sim, arg);
+		break;
+	case VVSENSORIOC_S_STREAM:
+		ret = copy_from_user(&value, arg, sizeof(value));
+		ret |= vvsim_set_stream(sim, value);
+		break;
+	case VVSENSORIOC_WRITE_REG:
+		ret = copy_from_user(&sensor_reg, arg,
+			sizeof(struct vvcam_sccb_data_s));
+		ret |= vvsim_write_reg(sim, sensor_reg.addr, sensor_reg.data);
+		break;
+	case VVSENSORIOC_READ_REG:
+		ret = copy_from_user(&sensor_reg, arg,
+			sizeof(struct vvcam_sccb_data_s));
+		sensor_reg.data = vvsim_read_reg(sim, sensor_reg.addr);
+		ret |= copy_to_user(arg, &sensor_reg,
+			sizeof(struct vvcam_sccb_data_s));
+		break;
+	case VVSENSORIOC_S_EXP:
+	case VVSENSORIOC_S_VSEXP:
+		ret = copy_from_user(&value, arg, sizeof(value));
+		ret |= vvsim_set_exp(sim, value);
+		break;
+	case VVSENSORIOC_S_GAIN:
+	case VVSENSORIOC_S_VSGAIN:
+		/* gain encodings differ per sensor, keep the requested value */
+		ret = copy_from_user(&value, arg, sizeof(value));
+		sim->gain = value;
+		break;
+	case VVSENSORIOC_S_FPS:
+		ret = copy_from_user(&value, arg, sizeof(value));
+		ret |= vvsim_set_fps(sim, value);
+		break;
+	case VVSENSORIOC_G_FPS:
+		value = sim->cur_mode.ae_info.cur_fps;
+		ret = copy_to_user(arg, &value, sizeof(value));
+		break;
+	case VVSENSORIOC_S_TEST_PATTERN:
+		ret = vvsim_set_test_pattern(sim, arg);
+		break;
+	default:
+		break;
+	}
+	mutex_unlock(&sim->lock);
+
+	return ret;
+}
+
+static int vvsim_subscribe_event(struct v4l2_subdev *sd, struct v4l2_fh *fh,
+				 struct v4l2_event_subscription *sub)
+{
+	if (sub->type != V4L2_EVENT_FRAME_SYNC)
+		return -EINVAL;
+	return v4l2_event_subscribe(fh, sub, 4, NULL);
+}
+
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5, 12, 0)
+static int vvsim_enum_mbus_code(struct v4l2_subdev *sd,
+				struct v4l2_subdev_state *state,
+				struct v4l2_subdev_mbus_code_enum *code)
+#else
+static int vvsim_enum_mbus_code(struct v4l2_subdev *sd,
+				struct v4l2_subdev_pad_config *cfg,
+				struct v4l2_subdev_mbus_code_enum *code)
+#endif
+{
+	struct vvsim *sim = to_vvsim(sd);
+
+	if (code->pad || code->index > 0)
+		return -EINVAL;
+	code->code = sim->format.code;
+	return 0;
+}
+
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5, 12, 0)
+static int vvsim_set_fmt(struct v4l2_subdev *sd,
+			 struct v4l2_subdev_state *state,
+			 struct v4l2_subdev_format *fmt)
+#else
+static int vvsim_set_fmt(struct v4l2_subdev *sd,
+			 struct v4l2_subdev_pad_config *cfg,
+			 struct v4l2_subdev_format *fmt)
+#endif
+{
+	struct vvsim *sim = to_vvsim(sd);
+	int ret;
+
+	mutex_lock(&sim->lock);
+	if ((fmt->format.width != sim->cur_mode.size.bounds_width) ||
+	    (fmt->format.height != sim->cur_mode.size.bounds_height)) {
+		pr_err("%s:set sensor format %dx%d error\n",
+			__func__, fmt->format.width, fmt->format.height);
+		mutex_unlock(&sim->lock);
+		return -EINVAL;
+	}
+
+	/* the mode table may start streaming itself (ov5647) */
+	vvsim_set_stream(sim, 0);
+	ret = vvsim_write_array(sim,
+		(struct vvcam_sccb_data_s *)sim->cur_mode.preg_data,
+		sim->cur_mode.reg_data_count);
+	if (ret < 0) {
+		mutex_unlock(&sim->lock);
+		return ret;
+	}
+
+	fmt->format = sim->format;
+	mutex_unlock(&sim->lock);
+	return 0;
+}
+
+#if LINUX_VERSION_CODE > KERNEL_VERSION(5, 12, 0)
+static int vvsim_get_fmt(struct v4l2_subdev *sd,
+			 struct v4l2_subdev_state *state,
+			 struct v4l2_subdev_format *fmt)
+#else
+static int vvsim_get_fmt(struct v4l2_subdev *sd,
+			 struct v4l2_subdev_pad_config *cfg,
+			 struct v4l2_subdev_format *fmt)
+#endif
+{
+	struct vvsim *sim = to_vvsim(sd);
+
+	mutex_lock(&sim->lock);
+	fmt->format = sim->format;
+	mutex_unlock(&sim->lock);
+	return 0;
+}
+
+static const struct v4l2_subdev_video_ops vvsim_subdev_video_ops = {
+	.s_stream = vvsim_s_stream,
+};
+
+static const struct v4l2_subdev_pad_ops vvsim_subdev_pad_ops = {
+	.enum_mbus_code = vvsim_enum_mbus_code,
+	.set_fmt = vvsim_set_fmt,
+	.get_fmt = vvsim_get_fmt,
+};
+
+static const struct v4l2_subdev_core_ops vvsim_subdev_core_ops = {
+	.s_power = vvsim_s_power,
+	.ioctl = vvsim_priv_ioctl,
+	.subscribe_event = vvsim_subscribe_event,
+	.unsubscribe_event = v4l2_event_subdev_unsubscribe,
+};
+
+static const struct v4l2_subdev_ops vvsim_subdev_ops = {
+	.core  = &vvsim_subdev_core_ops,
+	.video = &vvsim_subdev_video_ops,
+	.pad   = &vvsim_subdev_pad_ops,
+};
+
+/* capture node */
+
+static int vvsim_queue_setup(struct vb2_queue *vq,
+			     unsigned int *nbuffers, unsigned int *nplanes,
+			     unsigned int sizes[], struct device *alloc_devs[])
+{
+	struct vvsim *sim = vb2_get_drv_priv(vq);
+
+	if (*nplanes)
+		return sizes[0] < sim->sizeimage ? -EINVAL : 0;
+	*nplanes = 1;
+	sizes[0] = sim->sizeimage;
+	return 0;
+}
+
+static int vvsim_buf_prepare(struct vb2_buffer *vb)
+{
+	struct vvsim *sim = vb2_get_drv_priv(vb->vb2_queue);
+
+	if (vb2_plane_size(vb, 0) < sim->sizeimage)
+		return -EINVAL;
+	return 0;
+}
+
+static void vvsim_buf_queue(struct vb2_buffer *vb)
+{
+	struct vvsim *sim = vb2_get_drv_priv(vb->vb2_queue);
+	struct vb2_v4l2_buffer *vbuf = to_vb2_v4l2_buffer(vb);
+	struct vvsim_buffer *buf = container_of(vbuf, struct vvsim_buffer, vb);
+	unsigned long flags;
+
+	spin_lock_irqsave(&sim->buf_lock, flags);
+	list_add_tail(&buf->list, &sim->buf_list);
+	spin_unlock_irqrestore(&sim->buf_lock, flags);
+}
+
+static void vvsim_return_buffers(struct vvsim *sim, enum vb2_buffer_state state)
+{
+	struct vvsim_buffer *buf, *tmp;
+	unsigned long flags;
+
+	spin_lock_irqsave(&sim->buf_lock, flags);
+	list_for_each_entry_safe(buf, tmp, &sim->buf_list, list) {
+		list_del(&buf->list);
+		vb2_buffer_done(&buf->vb.vb2_buf, state);
+	}
+	spin_unlock_irqrestore(&sim->buf_lock, flags);
+}
+
+static int vvsim_start_streaming(struct vb2_queue *vq, unsigned int count)
+{
+	struct vvsim *sim = vb2_get_drv_priv(vq);
+	int ret;
+
+	ret = vvsim_s_stream(&sim->subdev, 1);
+	if (ret < 0)
+		vvsim_return_buffers(sim, VB2_BUF_STATE_QUEUED);
+	return ret;
+}
+
+static void vvsim_stop_streaming(struct vb2_queue *vq)
+{
+	struct vvsim *sim = vb2_get_drv_priv(vq);
+
+	vvsim_s_stream(&sim->subdev, 0);
+	vvsim_return_buffers(sim, VB2_BUF_STATE_ERROR);
+}
+
+static const struct vb2_ops vvsim_qops = {
+	.queue_setup     = vvsim_queue_setup,
+	.buf_prepare     = vvsim_buf_prepare,
+	.buf_queue       = vvsim_buf_queue,
+	.start_streaming = vvsim_start_streaming,
+	.stop_streaming  = vvsim_stop_streaming,
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6, 8, 0)
+	.wait_prepare    = vb2_ops_wait_prepare,
+	.wait_finish     = vb2_ops_wait_finish,
+#endif
+};
+
+static int vvsim_querycap(struct file *file, void *priv,
+			  struct v4l2_capability *cap)
+{
+	struct vvsim *sim = video_drvdata(file);
+
+	strscpy(cap->driver, VVSIM_NAME, sizeof(cap->driver));
+	snprintf(cap->card, sizeof(cap->card), "%s simulator",
+		 sim->desc->name);
+	snprintf(cap->bus_info, sizeof(cap->bus_info), "platform:%s",
+		 VVSIM_NAME);
+	return 0;
+}
+
+static int vvsim_enum_fmt(struct file *file, void *priv,
+			  struct v4l2_fmtdesc *f)
+{
+	struct vvsim *sim = video_drvdata(file);
+
+	if (f->index > 0 || !sim->fmt)
+		return -EINVAL;
+	f->pixelformat = sim->fmt->fourcc;
+	return 0;
+}
+
+/* the format follows the sensor mode, S_FMT/TRY_FMT return it unchanged */
+static int vvsim_g_fmt(struct file *file, void *priv, struct v4l2_format *f)
+{
+	struct vvsim *sim = video_drvdata(file);
+	struct v4l2_pix_format *pix = &f->fmt.pix;
+
+	if (!sim->fmt)
+		return -EINVAL;
+	pix->width = sim->cur_mode.size.width;
+	pix->height = sim->cur_mode.size.height;
+	pix->pixelformat = sim->fmt->fourcc;
+	pix->field = V4L2_FIELD_NONE;
+	pix->bytesperline = sim->bytesperline;
+	pix->sizeimage = sim->sizeimage;
+	pix->colorspace = V4L2_COLORSPACE_RAW;
+	return 0;
+}
+
+static const struct v4l2_ioctl_ops vvsim_ioctl_ops = {
+	.vidioc_querycap         = vvsim_querycap,
+	.vidioc_enum_fmt_vid_cap = vvsim_enum_fmt,
+	.vidioc_g_fmt_vid_cap    = vvsim_g_fmt,
+	.vidioc_s_fmt_vid_cap    = vvsim_g_fmt,
+	.vidioc_try_fmt_vid_cap  = vvsim_g_fmt,
+	.vidioc_reqbufs          = vb2_ioctl_reqbufs,
+	.vidioc_create_bufs      = vb2_ioctl_create_bufs,
+	.vidioc_prepare_buf      = vb2_ioctl_prepare_buf,
+	.vidioc_querybuf         = vb2_ioctl_querybuf,
+	.vidioc_qbuf             = vb2_ioctl_qbuf,
+	.vidioc_dqbuf            = vb2_ioctl_dqbuf,
+	.vidioc_expbuf           = vb2_ioctl_expbuf,
+	.vidioc_streamon         = vb2_ioctl_streamon,
+	.vidioc_streamoff        = vb2_ioctl_streamoff,
+};
+
+static const struct v4l2_file_operations vvsim_fops = {
+	.owner          = THIS_MODULE,
+	.open           = v4l2_fh_open,
+	.release        = vb2_fop_release,
+	.read           = vb2_fop_read,
+	.poll           = vb2_fop_poll,
+	.unlocked_ioctl = video_ioctl2,
+	.mmap           = vb2_fop_mmap,
+};
+
+static int vvsim_register_capture(struct vvsim *sim, struct device *dev)
+{
+	struct vb2_queue *q = &sim->queue;
+	struct video_device *vdev = &sim->vdev;
+	int ret;
+
+	q->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	q->io_modes = VB2_MMAP | VB2_USERPTR | VB2_DMABUF | VB2_READ;
+	q->drv_priv = sim;
+	q->buf_struct_size = sizeof(struct vvsim_buffer);
+	q->ops = &vvsim_qops;
+	q->mem_ops = &vb2_vmalloc_memops;
+	q->timestamp_flags = V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC;
+	q->lock = &sim->queue_lock;
+	q->dev = dev;
+	ret = vb2_queue_init(q);
+	if (ret < 0)
+		return ret;
+
+	snprintf(vdev->name, sizeof(vdev->name), "%s-sim capture",
+		 sim->desc->name);
+	vdev->release = video_device_release_empty;
+	vdev->fops = &vvsim_fops;
+	vdev->ioctl_ops = &vvsim_ioctl_ops;
+	vdev->v4l2_dev = &sim->v4l2_dev;
+	vdev->queue = q;
+	vdev->lock = &sim->queue_lock;
+	vdev->device_caps = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING |
+			    V4L2_CAP_READWRITE;
+	video_set_drvdata(vdev, sim);
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 7, 0)
+	return video_register_device(vdev, VFL_TYPE_VIDEO, -1);
+#else
+	return video_register_device(vdev, VFL_TYPE_GRABBER, -1);
+#endif
+}
+
+static int vvsim_probe(struct platform_device *pdev)
+{
+	struct device *dev = &pdev->dev;
+	struct v4l2_subdev *sd;
+	struct vvsim *sim;
+	u32 max_width = 0;
+	int i, retval;
+
+	sim = devm_kzalloc(dev, sizeof(*sim), GFP_KERNEL);
+	if (!sim)
+		return -ENOMEM;
+
+	for (i = 0; i < ARRAY_SIZE(vvsim_sensors); i++) {
+		if (!strcmp(vvsim_sensors[i].name, sensor))
+			sim->desc = &vvsim_sensors[i];
+	}
+	if (!sim->desc) {
+		dev_err(dev, "unknown sensor %s\n", sensor);
+		return -EINVAL;
+	}
+
+	sim->regs = vzalloc(VVSIM_REG_COUNT * sizeof(u16));
+	if (!sim->regs)
+		return -ENOMEM;
+
+	mutex_init(&sim->lock);
+	mutex_init(&sim->queue_lock);
+	spin_lock_init(&sim->reg_lock);
+	spin_lock_init(&sim->buf_lock);
+	INIT_LIST_HEAD(&sim->buf_list);
+	sim->gain = 1 << SENSOR_FIX_FRACBITS;
+
+	memcpy(&sim->cur_mode, &sim->desc->modes[0],
+	       sizeof(struct vvcam_mode_info_s));
+	vvsim_reset_regs(sim);
+	vvsim_update_format(sim);
+
+	retval = v4l2_device_register(dev, &sim->v4l2_dev);
+	if (retval < 0)
+		goto probe_err_free_regs;
+
+	sd = &sim->subdev;
+	v4l2_subdev_init(sd, &vvsim_subdev_ops);
+	snprintf(sd->name, sizeof(sd->name), "%s-sim", sim->desc->name);
+	sd->owner = THIS_MODULE;
+	sd->dev = dev;
+	sd->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE | V4L2_SUBDEV_FL_HAS_EVENTS;
+	sd->entity.function = MEDIA_ENT_F_CAM_SENSOR;
+	sim->pads[0].flags = MEDIA_PAD_FL_SOURCE;
+	retval = media_entity_pads_init(&sd->entity, VVSIM_SENS_PADS_NUM,
+					sim->pads);
+	if (retval < 0)
+		goto probe_err_v4l2_unregister;
+
+	retval = v4l2_device_register_subdev(&sim->v4l2_dev, sd);
+	if (retval < 0)
+		goto probe_err_free_entity;
+	retval = v4l2_device_register_subdev_nodes(&sim->v4l2_dev);
+	if (retval < 0)
+		goto probe_err_unregister_subdev;
+
+	if (capture) {
+		for (i = 0; i < sim->desc->mode_count; i++)
+			max_width = max(max_width,
+					sim->desc->modes[i].size.width);
+		sim->row_buf = devm_kzalloc(dev, 2 * max_width * sizeof(u16),
+					    GFP_KERNEL);
+		retval = sim->row_buf ? vvsim_register_capture(sim, dev) :
+					-ENOMEM;
+		if (retval < 0)
+			goto probe_err_unregister_subdev;
+	}
+
+	platform_set_drvdata(pdev, sim);
+	dev_info(dev, "simulated %s sensor registered\n", sim->desc->name);
+	return 0;
+
+probe_err_unregister_subdev:
+	v4l2_device_unregister_subdev(sd);
+probe_err_free_entity:
+	media_entity_cleanup(&sd->entity);
+probe_err_v4l2_unregister:
+	v4l2_device_unregister(&sim->v4l2_dev);
+probe_err_free_regs:
+	vfree(sim->regs);
+	return retval;
+}
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6, 11, 0)
+static int vvsim_remove(struct platform_device *pdev)
+#else
+static void vvsim_remove(struct platform_device *pdev)
+#endif
+{
+	struct vvsim *sim = platform_get_drvdata(pdev);
+
+	mutex_lock(&sim->lock);
+	vvsim_set_stream(sim, 0);
+	mutex_unlock(&sim->lock);
+
+	if (capture)
+		video_unregister_device(&sim->vdev);
+	v4l2_device_unregister_subdev(&sim->subdev);
+	media_entity_cleanup(&sim->subdev.entity);
+	v4l2_device_unregister(&sim->v4l2_dev);
+	vfree(sim->regs);
+	mutex_destroy(&sim->queue_lock);
+	mutex_destroy(&sim->lock);
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6, 11, 0)
+	return 0;
+#endif
+}
+
+static struct platform_driver vvsim_driver = {
+	.driver = {
+		.name = VVSIM_NAME,
+	},
+	.probe  = vvsim_probe,
+	.remove = vvsim_remove,
+};
+
+static struct platform_device *vvsim_pdev;
+
+static int __init vvsim_init(void)
+{
+	int ret;
+
+	ret = platform_driver_register(&vvsim_driver);
+	if (ret < 0)
+		return ret;
+
+	vvsim_pdev = platform_device_register_simple(VVSIM_NAME, -1, NULL, 0);
+	if (IS_ERR(vvsim_pdev)) {
+		platform_driver_unregister(&vvsim_driver);
+		return PTR_ERR(vvsim_pdev);
+	}
+	return 0;
+}
+
+static void __exit vvsim_exit(void)
+{
+	platform_device_unregister(vvsim_pdev);
+	platform_driver_unregister(&vvsim_driver);
+}
+
+module_init(vvsim_init);
+module_exit(vvsim_exit);
+MODULE_DESCRIPTION("Simulated vvcam camera sensor");
+MODULE_LICENSE("GPL");
@@ -0,0 +1,424 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Host benchmark for the ISI sensor drivers.
+ *
+ * Loads a sensor .drv, resolves IsiCamDrvConfig and drives it against the
+ * mock HAL with scripted workloads, reporting calls per second, ioctls and
+ * sensor register writes per call and p50/p99 latency.
+ *
+ *   isi-bench -s ar0144 [-m mode] [-n ae_updates] [-w workloads] [-l] ar0144.drv
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock_hal.h"
+
+#define BENCH_LIFECYCLE_DEFAULT 1000
+#define BENCH_AE_DEFAULT        10000
+#define BENCH_SWEEP_DEFAULT     1000
+#define BENCH_I2C_KHZ           400
+
+typedef struct Bench_s
+{
+    IsiCamDrvConfig_t *pCamDrvConfig;
+    IsiSensor_t IsiSensor;
+    HalHandle_t HalHandle;
+    SensorModel_t *pModel;
+    uint32_t modeIndex;
+    IsiSensorHandle_t hSensor;
+} Bench_t;
+
+typedef struct BenchResult_s
+{
+    const char *name;
+    uint32_t calls;
+    uint32_t failures;
+    uint64_t *pSamples;
+    uint64_t totalNs;
+    SensorModelStats_t before;
+    SensorModelStats_t after;
+} BenchResult_t;
+
+typedef RESULT (*BenchStep_t)(Bench_t *pBench, uint32_t i);
+
+static uint64_t BenchNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int BenchCompareU64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t BenchPercentile(const uint64_t *pSorted, uint32_t n, uint32_t pct)
+{
+    if (n == 0)
+        return 0;
+    return pSorted[(uint64_t)(n - 1) * pct / 100];
+}
+
+static int BenchRun(Bench_t *pBench, BenchResult_t *pResult, BenchStep_t step,
+                    uint32_t calls)
+{
+    uint64_t start, t0;
+    uint32_t i;
+
+    pResult->calls = calls;
+    pResult->failures = 0;
+    pResult->pSamples = calloc(calls ? calls : 1, sizeof(uint64_t));
+    if (!pResult->pSamples)
+        return -1;
+
+    SensorModelGetStats(pBench->pModel, &pResult->before);
+    start = BenchNowNs();
+    for (i = 0; i < calls; i++) {
+        t0 = BenchNowNs();
+        if (step(pBench, i) != RET_SUCCESS)
+            pResult->failures++;
+        pResult->pSamples[i] = BenchNowNs() - t0;
+    }
+    pResult->totalNs = BenchNowNs() - start;
+    SensorModelGetStats(pBench->pModel, &pResult->after);
+    return 0;
+}
+
+static void BenchReportHeader(void)
+{
+    printf("%-10s %8s %6s %12s %10s %10s %10s %10s %12s\n",
+           "workload", "calls", "fail", "calls/s", "ioctl/call",
+           "regwr/call", "p50 us", "p99 us", "i2c us/call");
+}
+
+static void BenchReport(const BenchResult_t *pResult)
+{
+    uint64_t ioctls = pResult->after.ioctls - pResult->before.ioctls;
+    uint64_t writes = pResult->after.regWrites - pResult->before.regWrites;
+    uint64_t cycles = pResult->after.busCycles - pResult->before.busCycles;
+    double calls = pResult->calls ? pResult->calls : 1;
+
+    qsort(pResult->pSamples, pResult->calls, sizeof(uint64_t), BenchCompareU64);
+
+    printf("%-10s %8u %6u %12.0f %10.2f %10.2f %10.2f %10.2f %12.1f\n",
+           pResult->name, pResult->calls, pResult->failures,
+           pResult->totalNs ? pResult->calls * 1e9 / pResult->totalNs : 0.0,
+           ioctls / calls, writes / calls,
+           BenchPercentile(pResult->pSamples, pResult->calls, 50) / 1e3,
+           BenchPercentile(pResult->pSamples, pResult->calls, 99) / 1e3,
+           cycles * 1e3 / BENCH_I2C_KHZ / calls);
+}
+
+static RESULT BenchCreate(Bench_t *pBench)
+{
+    IsiSensorInstanceConfig_t Config;
+    RESULT result;
+
+    memset(&Config, 0, sizeof(Config));
+    Config.HalHandle = pBench->HalHandle;
+    Config.pSensor = &pBench->IsiSensor;
+    Config.SensorModeIndex = pBench->modeIndex;
+
+    result = pBench->IsiSensor.pIsiCreateSensorIss(&Config);
+    if (result != RET_SUCCESS)
+        return result;
+    pBench->hSensor = Config.hSensor;
+    return RET_SUCCESS;
+}
+
+static RESULT BenchSetup(Bench_t *pBench)
+{
+    IsiSensorCaps_t Caps;
+    RESULT result;
+
+    memset(&Caps, 0, sizeof(Caps));
+    result = pBench->IsiSensor.pIsiGetCapsIss(pBench->hSensor, &Caps);
+    if (result != RET_SUCCESS)
+        return result;
+    return pBench->IsiSensor.pIsiSetupSensorIss(pBench->hSensor, &Caps);
+}
+
+static RESULT BenchRelease(Bench_t *pBench)
+{
+    RESULT result = pBench->IsiSensor.pIsiReleaseSensorIss(pBench->hSensor);
+
+    pBench->hSensor = NULL;
+    return result;
+}
+
+/* create, set mode, stream on and off, release */
+static RESULT BenchStepLifecycle(Bench_t *pBench, uint32_t i)
+{
+    RESULT result;
+
+    (void)i;
+    result = BenchCreate(pBench);
+    if (result != RET_SUCCESS)
+        return result;
+    result = BenchSetup(pBench);
+    if (result == RET_SUCCESS)
+        result = pBench->IsiSensor.pIsiSensorSetStreamingIss(pBench->hSensor, BOOL_TRUE);
+    if (result == RET_SUCCESS)
+        result = pBench->IsiSensor.pIsiSensorSetStreamingIss(pBench->hSensor, BOOL_FALSE);
+    BenchRelease(pBench);
+    return result;
+}
+
+/* triangle wave between 0 and 1 with the given period */
+static float BenchTriangle(uint32_t i, uint32_t period)
+{
+    uint32_t phase = i % period;
+    uint32_t half = period / 2;
+
+    return phase < half ? (float)phase / half : (float)(period - phase) / half;
+}
+
+/*
+ * One AE update: integration time and gain as the AE loop sets them each
+ * frame. Exposure and gain ramp at different rates so consecutive updates
+ * change both most of the time, as they do while converging.
+ */
+static RESULT BenchStepAe(Bench_t *pBench, uint32_t i)
+{
+    IsiSensorAeInfo_t AeInfo;
+    IsiSensorIntTime_t IntTime;
+    IsiSensorGain_t Gain;
+    float t = BenchTriangle(i, 240);
+    float g = BenchTriangle(i, 90);
+    RESULT result;
+
+    result = pBench->IsiSensor.pIsiGetAeInfoIss(pBench->hSensor, &AeInfo);
+    if (result != RET_SUCCESS)
+        return result;
+
+    memset(&IntTime, 0, sizeof(IntTime));
+    IntTime.expoFrmType = ISI_EXPO_FRAME_TYPE_1FRAME;
+    IntTime.IntegrationTime.linearInt = AeInfo.minIntTime.linearInt +
+        t * (AeInfo.maxIntTime.linearInt - AeInfo.minIntTime.linearInt);
+    result = pBench->IsiSensor.pIsiSetIntegrationTimeIss(pBench->hSensor, &IntTime);
+    if (result != RET_SUCCESS)
+        return result;
+
+    memset(&Gain, 0, sizeof(Gain));
+    Gain.expoFrmType = ISI_EXPO_FRAME_TYPE_1FRAME;
+    Gain.gain.linearGainParas = AeInfo.minAGain.linearGainParas +
+        g * (AeInfo.maxAGain.linearGainParas - AeInfo.minAGain.linearGainParas);
+    return pBench->IsiSensor.pIsiSetGainIss(pBench->hSensor, &Gain);
+}
+
+static RESULT BenchStepFps(Bench_t *pBench, uint32_t i)
+{
+    const struct vvcam_mode_info_s *pMode = SensorModelCurMode(pBench->pModel);
+    uint32_t minFps = pMode->ae_info.min_fps;
+    uint32_t maxFps = pMode->ae_info.max_fps;
+    uint32_t fps;
+
+    fps = minFps + BenchTriangle(i, 64) * (maxFps - minFps);
+    return pBench->IsiSensor.pIsiSetSensorFpsIss(pBench->hSensor, fps);
+}
+
+static IsiFoucsCalibAttr_t BenchFocusCalib;
+
+static RESULT BenchStepFocus(Bench_t *pBench, uint32_t i)
+{
+    IsiFocusPos_t Pos;
+    float t = BenchTriangle(i, 128);
+
+    memset(&Pos, 0, sizeof(Pos));
+    Pos.mode = ISI_FOUCUS_MODE_ABSOLUTE;
+    Pos.Pos = BenchFocusCalib.minPos +
+        t * (BenchFocusCalib.maxPos - BenchFocusCalib.minPos);
+    return pBench->IsiSensor.pIsiFocusSetIss(pBench->hSensor, &Pos);
+}
+
+static int BenchWorkload(Bench_t *pBench, const char *name, uint32_t calls)
+{
+    BenchResult_t Result;
+    BenchStep_t step;
+    int focus = 0;
+
+    memset(&Result, 0, sizeof(Result));
+    Result.name = name;
+
+    if (strcmp(name, "lifecycle") == 0) {
+        step = BenchStepLifecycle;
+    } else if (strcmp(name, "ae") == 0) {
+        step = BenchStepAe;
+    } else if (strcmp(name, "fps") == 0) {
+        step = BenchStepFps;
+    } else if (strcmp(name, "focus") == 0) {
+        step = BenchStepFocus;
+        focus = 1;
+    } else {
+        fprintf(stderr, "unknown workload %s\n", name);
+        return -1;
+    }
+
+    if (step != BenchStepLifecycle) {
+        if (BenchCreate(pBench) != RET_SUCCESS || BenchSetup(pBench) != RET_SUCCESS) {
+            fprintf(stderr, "%s: sensor create failed\n", name);
+            return -1;
+        }
+        pBench->IsiSensor.pIsiSensorSetStreamingIss(pBench->hSensor, BOOL_TRUE);
+    }
+
+    if (focus) {
+        if (!pBench->IsiSensor.pIsiFocusSetupIss ||
+            pBench->IsiSensor.pIsiFocusSetupIss(pBench->hSensor) != RET_SUCCESS ||
+            pBench->IsiSensor.pIsiGetFocusCalibrateIss(pBench->hSensor,
+                                                        &BenchFocusCalib) != RET_SUCCESS) {
+            printf("%-10s not supported by this driver%s\n", name,
+                   SensorModelHasLens(pBench->pModel) ? "" : " (run with -l)");
+            BenchRelease(pBench);
+            return 0;
+        }
+    }
+
+    if (BenchRun(pBench, &Result, step, calls) == 0)
+        BenchReport(&Result);
+    free(Result.pSamples);
+
+    if (focus)
+        pBench->IsiSensor.pIsiFocusReleaseIss(pBench->hSensor);
+    if (step != BenchStepLifecycle)
+        BenchRelease(pBench);
+    return 0;
+}
+
+static void BenchUsage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s -s sensor [-m mode] [-c cycles] [-n ae_updates]\n"
+            "          [-f sweep_steps] [-w workloads] [-l] driver.drv\n"
+            "  -s  sensor model: %s\n"
+            "  -m  sensor mode index (default 0)\n"
+            "  -c  lifecycle iterations (default %d)\n"
+            "  -n  AE updates (default %d)\n"
+            "  -f  fps and focus sweep steps (default %d)\n"
+            "  -w  comma separated workloads: lifecycle,ae,fps,focus (default all)\n"
+            "  -l  give the model a focus lens\n",
+            prog, SensorModelNames(), BENCH_LIFECYCLE_DEFAULT,
+            BENCH_AE_DEFAULT, BENCH_SWEEP_DEFAULT);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t cycles = BENCH_LIFECYCLE_DEFAULT;
+    uint32_t aeUpdates = BENCH_AE_DEFAULT;
+    uint32_t sweepSteps = BENCH_SWEEP_DEFAULT;
+    char workloads[64] = "lifecycle,ae,fps,focus";
+    const char *sensor = NULL;
+    char *name, *cur;
+    Bench_t Bench;
+    void *pDrv;
+    int withLens = 0;
+    int opt, ret = 0;
+
+    memset(&Bench, 0, sizeof(Bench));
+
+    while ((opt = getopt(argc, argv, "s:m:c:n:f:w:lh")) != -1) {
+        switch (opt) {
+        case 's':
+            sensor = optarg;
+            break;
+        case 'm':
+            Bench.modeIndex = strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            cycles = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            aeUpdates = strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            sweepSteps = strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            snprintf(workloads, sizeof(workloads), "%s", optarg);
+            break;
+        case 'l':
+            withLens = 1;
+            break;
+        default:
+            BenchUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!sensor || optind != argc - 1) {
+        BenchUsage(argv[0]);
+        return 1;
+    }
+
+    pDrv = dlopen(argv[optind], RTLD_NOW | RTLD_LOCAL);
+    if (!pDrv) {
+        fprintf(stderr, "%s\n", dlerror());
+        return 1;
+    }
+
+    Bench.pCamDrvConfig = (IsiCamDrvConfig_t *)dlsym(pDrv, "IsiCamDrvConfig");
+    if (!Bench.pCamDrvConfig || !Bench.pCamDrvConfig->pfIsiGetSensorIss) {
+        fprintf(stderr, "%s: no IsiCamDrvConfig\n", argv[optind]);
+        ret = 1;
+        goto out_close;
+    }
+    Bench.pCamDrvConfig->pfIsiGetSensorIss(&Bench.IsiSensor);
+
+    Bench.pModel = SensorModelCreate(sensor, withLens);
+    if (!Bench.pModel) {
+        fprintf(stderr, "unknown sensor model %s, expected one of %s\n",
+                sensor, SensorModelNames());
+        ret = 1;
+        goto out_close;
+    }
+
+    Bench.HalHandle = MockHalCreate(Bench.pModel);
+    if (!Bench.HalHandle) {
+        ret = 1;
+        goto out_model;
+    }
+
+    printf("%s: driver id 0x%x, model %s, mode %u, i2c at %d kHz\n",
+           Bench.IsiSensor.pszName, Bench.pCamDrvConfig->CameraDriverID,
+           sensor, Bench.modeIndex, BENCH_I2C_KHZ);
+    BenchReportHeader();
+
+    cur = workloads;
+    while ((name = strsep(&cur, ",")) != NULL) {
+        uint32_t calls = sweepSteps;
+
+        if (!*name)
+            continue;
+        if (strcmp(name, "lifecycle") == 0)
+            calls = cycles;
+        else if (strcmp(name, "ae") == 0)
+            calls = aeUpdates;
+        if (BenchWorkload(&Bench, name, calls) != 0)
+            ret = 1;
+    }
+
+    MockHalDestroy(Bench.HalHandle);
+out_model:
+    SensorModelDestroy(Bench.pModel);
+out_close:
+    dlclose(pDrv);
+    return ret;
+}
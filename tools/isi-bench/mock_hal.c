@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+#undef _FORTIFY_SOURCE
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "mock_hal.h"
+
+#define MOCK_MOTOR_DEV  "/dev/v4l-subdev0"
+
+typedef int (*ioctl_fn)(int, unsigned long, ...);
+typedef int (*open_fn)(const char *, int, ...);
+typedef int (*close_fn)(int);
+
+static SensorModel_t *pMockModel;
+static int mockSensorFd = -1;
+static int mockMotorFd = -1;
+
+static ioctl_fn real_ioctl;
+static open_fn real_open;
+static close_fn real_close;
+
+static void MockHalResolve(void)
+{
+    if (!real_ioctl)
+        real_ioctl = (ioctl_fn)dlsym(RTLD_NEXT, "ioctl");
+    if (!real_open)
+        real_open = (open_fn)dlsym(RTLD_NEXT, "open");
+    if (!real_close)
+        real_close = (close_fn)dlsym(RTLD_NEXT, "close");
+}
+
+/* backing descriptors only reserve fd numbers, nothing is read from them */
+static int MockHalOpenNull(void)
+{
+    MockHalResolve();
+    return real_open("/dev/null", O_RDWR);
+}
+
+int ioctl(int fd, unsigned long request, ...)
+{
+    va_list ap;
+    void *arg;
+
+    va_start(ap, request);
+    arg = va_arg(ap, void *);
+    va_end(ap);
+
+    if (pMockModel && fd >= 0) {
+        if (fd == mockSensorFd)
+            return SensorModelIoctl(pMockModel, request, arg);
+        if (fd == mockMotorFd)
+            return SensorModelMotorIoctl(pMockModel, request, arg);
+    }
+
+    MockHalResolve();
+    return real_ioctl(fd, request, arg);
+}
+
+static int MockHalOpen(const char *path, int flags, mode_t mode)
+{
+    if (pMockModel && SensorModelHasLens(pMockModel) &&
+        strcmp(path, MOCK_MOTOR_DEV) == 0) {
+        if (mockMotorFd < 0)
+            mockMotorFd = MockHalOpenNull();
+        return mockMotorFd;
+    }
+
+    MockHalResolve();
+    return real_open(path, flags, mode);
+}
+
+int open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    va_list ap;
+
+    if (flags & O_CREAT) {
+        va_start(ap, flags);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+    return MockHalOpen(path, flags, mode);
+}
+
+int open64(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    va_list ap;
+
+    if (flags & O_CREAT) {
+        va_start(ap, flags);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+    return MockHalOpen(path, flags | O_LARGEFILE, mode);
+}
+
+int close(int fd)
+{
+    if (fd >= 0 && fd == mockMotorFd)
+        mockMotorFd = -1;
+
+    MockHalResolve();
+    return real_close(fd);
+}
+
+HalHandle_t MockHalCreate(SensorModel_t *pModel)
+{
+    HalContext_t *pHalCtx;
+
+    if (!pModel || pMockModel)
+        return NULL;
+
+    pHalCtx = calloc(1, sizeof(HalContext_t));
+    if (!pHalCtx)
+        return NULL;
+
+    mockSensorFd = MockHalOpenNull();
+    if (mockSensorFd < 0) {
+        free(pHalCtx);
+        return NULL;
+    }
+
+    pHalCtx->sensor_fd = mockSensorFd;
+    pMockModel = pModel;
+    return (HalHandle_t)pHalCtx;
+}
+
+void MockHalDestroy(HalHandle_t HalHandle)
+{
+    HalContext_t *pHalCtx = (HalContext_t *)HalHandle;
+
+    if (!pHalCtx)
+        return;
+
+    if (mockMotorFd >= 0)
+        close(mockMotorFd);
+    close(mockSensorFd);
+    mockSensorFd = -1;
+    pMockModel = NULL;
+    free(pHalCtx);
+}
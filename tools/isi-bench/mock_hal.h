@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef _ISI_BENCH_MOCK_HAL_H_
+#define _ISI_BENCH_MOCK_HAL_H_
+
+#include <ebase/types.h>
+#include <common/return_codes.h>
+#include "isi.h"
+#include "isi_iss.h"
+#include "isi_priv.h"
+#include "sensor_model.h"
+
+/*
+ * Mock HAL for running ISI sensor drivers on a host.
+ *
+ * MockHalCreate() returns a HalContext_t whose sensor_fd is served by the
+ * given sensor model. The ISI drivers call ioctl() and open() directly, so
+ * the harness interposes both: requests on the mock descriptors go to the
+ * model, everything else to libc. When the model has a lens, opening
+ * /dev/v4l-subdev0 returns the mock focus motor.
+ */
+
+HalHandle_t MockHalCreate(SensorModel_t *pModel);
+void MockHalDestroy(HalHandle_t HalHandle);
+
+#endif
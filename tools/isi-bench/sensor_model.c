@@ -0,0 +1,365 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/videodev2.h>
+#include <linux/v4l2-subdev.h>
+
+#include "sensor_model.h"
+#include "ar0144_modes.h"
+#include "imx219_modes.h"
+#include "ov5647_modes.h"
+
+#define ARRAY_SIZE(a)   (sizeof(a) / sizeof((a)[0]))
+
+#define MODEL_MCLK      24000000
+#define MODEL_LENS_NAME "vvcam-sim-vcm"
+#define MODEL_LENS_MAX  1023
+
+/*
+ * Register writes the kernel driver issues for each request, used for the
+ * I2C cost accounting. One register write is a start, the device address,
+ * two register address bytes and regBytes data bytes, then a stop.
+ */
+typedef struct SensorModelDesc_s
+{
+    const char *name;
+    uint32_t chipId;
+    uint32_t reserveId;
+    uint32_t idSize;
+    uint32_t regBytes;
+    struct vvcam_mode_info_s *pModes;
+    uint32_t modeCount;
+    uint64_t csiMaxPixelClk;
+    uint32_t expWrites;
+    uint32_t gainWrites;
+    uint32_t fpsWrites;
+} SensorModelDesc_t;
+
+static const SensorModelDesc_t SensorModelDescs[] = {
+    {
+        .name           = "ar0144",
+        .chipId         = 0x0356,
+        .reserveId      = 0x2770,
+        .idSize         = 2,
+        .regBytes       = 2,
+        .pModes         = par0144_mode_info,
+        .modeCount      = ARRAY_SIZE(par0144_mode_info),
+        .csiMaxPixelClk = AR0144_CSI_MAX_PIXEL_CLK,
+        .expWrites      = 1,
+        .gainWrites     = 1,
+        .fpsWrites      = 1,
+    },
+    {
+        .name           = "imx219",
+        .chipId         = 0x0219,
+        .reserveId      = 0x0219,
+        .idSize         = 4,
+        .regBytes       = 1,
+        .pModes         = pimx219_mode_info,
+        .modeCount      = ARRAY_SIZE(pimx219_mode_info),
+        .csiMaxPixelClk = IMX219_CSI_MAX_PIXEL_CLK,
+        .expWrites      = 2,
+        .gainWrites     = 3,
+        .fpsWrites      = 2,
+    },
+    {
+        .name           = "ov5647",
+        .chipId         = 0x5647,
+        .reserveId      = 0x5647,
+        .idSize         = 4,
+        .regBytes       = 1,
+        .pModes         = pov5647_mode_info,
+        .modeCount      = ARRAY_SIZE(pov5647_mode_info),
+        .csiMaxPixelClk = OV5647_CSI_MAX_PIXEL_CLK,
+        .expWrites      = 3,
+        .gainWrites     = 2,
+        .fpsWrites      = 2,
+    },
+};
+
+struct SensorModel_s
+{
+    const SensorModelDesc_t *pDesc;
+    struct vvcam_mode_info_s CurMode;
+    int withLens;
+    uint32_t stream;
+    uint32_t exp;
+    uint32_t gain;
+    int32_t focusPos;
+    SensorModelStats_t stats;
+};
+
+static void SensorModelAccountWrites(SensorModel_t *pModel, uint32_t count)
+{
+    uint32_t bytes = 1 + 2 + pModel->pDesc->regBytes;
+
+    pModel->stats.regWrites += count;
+    pModel->stats.busCycles += (uint64_t)count * (1 + 9 * bytes + 1);
+}
+
+static uint32_t SensorModelTableLength(const struct vvcam_mode_info_s *pMode)
+{
+    const struct vvcam_sccb_data_s *pReg = pMode->preg_data;
+    uint32_t i;
+
+    for (i = 0; i < pMode->reg_data_count; i++) {
+        if (pReg[i].addr == 0xffff)
+            break;
+    }
+    return i;
+}
+
+static int SensorModelSetMode(SensorModel_t *pModel, const struct vvcam_mode_info_s *pMode)
+{
+    const SensorModelDesc_t *pDesc = pModel->pDesc;
+    uint32_t i;
+
+    if (pModel->stream)
+        return -EBUSY;
+
+    for (i = 0; i < pDesc->modeCount; i++) {
+        if (pDesc->pModes[i].index == pMode->index) {
+            memcpy(&pModel->CurMode, &pDesc->pModes[i], sizeof(pModel->CurMode));
+            return 0;
+        }
+    }
+    return -ENXIO;
+}
+
+static int SensorModelSetFps(SensorModel_t *pModel, uint32_t fps)
+{
+    struct vvcam_sensor_ae_info_s *pAe = &pModel->CurMode.ae_info;
+    uint32_t margin = pAe->def_frm_len_lines - pAe->max_integration_line;
+    uint32_t vts;
+
+    if (fps > pAe->max_fps)
+        fps = pAe->max_fps;
+    else if (fps < pAe->min_fps)
+        fps = pAe->min_fps;
+    if (fps == 0)
+        return -EINVAL;
+
+    vts = pAe->max_fps * pAe->def_frm_len_lines / fps;
+    SensorModelAccountWrites(pModel, pModel->pDesc->fpsWrites);
+
+    pAe->cur_fps = fps;
+    pAe->curr_frm_len_lines = vts;
+    pAe->max_integration_line = vts - margin;
+    return 0;
+}
+
+static int SensorModelGetId(SensorModel_t *pModel, void *arg, uint32_t id)
+{
+    memcpy(arg, &id, pModel->pDesc->idSize);
+    return 0;
+}
+
+static int SensorModelGetLens(SensorModel_t *pModel, vvcam_lens_t *pLens)
+{
+    if (!pModel->withLens)
+        return -ENODEV;
+
+    memset(pLens, 0, sizeof(*pLens));
+    strncpy((char *)pLens->name, MODEL_LENS_NAME, sizeof(pLens->name) - 1);
+    pLens->id = 0;
+    return 0;
+}
+
+int SensorModelIoctl(SensorModel_t *pModel, unsigned long request, void *arg)
+{
+    const SensorModelDesc_t *pDesc = pModel->pDesc;
+    struct vvcam_mode_info_array_s *pModeArray;
+    struct vvcam_sccb_data_s *pReg;
+    struct vvcam_clk_s *pClk;
+    int ret = 0;
+
+    pModel->stats.ioctls++;
+
+    switch (request) {
+    case VVSENSORIOC_S_POWER:
+    case VVSENSORIOC_S_CLK:
+    case VVSENSORIOC_S_HDR_RADIO:
+    case VVSENSORIOC_S_WB:
+    case VVSENSORIOC_S_TEST_PATTERN:
+        break;
+    case VIDIOC_SUBDEV_S_FMT:
+        /* the kernel drivers write the mode table on set_fmt */
+        SensorModelAccountWrites(pModel,
+                                 SensorModelTableLength(&pModel->CurMode));
+        break;
+    case VVSENSORIOC_RESET:
+        pModel->stream = 0;
+        break;
+    case VVSENSORIOC_G_CLK:
+        pClk = arg;
+        pClk->sensor_mclk = MODEL_MCLK;
+        pClk->csi_max_pixel_clk = pDesc->csiMaxPixelClk;
+        break;
+    case VVSENSORIOC_QUERY:
+        pModeArray = arg;
+        pModeArray->count = pDesc->modeCount;
+        memcpy(pModeArray->modes, pDesc->pModes,
+               pDesc->modeCount * sizeof(struct vvcam_mode_info_s));
+        break;
+    case VVSENSORIOC_G_CHIP_ID:
+        ret = SensorModelGetId(pModel, arg, pDesc->chipId);
+        break;
+    case VVSENSORIOC_G_RESERVE_ID:
+        ret = SensorModelGetId(pModel, arg, pDesc->reserveId);
+        break;
+    case VVSENSORIOC_G_SENSOR_MODE:
+        memcpy(arg, &pModel->CurMode, sizeof(struct vvcam_mode_info_s));
+        break;
+    case VVSENSORIOC_S_SENSOR_MODE:
+        ret = SensorModelSetMode(pModel, arg);
+        break;
+    case VVSENSORIOC_S_STREAM:
+        pModel->stream = *(uint32_t *)arg;
+        SensorModelAccountWrites(pModel, 1);
+        break;
+    case VVSENSORIOC_WRITE_REG:
+        SensorModelAccountWrites(pModel, 1);
+        break;
+    case VVSENSORIOC_READ_REG:
+        pReg = arg;
+        pReg->data = 0;
+        break;
+    case VVSENSORIOC_S_EXP:
+    case VVSENSORIOC_S_VSEXP:
+    case VVSENSORIOC_S_LONG_EXP:
+        pModel->exp = *(uint32_t *)arg;
+        SensorModelAccountWrites(pModel, pDesc->expWrites);
+        break;
+    case VVSENSORIOC_S_GAIN:
+    case VVSENSORIOC_S_VSGAIN:
+    case VVSENSORIOC_S_LONG_GAIN:
+        pModel->gain = *(uint32_t *)arg;
+        SensorModelAccountWrites(pModel, pDesc->gainWrites);
+        break;
+    case VVSENSORIOC_S_FPS:
+        ret = SensorModelSetFps(pModel, *(uint32_t *)arg);
+        break;
+    case VVSENSORIOC_G_FPS:
+        *(uint32_t *)arg = pModel->CurMode.ae_info.cur_fps;
+        break;
+    case VVSENSORIOC_G_LENS:
+        ret = SensorModelGetLens(pModel, arg);
+        break;
+    default:
+        ret = -ENOTTY;
+        break;
+    }
+
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
+    }
+    return 0;
+}
+
+int SensorModelMotorIoctl(SensorModel_t *pModel, unsigned long request, void *arg)
+{
+    struct v4l2_capability *pCaps;
+    struct v4l2_queryctrl *pQctrl;
+    struct v4l2_control *pCtrl;
+
+    pModel->stats.ioctls++;
+
+    switch (request) {
+    case VIDIOC_QUERYCAP:
+        pCaps = arg;
+        memset(pCaps, 0, sizeof(*pCaps));
+        strncpy((char *)pCaps->driver, MODEL_LENS_NAME, sizeof(pCaps->driver) - 1);
+        snprintf((char *)pCaps->bus_info, sizeof(pCaps->bus_info), "%d", 0);
+        return 0;
+    case VIDIOC_QUERYCTRL:
+        pQctrl = arg;
+        if (pQctrl->id != V4L2_CID_FOCUS_ABSOLUTE)
+            break;
+        pQctrl->minimum = 0;
+        pQctrl->maximum = MODEL_LENS_MAX;
+        pQctrl->step = 1;
+        return 0;
+    case VIDIOC_G_CTRL:
+        pCtrl = arg;
+        if (pCtrl->id != V4L2_CID_FOCUS_ABSOLUTE)
+            break;
+        pCtrl->value = pModel->focusPos;
+        return 0;
+    case VIDIOC_S_CTRL:
+        pCtrl = arg;
+        if (pCtrl->id != V4L2_CID_FOCUS_ABSOLUTE)
+            break;
+        pModel->focusPos = pCtrl->value;
+        /* one two byte write to the voice coil driver */
+        pModel->stats.regWrites++;
+        pModel->stats.busCycles += 1 + 9 * 3 + 1;
+        return 0;
+    default:
+        break;
+    }
+
+    errno = EINVAL;
+    return -1;
+}
+
+SensorModel_t *SensorModelCreate(const char *name, int withLens)
+{
+    SensorModel_t *pModel;
+    uint32_t i;
+
+    for (i = 0; i < ARRAY_SIZE(SensorModelDescs); i++) {
+        if (strcmp(SensorModelDescs[i].name, name) == 0)
+            break;
+    }
+    if (i == ARRAY_SIZE(SensorModelDescs))
+        return NULL;
+
+    pModel = calloc(1, sizeof(*pModel));
+    if (!pModel)
+        return NULL;
+
+    pModel->pDesc = &SensorModelDescs[i];
+    pModel->withLens = withLens;
+    memcpy(&pModel->CurMode, &pModel->pDesc->pModes[0], sizeof(pModel->CurMode));
+    return pModel;
+}
+
+void SensorModelDestroy(SensorModel_t *pModel)
+{
+    free(pModel);
+}
+
+int SensorModelHasLens(const SensorModel_t *pModel)
+{
+    return pModel->withLens;
+}
+
+const struct vvcam_mode_info_s *SensorModelCurMode(const SensorModel_t *pModel)
+{
+    return &pModel->CurMode;
+}
+
+uint32_t SensorModelModeCount(const SensorModel_t *pModel)
+{
+    return pModel->pDesc->modeCount;
+}
+
+void SensorModelGetStats(const SensorModel_t *pModel, SensorModelStats_t *pStats)
+{
+    *pStats = pModel->stats;
+}
+
+const char *SensorModelNames(void)
+{
+    return "ar0144, imx219, ov5647";
+}
@@ -0,0 +1,43 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef _ISI_BENCH_SENSOR_MODEL_H_
+#define _ISI_BENCH_SENSOR_MODEL_H_
+
+#include <stdint.h>
+#include "vvsensor.h"
+
+/*
+ * In-process model of a vvcam sensor kernel driver. It answers the
+ * VVSENSORIOC_* requests the ISI drivers issue on HalContext_t::sensor_fd
+ * with the mode tables of the kernel driver, and counts the register
+ * writes and I2C bus cycles the real driver would spend on each of them.
+ */
+
+typedef struct SensorModelStats_s
+{
+    uint64_t ioctls;
+    uint64_t regWrites;
+    uint64_t busCycles;
+} SensorModelStats_t;
+
+typedef struct SensorModel_s SensorModel_t;
+
+SensorModel_t *SensorModelCreate(const char *name, int withLens);
+void SensorModelDestroy(SensorModel_t *pModel);
+
+int SensorModelIoctl(SensorModel_t *pModel, unsigned long request, void *arg);
+int SensorModelMotorIoctl(SensorModel_t *pModel, unsigned long request, void *arg);
+int SensorModelHasLens(const SensorModel_t *pModel);
+
+const struct vvcam_mode_info_s *SensorModelCurMode(const SensorModel_t *pModel);
+uint32_t SensorModelModeCount(const SensorModel_t *pModel);
+void SensorModelGetStats(const SensorModel_t *pModel, SensorModelStats_t *pStats);
+const char *SensorModelNames(void);
+
+#endif
@@ -0,0 +1,843 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * RAW capture to disk.
+ *
+ * Streams a V4L2 capture node into a .vvraw file (raw_container.h). The
+ * main thread dequeues buffers, stamps them with the timestamp, sequence
+ * and the exposure and gain read from the sensor subdev, and hands them to
+ * a writer thread. The writer issues one pwritev of the frame header block
+ * and the buffer itself, with O_DIRECT, and requeues the buffer. Frames are
+ * only copied when the buffer mapping cannot be used for direct I/O.
+ *
+ *   raw-capture -d /dev/video0 -o out.vvraw [-n frames] [-W width -H height]
+ *               [-f fourcc] [-r fps] [-c buffers] [-m mmap|userptr|dmabuf]
+ *               [-s sensor_subdev] [-b]
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-heap.h>
+#include <linux/videodev2.h>
+
+#include "raw_container.h"
+#include "vvsensor_ext.h"
+
+#define CAP_BUFFERS_DEFAULT     8
+#define CAP_BUFFERS_MAX         32
+#define CAP_POLL_MS             1000
+#define CAP_HEAP_DEFAULT        "/dev/dma_heap/linux,cma"
+
+typedef struct CapBuffer_s
+{
+    void *pData;
+    size_t length;                      /* mapped or allocated bytes */
+    int dmabufFd;
+    RawCapFrameHeader_t *pHeader;       /* RAWCAP_BLOCK sized and aligned */
+} CapBuffer_t;
+
+typedef struct Cap_s
+{
+    int videoFd;
+    int sensorFd;
+    int outFd;
+    enum v4l2_buf_type type;
+    enum v4l2_memory memory;
+    const char *heap;
+    struct v4l2_pix_format pix;
+    uint32_t numBuffers;
+    CapBuffer_t buffers[CAP_BUFFERS_MAX];
+    RawCapFileHeader_t *pFileHeader;    /* RAWCAP_BLOCK sized and aligned */
+    void *pBounce;
+    int directIo;
+    int zeroCopy;
+
+    /* dequeued buffers waiting for the writer, in capture order */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t queue[CAP_BUFFERS_MAX];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t peakBacklog;
+    int captureDone;
+    int writeError;
+
+    uint32_t framesWritten;
+    uint32_t droppedFrames;
+    uint64_t firstTimestampNs;
+    uint64_t lastTimestampNs;
+} Cap_t;
+
+static volatile sig_atomic_t CapStop;
+
+static void CapSignal(int sig)
+{
+    (void)sig;
+    CapStop = 1;
+}
+
+static uint64_t CapNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int CapIsMplane(const Cap_t *pCap)
+{
+    return pCap->type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+}
+
+static uint32_t CapBitDepth(uint32_t fourcc)
+{
+    switch (fourcc) {
+    case V4L2_PIX_FMT_SBGGR8:
+    case V4L2_PIX_FMT_SGBRG8:
+    case V4L2_PIX_FMT_SGRBG8:
+    case V4L2_PIX_FMT_SRGGB8:
+    case V4L2_PIX_FMT_GREY:
+        return 8;
+    case V4L2_PIX_FMT_SBGGR10:
+    case V4L2_PIX_FMT_SGBRG10:
+    case V4L2_PIX_FMT_SGRBG10:
+    case V4L2_PIX_FMT_SRGGB10:
+    case V4L2_PIX_FMT_Y10:
+        return 10;
+    case V4L2_PIX_FMT_SBGGR12:
+    case V4L2_PIX_FMT_SGBRG12:
+    case V4L2_PIX_FMT_SGRBG12:
+    case V4L2_PIX_FMT_SRGGB12:
+    case V4L2_PIX_FMT_Y12:
+        return 12;
+    case V4L2_PIX_FMT_SBGGR16:
+    case V4L2_PIX_FMT_Y16:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+static void CapInitV4l2Buffer(const Cap_t *pCap, struct v4l2_buffer *pBuf,
+                              struct v4l2_plane *pPlane, uint32_t index)
+{
+    memset(pBuf, 0, sizeof(*pBuf));
+    memset(pPlane, 0, sizeof(*pPlane));
+    pBuf->type = pCap->type;
+    pBuf->memory = pCap->memory;
+    pBuf->index = index;
+    if (CapIsMplane(pCap)) {
+        pBuf->m.planes = pPlane;
+        pBuf->length = 1;
+    }
+}
+
+static int CapQueueBuffer(Cap_t *pCap, uint32_t index)
+{
+    CapBuffer_t *pBuffer = &pCap->buffers[index];
+    struct v4l2_buffer buf;
+    struct v4l2_plane plane;
+
+    CapInitV4l2Buffer(pCap, &buf, &plane, index);
+    if (CapIsMplane(pCap)) {
+        plane.length = pBuffer->length;
+        if (pCap->memory == V4L2_MEMORY_USERPTR)
+            plane.m.userptr = (unsigned long)pBuffer->pData;
+        else if (pCap->memory == V4L2_MEMORY_DMABUF)
+            plane.m.fd = pBuffer->dmabufFd;
+    } else if (pCap->memory != V4L2_MEMORY_MMAP) {
+        buf.length = pBuffer->length;
+        if (pCap->memory == V4L2_MEMORY_USERPTR)
+            buf.m.userptr = (unsigned long)pBuffer->pData;
+        else
+            buf.m.fd = pBuffer->dmabufFd;
+    }
+
+    return ioctl(pCap->videoFd, VIDIOC_QBUF, &buf);
+}
+
+static int CapDmabufSync(const CapBuffer_t *pBuffer, uint64_t flags)
+{
+    struct dma_buf_sync sync;
+
+    if (pBuffer->dmabufFd < 0)
+        return 0;
+    sync.flags = flags | DMA_BUF_SYNC_READ;
+    return ioctl(pBuffer->dmabufFd, DMA_BUF_IOCTL_SYNC, &sync);
+}
+
+static int CapPwriteAll(int fd, struct iovec *pIov, int count, off_t offset)
+{
+    ssize_t n;
+
+    while (count > 0) {
+        n = pwritev(fd, pIov, count, offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        offset += n;
+        while (count > 0 && (size_t)n >= pIov->iov_len) {
+            n -= pIov->iov_len;
+            pIov++;
+            count--;
+        }
+        if (count > 0) {
+            pIov->iov_base = (char *)pIov->iov_base + n;
+            pIov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+static int CapWriteFrame(Cap_t *pCap, uint32_t index)
+{
+    CapBuffer_t *pBuffer = &pCap->buffers[index];
+    size_t payload = pCap->pFileHeader->recordSize - RAWCAP_BLOCK;
+    off_t offset = RawCapRecordOffset(pCap->pFileHeader, pCap->framesWritten);
+    struct iovec iov[2];
+    int ret;
+
+    iov[0].iov_base = pBuffer->pHeader;
+    iov[0].iov_len = RAWCAP_BLOCK;
+    iov[1].iov_len = payload;
+
+    CapDmabufSync(pBuffer, DMA_BUF_SYNC_START);
+    if (pCap->zeroCopy) {
+        iov[1].iov_base = pBuffer->pData;
+        ret = CapPwriteAll(pCap->outFd, iov, 2, offset);
+        if (ret == 0 || (errno != EFAULT && errno != EINVAL))
+            goto out;
+        /*
+         * Mappings of device memory (VM_PFNMAP) cannot be pinned for direct
+         * I/O. Copy through the bounce buffer from now on.
+         */
+        fprintf(stderr, "buffers cannot be written directly, copying them\n");
+        pCap->zeroCopy = 0;
+        iov[0].iov_base = pBuffer->pHeader;
+        iov[0].iov_len = RAWCAP_BLOCK;
+        iov[1].iov_len = payload;
+    }
+    memcpy(pCap->pBounce, pBuffer->pData,
+           pBuffer->pHeader->bytesUsed < payload ? pBuffer->pHeader->bytesUsed : payload);
+    iov[1].iov_base = pCap->pBounce;
+    ret = CapPwriteAll(pCap->outFd, iov, 2, offset);
+out:
+    CapDmabufSync(pBuffer, DMA_BUF_SYNC_END);
+    return ret;
+}
+
+static void *CapWriter(void *arg)
+{
+    Cap_t *pCap = (Cap_t *)arg;
+    uint32_t index;
+    int requeue;
+
+    for (;;) {
+        pthread_mutex_lock(&pCap->lock);
+        while (pCap->head == pCap->tail && !pCap->captureDone)
+            pthread_cond_wait(&pCap->cond, &pCap->lock);
+        if (pCap->head == pCap->tail) {
+            pthread_mutex_unlock(&pCap->lock);
+            break;
+        }
+        index = pCap->queue[pCap->head % CAP_BUFFERS_MAX];
+        pthread_mutex_unlock(&pCap->lock);
+
+        if (CapWriteFrame(pCap, index) != 0) {
+            perror("write");
+            pthread_mutex_lock(&pCap->lock);
+            pCap->writeError = 1;
+            pthread_mutex_unlock(&pCap->lock);
+            break;
+        }
+        pCap->framesWritten++;
+
+        pthread_mutex_lock(&pCap->lock);
+        pCap->head++;
+        requeue = !pCap->captureDone;
+        pthread_mutex_unlock(&pCap->lock);
+
+        if (requeue && CapQueueBuffer(pCap, index) != 0)
+            perror("VIDIOC_QBUF");
+    }
+    return NULL;
+}
+
+static int CapSetFormat(Cap_t *pCap, uint32_t width, uint32_t height,
+                        uint32_t fourcc)
+{
+    struct v4l2_format fmt;
+
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = pCap->type;
+    if (ioctl(pCap->videoFd, VIDIOC_G_FMT, &fmt) != 0) {
+        perror("VIDIOC_G_FMT");
+        return -1;
+    }
+
+    if (width || height || fourcc) {
+        if (CapIsMplane(pCap)) {
+            if (width)
+                fmt.fmt.pix_mp.width = width;
+            if (height)
+                fmt.fmt.pix_mp.height = height;
+            if (fourcc)
+                fmt.fmt.pix_mp.pixelformat = fourcc;
+            fmt.fmt.pix_mp.num_planes = 1;
+            fmt.fmt.pix_mp.plane_fmt[0].bytesperline = 0;
+            fmt.fmt.pix_mp.plane_fmt[0].sizeimage = 0;
+        } else {
+            if (width)
+                fmt.fmt.pix.width = width;
+            if (height)
+                fmt.fmt.pix.height = height;
+            if (fourcc)
+                fmt.fmt.pix.pixelformat = fourcc;
+            fmt.fmt.pix.bytesperline = 0;
+            fmt.fmt.pix.sizeimage = 0;
+        }
+        if (ioctl(pCap->videoFd, VIDIOC_S_FMT, &fmt) != 0) {
+            perror("VIDIOC_S_FMT");
+            return -1;
+        }
+    }
+
+    if (CapIsMplane(pCap)) {
+        if (fmt.fmt.pix_mp.num_planes != 1) {
+            fprintf(stderr, "only single plane formats are supported\n");
+            return -1;
+        }
+        pCap->pix.width = fmt.fmt.pix_mp.width;
+        pCap->pix.height = fmt.fmt.pix_mp.height;
+        pCap->pix.pixelformat = fmt.fmt.pix_mp.pixelformat;
+        pCap->pix.bytesperline = fmt.fmt.pix_mp.plane_fmt[0].bytesperline;
+        pCap->pix.sizeimage = fmt.fmt.pix_mp.plane_fmt[0].sizeimage;
+    } else {
+        pCap->pix = fmt.fmt.pix;
+    }
+
+    if ((width && pCap->pix.width != width) ||
+        (height && pCap->pix.height != height) ||
+        (fourcc && pCap->pix.pixelformat != fourcc)) {
+        fprintf(stderr, "device picked %ux%u %.4s\n", pCap->pix.width,
+                pCap->pix.height, (const char *)&pCap->pix.pixelformat);
+        return -1;
+    }
+    return 0;
+}
+
+static int CapSetFps(Cap_t *pCap, uint32_t fps)
+{
+    struct v4l2_streamparm parm;
+
+    memset(&parm, 0, sizeof(parm));
+    parm.type = pCap->type;
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = fps;
+    if (ioctl(pCap->videoFd, VIDIOC_S_PARM, &parm) != 0) {
+        perror("VIDIOC_S_PARM");
+        return -1;
+    }
+    if (parm.parm.capture.timeperframe.numerator * fps !=
+        parm.parm.capture.timeperframe.denominator)
+        fprintf(stderr, "device runs at %u/%u fps\n",
+                parm.parm.capture.timeperframe.denominator,
+                parm.parm.capture.timeperframe.numerator);
+    return 0;
+}
+
+static int CapAllocBuffer(Cap_t *pCap, uint32_t index, int heapFd)
+{
+    CapBuffer_t *pBuffer = &pCap->buffers[index];
+    size_t size = RAWCAP_ALIGN(pCap->pix.sizeimage);
+    struct dma_heap_allocation_data alloc;
+    struct v4l2_buffer buf;
+    struct v4l2_plane plane;
+
+    pBuffer->dmabufFd = -1;
+    if (posix_memalign((void **)&pBuffer->pHeader, RAWCAP_BLOCK, RAWCAP_BLOCK) != 0)
+        return -1;
+    memset(pBuffer->pHeader, 0, RAWCAP_BLOCK);
+
+    switch (pCap->memory) {
+    case V4L2_MEMORY_MMAP:
+        CapInitV4l2Buffer(pCap, &buf, &plane, index);
+        if (ioctl(pCap->videoFd, VIDIOC_QUERYBUF, &buf) != 0) {
+            perror("VIDIOC_QUERYBUF");
+            return -1;
+        }
+        pBuffer->length = CapIsMplane(pCap) ? plane.length : buf.length;
+        pBuffer->pData = mmap(NULL, pBuffer->length, PROT_READ, MAP_SHARED,
+                              pCap->videoFd,
+                              CapIsMplane(pCap) ? plane.m.mem_offset : buf.m.offset);
+        break;
+    case V4L2_MEMORY_USERPTR:
+        pBuffer->length = size;
+        if (posix_memalign(&pBuffer->pData, RAWCAP_BLOCK, size) != 0)
+            pBuffer->pData = MAP_FAILED;
+        break;
+    default:
+        memset(&alloc, 0, sizeof(alloc));
+        alloc.len = size;
+        alloc.fd_flags = O_RDWR | O_CLOEXEC;
+        if (ioctl(heapFd, DMA_HEAP_IOCTL_ALLOC, &alloc) != 0) {
+            perror("DMA_HEAP_IOCTL_ALLOC");
+            return -1;
+        }
+        pBuffer->dmabufFd = alloc.fd;
+        pBuffer->length = size;
+        pBuffer->pData = mmap(NULL, size, PROT_READ, MAP_SHARED, alloc.fd, 0);
+        break;
+    }
+
+    if (pBuffer->pData == MAP_FAILED) {
+        pBuffer->pData = NULL;
+        perror("buffer mapping");
+        return -1;
+    }
+    /* the tail of the record is written from the buffer too */
+    if (pBuffer->length < size)
+        pCap->zeroCopy = 0;
+    return 0;
+}
+
+static void CapFreeBuffer(Cap_t *pCap, uint32_t index)
+{
+    CapBuffer_t *pBuffer = &pCap->buffers[index];
+
+    if (pBuffer->pData) {
+        if (pCap->memory == V4L2_MEMORY_USERPTR)
+            free(pBuffer->pData);
+        else
+            munmap(pBuffer->pData, pBuffer->length);
+    }
+    if (pBuffer->dmabufFd >= 0)
+        close(pBuffer->dmabufFd);
+    free(pBuffer->pHeader);
+}
+
+static int CapSetupBuffers(Cap_t *pCap, uint32_t count)
+{
+    struct v4l2_requestbuffers req;
+    int heapFd = -1;
+    uint32_t i;
+
+    memset(&req, 0, sizeof(req));
+    req.count = count;
+    req.type = pCap->type;
+    req.memory = pCap->memory;
+    if (ioctl(pCap->videoFd, VIDIOC_REQBUFS, &req) != 0) {
+        perror("VIDIOC_REQBUFS");
+        return -1;
+    }
+    if (req.count == 0 || req.count > CAP_BUFFERS_MAX) {
+        fprintf(stderr, "device gave %u buffers\n", req.count);
+        return -1;
+    }
+    pCap->numBuffers = req.count;
+
+    if (pCap->memory == V4L2_MEMORY_DMABUF) {
+        heapFd = open(pCap->heap, O_RDONLY | O_CLOEXEC);
+        if (heapFd < 0) {
+            perror(pCap->heap);
+            return -1;
+        }
+    }
+
+    for (i = 0; i < pCap->numBuffers; i++) {
+        if (CapAllocBuffer(pCap, i, heapFd) != 0)
+            break;
+    }
+    if (heapFd >= 0)
+        close(heapFd);
+    if (i < pCap->numBuffers) {
+        pCap->numBuffers = i + 1;
+        return -1;
+    }
+
+    for (i = 0; i < pCap->numBuffers; i++) {
+        if (CapQueueBuffer(pCap, i) != 0) {
+            perror("VIDIOC_QBUF");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int CapOpenOutput(Cap_t *pCap, const char *path, uint32_t maxFrames)
+{
+    RawCapFileHeader_t *pHeader = pCap->pFileHeader;
+
+    if (pCap->directIo) {
+        pCap->outFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        if (pCap->outFd < 0 && errno == EINVAL) {
+            fprintf(stderr, "%s: no O_DIRECT support, using buffered I/O\n", path);
+            pCap->directIo = 0;
+        }
+    }
+    if (!pCap->directIo)
+        pCap->outFd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (pCap->outFd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    memset(pHeader, 0, RAWCAP_BLOCK);
+    memcpy(pHeader->magic, RAWCAP_MAGIC, sizeof(pHeader->magic));
+    pHeader->version = RAWCAP_VERSION;
+    pHeader->headerSize = RAWCAP_BLOCK;
+    pHeader->width = pCap->pix.width;
+    pHeader->height = pCap->pix.height;
+    pHeader->pixelFormat = pCap->pix.pixelformat;
+    pHeader->bitDepth = CapBitDepth(pCap->pix.pixelformat);
+    pHeader->bytesPerLine = pCap->pix.bytesperline;
+    pHeader->frameSize = pCap->pix.sizeimage;
+    pHeader->recordSize = RAWCAP_BLOCK + RAWCAP_ALIGN(pCap->pix.sizeimage);
+
+    /* keep the file contiguous and the writes free of block allocation */
+    if (maxFrames &&
+        fallocate(pCap->outFd, 0, 0, RawCapRecordOffset(pHeader, maxFrames)) != 0 &&
+        errno != EOPNOTSUPP)
+        perror("fallocate");
+
+    if (pwrite(pCap->outFd, pHeader, RAWCAP_BLOCK, 0) != RAWCAP_BLOCK) {
+        perror("write header");
+        return -1;
+    }
+    return 0;
+}
+
+static int CapCloseOutput(Cap_t *pCap)
+{
+    RawCapFileHeader_t *pHeader = pCap->pFileHeader;
+    int ret = 0;
+
+    pHeader->frameCount = pCap->framesWritten;
+    pHeader->droppedFrames = pCap->droppedFrames;
+    if (pwrite(pCap->outFd, pHeader, RAWCAP_BLOCK, 0) != RAWCAP_BLOCK ||
+        ftruncate(pCap->outFd, RawCapRecordOffset(pHeader, pCap->framesWritten)) != 0 ||
+        fdatasync(pCap->outFd) != 0) {
+        perror("close output");
+        ret = -1;
+    }
+    close(pCap->outFd);
+    return ret;
+}
+
+static void CapStampFrame(Cap_t *pCap, const struct v4l2_buffer *pBuf,
+                          uint32_t bytesUsed, uint32_t droppedBefore)
+{
+    RawCapFrameHeader_t *pHeader = pCap->buffers[pBuf->index].pHeader;
+    struct vvcam_exposure_s exposure;
+
+    pHeader->timestampNs = (uint64_t)pBuf->timestamp.tv_sec * 1000000000ull +
+                           (uint64_t)pBuf->timestamp.tv_usec * 1000ull;
+    pHeader->sequence = pBuf->sequence;
+    pHeader->bytesUsed = bytesUsed;
+    pHeader->droppedBefore = droppedBefore;
+    pHeader->flags = 0;
+    if (pBuf->flags & V4L2_BUF_FLAG_ERROR)
+        pHeader->flags |= RAWCAP_FRAME_ERROR;
+
+    if (pCap->sensorFd >= 0 &&
+        ioctl(pCap->sensorFd, VVSENSORIOC_G_EXPOSURE, &exposure) == 0) {
+        pHeader->integrationLine = exposure.integration_line;
+        pHeader->gain = exposure.gain;
+        pHeader->flags |= RAWCAP_FRAME_EXPOSURE_VALID;
+    }
+
+    if (!pCap->firstTimestampNs)
+        pCap->firstTimestampNs = pHeader->timestampNs;
+    pCap->lastTimestampNs = pHeader->timestampNs;
+}
+
+static int CapRun(Cap_t *pCap, uint32_t maxFrames)
+{
+    struct pollfd pfd = { .fd = pCap->videoFd, .events = POLLIN };
+    struct v4l2_buffer buf;
+    struct v4l2_plane plane;
+    uint32_t captured = 0, lastSequence = 0, dropped, bytesUsed, backlog;
+    int ret;
+
+    while (!CapStop && (!maxFrames || captured < maxFrames)) {
+        if (pCap->writeError)
+            return -1;
+
+        ret = poll(&pfd, 1, CAP_POLL_MS);
+        if (ret < 0 && errno != EINTR) {
+            perror("poll");
+            return -1;
+        }
+        if (ret <= 0)
+            continue;
+
+        CapInitV4l2Buffer(pCap, &buf, &plane, 0);
+        if (ioctl(pCap->videoFd, VIDIOC_DQBUF, &buf) != 0) {
+            if (errno == EAGAIN || errno == EINTR)
+                continue;
+            perror("VIDIOC_DQBUF");
+            return -1;
+        }
+        bytesUsed = CapIsMplane(pCap) ? plane.bytesused : buf.bytesused;
+
+        dropped = 0;
+        if (captured && buf.sequence != lastSequence + 1)
+            dropped = buf.sequence - lastSequence - 1;
+        lastSequence = buf.sequence;
+        pCap->droppedFrames += dropped;
+        captured++;
+
+        CapStampFrame(pCap, &buf, bytesUsed, dropped);
+
+        pthread_mutex_lock(&pCap->lock);
+        pCap->queue[pCap->tail % CAP_BUFFERS_MAX] = buf.index;
+        pCap->tail++;
+        backlog = pCap->tail - pCap->head;
+        if (backlog > pCap->peakBacklog)
+            pCap->peakBacklog = backlog;
+        pthread_cond_signal(&pCap->cond);
+        pthread_mutex_unlock(&pCap->lock);
+    }
+    return 0;
+}
+
+static int CapParseFourcc(const char *str, uint32_t *pFourcc)
+{
+    if (strlen(str) != 4)
+        return -1;
+    *pFourcc = v4l2_fourcc(str[0], str[1], str[2], str[3]);
+    return 0;
+}
+
+static void CapUsage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s -d device -o file [-n frames] [-W width] [-H height]\n"
+            "          [-f fourcc] [-r fps] [-c buffers] [-m memory] [-s subdev]\n"
+            "          [-D heap] [-b]\n"
+            "  -d  V4L2 capture node\n"
+            "  -o  output .vvraw file\n"
+            "  -n  frames to capture (default until interrupted)\n"
+            "  -W, -H, -f  format to set, e.g. -f RG10 (default current format)\n"
+            "  -r  frame rate to request with VIDIOC_S_PARM\n"
+            "  -c  capture buffers (default %d, at most %d)\n"
+            "  -m  mmap, userptr or dmabuf (default mmap)\n"
+            "  -s  sensor subdev to read exposure and gain from per frame\n"
+            "  -D  dma-heap for dmabuf buffers (default %s)\n"
+            "  -b  buffered writes instead of O_DIRECT\n",
+            prog, CAP_BUFFERS_DEFAULT, CAP_BUFFERS_MAX, CAP_HEAP_DEFAULT);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t width = 0, height = 0, fourcc = 0, fps = 0, maxFrames = 0;
+    uint32_t numBuffers = CAP_BUFFERS_DEFAULT;
+    const char *device = NULL, *output = NULL, *subdev = NULL;
+    struct v4l2_capability cap;
+    struct sigaction sa;
+    pthread_t writer;
+    uint64_t startNs = 0, elapsedNs, bytes;
+    uint32_t caps, i;
+    Cap_t Cap;
+    int opt, ret = 1;
+
+    memset(&Cap, 0, sizeof(Cap));
+    Cap.videoFd = -1;
+    Cap.sensorFd = -1;
+    Cap.outFd = -1;
+    Cap.memory = V4L2_MEMORY_MMAP;
+    Cap.heap = CAP_HEAP_DEFAULT;
+    Cap.directIo = 1;
+    Cap.zeroCopy = 1;
+
+    while ((opt = getopt(argc, argv, "d:o:n:W:H:f:r:c:m:s:D:bh")) != -1) {
+        switch (opt) {
+        case 'd':
+            device = optarg;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'n':
+            maxFrames = strtoul(optarg, NULL, 0);
+            break;
+        case 'W':
+            width = strtoul(optarg, NULL, 0);
+            break;
+        case 'H':
+            height = strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            if (CapParseFourcc(optarg, &fourcc) != 0) {
+                CapUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'r':
+            fps = strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            numBuffers = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            if (strcmp(optarg, "mmap") == 0)
+                Cap.memory = V4L2_MEMORY_MMAP;
+            else if (strcmp(optarg, "userptr") == 0)
+                Cap.memory = V4L2_MEMORY_USERPTR;
+            else if (strcmp(optarg, "dmabuf") == 0)
+                Cap.memory = V4L2_MEMORY_DMABUF;
+            else {
+                CapUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 's':
+            subdev = optarg;
+            break;
+        case 'D':
+            Cap.heap = optarg;
+            break;
+        case 'b':
+            Cap.directIo = 0;
+            break;
+        default:
+            CapUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!device || !output || optind != argc ||
+        numBuffers == 0 || numBuffers > CAP_BUFFERS_MAX) {
+        CapUsage(argv[0]);
+        return 1;
+    }
+
+    Cap.videoFd = open(device, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (Cap.videoFd < 0) {
+        perror(device);
+        return 1;
+    }
+    if (ioctl(Cap.videoFd, VIDIOC_QUERYCAP, &cap) != 0) {
+        perror("VIDIOC_QUERYCAP");
+        goto out_video;
+    }
+    caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_STREAMING)) {
+        fprintf(stderr, "%s: no streaming support\n", device);
+        goto out_video;
+    }
+    if (caps & V4L2_CAP_VIDEO_CAPTURE) {
+        Cap.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    } else if (caps & V4L2_CAP_VIDEO_CAPTURE_MPLANE) {
+        Cap.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    } else {
+        fprintf(stderr, "%s: not a capture device\n", device);
+        goto out_video;
+    }
+
+    if (subdev) {
+        Cap.sensorFd = open(subdev, O_RDWR | O_CLOEXEC);
+        if (Cap.sensorFd < 0) {
+            perror(subdev);
+            goto out_video;
+        }
+    }
+
+    if (CapSetFormat(&Cap, width, height, fourcc) != 0 ||
+        (fps && CapSetFps(&Cap, fps) != 0))
+        goto out_sensor;
+
+    if (posix_memalign((void **)&Cap.pFileHeader, RAWCAP_BLOCK, RAWCAP_BLOCK) != 0 ||
+        posix_memalign(&Cap.pBounce, RAWCAP_BLOCK, RAWCAP_ALIGN(Cap.pix.sizeimage)) != 0) {
+        fprintf(stderr, "out of memory\n");
+        goto out_sensor;
+    }
+
+    if (CapSetupBuffers(&Cap, numBuffers) != 0)
+        goto out_buffers;
+    if (CapOpenOutput(&Cap, output, maxFrames) != 0)
+        goto out_buffers;
+
+    pthread_mutex_init(&Cap.lock, NULL);
+    pthread_cond_init(&Cap.cond, NULL);
+    if (pthread_create(&writer, NULL, CapWriter, &Cap) != 0) {
+        fprintf(stderr, "cannot start the writer thread\n");
+        goto out_output;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = CapSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("%s: %ux%u %.4s, %u bytes per frame, %u %s buffers\n", device,
+           Cap.pix.width, Cap.pix.height, (const char *)&Cap.pix.pixelformat,
+           Cap.pix.sizeimage, Cap.numBuffers,
+           Cap.memory == V4L2_MEMORY_MMAP ? "mmap" :
+           Cap.memory == V4L2_MEMORY_USERPTR ? "userptr" : "dmabuf");
+
+    startNs = CapNowNs();
+    if (ioctl(Cap.videoFd, VIDIOC_STREAMON, &Cap.type) != 0) {
+        perror("VIDIOC_STREAMON");
+        CapStop = 1;
+    }
+    ret = CapRun(&Cap, maxFrames) != 0;
+
+    pthread_mutex_lock(&Cap.lock);
+    Cap.captureDone = 1;
+    pthread_cond_signal(&Cap.cond);
+    pthread_mutex_unlock(&Cap.lock);
+    pthread_join(writer, NULL);
+    ioctl(Cap.videoFd, VIDIOC_STREAMOFF, &Cap.type);
+    ret |= Cap.writeError;
+
+out_output:
+    if (CapCloseOutput(&Cap) != 0)
+        ret = 1;
+    if (Cap.framesWritten) {
+        elapsedNs = CapNowNs() - startNs;
+        bytes = RawCapRecordOffset(Cap.pFileHeader, Cap.framesWritten);
+        printf("%u frames, %u dropped, %.1f fps, %.1f MB/s, "
+               "peak writer backlog %u/%u, %s\n",
+               Cap.framesWritten, Cap.droppedFrames,
+               Cap.lastTimestampNs > Cap.firstTimestampNs ?
+               (Cap.framesWritten - 1) * 1e9 /
+               (double)(Cap.lastTimestampNs - Cap.firstTimestampNs) : 0.0,
+               bytes * 1e3 / (double)elapsedNs, Cap.peakBacklog, Cap.numBuffers,
+               !Cap.directIo ? "buffered" :
+               Cap.zeroCopy ? "O_DIRECT without copies" : "O_DIRECT with copies");
+    }
+out_buffers:
+    for (i = 0; i < Cap.numBuffers; i++)
+        CapFreeBuffer(&Cap, i);
+    free(Cap.pBounce);
+    free(Cap.pFileHeader);
+out_sensor:
+    if (Cap.sensorFd >= 0)
+        close(Cap.sensorFd);
+out_video:
+    close(Cap.videoFd);
+    return ret;
+}
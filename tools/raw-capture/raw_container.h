@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Layout of the .vvraw files written by raw-capture.
+ *
+ * A file is one RAWCAP_BLOCK holding RawCapFileHeader_t, followed by
+ * frameCount fixed size records. Each record is one RAWCAP_BLOCK holding
+ * RawCapFrameHeader_t and the frame payload, padded to RAWCAP_BLOCK, so
+ * that every record can be written with O_DIRECT and frame i is found at
+ * RawCapRecordOffset(header, i). All fields are little endian.
+ */
+
+#ifndef __RAW_CONTAINER_H__
+#define __RAW_CONTAINER_H__
+
+#include <stdint.h>
+
+#define RAWCAP_MAGIC            "VVRAWCAP"
+#define RAWCAP_VERSION          1
+#define RAWCAP_BLOCK            4096
+
+#define RAWCAP_ALIGN(x)         (((x) + RAWCAP_BLOCK - 1) & ~(uint64_t)(RAWCAP_BLOCK - 1))
+
+/* RawCapFrameHeader_t flags */
+#define RAWCAP_FRAME_EXPOSURE_VALID   (1u << 0)   /* integrationLine, gain set */
+#define RAWCAP_FRAME_ERROR            (1u << 1)   /* V4L2_BUF_FLAG_ERROR */
+
+typedef struct RawCapFileHeader_s
+{
+    char magic[8];                      /* RAWCAP_MAGIC, not terminated */
+    uint32_t version;                   /* RAWCAP_VERSION */
+    uint32_t headerSize;                /* offset of the first record */
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixelFormat;               /* V4L2 fourcc */
+    uint32_t bitDepth;                  /* bits per sample, 0 if unknown */
+    uint32_t bytesPerLine;
+    uint32_t frameSize;                 /* V4L2 sizeimage */
+    uint32_t recordSize;                /* frame header block and payload */
+    uint32_t frameCount;                /* 0 until the capture is closed */
+    uint32_t droppedFrames;             /* sequence gaps seen by the capture */
+    uint32_t reserved[19];
+} RawCapFileHeader_t;
+
+typedef struct RawCapFrameHeader_s
+{
+    uint64_t timestampNs;               /* V4L2 buffer timestamp */
+    uint32_t sequence;                  /* V4L2 buffer sequence */
+    uint32_t bytesUsed;                 /* valid payload bytes */
+    uint32_t integrationLine;           /* from VVSENSORIOC_G_EXPOSURE */
+    uint32_t gain;                      /* SENSOR_FIX_FRACBITS fixed point */
+    uint32_t flags;                     /* RAWCAP_FRAME_* */
+    uint32_t droppedBefore;             /* frames missing before this one */
+    uint32_t reserved[8];
+} RawCapFrameHeader_t;
+
+static inline uint64_t RawCapRecordOffset(const RawCapFileHeader_t *pHeader,
+                                          uint32_t frame)
+{
+    return pHeader->headerSize + (uint64_t)frame * pHeader->recordSize;
+}
+
+#endif
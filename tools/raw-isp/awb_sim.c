@@ -0,0 +1,415 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Offline AWB simulator.
+ *
+ * Runs the AWB model of a calibration XML over RAW capture sequences:
+ * window statistics after black level and LSC, GMM illumination
+ * likelihoods, IIR damping and the white balance gains of the selected
+ * illuminations. Reports per capture the final illumination and gains and
+ * how many frames the gains took to converge.
+ *
+ *   awb-sim -c calib.xml [-R resolution] [-B bits] [-g WxH] [-e percent] [-L]
+ *           [-f first] [-n frames] [-v] [-W width -H height -b bits
+ *           -p pattern [-k]] input...
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raw_input.h"
+#include "ref_awb.h"
+#include "ref_lsc.h"
+
+#define AWB_CALIB_BITS_DEFAULT  10
+#define AWB_SATURATION          0.95f   /* of the white level */
+#define AWB_DARK                0.01f   /* of the white level, window mean G */
+#define AWB_LSC_CT_THRESHOLD    100.0f  /* kelvin */
+#define AWB_GAIN_FRACBITS       10      /* SENSOR_FIX_FRACBITS of frame headers */
+
+typedef struct AwbSimOptions_s
+{
+    const char *resolution;
+    uint32_t calibBitDepth;
+    uint32_t gridWidth;
+    uint32_t gridHeight;
+    float tolerance;                    /* relative, of the final gains */
+    int noLsc;
+    uint32_t first;
+    uint32_t frames;
+    int verbose;
+} AwbSimOptions_t;
+
+typedef struct AwbSimStats_s
+{
+    uint32_t windows;
+    float *pSum[3];                     /* R G B sums of each window */
+    uint32_t *pCount;                   /* unsaturated quads */
+    uint32_t *pQuads;                   /* all quads */
+    float *pMean[3];                    /* window means, G 0 if left out */
+    uint16_t *pWinX;                    /* window column of each quad column */
+} AwbSimStats_t;
+
+static void AwbSimStatsFree(AwbSimStats_t *pStats)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        free(pStats->pSum[i]);
+        free(pStats->pMean[i]);
+    }
+    free(pStats->pCount);
+    free(pStats->pQuads);
+    free(pStats->pWinX);
+    memset(pStats, 0, sizeof(*pStats));
+}
+
+static int AwbSimStatsInit(AwbSimStats_t *pStats, const AwbSimOptions_t *pOptions,
+                           uint32_t width)
+{
+    uint32_t qx, quadsX = width / 2;
+    int i;
+
+    memset(pStats, 0, sizeof(*pStats));
+    pStats->windows = pOptions->gridWidth * pOptions->gridHeight;
+    for (i = 0; i < 3; i++) {
+        pStats->pSum[i] = malloc(pStats->windows * sizeof(float));
+        pStats->pMean[i] = malloc(pStats->windows * sizeof(float));
+        if (!pStats->pSum[i] || !pStats->pMean[i])
+            return -1;
+    }
+    pStats->pCount = malloc(pStats->windows * sizeof(uint32_t));
+    pStats->pQuads = malloc(pStats->windows * sizeof(uint32_t));
+    pStats->pWinX = malloc(quadsX * sizeof(uint16_t));
+    if (!pStats->pCount || !pStats->pQuads || !pStats->pWinX)
+        return -1;
+    for (qx = 0; qx < quadsX; qx++)
+        pStats->pWinX[qx] = qx * pOptions->gridWidth / quadsX;
+    return 0;
+}
+
+/*
+ * Mean R G B of each window over the Bayer quads with no saturated sample,
+ * after black level and lens shading correction.
+ */
+static void AwbSimStatsFrame(AwbSimStats_t *pStats, const AwbSimOptions_t *pOptions,
+                             const RawInput_t *pInput, const uint16_t *pSamples,
+                             const uint8_t chan[2][2], const float *pBls,
+                             const RefLscMap_t *pLscMap)
+{
+    const uint32_t quadsX = pInput->width / 2, quadsY = pInput->height / 2;
+    const float white = (float)((1u << pInput->bitDepth) - 1);
+    const uint16_t saturation = (uint16_t)(white * AWB_SATURATION);
+    const float *pGain[2][2] = { { NULL, NULL }, { NULL, NULL } };
+    float value[REF_CH_MAX], dark;
+    uint32_t qx, qy, w, wy, i;
+    int y, x;
+
+    for (i = 0; i < 3; i++)
+        memset(pStats->pSum[i], 0, pStats->windows * sizeof(float));
+    memset(pStats->pCount, 0, pStats->windows * sizeof(uint32_t));
+    memset(pStats->pQuads, 0, pStats->windows * sizeof(uint32_t));
+
+    for (qy = 0; qy < quadsY; qy++) {
+        const uint16_t *pRows[2] = {
+            pSamples + (size_t)(2 * qy) * pInput->width,
+            pSamples + (size_t)(2 * qy + 1) * pInput->width,
+        };
+
+        wy = qy * pOptions->gridHeight / quadsY;
+        if (pLscMap) {
+            for (y = 0; y < 2; y++) {
+                for (x = 0; x < 2; x++)
+                    pGain[y][x] = RefLscMapRow(pLscMap, (RefChannel_t)chan[y][x], qy);
+            }
+        }
+
+        for (qx = 0; qx < quadsX; qx++) {
+            int saturated = 0;
+
+            w = wy * pOptions->gridWidth + pStats->pWinX[qx];
+            pStats->pQuads[w]++;
+            for (y = 0; y < 2; y++) {
+                for (x = 0; x < 2; x++) {
+                    uint16_t raw = pRows[y][2 * qx + x];
+                    RefChannel_t ch = (RefChannel_t)chan[y][x];
+                    float v = (float)raw - pBls[ch];
+
+                    saturated |= raw >= saturation;
+                    v = v > 0.0f ? v : 0.0f;
+                    value[ch] = pLscMap ? v * pGain[y][x][qx] : v;
+                }
+            }
+            if (saturated)
+                continue;
+            pStats->pSum[0][w] += value[REF_CH_R];
+            pStats->pSum[1][w] += 0.5f * (value[REF_CH_GR] + value[REF_CH_GB]);
+            pStats->pSum[2][w] += value[REF_CH_B];
+            pStats->pCount[w]++;
+        }
+    }
+
+    /* windows that are mostly saturated or dark are left out */
+    dark = white * AWB_DARK;
+    for (w = 0; w < pStats->windows; w++) {
+        float inv = pStats->pCount[w] ? 1.0f / pStats->pCount[w] : 0.0f;
+
+        for (i = 0; i < 3; i++)
+            pStats->pMean[i][w] = pStats->pSum[i][w] * inv;
+        if (2 * pStats->pCount[w] < pStats->pQuads[w] || pStats->pMean[1][w] < dark) {
+            for (i = 0; i < 3; i++)
+                pStats->pMean[i][w] = 0.0f;
+        }
+    }
+}
+
+static int AwbSimGainsClose(const float *pGains, const float *pFinal, float tolerance)
+{
+    int ch;
+
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        if (fabsf(pGains[ch] - pFinal[ch]) > tolerance * pFinal[ch])
+            return 0;
+    }
+    return 1;
+}
+
+static int AwbSimCapture(const char *path, RawInput_t *pInput, const AwbSimOptions_t *pOptions,
+                         const RefCalib_t *pCalib, const RefAwbModel_t *pModel)
+{
+    RefLscMapConfig_t LscConfig;
+    RefLscMap_t *pLscMap = NULL;
+    RefAwb_t *pAwb = NULL;
+    RefAwbResult_t Result;
+    AwbSimStats_t Stats;
+    RawCapFrameHeader_t Header;
+    uint16_t *pSamples = NULL;
+    float (*pGains)[REF_CH_MAX] = NULL;
+    float bls[REF_CH_MAX], calibScale;
+    uint32_t frame, frames, first, i, converged;
+    int blend, ret = -1;
+
+    memset(&Stats, 0, sizeof(Stats));
+    if (RawInputOpen(pInput, path) != 0)
+        goto out;
+    if (pInput->bayer == REF_BAYER_MONO) {
+        fprintf(stderr, "%s: AWB needs a Bayer capture\n", path);
+        goto out;
+    }
+    first = pOptions->first;
+    if (first >= pInput->frames) {
+        fprintf(stderr, "%s has %u frames\n", path, pInput->frames);
+        goto out;
+    }
+    frames = pInput->frames - first;
+    if (pOptions->frames && pOptions->frames < frames)
+        frames = pOptions->frames;
+
+    /* blsData is on the calibration bit depth */
+    calibScale = (float)(1u << pInput->bitDepth) / (float)(1u << pOptions->calibBitDepth);
+    for (i = 0; i < REF_CH_MAX; i++)
+        bls[i] = pCalib->bls[i] * calibScale;
+
+    memset(&LscConfig, 0, sizeof(LscConfig));
+    LscConfig.width = pInput->width;
+    LscConfig.height = pInput->height;
+    LscConfig.block = 2;
+    LscConfig.ctThreshold = AWB_LSC_CT_THRESHOLD;
+    RefIspBayerChannels(pInput->bayer, LscConfig.chan);
+    blend = pCalib->numLscProfiles > 0;
+    if (!pOptions->noLsc && pCalib->hasLsc) {
+        pLscMap = RefLscMapCreate(&LscConfig,
+                                  blend ? pCalib->lscProfiles : &pCalib->lsc,
+                                  blend ? pCalib->numLscProfiles : 1);
+        if (!pLscMap)
+            goto out;
+        /* until the AWB has an estimate, the calibration's illumination */
+        RefLscMapUpdate(pLscMap, pCalib->lsc.ct);
+    }
+
+    pSamples = malloc((size_t)pInput->width * pInput->height * sizeof(uint16_t));
+    pGains = malloc(frames * sizeof(*pGains));
+    pAwb = RefAwbCreate(pModel, pOptions->gridWidth * pOptions->gridHeight);
+    if (!pSamples || !pGains || !pAwb ||
+        AwbSimStatsInit(&Stats, pOptions, pInput->width) != 0) {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+
+    if (pOptions->verbose)
+        printf("%s\nframe  seq  exposure   gain  windows damping illumination"
+               "      ct  R gain B gain  line\n", path);
+
+    for (frame = 0; frame < frames; frame++) {
+        if (RawInputRead(pInput, first + frame, pSamples, &Header) != 0)
+            goto out;
+        AwbSimStatsFrame(&Stats, pOptions, pInput, pSamples, LscConfig.chan, bls,
+                         pLscMap);
+        RefAwbProcess(pAwb, Stats.pMean[0], Stats.pMean[1], Stats.pMean[2], &Result);
+        memcpy(pGains[frame], Result.gains, sizeof(Result.gains));
+
+        /* the next frame is shaded for the temperature found */
+        if (pLscMap && Result.ct > 0.0f)
+            RefLscMapUpdate(pLscMap, Result.ct);
+
+        if (pOptions->verbose)
+            printf("%5u %4u %9u %6.2f %8u %7.2f %-16s %5.0f %6.3f %6.3f %5.2f\n",
+                   first + frame, Header.sequence, Header.integrationLine,
+                   Header.gain / (float)(1 << AWB_GAIN_FRACBITS), Result.whiteWindows,
+                   Result.damping, pModel->illums[Result.illum].name, Result.ct,
+                   Result.gains[REF_CH_R], Result.gains[REF_CH_B],
+                   Result.lineDistance);
+    }
+
+    /* converged from the first frame after which the gains stay close to
+     * the final ones */
+    converged = frames;
+    while (converged > 0 &&
+           AwbSimGainsClose(pGains[converged - 1], pGains[frames - 1], pOptions->tolerance))
+        converged--;
+
+    if (Result.gains[REF_CH_GR] == 0.0f) {
+        printf("%s: %u frames, no white windows\n", path, frames);
+        ret = 0;
+        goto out;
+    }
+    printf("%s: %u frames, %s (%.0f%%), %.0f K, gains %.3f %.3f %.3f %.3f, ",
+           path, frames, pModel->illums[Result.illum].name,
+           100.0f * Result.prob[Result.illum], Result.ct, Result.gains[REF_CH_R],
+           Result.gains[REF_CH_GR], Result.gains[REF_CH_GB], Result.gains[REF_CH_B]);
+    if (!Result.whiteWindows)
+        printf("no white windows in the last frame\n");
+    else if (converged + 1 >= frames && frames > 1)
+        printf("not converged\n");
+    else
+        printf("converged in %u frames\n", converged);
+    ret = 0;
+out:
+    AwbSimStatsFree(&Stats);
+    RefAwbDestroy(pAwb);
+    free(pGains);
+    free(pSamples);
+    RefLscMapDestroy(pLscMap);
+    RawInputClose(pInput);
+    return ret;
+}
+
+static void AwbSimUsage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s -c calib.xml [-R resolution] [-B bits] [-g WxH] [-e percent]\n"
+            "          [-L] [-f first] [-n frames] [-v]\n"
+            "          [-W width -H height -b bits -p pattern [-k]] input...\n"
+            "  -c  calibration XML\n"
+            "  -R  calibration resolution (default the first)\n"
+            "  -B  bit depth of blsData (default %d)\n"
+            "  -g  statistics windows (default 32x32)\n"
+            "  -e  gains within this percentage of the final ones are converged\n"
+            "      (default 1)\n"
+            "  -L  no lens shading correction of the statistics\n"
+            "  -f, -n  first frame and number of frames (default all)\n"
+            "  -v  print the estimate of every frame\n"
+            "  -W, -H, -b, -p, -k  size, bit depth, pattern (rggb, grbg, gbrg,\n"
+            "      bggr) and CSI-2 packing of files that are not .vvraw\n",
+            prog, AWB_CALIB_BITS_DEFAULT);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *calibPath = NULL;
+    AwbSimOptions_t Options;
+    RefAwbModel_t Model;
+    RefCalib_t Calib;
+    RawInput_t Input, Bare;
+    int opt, ret = 0;
+
+    memset(&Options, 0, sizeof(Options));
+    memset(&Bare, 0, sizeof(Bare));
+    Options.calibBitDepth = AWB_CALIB_BITS_DEFAULT;
+    Options.gridWidth = 32;
+    Options.gridHeight = 32;
+    Options.tolerance = 0.01f;
+
+    while ((opt = getopt(argc, argv, "c:R:B:g:e:Lf:n:vW:H:b:p:kh")) != -1) {
+        switch (opt) {
+        case 'c':
+            calibPath = optarg;
+            break;
+        case 'R':
+            Options.resolution = optarg;
+            break;
+        case 'B':
+            Options.calibBitDepth = strtoul(optarg, NULL, 0);
+            break;
+        case 'g':
+            if (sscanf(optarg, "%ux%u", &Options.gridWidth, &Options.gridHeight) != 2) {
+                AwbSimUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'e':
+            Options.tolerance = strtof(optarg, NULL) / 100.0f;
+            break;
+        case 'L':
+            Options.noLsc = 1;
+            break;
+        case 'f':
+            Options.first = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            Options.frames = strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            Options.verbose = 1;
+            break;
+        case 'W':
+            Bare.width = strtoul(optarg, NULL, 0);
+            break;
+        case 'H':
+            Bare.height = strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            Bare.bitDepth = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            if (RawInputParseBayer(optarg, &Bare.bayer) != 0) {
+                AwbSimUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'k':
+            Bare.packed = 1;
+            break;
+        default:
+            AwbSimUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!calibPath || optind >= argc || !Options.gridWidth || !Options.gridHeight ||
+        Options.calibBitDepth < 8 || Options.calibBitDepth > 16) {
+        AwbSimUsage(argv[0]);
+        return 1;
+    }
+
+    if (RefCalibLoad(&Calib, calibPath, NULL, Options.resolution) != 0 ||
+        RefAwbLoad(&Model, calibPath, Options.resolution) != 0)
+        return 1;
+
+    for (; optind < argc; optind++) {
+        /* every file starts from the bare description */
+        Input = Bare;
+        if (AwbSimCapture(argv[optind], &Input, &Options, &Calib, &Model) != 0)
+            ret = 1;
+    }
+    return ret;
+}
@@ -0,0 +1,334 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "calib_xml.h"
+
+#define CALIB_XML_MAX_DEPTH     64
+
+/* the root owns the file buffer all names and texts point into, and an
+ * untouched copy of it */
+typedef struct CalibXmlDoc_s
+{
+    CalibXmlNode_t root;
+    char *pBuffer;
+    char *pSource;
+} CalibXmlDoc_t;
+
+static char *CalibXmlRead(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    char *pBuffer = NULL;
+    long size;
+
+    if (!fp) {
+        perror(path);
+        return NULL;
+    }
+    if (fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) >= 0 &&
+        fseek(fp, 0, SEEK_SET) == 0) {
+        pBuffer = malloc(size + 1);
+        if (pBuffer && fread(pBuffer, 1, size, fp) == (size_t)size) {
+            pBuffer[size] = '\0';
+        } else {
+            free(pBuffer);
+            pBuffer = NULL;
+        }
+    }
+    if (!pBuffer)
+        fprintf(stderr, "%s: read error\n", path);
+    fclose(fp);
+    return pBuffer;
+}
+
+static char *CalibXmlTrim(char *pStart, char *pEnd)
+{
+    while (pStart < pEnd && isspace((unsigned char)*pStart))
+        pStart++;
+    while (pEnd > pStart && isspace((unsigned char)pEnd[-1]))
+        pEnd--;
+    *pEnd = '\0';
+    return pStart;
+}
+
+static void CalibXmlFreeNodes(CalibXmlNode_t *pNode)
+{
+    CalibXmlNode_t *pNext;
+
+    while (pNode) {
+        CalibXmlFreeNodes(pNode->pChild);
+        pNext = pNode->pNext;
+        free(pNode);
+        pNode = pNext;
+    }
+}
+
+void CalibXmlFree(CalibXmlNode_t *pRoot)
+{
+    CalibXmlDoc_t *pDoc = (CalibXmlDoc_t *)pRoot;
+
+    if (!pDoc)
+        return;
+    CalibXmlFreeNodes(pDoc->root.pChild);
+    free(pDoc->pBuffer);
+    free(pDoc->pSource);
+    free(pDoc);
+}
+
+CalibXmlNode_t *CalibXmlLoad(const char *path)
+{
+    CalibXmlNode_t *pStack[CALIB_XML_MAX_DEPTH];
+    CalibXmlNode_t *pLast[CALIB_XML_MAX_DEPTH];
+    char *pText[CALIB_XML_MAX_DEPTH];
+    CalibXmlDoc_t *pDoc;
+    CalibXmlNode_t *pNode;
+    char *p, *pName, *pEnd;
+    int depth = 0, selfClosing;
+    char c;
+
+    pDoc = calloc(1, sizeof(*pDoc));
+    if (!pDoc)
+        return NULL;
+    pDoc->root.name = "";
+    pDoc->root.text = "";
+    pDoc->pBuffer = CalibXmlRead(path);
+    if (!pDoc->pBuffer) {
+        free(pDoc);
+        return NULL;
+    }
+    pDoc->root.end = strlen(pDoc->pBuffer);
+    pDoc->root.contentEnd = pDoc->root.end;
+    pDoc->pSource = strdup(pDoc->pBuffer);
+    if (!pDoc->pSource) {
+        CalibXmlFree(&pDoc->root);
+        return NULL;
+    }
+
+    pStack[0] = &pDoc->root;
+    pLast[0] = NULL;
+    pText[0] = NULL;
+    p = pDoc->pBuffer;
+
+    while ((p = strchr(p, '<')) != NULL) {
+        if (strncmp(p, "<?", 2) == 0 || strncmp(p, "<!--", 4) == 0) {
+            pEnd = strstr(p, p[1] == '?' ? "?>" : "-->");
+            if (!pEnd)
+                goto error;
+            p = pEnd + 2;
+            continue;
+        }
+        if (p[1] == '!') {
+            p++;
+            continue;
+        }
+
+        if (p[1] == '/') {
+            /* closing tag: the text of a leaf ends here */
+            pEnd = p;
+            pName = p + 2;
+            p = strchr(pName, '>');
+            if (!p || depth == 0)
+                goto error;
+            *p++ = '\0';
+            pNode = pStack[depth];
+            pNode->contentEnd = pEnd - pDoc->pBuffer;
+            pNode->end = p - pDoc->pBuffer;
+            if (strcmp(CalibXmlTrim(pName, pName + strlen(pName)), pNode->name) != 0)
+                goto error;
+            pNode->text = pNode->pChild ? "" : CalibXmlTrim(pText[depth], pEnd);
+            depth--;
+            continue;
+        }
+
+        pName = ++p;
+        while (*p && !isspace((unsigned char)*p) && *p != '/' && *p != '>')
+            p++;
+        c = *p;
+        *p = '\0';
+        if (c == '/') {
+            if (*++p != '>')
+                goto error;
+            selfClosing = 1;
+        } else if (c == '>') {
+            selfClosing = 0;
+        } else {
+            /* skip the attributes, quoted values may hold '>' */
+            p++;
+            while (*p && *p != '>') {
+                if (*p == '"' || *p == '\'') {
+                    pEnd = strchr(p + 1, *p);
+                    if (!pEnd)
+                        goto error;
+                    p = pEnd;
+                }
+                p++;
+            }
+            if (!*p)
+                goto error;
+            selfClosing = p[-1] == '/';
+        }
+        p++;
+
+        pNode = calloc(1, sizeof(*pNode));
+        if (!pNode)
+            goto error;
+        pNode->name = pName;
+        pNode->text = "";
+        pNode->start = pName - 1 - pDoc->pBuffer;
+        pNode->contentStart = p - pDoc->pBuffer;
+        pNode->contentEnd = pNode->contentStart;
+        pNode->end = pNode->contentStart;
+        if (pLast[depth])
+            pLast[depth]->pNext = pNode;
+        else
+            pStack[depth]->pChild = pNode;
+        pLast[depth] = pNode;
+
+        if (!selfClosing) {
+            if (++depth >= CALIB_XML_MAX_DEPTH)
+                goto error;
+            pStack[depth] = pNode;
+            pLast[depth] = NULL;
+            pText[depth] = p;
+        }
+    }
+
+    if (depth == 0)
+        return &pDoc->root;
+error:
+    fprintf(stderr, "%s: malformed XML\n", path);
+    CalibXmlFree(&pDoc->root);
+    return NULL;
+}
+
+CalibXmlNode_t *CalibXmlChild(const CalibXmlNode_t *pNode, const char *name)
+{
+    CalibXmlNode_t *pChild;
+
+    if (!pNode)
+        return NULL;
+    for (pChild = pNode->pChild; pChild; pChild = pChild->pNext) {
+        if (strcmp(pChild->name, name) == 0)
+            return pChild;
+    }
+    return NULL;
+}
+
+CalibXmlNode_t *CalibXmlNext(const CalibXmlNode_t *pNode)
+{
+    CalibXmlNode_t *pNext;
+
+    for (pNext = pNode->pNext; pNext; pNext = pNext->pNext) {
+        if (strcmp(pNext->name, pNode->name) == 0)
+            return pNext;
+    }
+    return NULL;
+}
+
+CalibXmlNode_t *CalibXmlPath(const CalibXmlNode_t *pNode, const char *path)
+{
+    char name[64];
+    size_t len;
+
+    while (pNode && *path) {
+        len = strcspn(path, "/");
+        if (len >= sizeof(name))
+            return NULL;
+        memcpy(name, path, len);
+        name[len] = '\0';
+        pNode = CalibXmlChild(pNode, name);
+        path += len;
+        if (*path == '/')
+            path++;
+    }
+    return (CalibXmlNode_t *)pNode;
+}
+
+const char *CalibXmlText(const CalibXmlNode_t *pNode)
+{
+    return pNode ? pNode->text : "";
+}
+
+const char *CalibXmlChildText(const CalibXmlNode_t *pNode, const char *name)
+{
+    CalibXmlNode_t *pChild = CalibXmlChild(pNode, name);
+
+    return pChild ? pChild->text : "";
+}
+
+int CalibXmlDoubles(const CalibXmlNode_t *pNode, double *pValues, int max)
+{
+    const char *p;
+    char *pEnd;
+    double value;
+    int count = 0;
+
+    if (!pNode || pNode->text[0] != '[')
+        return -1;
+
+    p = pNode->text + 1;
+    for (;;) {
+        while (isspace((unsigned char)*p) || *p == ',' || *p == ';')
+            p++;
+        if (*p == ']')
+            return count;
+        value = strtod(p, &pEnd);
+        if (pEnd == p)
+            return -1;
+        if (count < max)
+            pValues[count] = value;
+        count++;
+        p = pEnd;
+    }
+}
+
+const char *CalibXmlSource(const CalibXmlNode_t *pRoot)
+{
+    return ((const CalibXmlDoc_t *)pRoot)->pSource;
+}
+
+char *CalibXmlRender(const CalibXmlNode_t *pRoot, size_t start, size_t end,
+                     CalibXmlEdit_t *pEdits, uint32_t count)
+{
+    const char *pSource = CalibXmlSource(pRoot);
+    size_t size = end - start, pos, len;
+    CalibXmlEdit_t edit;
+    char *pText, *pDst;
+    uint32_t i, j;
+
+    /* a stable sort, edits are few */
+    for (i = 1; i < count; i++) {
+        edit = pEdits[i];
+        for (j = i; j > 0 && pEdits[j - 1].start > edit.start; j--)
+            pEdits[j] = pEdits[j - 1];
+        pEdits[j] = edit;
+    }
+    for (i = 0; i < count; i++)
+        size += strlen(pEdits[i].text) - (pEdits[i].end - pEdits[i].start);
+
+    pText = malloc(size + 1);
+    if (!pText)
+        return NULL;
+    pDst = pText;
+    pos = start;
+    for (i = 0; i < count; i++) {
+        memcpy(pDst, pSource + pos, pEdits[i].start - pos);
+        pDst += pEdits[i].start - pos;
+        len = strlen(pEdits[i].text);
+        memcpy(pDst, pEdits[i].text, len);
+        pDst += len;
+        pos = pEdits[i].end;
+    }
+    memcpy(pDst, pSource + pos, end - pos);
+    pDst[end - pos] = '\0';
+    return pText;
+}
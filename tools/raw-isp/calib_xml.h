@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Reader for the ISP calibration XML files in calib/<SENSOR>.
+ *
+ * The files are MATLAB struct dumps: elements with a type and size
+ * attribute whose text is a string or a "[v0 v1 ...]" array, and cell
+ * arrays of <cell> elements. Only element names and text are kept, with
+ * where each element lies in the file so that it can be edited as text.
+ */
+
+#ifndef __CALIB_XML_H__
+#define __CALIB_XML_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct CalibXmlNode_s
+{
+    const char *name;
+    const char *text;                   /* trimmed, "" for none */
+    struct CalibXmlNode_s *pChild;
+    struct CalibXmlNode_s *pNext;
+    /* byte offsets in the file of the '<' of the open tag, of the content
+     * between the tags and of the end of the close tag */
+    size_t start;
+    size_t contentStart;
+    size_t contentEnd;
+    size_t end;
+} CalibXmlNode_t;
+
+/* replaces bytes [start, end) of the file, inserts when start == end */
+typedef struct CalibXmlEdit_s
+{
+    size_t start;
+    size_t end;
+    const char *text;
+} CalibXmlEdit_t;
+
+/* NULL on a read or parse error, reported on stderr */
+CalibXmlNode_t *CalibXmlLoad(const char *path);
+void CalibXmlFree(CalibXmlNode_t *pRoot);
+
+/* first child named name, NULL if none */
+CalibXmlNode_t *CalibXmlChild(const CalibXmlNode_t *pNode, const char *name);
+
+/* next sibling with the same name, for walking <cell> lists */
+CalibXmlNode_t *CalibXmlNext(const CalibXmlNode_t *pNode);
+
+/* descendant along a '/' separated path of names, e.g. "matfile/sensor/LSC" */
+CalibXmlNode_t *CalibXmlPath(const CalibXmlNode_t *pNode, const char *path);
+
+/* text of a node, "" for NULL */
+const char *CalibXmlText(const CalibXmlNode_t *pNode);
+
+/* text of the named child, "" if there is none */
+const char *CalibXmlChildText(const CalibXmlNode_t *pNode, const char *name);
+
+/*
+ * Parse the "[v0 v1 ...]" text of a node into at most max values and
+ * return how many there were, -1 if the text is not an array.
+ */
+int CalibXmlDoubles(const CalibXmlNode_t *pNode, double *pValues, int max);
+
+/* the file as read, before parsing */
+const char *CalibXmlSource(const CalibXmlNode_t *pRoot);
+
+/*
+ * Bytes [start, end) of the file with the edits applied, in a string to
+ * free. The edits must lie inside the range and not overlap; they are
+ * sorted in place, insertions at the same offset keeping their order.
+ * NULL when out of memory.
+ */
+char *CalibXmlRender(const CalibXmlNode_t *pRoot, size_t start, size_t end,
+                     CalibXmlEdit_t *pEdits, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
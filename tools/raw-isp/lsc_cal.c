@@ -0,0 +1,1148 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Flat-field lens shading calibration.
+ *
+ * Averages flat-field RAW captures of each illumination, fits the 17x17
+ * gain grids of every Bayer channel on the LSC_SECT_SIZE_X/Y sectors of the
+ * calibration and writes them into its LSC profiles. An illumination with no
+ * profile at the resolution gets a new one, with its aLSC entry, on the
+ * sectors of the resolution's other profiles or scaled from its own at
+ * another resolution.
+ *
+ *   lsc-cal -c calib.xml [-o out.xml] [-R resolution] [-B bits] [-V percent]
+ *           [-t threads] [-f first] [-n frames] [-v] [-W width -H height
+ *           -b bits -p pattern [-k]] illumination=input...
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "raw_input.h"
+#include "ref_lsc.h"
+
+#define LSC_CAL_CALIB_BITS_DEFAULT  10
+#define LSC_CAL_MAX_INPUTS      64
+#define LSC_CAL_MAX_THREADS     64
+#define LSC_CAL_NODES           (REF_LSC_GRID * REF_LSC_GRID)
+#define LSC_CAL_SECTORS         (2 * REF_LSC_SECTORS_HALF)
+#define LSC_CAL_UNITY           1024.0  /* sample of a 1.0 gain */
+#define LSC_CAL_SAMPLE_MAX      4095    /* 2.10 gains of the ISP */
+#define LSC_CAL_SATURATION      0.95f   /* of the white level, averaged */
+#define LSC_CAL_MAX_SATURATED   0.001   /* of the pixels */
+#define LSC_CAL_DARK            0.02f   /* of the white level, centre */
+
+static const char *LscCalChannelNames[REF_CH_MAX] = { "R", "Gr", "Gb", "B" };
+
+typedef struct LscCalOptions_s
+{
+    const char *resolution;
+    uint32_t calibBitDepth;
+    uint32_t vignetting;                /* percent of the luminance shading */
+    uint32_t threads;
+    uint32_t first;
+    uint32_t frames;
+    int verbose;
+} LscCalOptions_t;
+
+/* the captures of one illumination */
+typedef struct LscCalIllum_s
+{
+    const char *name;
+    const char *paths[LSC_CAL_MAX_INPUTS];
+    uint32_t numPaths;
+    uint32_t profile[2][REF_LSC_SECTORS_HALF];  /* sectors, x then y */
+    uint16_t samples[REF_CH_MAX][LSC_CAL_NODES];
+} LscCalIllum_t;
+
+/* averaged flat field, black subtracted */
+typedef struct LscCalFlat_s
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t bitDepth;
+    RefBayer_t bayer;
+    uint32_t frames;
+    float *pMean;
+} LscCalFlat_t;
+
+typedef struct LscCalWorker_s
+{
+    pthread_t thread;
+    RawInput_t input;                   /* shares the fd, own frame buffer */
+    uint16_t *pSamples;
+    uint32_t *pSum;
+    uint32_t frame;                     /* first, then every step */
+    uint32_t end;
+    uint32_t step;
+    int ret;
+} LscCalWorker_t;
+
+static void *LscCalWorker(void *pArg)
+{
+    LscCalWorker_t *pWorker = pArg;
+    size_t i, count = (size_t)pWorker->input.width * pWorker->input.height;
+    uint32_t frame;
+
+    for (frame = pWorker->frame; frame < pWorker->end; frame += pWorker->step) {
+        if (RawInputRead(&pWorker->input, frame, pWorker->pSamples, NULL) != 0) {
+            pWorker->ret = -1;
+            break;
+        }
+        for (i = 0; i < count; i++)
+            pWorker->pSum[i] += pWorker->pSamples[i];
+    }
+    return NULL;
+}
+
+/* add the frames of one capture to pSum, a thread per share of them */
+static int LscCalAccumulate(RawInput_t *pInput, uint32_t first, uint32_t frames,
+                            uint32_t threads, uint32_t *pSum)
+{
+    LscCalWorker_t workers[LSC_CAL_MAX_THREADS];
+    size_t i, count = (size_t)pInput->width * pInput->height;
+    uint32_t t, started = 0;
+    int ret = -1;
+
+    if (threads > frames)
+        threads = frames;
+    memset(workers, 0, sizeof(workers));
+    for (t = 0; t < threads; t++) {
+        workers[t].input = *pInput;
+        workers[t].input.pFrame = malloc(pInput->frameSize);
+        workers[t].pSamples = malloc(count * sizeof(uint16_t));
+        /* the first worker adds to the total directly */
+        workers[t].pSum = t ? calloc(count, sizeof(uint32_t)) : pSum;
+        if (!workers[t].input.pFrame || !workers[t].pSamples || !workers[t].pSum) {
+            fprintf(stderr, "out of memory\n");
+            goto out;
+        }
+        workers[t].frame = first + t;
+        workers[t].end = first + frames;
+        workers[t].step = threads;
+    }
+
+    for (started = 0; started < threads; started++) {
+        if (pthread_create(&workers[started].thread, NULL, LscCalWorker,
+                           &workers[started]) != 0) {
+            fprintf(stderr, "cannot start the worker threads\n");
+            break;
+        }
+    }
+    ret = started == threads ? 0 : -1;
+    for (t = 0; t < started; t++) {
+        pthread_join(workers[t].thread, NULL);
+        if (workers[t].ret != 0)
+            ret = -1;
+    }
+    for (t = 1; t < started && ret == 0; t++) {
+        for (i = 0; i < count; i++)
+            pSum[i] += workers[t].pSum[i];
+    }
+
+out:
+    for (t = 0; t < threads; t++) {
+        free(workers[t].input.pFrame);
+        free(workers[t].pSamples);
+        if (t)
+            free(workers[t].pSum);
+    }
+    return ret;
+}
+
+/* add the frames of one capture to the sums, the first one sets the format */
+static int LscCalAddCapture(const char *path, const char *firstPath, const RawInput_t *pBare,
+                            const LscCalOptions_t *pOptions, LscCalFlat_t *pFlat,
+                            uint32_t **ppSum)
+{
+    RawInput_t Input = *pBare;
+    uint32_t first, frames;
+    int ret = -1;
+
+    if (RawInputOpen(&Input, path) != 0)
+        goto out;
+    if (!*ppSum) {
+        pFlat->width = Input.width;
+        pFlat->height = Input.height;
+        pFlat->bitDepth = Input.bitDepth;
+        pFlat->bayer = Input.bayer;
+        *ppSum = calloc((size_t)Input.width * Input.height, sizeof(uint32_t));
+        if (!*ppSum) {
+            fprintf(stderr, "out of memory\n");
+            goto out;
+        }
+    } else if (Input.width != pFlat->width || Input.height != pFlat->height ||
+               Input.bitDepth != pFlat->bitDepth || Input.bayer != pFlat->bayer) {
+        fprintf(stderr, "%s: not in the format of %s\n", path, firstPath);
+        goto out;
+    }
+
+    first = pOptions->first;
+    if (first >= Input.frames) {
+        fprintf(stderr, "%s has %u frames\n", path, Input.frames);
+        goto out;
+    }
+    frames = Input.frames - first;
+    if (pOptions->frames && pOptions->frames < frames)
+        frames = pOptions->frames;
+    /* the sums are 32 bit */
+    if ((uint64_t)(pFlat->frames + frames) << Input.bitDepth > UINT32_MAX) {
+        fprintf(stderr, "%s: too many frames to average\n", path);
+        goto out;
+    }
+    if (LscCalAccumulate(&Input, first, frames, pOptions->threads, *ppSum) != 0)
+        goto out;
+    pFlat->frames += frames;
+    ret = 0;
+out:
+    RawInputClose(&Input);
+    return ret;
+}
+
+/* average every capture of an illumination into pFlat */
+static int LscCalAverage(const LscCalIllum_t *pIllum, const RawInput_t *pBare,
+                         const LscCalOptions_t *pOptions, const float *pBls,
+                         LscCalFlat_t *pFlat)
+{
+    uint32_t *pSum = NULL;
+    uint32_t n, i, x, y;
+    uint8_t chan[2][2];
+    float scale, bls[REF_CH_MAX];
+    int ret = -1;
+
+    memset(pFlat, 0, sizeof(*pFlat));
+    for (n = 0; n < pIllum->numPaths; n++) {
+        if (LscCalAddCapture(pIllum->paths[n], pIllum->paths[0], pBare, pOptions,
+                             pFlat, &pSum) != 0)
+            goto out;
+    }
+
+    pFlat->pMean = malloc((size_t)pFlat->width * pFlat->height * sizeof(float));
+    if (!pFlat->pMean) {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+    /* blsData is on the calibration bit depth */
+    scale = (float)(1u << pFlat->bitDepth) / (float)(1u << pOptions->calibBitDepth);
+    for (i = 0; i < REF_CH_MAX; i++)
+        bls[i] = pBls[i] * scale;
+    RefIspBayerChannels(pFlat->bayer, chan);
+    scale = 1.0f / (float)pFlat->frames;
+    for (y = 0; y < pFlat->height; y++) {
+        const uint32_t *pSrc = pSum + (size_t)y * pFlat->width;
+        float *pDst = pFlat->pMean + (size_t)y * pFlat->width;
+        const float bls0 = bls[chan[y & 1][0]], bls1 = bls[chan[y & 1][1]];
+
+        for (x = 0; x + 1 < pFlat->width; x += 2) {
+            pDst[x] = (float)pSrc[x] * scale - bls0;
+            pDst[x + 1] = (float)pSrc[x + 1] * scale - bls1;
+        }
+        if (x < pFlat->width)
+            pDst[x] = (float)pSrc[x] * scale - bls0;
+    }
+    ret = 0;
+out:
+    free(pSum);
+    return ret;
+}
+
+/* the sector and the position in it of every sample of one channel along an
+ * axis, placed as RefLscMap places them */
+static void LscCalAxis(const uint32_t *pHalfSizes, uint32_t length, uint32_t parity,
+                       uint8_t *pSect, float *pFrac)
+{
+    float start[LSC_CAL_SECTORS + 1], size[LSC_CAL_SECTORS], total = 0.0f, pos;
+    uint32_t i, k, s = 0;
+
+    for (i = 0; i < REF_LSC_SECTORS_HALF; i++) {
+        size[i] = (float)pHalfSizes[i];
+        size[LSC_CAL_SECTORS - 1 - i] = (float)pHalfSizes[i];
+        total += 2.0f * pHalfSizes[i];
+    }
+    start[0] = 0.0f;
+    for (i = 0; i < LSC_CAL_SECTORS; i++)
+        start[i + 1] = start[i] + size[i];
+
+    for (k = 0; parity + 2 * k < length; k++) {
+        pos = (float)(parity + 2 * k) * total / (float)length;
+        while (s < LSC_CAL_SECTORS - 1 && pos >= start[s + 1])
+            s++;
+        pSect[k] = (uint8_t)s;
+        pFrac[k] = (pos - start[s]) / size[s];
+    }
+}
+
+/* Cholesky solution of the symmetric positive definite pA x = pB, in place */
+static int LscCalSolve(double *pA, double *pB, uint32_t n)
+{
+    uint32_t i, j, k;
+    double sum;
+
+    for (j = 0; j < n; j++) {
+        sum = pA[j * n + j];
+        for (k = 0; k < j; k++)
+            sum -= pA[j * n + k] * pA[j * n + k];
+        if (sum <= 0.0)
+            return -1;
+        pA[j * n + j] = sqrt(sum);
+        for (i = j + 1; i < n; i++) {
+            sum = pA[i * n + j];
+            for (k = 0; k < j; k++)
+                sum -= pA[i * n + k] * pA[j * n + k];
+            pA[i * n + j] = sum / pA[j * n + j];
+        }
+    }
+    for (i = 0; i < n; i++) {
+        sum = pB[i];
+        for (k = 0; k < i; k++)
+            sum -= pA[i * n + k] * pB[k];
+        pB[i] = sum / pA[i * n + i];
+    }
+    for (i = n; i-- > 0;) {
+        sum = pB[i];
+        for (k = i + 1; k < n; k++)
+            sum -= pA[k * n + i] * pB[k];
+        pB[i] = sum / pA[i * n + i];
+    }
+    return 0;
+}
+
+/*
+ * The grid of one channel whose bilinear interpolation G makes the flat
+ * field I flat: least squares of G * I - 1 over the channel's pixels, which
+ * weighs every pixel by how much its corrected value is off. The result is
+ * up to a scale, applied by the caller.
+ */
+static int LscCalFitChannel(const LscCalFlat_t *pFlat, const uint32_t profile[2][REF_LSC_SECTORS_HALF],
+                            uint32_t py, uint32_t px, float saturation, double *pA,
+                            double *pGrid, uint32_t *pSaturated)
+{
+    const uint32_t cols = (pFlat->width - px + 1) / 2, rows = (pFlat->height - py + 1) / 2;
+    uint8_t *pSectX = malloc(cols), *pSectY = malloc(rows);
+    float *pFracX = malloc(cols * sizeof(float)), *pFracY = malloc(rows * sizeof(float));
+    uint32_t i, j, a, b, node[4];
+    double v, w[4], diag = 0.0;
+    int ret = -1;
+
+    if (!pSectX || !pSectY || !pFracX || !pFracY) {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+    LscCalAxis(profile[0], pFlat->width, px, pSectX, pFracX);
+    LscCalAxis(profile[1], pFlat->height, py, pSectY, pFracY);
+
+    memset(pA, 0, LSC_CAL_NODES * LSC_CAL_NODES * sizeof(double));
+    memset(pGrid, 0, LSC_CAL_NODES * sizeof(double));
+    for (j = 0; j < rows; j++) {
+        const float *pRow = pFlat->pMean + (size_t)(py + 2 * j) * pFlat->width + px;
+        const double fy = pFracY[j];
+
+        for (i = 0; i < cols; i++) {
+            v = pRow[2 * i];
+            if (v >= saturation) {
+                (*pSaturated)++;
+                continue;
+            }
+            node[0] = pSectY[j] * REF_LSC_GRID + pSectX[i];
+            node[1] = node[0] + 1;
+            node[2] = node[0] + REF_LSC_GRID;
+            node[3] = node[2] + 1;
+            w[0] = (1.0 - fy) * (1.0 - pFracX[i]) * v;
+            w[1] = (1.0 - fy) * pFracX[i] * v;
+            w[2] = fy * (1.0 - pFracX[i]) * v;
+            w[3] = fy * pFracX[i] * v;
+            for (a = 0; a < 4; a++) {
+                pGrid[node[a]] += w[a];
+                for (b = 0; b < 4; b++)
+                    pA[node[a] * LSC_CAL_NODES + node[b]] += w[a] * w[b];
+            }
+        }
+    }
+
+    /* a touch of ridge keeps nodes the pixels hardly reach solvable */
+    for (a = 0; a < LSC_CAL_NODES; a++)
+        diag += pA[a * LSC_CAL_NODES + a];
+    for (a = 0; a < LSC_CAL_NODES; a++)
+        pA[a * LSC_CAL_NODES + a] += 1e-9 * diag / LSC_CAL_NODES;
+    if (LscCalSolve(pA, pGrid, LSC_CAL_NODES) != 0) {
+        fprintf(stderr, "the flat field leaves the LSC grid undetermined\n");
+        goto out;
+    }
+    ret = 0;
+out:
+    free(pSectX);
+    free(pSectY);
+    free(pFracX);
+    free(pFracY);
+    return ret;
+}
+
+static void LscCalNormalize(double *pGrid)
+{
+    double low = pGrid[0];
+    uint32_t a;
+
+    for (a = 1; a < LSC_CAL_NODES; a++) {
+        if (pGrid[a] < low)
+            low = pGrid[a];
+    }
+    for (a = 0; a < LSC_CAL_NODES; a++)
+        pGrid[a] /= low;
+}
+
+/*
+ * Fit the grids of every channel. Each is scaled to a lowest gain of 1, so
+ * that the colour where the lens is brightest is left to the white balance;
+ * below 100% vignetting only that part of the luminance shading is
+ * corrected, the colour shading still in full.
+ */
+static int LscCalFit(LscCalIllum_t *pIllum, const LscCalFlat_t *pFlat,
+                     const LscCalOptions_t *pOptions)
+{
+    const float saturation = LSC_CAL_SATURATION * (float)((1u << pFlat->bitDepth) - 1);
+    double *pA, grids[REF_CH_MAX][LSC_CAL_NODES], lum, exponent, v;
+    uint32_t ch, p, a, saturated = 0, clipped = 0;
+    uint8_t chan[2][2];
+    int ret = -1;
+
+    pA = malloc(LSC_CAL_NODES * LSC_CAL_NODES * sizeof(double));
+    if (!pA) {
+        fprintf(stderr, "out of memory\n");
+        return -1;
+    }
+    RefIspBayerChannels(pFlat->bayer, chan);
+    for (p = 0; p < 4; p++) {
+        if (LscCalFitChannel(pFlat, pIllum->profile, p >> 1, p & 1, saturation, pA,
+                             grids[chan[p >> 1][p & 1]], &saturated) != 0)
+            goto out;
+    }
+    if (saturated > LSC_CAL_MAX_SATURATED * pFlat->width * pFlat->height) {
+        fprintf(stderr, "%s: %u saturated pixels, lower the exposure\n",
+                pIllum->name, saturated);
+        goto out;
+    }
+
+    for (ch = 0; ch < REF_CH_MAX; ch++)
+        LscCalNormalize(grids[ch]);
+    if (pOptions->vignetting < 100) {
+        exponent = (double)pOptions->vignetting / 100.0 - 1.0;
+        for (a = 0; a < LSC_CAL_NODES; a++) {
+            lum = pow(0.5 * (grids[REF_CH_GR][a] + grids[REF_CH_GB][a]), exponent);
+            for (ch = 0; ch < REF_CH_MAX; ch++)
+                grids[ch][a] *= lum;
+        }
+        for (ch = 0; ch < REF_CH_MAX; ch++)
+            LscCalNormalize(grids[ch]);
+    }
+
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        for (a = 0; a < LSC_CAL_NODES; a++) {
+            v = floor(grids[ch][a] * LSC_CAL_UNITY + 0.5);
+            if (v > LSC_CAL_SAMPLE_MAX) {
+                v = LSC_CAL_SAMPLE_MAX;
+                clipped++;
+            }
+            pIllum->samples[ch][a] = (uint16_t)v;
+        }
+    }
+    if (clipped)
+        fprintf(stderr, "%s: %u gains clipped to %.2f\n", pIllum->name, clipped,
+                LSC_CAL_SAMPLE_MAX / LSC_CAL_UNITY);
+    ret = 0;
+out:
+    free(pA);
+    return ret;
+}
+
+/*
+ * How flat the flat field comes out of the written grids, applied as the
+ * reference pipeline applies them: the RMS deviation of each channel from
+ * its mean, in percent, and the range of the averages of 16x16 pixel blocks.
+ */
+static int LscCalCheck(const LscCalIllum_t *pIllum, const LscCalFlat_t *pFlat,
+                       float rms[REF_CH_MAX], float range[REF_CH_MAX][2])
+{
+    enum { BLOCK = 16 };
+    RefLscMapConfig_t Config;
+    RefLscProfile_t Profile;
+    RefLscMap_t *pMap;
+    const float *pGain[2];
+    double sum[REF_CH_MAX], sum2[REF_CH_MAX], v, mean;
+    uint32_t bx = pFlat->width / BLOCK, by = pFlat->height / BLOCK;
+    uint32_t ch, a, x, y, n[REF_CH_MAX];
+    double *pBlock[REF_CH_MAX];
+    uint8_t chan[2][2];
+
+    memset(&Profile, 0, sizeof(Profile));
+    memcpy(Profile.sectSizeX, pIllum->profile[0], sizeof(Profile.sectSizeX));
+    memcpy(Profile.sectSizeY, pIllum->profile[1], sizeof(Profile.sectSizeY));
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        for (a = 0; a < LSC_CAL_NODES; a++)
+            Profile.samples[ch][a] = pIllum->samples[ch][a] / LSC_CAL_UNITY;
+    }
+    memset(&Config, 0, sizeof(Config));
+    Config.width = pFlat->width;
+    Config.height = pFlat->height;
+    Config.block = 2;
+    RefIspBayerChannels(pFlat->bayer, Config.chan);
+    memcpy(chan, Config.chan, sizeof(chan));
+    pMap = RefLscMapCreate(&Config, &Profile, 1);
+    if (!pMap)
+        return -1;
+    RefLscMapUpdate(pMap, 0.0f);
+
+    memset(sum, 0, sizeof(sum));
+    memset(sum2, 0, sizeof(sum2));
+    memset(n, 0, sizeof(n));
+    for (ch = 0; ch < REF_CH_MAX; ch++)
+        pBlock[ch] = calloc((size_t)(bx ? bx : 1) * (by ? by : 1), sizeof(double));
+    for (y = 0; y < pFlat->height; y++) {
+        const float *pRow = pFlat->pMean + (size_t)y * pFlat->width;
+
+        pGain[0] = RefLscMapRow(pMap, (RefChannel_t)chan[y & 1][0], y / 2);
+        pGain[1] = RefLscMapRow(pMap, (RefChannel_t)chan[y & 1][1], y / 2);
+        for (x = 0; x < pFlat->width; x++) {
+            ch = chan[y & 1][x & 1];
+            v = pRow[x] * pGain[x & 1][x / 2];
+            sum[ch] += v;
+            sum2[ch] += v * v;
+            n[ch]++;
+            if (pBlock[ch] && x / BLOCK < bx && y / BLOCK < by)
+                pBlock[ch][(y / BLOCK) * bx + x / BLOCK] += v;
+        }
+    }
+
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        mean = sum[ch] / n[ch];
+        rms[ch] = (float)(100.0 * sqrt(fmax(sum2[ch] / n[ch] - mean * mean, 0.0)) / mean);
+        range[ch][0] = range[ch][1] = 1.0f;
+        for (a = 0; pBlock[ch] && a < bx * by; a++) {
+            /* a block holds a quarter of its pixels of each channel */
+            v = pBlock[ch][a] / (BLOCK * BLOCK / 4) / mean;
+            if (a == 0 || v < range[ch][0])
+                range[ch][0] = (float)v;
+            if (a == 0 || v > range[ch][1])
+                range[ch][1] = (float)v;
+        }
+        free(pBlock[ch]);
+    }
+    RefLscMapDestroy(pMap);
+    return 0;
+}
+
+/*
+ * Text editing of the calibration: the edits, and the strings they own.
+ */
+
+#define LSC_CAL_MAX_EDITS       256
+
+typedef struct LscCalEdits_s
+{
+    const CalibXmlNode_t *pRoot;
+    uint32_t count;
+    CalibXmlEdit_t edits[LSC_CAL_MAX_EDITS];
+} LscCalEdits_t;
+
+static void LscCalEditsClear(LscCalEdits_t *pEdits)
+{
+    uint32_t i;
+
+    for (i = 0; i < pEdits->count; i++)
+        free((char *)pEdits->edits[i].text);
+    pEdits->count = 0;
+}
+
+/* takes pText, which may be NULL after a failed allocation */
+static int LscCalEdit(LscCalEdits_t *pEdits, size_t start, size_t end, char *pText)
+{
+    if (!pText || pEdits->count == LSC_CAL_MAX_EDITS) {
+        fprintf(stderr, "out of memory\n");
+        free(pText);
+        return -1;
+    }
+    pEdits->edits[pEdits->count].start = start;
+    pEdits->edits[pEdits->count].end = end;
+    pEdits->edits[pEdits->count].text = pText;
+    pEdits->count++;
+    return 0;
+}
+
+/* replace the value of an attribute of the node's open tag */
+static int LscCalEditAttribute(LscCalEdits_t *pEdits, const CalibXmlNode_t *pNode,
+                               const char *name, const char *value)
+{
+    const char *pSource = CalibXmlSource(pEdits->pRoot);
+    size_t len = strlen(name), pos;
+
+    for (pos = pNode->start; pos + len + 2 < pNode->contentStart; pos++) {
+        if (pSource[pos] == ' ' && strncmp(pSource + pos + 1, name, len) == 0 &&
+            pSource[pos + len + 1] == '=' && pSource[pos + len + 2] == '"') {
+            pos += len + 3;
+            return LscCalEdit(pEdits, pos, pos + strcspn(pSource + pos, "\""),
+                              strdup(value));
+        }
+    }
+    fprintf(stderr, "<%s> has no %s attribute\n", pNode->name, name);
+    return -1;
+}
+
+/* replace the text of a char element, and its size */
+static int LscCalEditString(LscCalEdits_t *pEdits, const CalibXmlNode_t *pNode,
+                            const char *value)
+{
+    char size[32];
+
+    if (!pNode) {
+        fprintf(stderr, "missing element for %s\n", value);
+        return -1;
+    }
+    snprintf(size, sizeof(size), "[1 %zu]", strlen(value));
+    if (LscCalEditAttribute(pEdits, pNode, "size", size) != 0)
+        return -1;
+    return LscCalEdit(pEdits, pNode->contentStart, pNode->contentEnd, strdup(value));
+}
+
+/* replace the "[v0 v1 ...]" text of a double element, which keeps its size;
+ * one value is written "[ v]" as in the calibration files */
+static int LscCalEditArray(LscCalEdits_t *pEdits, const CalibXmlNode_t *pNode,
+                           const uint32_t *pValues, uint32_t count, uint32_t stride)
+{
+    char *pText, *p;
+    uint32_t i;
+
+    if (!pNode) {
+        fprintf(stderr, "missing LSC element\n");
+        return -1;
+    }
+    pText = malloc(count * 12 + 4);
+    if (!pText)
+        return LscCalEdit(pEdits, 0, 0, NULL);
+    p = pText;
+    *p++ = '[';
+    if (count == 1)
+        *p++ = ' ';
+    for (i = 0; i < count; i++)
+        p += sprintf(p, i ? " %u" : "%u", pValues[i * stride]);
+    strcpy(p, "]");
+    return LscCalEdit(pEdits, pNode->contentStart, pNode->contentEnd, pText);
+}
+
+static int LscCalEditSamples(LscCalEdits_t *pEdits, const CalibXmlNode_t *pCell,
+                             const LscCalIllum_t *pIllum, uint32_t vignetting)
+{
+    static const char *names[REF_CH_MAX] = {
+        "LSC_SAMPLES_red", "LSC_SAMPLES_greenR", "LSC_SAMPLES_greenB", "LSC_SAMPLES_blue",
+    };
+    uint32_t values[LSC_CAL_NODES], ch, a;
+
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        for (a = 0; a < LSC_CAL_NODES; a++)
+            values[a] = pIllum->samples[ch][a];
+        if (LscCalEditArray(pEdits, CalibXmlChild(pCell, names[ch]), values,
+                            LSC_CAL_NODES, 1) != 0)
+            return -1;
+    }
+    return LscCalEditArray(pEdits, CalibXmlChild(pCell, "vignetting"), &vignetting, 1, 1);
+}
+
+/* the whitespace the line of a node starts with */
+static char *LscCalIndent(const CalibXmlNode_t *pRoot, const CalibXmlNode_t *pNode)
+{
+    const char *pSource = CalibXmlSource(pRoot);
+    size_t pos = pNode->start;
+    char *pText;
+
+    while (pos > 0 && pSource[pos - 1] != '\n')
+        pos--;
+    pText = malloc(pNode->start - pos + 2);
+    if (pText) {
+        pText[0] = '\n';
+        memcpy(pText + 1, pSource + pos, pNode->start - pos);
+        pText[pNode->start - pos + 1] = '\0';
+    }
+    return pText;
+}
+
+/* the last <cell> of a cell array, and how many there are */
+static const CalibXmlNode_t *LscCalLastCell(const CalibXmlNode_t *pList, uint32_t *pCount)
+{
+    const CalibXmlNode_t *pCell, *pLast = NULL;
+
+    *pCount = 0;
+    for (pCell = CalibXmlChild(pList, "cell"); pCell; pCell = CalibXmlNext(pCell)) {
+        pLast = pCell;
+        (*pCount)++;
+    }
+    return pLast;
+}
+
+/*
+ * Append a copy of pTemplate, with the edits of pCellEdits applied, after the
+ * last cell of pList: the copy is numbered on and the list's size grows.
+ */
+static int LscCalAppendCell(LscCalEdits_t *pEdits, const CalibXmlNode_t *pList,
+                            const CalibXmlNode_t *pTemplate, LscCalEdits_t *pCellEdits,
+                            uint32_t *pAdded)
+{
+    const CalibXmlNode_t *pLast;
+    uint32_t count;
+    char text[32], *pIndent, *pCell, *pText;
+
+    pLast = LscCalLastCell(pList, &count);
+    snprintf(text, sizeof(text), "%u", count + ++*pAdded);
+    if (LscCalEditAttribute(pCellEdits, pTemplate, "index", text) != 0)
+        return -1;
+    pCell = CalibXmlRender(pCellEdits->pRoot, pTemplate->start, pTemplate->end,
+                           pCellEdits->edits, pCellEdits->count);
+    pIndent = LscCalIndent(pEdits->pRoot, pLast);
+    pText = pCell && pIndent ? malloc(strlen(pIndent) + strlen(pCell) + 1) : NULL;
+    if (pText)
+        sprintf(pText, "%s%s", pIndent, pCell);
+    free(pCell);
+    free(pIndent);
+    return LscCalEdit(pEdits, pLast->end, pLast->end, pText);
+}
+
+static int LscCalEditListSize(LscCalEdits_t *pEdits, const CalibXmlNode_t *pList,
+                              uint32_t added)
+{
+    char size[32];
+    uint32_t count;
+
+    if (!added)
+        return 0;
+    LscCalLastCell(pList, &count);
+    snprintf(size, sizeof(size), "[1 %u]", count + added);
+    return LscCalEditAttribute(pEdits, pList, "size", size);
+}
+
+/* the sector sizes of a profile cell */
+static int LscCalSectors(const CalibXmlNode_t *pCell, uint32_t profile[2][REF_LSC_SECTORS_HALF])
+{
+    double values[REF_LSC_SECTORS_HALF];
+    uint32_t i;
+
+    if (RefCalibArray(pCell, "LSC_SECT_SIZE_X", values, REF_LSC_SECTORS_HALF) != 0)
+        return -1;
+    for (i = 0; i < REF_LSC_SECTORS_HALF; i++)
+        profile[0][i] = (uint32_t)values[i];
+    if (RefCalibArray(pCell, "LSC_SECT_SIZE_Y", values, REF_LSC_SECTORS_HALF) != 0)
+        return -1;
+    for (i = 0; i < REF_LSC_SECTORS_HALF; i++)
+        profile[1][i] = (uint32_t)values[i];
+    return 0;
+}
+
+/* scale the sectors of one half to sum to half, the rounding errors going
+ * to the sectors that lose most to them */
+static void LscCalScaleSectors(uint32_t *pSizes, uint32_t half)
+{
+    double exact[REF_LSC_SECTORS_HALF], scale, best;
+    uint32_t i, sum = 0, total = 0, pick;
+
+    for (i = 0; i < REF_LSC_SECTORS_HALF; i++)
+        total += pSizes[i];
+    scale = (double)half / (double)total;
+    for (i = 0; i < REF_LSC_SECTORS_HALF; i++) {
+        exact[i] = pSizes[i] * scale;
+        pSizes[i] = (uint32_t)exact[i];
+        sum += pSizes[i];
+    }
+    while (sum < half) {
+        pick = 0;
+        best = -1.0;
+        for (i = 0; i < REF_LSC_SECTORS_HALF; i++) {
+            if (exact[i] - pSizes[i] > best) {
+                best = exact[i] - pSizes[i];
+                pick = i;
+            }
+        }
+        pSizes[pick]++;
+        exact[pick] -= 1.0;
+        sum++;
+    }
+}
+
+/* a profile cell at the resolution, else any, to take a new profile from */
+static const CalibXmlNode_t *LscCalTemplate(const CalibXmlNode_t *pRoot,
+                                            const CalibXmlNode_t *pIllum,
+                                            const char *resolution)
+{
+    const CalibXmlNode_t *pLsc = CalibXmlPath(pRoot, "matfile/sensor/LSC");
+    const CalibXmlNode_t *pCell;
+    char profile[64];
+
+    pCell = RefCalibFindCell(pLsc, "resolution", resolution);
+    if (pCell)
+        return pCell;
+    /* the illumination's own profile at another resolution */
+    RefCalibFirstName(profile, sizeof(profile),
+                      CalibXmlText(CalibXmlPath(pIllum, "aLSC/cell/LSC_PROFILE_LIST")));
+    pCell = RefCalibFindCell(pLsc, "name", profile);
+    return pCell ? pCell : CalibXmlChild(pLsc, "cell");
+}
+
+/* find the profile an illumination uses at the resolution, or plan a new
+ * one; *ppCell is NULL for a new profile, *ppTemplate what it copies */
+static int LscCalProfile(LscCalIllum_t *pIllum, const CalibXmlNode_t *pRoot,
+                         const RefCalib_t *pCalib, const CalibXmlNode_t **ppIllum,
+                         const CalibXmlNode_t **ppCell, const CalibXmlNode_t **ppTemplate)
+{
+    const CalibXmlNode_t *pIllums = CalibXmlPath(pRoot, "matfile/sensor/AWB/illumination");
+    const CalibXmlNode_t *pCell;
+    char profile[64];
+
+    *ppIllum = RefCalibFindCell(pIllums, "name", pIllum->name);
+    if (!*ppIllum) {
+        fprintf(stderr, "the calibration has no illumination %s\n", pIllum->name);
+        return -1;
+    }
+    if (!CalibXmlChild(*ppIllum, "aLSC")) {
+        fprintf(stderr, "illumination %s has no aLSC list\n", pIllum->name);
+        return -1;
+    }
+
+    *ppCell = NULL;
+    *ppTemplate = NULL;
+    pCell = RefCalibFindCell(CalibXmlChild(*ppIllum, "aLSC"), "resolution",
+                             pCalib->resolution);
+    if (pCell) {
+        RefCalibFirstName(profile, sizeof(profile),
+                          CalibXmlChildText(pCell, "LSC_PROFILE_LIST"));
+        *ppCell = RefCalibFindCell(CalibXmlPath(pRoot, "matfile/sensor/LSC"), "name",
+                                   profile);
+        if (!*ppCell) {
+            fprintf(stderr, "no LSC profile %s\n", profile);
+            return -1;
+        }
+        return LscCalSectors(*ppCell, pIllum->profile);
+    }
+
+    *ppTemplate = LscCalTemplate(pRoot, *ppIllum, pCalib->resolution);
+    if (!*ppTemplate) {
+        fprintf(stderr, "the calibration has no LSC profile to start from\n");
+        return -1;
+    }
+    if (LscCalSectors(*ppTemplate, pIllum->profile) != 0)
+        return -1;
+    LscCalScaleSectors(pIllum->profile[0], pCalib->width / 2);
+    LscCalScaleSectors(pIllum->profile[1], pCalib->height / 2);
+    return 0;
+}
+
+/* the edits that write the grids of every illumination into the file */
+static int LscCalEditCalib(LscCalEdits_t *pEdits, const CalibXmlNode_t *pRoot,
+                           LscCalIllum_t *pIllums, uint32_t numIllums,
+                           const RefCalib_t *pCalib, const LscCalOptions_t *pOptions)
+{
+    const CalibXmlNode_t *pLsc = CalibXmlPath(pRoot, "matfile/sensor/LSC");
+    const CalibXmlNode_t *pIllum, *pCell, *pTemplate, *pAlsc;
+    LscCalEdits_t *pCellEdits;
+    uint32_t n, newProfiles = 0, newEntries, values[REF_LSC_SECTORS_HALF];
+    char illum[32];
+    /* "<resolution>_<illum>_<vignetting>", room for the longest of each */
+    char name[sizeof(pCalib->resolution) + sizeof(illum) + 11];
+    int ret = -1;
+
+    pCellEdits = calloc(1, sizeof(*pCellEdits));
+    if (!pCellEdits)
+        return -1;
+    pCellEdits->pRoot = pRoot;
+
+    for (n = 0; n < numIllums; n++) {
+        if (LscCalProfile(&pIllums[n], pRoot, pCalib, &pIllum, &pCell, &pTemplate) != 0)
+            goto out;
+        if (pCell) {
+            if (LscCalEditSamples(pEdits, pCell, &pIllums[n], pOptions->vignetting) != 0)
+                goto out;
+            continue;
+        }
+
+        /* a new profile, named as the calibration names them: "F2 (CWF)"
+         * profiles are F2 */
+        RefCalibFirstName(illum, sizeof(illum), pIllums[n].name);
+        snprintf(name, sizeof(name), "%s_%s_%u", pCalib->resolution, illum,
+                 pOptions->vignetting);
+        if (LscCalEditString(pCellEdits, CalibXmlChild(pTemplate, "name"), name) != 0 ||
+            LscCalEditString(pCellEdits, CalibXmlChild(pTemplate, "resolution"),
+                             pCalib->resolution) != 0 ||
+            LscCalEditString(pCellEdits, CalibXmlChild(pTemplate, "illumination"),
+                             illum) != 0)
+            goto out;
+        memcpy(values, pIllums[n].profile[0], sizeof(values));
+        if (LscCalEditArray(pCellEdits, CalibXmlChild(pTemplate, "LSC_SECT_SIZE_X"),
+                            values, REF_LSC_SECTORS_HALF, 1) != 0)
+            goto out;
+        memcpy(values, pIllums[n].profile[1], sizeof(values));
+        if (LscCalEditArray(pCellEdits, CalibXmlChild(pTemplate, "LSC_SECT_SIZE_Y"),
+                            values, REF_LSC_SECTORS_HALF, 1) != 0 ||
+            LscCalEditSamples(pCellEdits, pTemplate, &pIllums[n], pOptions->vignetting) != 0 ||
+            LscCalAppendCell(pEdits, pLsc, pTemplate, pCellEdits, &newProfiles) != 0)
+            goto out;
+        LscCalEditsClear(pCellEdits);
+
+        /* and the illumination's entry for the resolution */
+        pAlsc = CalibXmlChild(pIllum, "aLSC");
+        pTemplate = CalibXmlChild(pAlsc, "cell");
+        newEntries = 0;
+        if (!pTemplate ||
+            LscCalEditString(pCellEdits, CalibXmlChild(pTemplate, "resolution"),
+                             pCalib->resolution) != 0 ||
+            LscCalEditString(pCellEdits, CalibXmlChild(pTemplate, "LSC_PROFILE_LIST"),
+                             name) != 0 ||
+            LscCalAppendCell(pEdits, pAlsc, pTemplate, pCellEdits, &newEntries) != 0 ||
+            LscCalEditListSize(pEdits, pAlsc, newEntries) != 0)
+            goto out;
+        LscCalEditsClear(pCellEdits);
+    }
+    ret = LscCalEditListSize(pEdits, pLsc, newProfiles);
+out:
+    LscCalEditsClear(pCellEdits);
+    free(pCellEdits);
+    return ret;
+}
+
+static int LscCalSave(const char *path, const char *pText)
+{
+    char tmp[4096];
+    size_t len = strlen(pText);
+    FILE *fp;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    fp = fopen(tmp, "wb");
+    if (!fp) {
+        perror(tmp);
+        return -1;
+    }
+    if (fwrite(pText, 1, len, fp) != len || fclose(fp) != 0) {
+        perror(tmp);
+        remove(tmp);
+        return -1;
+    }
+    if (rename(tmp, path) != 0) {
+        perror(path);
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+static double LscCalSeconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void LscCalUsage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s -c calib.xml [-o out.xml] [-R resolution] [-B bits] [-V percent]\n"
+            "          [-t threads] [-f first] [-n frames] [-v]\n"
+            "          [-W width -H height -b bits -p pattern [-k]] illumination=input...\n"
+            "  -c  calibration XML, rewritten unless -o is given\n"
+            "  -o  write the calibration with the new grids here\n"
+            "  -R  calibration resolution (default the first)\n"
+            "  -B  bit depth of blsData (default %d)\n"
+            "  -V  vignetting correction in percent of the luminance shading\n"
+            "      (default 100)\n"
+            "  -t  threads (default one per CPU)\n"
+            "  -f, -n  first frame and number of frames of each input (default all)\n"
+            "  -v  print the grids\n"
+            "  -W, -H, -b, -p, -k  size, bit depth, pattern (rggb, grbg, gbrg,\n"
+            "      bggr, mono) and CSI-2 packing of files that are not .vvraw\n"
+            "  an illumination given several inputs averages all of them\n",
+            prog, LSC_CAL_CALIB_BITS_DEFAULT);
+}
+
+static void LscCalPrintGrids(const LscCalIllum_t *pIllum)
+{
+    uint32_t ch, i, j;
+
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        printf("%s %s:\n", pIllum->name, LscCalChannelNames[ch]);
+        for (j = 0; j < REF_LSC_GRID; j++) {
+            for (i = 0; i < REF_LSC_GRID; i++)
+                printf(" %4u", pIllum->samples[ch][j * REF_LSC_GRID + i]);
+            printf("\n");
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *calibPath = NULL, *outPath = NULL;
+    static LscCalIllum_t Illums[LSC_CAL_MAX_INPUTS];
+    static LscCalEdits_t Edits;
+    LscCalOptions_t Options;
+    CalibXmlNode_t *pRoot = NULL;
+    LscCalFlat_t Flat;
+    RefCalib_t Calib;
+    RawInput_t Bare;
+    uint32_t numIllums = 0, n, ch;
+    float rms[REF_CH_MAX], range[REF_CH_MAX][2], centre;
+    double start;
+    char *pText, *pEq;
+    long cpus;
+    int opt, ret = 1;
+
+    memset(&Options, 0, sizeof(Options));
+    memset(&Bare, 0, sizeof(Bare));
+    Options.calibBitDepth = LSC_CAL_CALIB_BITS_DEFAULT;
+    Options.vignetting = 100;
+
+    while ((opt = getopt(argc, argv, "c:o:R:B:V:t:f:n:vW:H:b:p:kh")) != -1) {
+        switch (opt) {
+        case 'c':
+            calibPath = optarg;
+            break;
+        case 'o':
+            outPath = optarg;
+            break;
+        case 'R':
+            Options.resolution = optarg;
+            break;
+        case 'B':
+            Options.calibBitDepth = strtoul(optarg, NULL, 0);
+            break;
+        case 'V':
+            Options.vignetting = strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            Options.threads = strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            Options.first = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            Options.frames = strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            Options.verbose = 1;
+            break;
+        case 'W':
+            Bare.width = strtoul(optarg, NULL, 0);
+            break;
+        case 'H':
+            Bare.height = strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            Bare.bitDepth = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            if (RawInputParseBayer(optarg, &Bare.bayer) != 0) {
+                LscCalUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'k':
+            Bare.packed = 1;
+            break;
+        default:
+            LscCalUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!calibPath || optind >= argc || Options.vignetting > 100 ||
+        Options.calibBitDepth < 8 || Options.calibBitDepth > 16) {
+        LscCalUsage(argv[0]);
+        return 1;
+    }
+    if (!Options.threads) {
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        Options.threads = cpus > 0 ? (uint32_t)cpus : 1;
+    }
+    if (Options.threads > LSC_CAL_MAX_THREADS)
+        Options.threads = LSC_CAL_MAX_THREADS;
+
+    /* illumination=input, several inputs of one illumination are averaged */
+    for (; optind < argc; optind++) {
+        pEq = strchr(argv[optind], '=');
+        if (!pEq || pEq == argv[optind] || !pEq[1]) {
+            LscCalUsage(argv[0]);
+            return 1;
+        }
+        *pEq = '\0';
+        for (n = 0; n < numIllums && strcmp(Illums[n].name, argv[optind]) != 0; n++)
+            ;
+        if (n == numIllums)
+            Illums[numIllums++].name = argv[optind];
+        if (Illums[n].numPaths == LSC_CAL_MAX_INPUTS) {
+            fprintf(stderr, "too many inputs for %s\n", Illums[n].name);
+            return 1;
+        }
+        Illums[n].paths[Illums[n].numPaths++] = pEq + 1;
+    }
+
+    if (RefCalibLoad(&Calib, calibPath, NULL, Options.resolution) != 0)
+        return 1;
+    pRoot = CalibXmlLoad(calibPath);
+    if (!pRoot)
+        return 1;
+    Edits.pRoot = pRoot;
+
+    for (n = 0; n < numIllums; n++) {
+        const CalibXmlNode_t *pIllum, *pCell, *pTemplate;
+
+        /* the sectors to fit on */
+        if (LscCalProfile(&Illums[n], pRoot, &Calib, &pIllum, &pCell, &pTemplate) != 0)
+            goto out;
+
+        start = LscCalSeconds();
+        if (LscCalAverage(&Illums[n], &Bare, &Options, Calib.bls, &Flat) != 0)
+            goto out;
+        centre = Flat.pMean[(size_t)(Flat.height / 2) * Flat.width + Flat.width / 2] /
+                 (float)((1u << Flat.bitDepth) - 1);
+        if (centre < LSC_CAL_DARK)
+            fprintf(stderr, "%s: the centre is at %.1f%% of the white level, too dark "
+                    "for a good fit\n", Illums[n].name, 100.0f * centre);
+        if (LscCalFit(&Illums[n], &Flat, &Options) != 0 ||
+            LscCalCheck(&Illums[n], &Flat, rms, range) != 0) {
+            free(Flat.pMean);
+            goto out;
+        }
+
+        printf("%s: %s, %u frames %ux%u in %.2f s, centre %.0f%%, %u%% vignetting\n",
+               Illums[n].name, pCell ? CalibXmlChildText(pCell, "name") : "new profile",
+               Flat.frames, Flat.width, Flat.height, LscCalSeconds() - start,
+               100.0f * centre, Options.vignetting);
+        if (Options.vignetting == 100) {
+            for (ch = 0; ch < REF_CH_MAX; ch++)
+                printf("  %-2s residual %.2f%% rms, 16x16 blocks %.3f to %.3f\n",
+                       LscCalChannelNames[ch], rms[ch],
+                       range[ch][0], range[ch][1]);
+        }
+        if (Options.verbose)
+            LscCalPrintGrids(&Illums[n]);
+        free(Flat.pMean);
+    }
+
+    if (LscCalEditCalib(&Edits, pRoot, Illums, numIllums, &Calib, &Options) != 0)
+        goto out;
+    pText = CalibXmlRender(pRoot, 0, pRoot->end, Edits.edits, Edits.count);
+    if (!pText) {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+    if (LscCalSave(outPath ? outPath : calibPath, pText) == 0)
+        ret = 0;
+    free(pText);
+out:
+    LscCalEditsClear(&Edits);
+    CalibXmlFree(pRoot);
+    return ret;
+}
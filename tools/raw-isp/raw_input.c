@@ -0,0 +1,214 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+
+#include "raw_input.h"
+#include "raw_pack.h"
+
+typedef struct RawInputFormat_s
+{
+    uint32_t fourcc;
+    RefBayer_t bayer;
+    uint32_t bitDepth;
+    int packed;                         /* CSI-2 packing, else 16 bit samples */
+} RawInputFormat_t;
+
+static const RawInputFormat_t RawInputFormats[] = {
+    { V4L2_PIX_FMT_SRGGB8, REF_BAYER_RGGB, 8, 1 },
+    { V4L2_PIX_FMT_SGRBG8, REF_BAYER_GRBG, 8, 1 },
+    { V4L2_PIX_FMT_SGBRG8, REF_BAYER_GBRG, 8, 1 },
+    { V4L2_PIX_FMT_SBGGR8, REF_BAYER_BGGR, 8, 1 },
+    { V4L2_PIX_FMT_GREY, REF_BAYER_MONO, 8, 1 },
+    { V4L2_PIX_FMT_SRGGB10, REF_BAYER_RGGB, 10, 0 },
+    { V4L2_PIX_FMT_SGRBG10, REF_BAYER_GRBG, 10, 0 },
+    { V4L2_PIX_FMT_SGBRG10, REF_BAYER_GBRG, 10, 0 },
+    { V4L2_PIX_FMT_SBGGR10, REF_BAYER_BGGR, 10, 0 },
+    { V4L2_PIX_FMT_Y10, REF_BAYER_MONO, 10, 0 },
+    { V4L2_PIX_FMT_SRGGB10P, REF_BAYER_RGGB, 10, 1 },
+    { V4L2_PIX_FMT_SGRBG10P, REF_BAYER_GRBG, 10, 1 },
+    { V4L2_PIX_FMT_SGBRG10P, REF_BAYER_GBRG, 10, 1 },
+    { V4L2_PIX_FMT_SBGGR10P, REF_BAYER_BGGR, 10, 1 },
+    { V4L2_PIX_FMT_Y10P, REF_BAYER_MONO, 10, 1 },
+    { V4L2_PIX_FMT_SRGGB12, REF_BAYER_RGGB, 12, 0 },
+    { V4L2_PIX_FMT_SGRBG12, REF_BAYER_GRBG, 12, 0 },
+    { V4L2_PIX_FMT_SGBRG12, REF_BAYER_GBRG, 12, 0 },
+    { V4L2_PIX_FMT_SBGGR12, REF_BAYER_BGGR, 12, 0 },
+    { V4L2_PIX_FMT_Y12, REF_BAYER_MONO, 12, 0 },
+    { V4L2_PIX_FMT_SRGGB12P, REF_BAYER_RGGB, 12, 1 },
+    { V4L2_PIX_FMT_SGRBG12P, REF_BAYER_GRBG, 12, 1 },
+    { V4L2_PIX_FMT_SGBRG12P, REF_BAYER_GBRG, 12, 1 },
+    { V4L2_PIX_FMT_SBGGR12P, REF_BAYER_BGGR, 12, 1 },
+    { V4L2_PIX_FMT_SRGGB16, REF_BAYER_RGGB, 16, 0 },
+    { V4L2_PIX_FMT_SGRBG16, REF_BAYER_GRBG, 16, 0 },
+    { V4L2_PIX_FMT_SGBRG16, REF_BAYER_GBRG, 16, 0 },
+    { V4L2_PIX_FMT_SBGGR16, REF_BAYER_BGGR, 16, 0 },
+    { V4L2_PIX_FMT_Y16, REF_BAYER_MONO, 16, 0 },
+};
+
+static const char *RawInputBayerNames[] = { "rggb", "grbg", "gbrg", "bggr", "mono" };
+
+typedef struct IspInput_s
+{
+    int fd;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bitDepth;
+    RefBayer_t bayer;
+    int packed;
+    uint32_t bytesPerLine;
+    uint32_t frameSize;
+    uint64_t firstOffset;               /* of frame 0's data */
+    uint64_t frameStride;
+    uint32_t frames;
+    uint8_t *pFrame;
+} IspInput_t;
+
+static int RawInputOpenContainer(RawInput_t *pInput, const RawCapFileHeader_t *pHeader,
+                            off_t fileSize)
+{
+    const RawInputFormat_t *pFormat = NULL;
+    size_t i;
+
+    if (pHeader->version != RAWCAP_VERSION || pHeader->recordSize <= RAWCAP_BLOCK) {
+        fprintf(stderr, "unsupported .vvraw version %u\n", pHeader->version);
+        return -1;
+    }
+    for (i = 0; i < sizeof(RawInputFormats) / sizeof(RawInputFormats[0]); i++) {
+        if (RawInputFormats[i].fourcc == pHeader->pixelFormat)
+            pFormat = &RawInputFormats[i];
+    }
+    if (!pFormat) {
+        fprintf(stderr, "unsupported pixel format %.4s\n",
+                (const char *)&pHeader->pixelFormat);
+        return -1;
+    }
+
+    pInput->width = pHeader->width;
+    pInput->height = pHeader->height;
+    pInput->bitDepth = pFormat->bitDepth;
+    pInput->bayer = pFormat->bayer;
+    pInput->packed = pFormat->packed;
+    pInput->bytesPerLine = pHeader->bytesPerLine;
+    pInput->frameSize = pHeader->frameSize;
+    pInput->firstOffset = pHeader->headerSize + RAWCAP_BLOCK;
+    pInput->frameStride = pHeader->recordSize;
+    pInput->container = 1;
+    /* a capture that did not close properly has no count */
+    pInput->frames = pHeader->frameCount ? pHeader->frameCount :
+                     (uint32_t)((fileSize - pHeader->headerSize) / pHeader->recordSize);
+    return 0;
+}
+
+int RawInputOpen(RawInput_t *pInput, const char *path)
+{
+    RawCapFileHeader_t header;
+    off_t fileSize;
+
+    pInput->container = 0;
+    pInput->pFrame = NULL;
+    pInput->fd = open(path, O_RDONLY);
+    if (pInput->fd < 0) {
+        perror(path);
+        return -1;
+    }
+    fileSize = lseek(pInput->fd, 0, SEEK_END);
+
+    if (pread(pInput->fd, &header, sizeof(header), 0) == sizeof(header) &&
+        memcmp(header.magic, RAWCAP_MAGIC, sizeof(header.magic)) == 0) {
+        if (RawInputOpenContainer(pInput, &header, fileSize) != 0)
+            return -1;
+    } else {
+        /* bare frames, described on the command line */
+        if (!pInput->width || !pInput->height || !pInput->bitDepth) {
+            fprintf(stderr, "%s: not a .vvraw file, give -W, -H, -b and -p\n", path);
+            return -1;
+        }
+        pInput->bytesPerLine = pInput->packed ?
+                               RawPackedBytes(pInput->bitDepth, pInput->width) :
+                               pInput->width * sizeof(uint16_t);
+        pInput->frameSize = pInput->bytesPerLine * pInput->height;
+        pInput->firstOffset = 0;
+        pInput->frameStride = pInput->frameSize;
+        pInput->frames = fileSize / pInput->frameSize;
+    }
+
+    if (pInput->packed && !RawPackedBytes(pInput->bitDepth, pInput->width)) {
+        fprintf(stderr, "%s: no %u bit CSI-2 packing\n", path, pInput->bitDepth);
+        return -1;
+    }
+    pInput->pFrame = malloc(pInput->frameSize);
+    return pInput->pFrame ? 0 : -1;
+}
+
+int RawInputRead(RawInput_t *pInput, uint32_t frame, uint16_t *pSamples,
+                 RawCapFrameHeader_t *pHeader)
+{
+    off_t offset = pInput->firstOffset + frame * pInput->frameStride;
+    uint32_t y;
+
+    if (pHeader) {
+        memset(pHeader, 0, sizeof(*pHeader));
+        if (pInput->container &&
+            pread(pInput->fd, pHeader, sizeof(*pHeader), offset - RAWCAP_BLOCK) !=
+            sizeof(*pHeader)) {
+            fprintf(stderr, "frame %u: short read\n", frame);
+            return -1;
+        }
+    }
+
+    if (pread(pInput->fd, pInput->pFrame, pInput->frameSize, offset) !=
+        (ssize_t)pInput->frameSize) {
+        fprintf(stderr, "frame %u: short read\n", frame);
+        return -1;
+    }
+
+    for (y = 0; y < pInput->height; y++) {
+        const uint8_t *pLine = pInput->pFrame + (size_t)y * pInput->bytesPerLine;
+        uint16_t *pDst = pSamples + (size_t)y * pInput->width;
+
+        if (!pInput->packed)
+            memcpy(pDst, pLine, pInput->width * sizeof(uint16_t));
+        else if (RawUnpackLine(pDst, pLine, pInput->bitDepth, pInput->width) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+void RawInputClose(RawInput_t *pInput)
+{
+    free(pInput->pFrame);
+    pInput->pFrame = NULL;
+    if (pInput->fd >= 0)
+        close(pInput->fd);
+    pInput->fd = -1;
+}
+
+const char *RawInputBayerName(RefBayer_t bayer)
+{
+    return bayer <= REF_BAYER_MONO ? RawInputBayerNames[bayer] : "?";
+}
+
+int RawInputParseBayer(const char *name, RefBayer_t *pBayer)
+{
+    int i;
+
+    for (i = 0; i <= REF_BAYER_MONO; i++) {
+        if (strcmp(name, RawInputBayerNames[i]) == 0) {
+            *pBayer = (RefBayer_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
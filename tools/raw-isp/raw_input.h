@@ -0,0 +1,65 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * RAW frames of a raw-capture .vvraw file, or of a bare file of frames
+ * described by the caller, read as right aligned 16 bit samples.
+ */
+
+#ifndef __RAW_INPUT_H__
+#define __RAW_INPUT_H__
+
+#include <stdint.h>
+
+#include "raw_container.h"
+#include "ref_isp.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct RawInput_s
+{
+    int fd;
+    /* set by the caller for a bare file, from the header of a .vvraw */
+    uint32_t width;
+    uint32_t height;
+    uint32_t bitDepth;
+    RefBayer_t bayer;
+    int packed;                         /* CSI-2 packing, else 16 bit samples */
+
+    int container;                      /* a .vvraw, with frame headers */
+    uint32_t bytesPerLine;
+    uint32_t frameSize;
+    uint64_t firstOffset;               /* of frame 0's data */
+    uint64_t frameStride;
+    uint32_t frames;
+    uint8_t *pFrame;
+} RawInput_t;
+
+/* -1 with a message on stderr */
+int RawInputOpen(RawInput_t *pInput, const char *path);
+void RawInputClose(RawInput_t *pInput);
+
+/*
+ * Read frame into width * height samples. pHeader, if not NULL, gets the
+ * frame header of a .vvraw and is zeroed for a bare file.
+ */
+int RawInputRead(RawInput_t *pInput, uint32_t frame, uint16_t *pSamples,
+                 RawCapFrameHeader_t *pHeader);
+
+/* "rggb", "grbg", "gbrg", "bggr" and "mono" */
+const char *RawInputBayerName(RefBayer_t bayer);
+int RawInputParseBayer(const char *name, RefBayer_t *pBayer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
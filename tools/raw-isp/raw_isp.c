@@ -0,0 +1,306 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Host reference RAW pipeline.
+ *
+ * Runs the black level, LSC, white balance, demosaic and colour correction
+ * of a calibration XML over RAW frames from a raw-capture .vvraw file or a
+ * bare file of frames, and writes one PPM (PGM for mono sensors) per frame.
+ *
+ *   raw-isp -c calib.xml [-i illumination] [-o prefix] [-f first] [-n frames]
+ *           [-s stages] [-w r,gr,gb,b] [-T ct[,step]] [-B bits] [-t threads]
+ *           [-l] [-r repeat] [-x] [-W width -H height -b bits -p pattern [-k]] input
+ */
+
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "raw_input.h"
+#include "ref_isp.h"
+
+#define ISP_CALIB_BITS_DEFAULT  10
+
+static uint64_t IspNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int IspWriteImage(const char *path, const void *pImage, uint32_t width,
+                         uint32_t height, uint32_t channels, int output16)
+{
+    size_t count = (size_t)width * height * channels;
+    FILE *fp = fopen(path, "wb");
+    uint16_t *pSwapped = NULL;
+    const void *pData = pImage;
+    size_t i, size = output16 ? 2 : 1;
+    int ret = 0;
+
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    /* 16 bit PNM samples are big endian */
+    if (output16) {
+        pSwapped = malloc(count * sizeof(uint16_t));
+        if (!pSwapped) {
+            fclose(fp);
+            return -1;
+        }
+        for (i = 0; i < count; i++)
+            pSwapped[i] = __builtin_bswap16(((const uint16_t *)pImage)[i]);
+        pData = pSwapped;
+    }
+
+    fprintf(fp, "P%c\n%u %u\n%u\n", channels == 3 ? '6' : '5', width, height,
+            output16 ? 65535 : 255);
+    if (fwrite(pData, size, count, fp) != count) {
+        perror(path);
+        ret = -1;
+    }
+    free(pSwapped);
+    if (fclose(fp) != 0)
+        ret = -1;
+    return ret;
+}
+
+static int IspParseStages(const char *list, uint32_t *pStages)
+{
+    char buffer[64], *cur, *name;
+
+    snprintf(buffer, sizeof(buffer), "%s", list);
+    *pStages = 0;
+    cur = buffer;
+    while ((name = strsep(&cur, ",")) != NULL) {
+        if (strcmp(name, "bls") == 0)
+            *pStages |= REF_STAGE_BLS;
+        else if (strcmp(name, "lsc") == 0)
+            *pStages |= REF_STAGE_LSC;
+        else if (strcmp(name, "awb") == 0)
+            *pStages |= REF_STAGE_AWB;
+        else if (strcmp(name, "cc") == 0)
+            *pStages |= REF_STAGE_CC;
+        else if (*name)
+            return -1;
+    }
+    return 0;
+}
+
+static void IspUsage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s -c calib.xml [-i illumination] [-R resolution] [-o prefix]\n"
+            "          [-f first] [-n frames] [-s stages] [-w r,gr,gb,b]\n"
+            "          [-T ct[,step]] [-B bits] [-t threads] [-l] [-r repeat] [-x]\n"
+            "          [-W width -H height -b bits -p pattern [-k]] input\n"
+            "  -c  calibration XML\n"
+            "  -i  AWB illumination whose LSC and CC profiles to use (default D65)\n"
+            "  -R  calibration resolution (default the first)\n"
+            "  -o  output prefix, frames go to <prefix>_<n>.ppm (default out)\n"
+            "  -f, -n  first frame and number of frames (default all)\n"
+            "  -s  stages: bls,lsc,awb,cc (default all)\n"
+            "  -w  white balance gains instead of the CC profile's\n"
+            "  -T  blend the LSC profiles of all illuminations at this colour\n"
+            "      temperature, changing by step kelvin every frame\n"
+            "  -B  bit depth of blsData and ccOffsets (default %d)\n"
+            "  -t  threads (default one per CPU)\n"
+            "  -l  16 bit linear output instead of 8 bit sRGB\n"
+            "  -r  process each frame this many times, for timing\n"
+            "  -x  do not write images\n"
+            "  -W, -H, -b, -p, -k  size, bit depth, pattern (rggb, grbg, gbrg,\n"
+            "      bggr, mono) and CSI-2 packing of a file that is not .vvraw\n",
+            prog, ISP_CALIB_BITS_DEFAULT);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *calibPath = NULL, *illumination = NULL, *resolution = NULL;
+    const char *prefix = "out";
+    uint32_t first = 0, frames = 0, repeat = 1, frame, r, channels;
+    int noOutput = 0, opt, ret = 1;
+    RefIspConfig_t Config;
+    RefCalib_t Calib;
+    RawInput_t Input;
+    RefIsp_t *pIsp = NULL;
+    uint16_t *pSamples = NULL;
+    void *pImage = NULL;
+    uint64_t startNs, totalNs = 0;
+    float wb[REF_CH_MAX], ctStep = 0.0f;
+    uint32_t lscUpdates = 0;
+    char path[512];
+
+    memset(&Config, 0, sizeof(Config));
+    memset(&Input, 0, sizeof(Input));
+    Input.fd = -1;
+    Config.calibBitDepth = ISP_CALIB_BITS_DEFAULT;
+    Config.stages = REF_STAGE_ALL;
+
+    while ((opt = getopt(argc, argv, "c:i:R:o:f:n:s:w:T:B:t:lr:xW:H:b:p:kh")) != -1) {
+        switch (opt) {
+        case 'c':
+            calibPath = optarg;
+            break;
+        case 'i':
+            illumination = optarg;
+            break;
+        case 'R':
+            resolution = optarg;
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        case 'f':
+            first = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            frames = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            if (IspParseStages(optarg, &Config.stages) != 0) {
+                IspUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'w':
+            if (sscanf(optarg, "%f,%f,%f,%f", &wb[0], &wb[1], &wb[2], &wb[3]) != 4) {
+                IspUsage(argv[0]);
+                return 1;
+            }
+            Config.pWbGains = wb;
+            break;
+        case 'T':
+            if (sscanf(optarg, "%f,%f", &Config.ct, &ctStep) < 1 || Config.ct <= 0.0f) {
+                IspUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'B':
+            Config.calibBitDepth = strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            Config.threads = strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            Config.output16 = 1;
+            break;
+        case 'r':
+            repeat = strtoul(optarg, NULL, 0);
+            break;
+        case 'x':
+            noOutput = 1;
+            break;
+        case 'W':
+            Input.width = strtoul(optarg, NULL, 0);
+            break;
+        case 'H':
+            Input.height = strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            Input.bitDepth = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            if (RawInputParseBayer(optarg, &Input.bayer) != 0) {
+                IspUsage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'k':
+            Input.packed = 1;
+            break;
+        default:
+            IspUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!calibPath || optind != argc - 1 || !repeat ||
+        Config.calibBitDepth < 8 || Config.calibBitDepth > 16) {
+        IspUsage(argv[0]);
+        return 1;
+    }
+
+    if (RefCalibLoad(&Calib, calibPath, illumination, resolution) != 0)
+        return 1;
+    if (RawInputOpen(&Input, argv[optind]) != 0)
+        goto out;
+
+    if (first >= Input.frames) {
+        fprintf(stderr, "%s has %u frames\n", argv[optind], Input.frames);
+        goto out;
+    }
+    if (!frames || first + frames > Input.frames)
+        frames = Input.frames - first;
+
+    Config.width = Input.width;
+    Config.height = Input.height;
+    Config.bitDepth = Input.bitDepth;
+    Config.bayer = Input.bayer;
+    Config.pCalib = &Calib;
+    pIsp = RefIspCreate(&Config);
+    if (!pIsp)
+        goto out;
+
+    channels = Input.bayer == REF_BAYER_MONO ? 1 : 3;
+    pSamples = malloc((size_t)Input.width * Input.height * sizeof(uint16_t));
+    pImage = malloc((size_t)Input.width * Input.height * channels *
+                    (Config.output16 ? 2 : 1));
+    if (!pSamples || !pImage) {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+
+    printf("%s %s, illumination %s: %ux%u %s %u bit, frames %u to %u\n",
+           Calib.sensorName, Calib.resolution, Calib.illumination, Input.width,
+           Input.height, RawInputBayerName(Input.bayer), Input.bitDepth, first,
+           first + frames - 1);
+
+    for (frame = first; frame < first + frames; frame++) {
+        if (RawInputRead(&Input, frame, pSamples, NULL) != 0)
+            goto out;
+
+        startNs = IspNowNs();
+        if (Config.ct > 0.0f)
+            lscUpdates += RefIspSetCt(pIsp, Config.ct + ctStep * (frame - first));
+        for (r = 0; r < repeat; r++) {
+            if (RefIspProcess(pIsp, pSamples, pImage) != 0) {
+                fprintf(stderr, "cannot start the worker threads\n");
+                goto out;
+            }
+        }
+        totalNs += IspNowNs() - startNs;
+
+        if (!noOutput) {
+            snprintf(path, sizeof(path), "%s_%04u.%s", prefix, frame,
+                     channels == 3 ? "ppm" : "pgm");
+            if (IspWriteImage(path, pImage, Input.width, Input.height, channels,
+                              Config.output16) != 0)
+                goto out;
+        }
+    }
+
+    printf("%u frames processed %u times, %.1f ms per frame, %.1f Mpix/s\n",
+           frames, repeat, totalNs / 1e6 / ((double)frames * repeat),
+           (double)Input.width * Input.height * frames * repeat * 1e3 / totalNs);
+    if (Config.ct > 0.0f)
+        printf("LSC map recomputed %u times for %u LSC profiles\n", lscUpdates,
+               Calib.numLscProfiles);
+    ret = 0;
+out:
+    free(pImage);
+    free(pSamples);
+    RefIspDestroy(pIsp);
+    RawInputClose(&Input);
+    return ret;
+}
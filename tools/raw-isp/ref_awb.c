@@ -0,0 +1,354 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ref_awb.h"
+
+struct RefAwb_s
+{
+    const RefAwbModel_t *pModel;
+    uint32_t windows;
+    float *pU;                          /* PCA coordinates of each window */
+    float *pV;
+    float *pValid;                      /* 1.0 for windows that take part */
+    float *pLike[REF_AWB_MAX_ILLUMS];   /* likelihoods, then votes */
+    float *pSum;
+
+    int started;
+    RefAwbResult_t last;
+};
+
+static int RefAwbScalar(const CalibXmlNode_t *pCell, const char *name, float *pValue)
+{
+    double value;
+
+    if (RefCalibArray(pCell, name, &value, 1) != 0)
+        return -1;
+    *pValue = (float)value;
+    return 0;
+}
+
+static int RefAwbFloats(const CalibXmlNode_t *pCell, const char *name,
+                        float *pValues, int count)
+{
+    double values[9];
+    int i;
+
+    if (RefCalibArray(pCell, name, values, count) != 0)
+        return -1;
+    for (i = 0; i < count; i++)
+        pValues[i] = (float)values[i];
+    return 0;
+}
+
+static int RefAwbLoadIllum(RefAwbIllum_t *pIllum, const CalibXmlNode_t *pRoot,
+                           const CalibXmlNode_t *pCell, const char *path)
+{
+    const CalibXmlNode_t *pGmm = CalibXmlChild(pCell, "GMM");
+    CalibXmlNode_t *pCc;
+    char profile[64];
+
+    snprintf(pIllum->name, sizeof(pIllum->name), "%s", CalibXmlChildText(pCell, "name"));
+    pIllum->outdoor = strcmp(CalibXmlChildText(pCell, "doorType"), "Outdoor") == 0;
+    pIllum->ct = RefCalibIlluminantCt(pIllum->name);
+
+    if (!pGmm ||
+        RefAwbFloats(pGmm, "GaussianMeanValue", pIllum->mean, 2) != 0 ||
+        RefAwbFloats(pGmm, "invCovMatrix", pIllum->invCov, 4) != 0 ||
+        RefAwbScalar(pGmm, "GaussianScalingFactor", &pIllum->scale) != 0 ||
+        RefAwbFloats(pGmm, "tau", pIllum->tau, 2) != 0) {
+        fprintf(stderr, "%s: illumination %s has no GMM\n", path, pIllum->name);
+        return -1;
+    }
+
+    /* gains of the illumination's CC profile, 1.0 without one */
+    pIllum->wb[REF_CH_R] = pIllum->wb[REF_CH_GR] = 1.0f;
+    pIllum->wb[REF_CH_GB] = pIllum->wb[REF_CH_B] = 1.0f;
+    RefCalibFirstName(profile, sizeof(profile),
+                      CalibXmlText(CalibXmlPath(pCell, "aCC/CC_PROFILE_LIST")));
+    pCc = profile[0] ? RefCalibFindCell(CalibXmlPath(pRoot, "matfile/sensor/CC"),
+                                        "name", profile) : NULL;
+    if (pCc && RefAwbFloats(pCc, "wb", pIllum->wb, REF_CH_MAX) != 0)
+        return -1;
+    return 0;
+}
+
+int RefAwbLoad(RefAwbModel_t *pModel, const char *path, const char *resolution)
+{
+    CalibXmlNode_t *pRoot, *pGlobals, *pIir, *pCell;
+    float pca[6];
+    int ret = -1, i;
+
+    memset(pModel, 0, sizeof(*pModel));
+
+    pRoot = CalibXmlLoad(path);
+    if (!pRoot)
+        return -1;
+
+    pGlobals = CalibXmlPath(pRoot, "matfile/sensor/AWB/globals");
+    pGlobals = resolution ? RefCalibFindCell(pGlobals, "resolution", resolution) :
+                            CalibXmlChild(pGlobals, "cell");
+    if (!pGlobals) {
+        fprintf(stderr, "%s: no AWB globals for %s\n", path, resolution ? resolution : "");
+        goto out;
+    }
+    snprintf(pModel->resolution, sizeof(pModel->resolution), "%s",
+             CalibXmlChildText(pGlobals, "resolution"));
+
+    /* PCAMatrix is 3x2, listed column after column */
+    if (RefAwbFloats(pGlobals, "SVDMeanValue", pModel->svdMean, 3) != 0 ||
+        RefAwbFloats(pGlobals, "PCAMatrix", pca, 6) != 0 ||
+        RefAwbFloats(pGlobals, "CenterLine", pModel->centerLine, 3) != 0)
+        goto out;
+    for (i = 0; i < 3; i++) {
+        pModel->pca[0][i] = pca[i];
+        pModel->pca[1][i] = pca[3 + i];
+    }
+
+    pIir = CalibXmlChild(pGlobals, "IIR");
+    if (RefAwbScalar(pIir, "DampCoefAdd", &pModel->dampCoefAdd) != 0 ||
+        RefAwbScalar(pIir, "DampCoefSub", &pModel->dampCoefSub) != 0 ||
+        RefAwbScalar(pIir, "DampFilterThreshold", &pModel->dampFilterThreshold) != 0 ||
+        RefAwbScalar(pIir, "DampingCoefMin", &pModel->dampingCoefMin) != 0 ||
+        RefAwbScalar(pIir, "DampingCoefMax", &pModel->dampingCoefMax) != 0 ||
+        RefAwbScalar(pIir, "DampingCoefInit", &pModel->dampingCoefInit) != 0)
+        goto out;
+
+    for (pCell = CalibXmlChild(CalibXmlPath(pRoot, "matfile/sensor/AWB/illumination"), "cell");
+         pCell && pModel->numIllums < REF_AWB_MAX_ILLUMS; pCell = CalibXmlNext(pCell)) {
+        if (RefAwbLoadIllum(&pModel->illums[pModel->numIllums], pRoot, pCell, path) != 0)
+            goto out;
+        pModel->numIllums++;
+    }
+    if (!pModel->numIllums) {
+        fprintf(stderr, "%s: no AWB illuminations\n", path);
+        goto out;
+    }
+    ret = 0;
+out:
+    CalibXmlFree(pRoot);
+    return ret;
+}
+
+/*
+ * exp(x) for x <= 0 as 2^n * exp(r), |r| <= ln(2) / 2, with a polynomial
+ * for exp(r): no calls or branches, so that the likelihood loop vectorizes.
+ * The clamp is max(x, -87) written with fabsf(): GCC does not if-convert
+ * a select next to the type punning. Relative error below 4e-6.
+ */
+static inline float RefAwbExp(float x)
+{
+    union
+    {
+        float f;
+        int32_t i;
+    } scale;
+    float r, p;
+    int32_t n;
+
+    x = 0.5f * (x - 87.0f + fabsf(x + 87.0f));
+    n = (int32_t)(x * 1.44269504f - 0.5f);
+    r = x - (float)n * 0.693359375f + (float)n * 2.12194440e-4f;
+    p = 1.0f + r * (1.0f + r * (0.5f + r * (1.66666667e-1f + r * (4.16666667e-2f +
+                                                               r * 8.33333333e-3f))));
+    scale.i = (n + 127) << 23;
+    return p * scale.f;
+}
+
+RefAwb_t *RefAwbCreate(const RefAwbModel_t *pModel, uint32_t windows)
+{
+    RefAwb_t *pAwb;
+    uint32_t i;
+
+    pAwb = calloc(1, sizeof(*pAwb));
+    if (!pAwb)
+        return NULL;
+    pAwb->pModel = pModel;
+    pAwb->windows = windows;
+    pAwb->pU = malloc(windows * sizeof(float));
+    pAwb->pV = malloc(windows * sizeof(float));
+    pAwb->pValid = malloc(windows * sizeof(float));
+    pAwb->pSum = malloc(windows * sizeof(float));
+    if (!pAwb->pU || !pAwb->pV || !pAwb->pValid || !pAwb->pSum)
+        goto error;
+    for (i = 0; i < pModel->numIllums; i++) {
+        pAwb->pLike[i] = malloc(windows * sizeof(float));
+        if (!pAwb->pLike[i])
+            goto error;
+    }
+    return pAwb;
+
+error:
+    RefAwbDestroy(pAwb);
+    return NULL;
+}
+
+void RefAwbDestroy(RefAwb_t *pAwb)
+{
+    uint32_t i;
+
+    if (!pAwb)
+        return;
+    for (i = 0; i < REF_AWB_MAX_ILLUMS; i++)
+        free(pAwb->pLike[i]);
+    free(pAwb->pSum);
+    free(pAwb->pValid);
+    free(pAwb->pV);
+    free(pAwb->pU);
+    free(pAwb);
+}
+
+void RefAwbReset(RefAwb_t *pAwb)
+{
+    pAwb->started = 0;
+    memset(&pAwb->last, 0, sizeof(pAwb->last));
+}
+
+/* PCA coordinates of the windows */
+static void RefAwbProject(RefAwb_t *pAwb, const float *pR, const float *pG, const float *pB)
+{
+    const RefAwbModel_t *pModel = pAwb->pModel;
+    const float a0 = pModel->pca[0][0], a1 = pModel->pca[0][1], a2 = pModel->pca[0][2];
+    const float b0 = pModel->pca[1][0], b1 = pModel->pca[1][1], b2 = pModel->pca[1][2];
+    const float m0 = pModel->svdMean[0], m1 = pModel->svdMean[1], m2 = pModel->svdMean[2];
+    float *pU = pAwb->pU, *pV = pAwb->pV, *pValid = pAwb->pValid;
+    const uint32_t windows = pAwb->windows;
+    uint32_t w;
+
+    for (w = 0; w < windows; w++) {
+        /* means are never negative, a left out window is all 0 */
+        float inv = 1.0f / (pR[w] + pG[w] + pB[w] + 1e-20f);
+        float r, g, b;
+
+        r = pR[w] * inv - m0;
+        g = pG[w] * inv - m1;
+        b = pB[w] * inv - m2;
+
+        pU[w] = a0 * r + a1 * g + a2 * b;
+        pV[w] = b0 * r + b1 * g + b2 * b;
+    }
+    for (w = 0; w < windows; w++)
+        pValid[w] = pG[w] > 0.0f ? 1.0f : 0.0f;
+}
+
+/* likelihoods of one illumination, gated by its tau ramp */
+static void RefAwbLikelihood(RefAwb_t *pAwb, const RefAwbIllum_t *pIllum, float *pLike)
+{
+    const float m0 = pIllum->mean[0], m1 = pIllum->mean[1], scale = pIllum->scale;
+    const float c00 = -0.5f * pIllum->invCov[0], c11 = -0.5f * pIllum->invCov[3];
+    const float c01 = -0.5f * (pIllum->invCov[1] + pIllum->invCov[2]);
+    const float tau0 = pIllum->tau[0];
+    /* a step at tau0 when both are the same, as in the calibrations */
+    const float tauScale = pIllum->tau[1] > tau0 ? 1.0f / (pIllum->tau[1] - tau0) : 1e30f;
+    const float *pU = pAwb->pU, *pV = pAwb->pV, *pValid = pAwb->pValid;
+    const uint32_t windows = pAwb->windows;
+    uint32_t w;
+
+    /* a select next to the type punning of RefAwbExp() keeps GCC from
+     * vectorizing, so the gate is a loop of its own */
+    for (w = 0; w < windows; w++) {
+        float d0 = pU[w] - m0, d1 = pV[w] - m1;
+
+        pLike[w] = scale * RefAwbExp(c00 * d0 * d0 + c01 * d0 * d1 + c11 * d1 * d1);
+    }
+    for (w = 0; w < windows; w++) {
+        float t = (pLike[w] - tau0) * tauScale;
+
+        t = t > 0.0f ? t : 0.0f;
+        t = t < 1.0f ? t : 1.0f;
+        pLike[w] *= t * pValid[w];
+    }
+}
+
+void RefAwbProcess(RefAwb_t *pAwb, const float *pR, const float *pG, const float *pB,
+                   RefAwbResult_t *pResult)
+{
+    const RefAwbModel_t *pModel = pAwb->pModel;
+    const uint32_t numIllums = pModel->numIllums;
+    RefAwbResult_t *pLast = &pAwb->last;
+    float prob[REF_AWB_MAX_ILLUMS] = { 0 }, total = 0.0f, delta = 0.0f, coef;
+    float mired = 0.0f, miredWeight = 0.0f, gain;
+    uint32_t i, w, votes = 0;
+
+    RefAwbProject(pAwb, pR, pG, pB);
+    for (i = 0; i < numIllums; i++)
+        RefAwbLikelihood(pAwb, &pModel->illums[i], pAwb->pLike[i]);
+
+    /* each white window has one vote, split by likelihood */
+    memset(pAwb->pSum, 0, pAwb->windows * sizeof(float));
+    for (i = 0; i < numIllums; i++) {
+        for (w = 0; w < pAwb->windows; w++)
+            pAwb->pSum[w] += pAwb->pLike[i][w];
+    }
+    for (w = 0; w < pAwb->windows; w++) {
+        if (pAwb->pSum[w] > 0.0f) {
+            pAwb->pSum[w] = 1.0f / pAwb->pSum[w];
+            votes++;
+        }
+    }
+    for (i = 0; i < numIllums; i++) {
+        for (w = 0; w < pAwb->windows; w++)
+            prob[i] += pAwb->pLike[i][w] * pAwb->pSum[w];
+        total += prob[i];
+    }
+
+    if (!votes) {
+        *pResult = *pLast;
+        pResult->whiteWindows = 0;
+        return;
+    }
+    for (i = 0; i < numIllums; i++)
+        prob[i] /= total;
+
+    /* IIR: follow faster while the estimate moves by more than the threshold */
+    if (!pAwb->started) {
+        coef = 0.0f;
+        pLast->damping = pModel->dampingCoefInit;
+        pAwb->started = 1;
+    } else {
+        for (i = 0; i < numIllums; i++)
+            delta += fabsf(prob[i] - pLast->prob[i]);
+        delta *= 0.5f;
+        coef = pLast->damping + (delta > pModel->dampFilterThreshold ?
+                                 -pModel->dampCoefSub : pModel->dampCoefAdd);
+        coef = fminf(fmaxf(coef, pModel->dampingCoefMin), pModel->dampingCoefMax);
+        pLast->damping = coef;
+    }
+
+    memset(pLast->gains, 0, sizeof(pLast->gains));
+    pLast->illum = 0;
+    for (i = 0; i < numIllums; i++) {
+        const RefAwbIllum_t *pIllum = &pModel->illums[i];
+        int ch;
+
+        pLast->prob[i] = coef * pLast->prob[i] + (1.0f - coef) * prob[i];
+        if (pLast->prob[i] > pLast->prob[pLast->illum])
+            pLast->illum = i;
+        for (ch = 0; ch < REF_CH_MAX; ch++)
+            pLast->gains[ch] += pLast->prob[i] * pIllum->wb[ch];
+        if (pIllum->ct > 0.0f) {
+            mired += pLast->prob[i] / pIllum->ct;
+            miredWeight += pLast->prob[i];
+        }
+    }
+    pLast->ct = mired > 0.0f ? miredWeight / mired : 0.0f;
+
+    /* normalize to a green gain of 1 */
+    gain = 0.5f * (pLast->gains[REF_CH_GR] + pLast->gains[REF_CH_GB]);
+    for (i = 0; i < REF_CH_MAX; i++)
+        pLast->gains[i] /= gain;
+    pLast->lineDistance = pModel->centerLine[0] * pLast->gains[REF_CH_R] +
+                          pModel->centerLine[1] * pLast->gains[REF_CH_B] -
+                          pModel->centerLine[2];
+    pLast->whiteWindows = votes;
+    *pResult = *pLast;
+}
@@ -0,0 +1,103 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Host model of the auto white balance the calibration XML describes.
+ *
+ * The mean R G B of each statistics window, normalized to sum 1, is moved
+ * by SVDMeanValue and projected on the two PCAMatrix axes. There every
+ * illumination is a Gaussian (GaussianMeanValue, invCovMatrix,
+ * GaussianScalingFactor); a window votes for the illuminations in
+ * proportion to their likelihoods, once one of them reaches tau. The frame's
+ * votes are damped by the IIR filter of the globals, and the white balance
+ * gains are those of the illuminations' CC profiles, weighted by the
+ * damped probabilities.
+ */
+
+#ifndef __REF_AWB_H__
+#define __REF_AWB_H__
+
+#include <stdint.h>
+
+#include "ref_calib.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define REF_AWB_MAX_ILLUMS      8
+
+typedef struct RefAwbIllum_s
+{
+    char name[32];
+    int outdoor;                        /* doorType */
+    float ct;                           /* kelvin, 0 if unknown */
+    float mean[2];                      /* GaussianMeanValue */
+    float invCov[4];                    /* invCovMatrix */
+    float scale;                        /* GaussianScalingFactor */
+    /* likelihood below which a window does not vote, ramping to a full
+     * vote at tau[1] */
+    float tau[2];
+    float wb[REF_CH_MAX];               /* of the illumination's CC profile */
+} RefAwbIllum_t;
+
+typedef struct RefAwbModel_s
+{
+    char resolution[32];
+    float svdMean[3];                   /* SVDMeanValue */
+    float pca[2][3];                    /* PCAMatrix, one axis per row */
+    /* CenterLine: the gains (R, B) on it satisfy
+     * centerLine[0] * R + centerLine[1] * B = centerLine[2] */
+    float centerLine[3];
+    /* IIR */
+    float dampCoefAdd;
+    float dampCoefSub;
+    float dampFilterThreshold;
+    float dampingCoefMin;
+    float dampingCoefMax;
+    float dampingCoefInit;
+    uint32_t numIllums;
+    RefAwbIllum_t illums[REF_AWB_MAX_ILLUMS];
+} RefAwbModel_t;
+
+/* the AWB globals of the resolution (NULL for the first) and every
+ * illumination; -1 with a message on stderr */
+int RefAwbLoad(RefAwbModel_t *pModel, const char *path, const char *resolution);
+
+typedef struct RefAwbResult_s
+{
+    uint32_t whiteWindows;              /* that voted this frame */
+    float prob[REF_AWB_MAX_ILLUMS];     /* damped illumination probabilities */
+    float damping;                      /* IIR coefficient used */
+    uint32_t illum;                     /* the most probable */
+    float gains[REF_CH_MAX];
+    float ct;                           /* mired weighted, 0 if unknown */
+    float lineDistance;                 /* of the gains from CenterLine */
+} RefAwbResult_t;
+
+typedef struct RefAwb_s RefAwb_t;
+
+RefAwb_t *RefAwbCreate(const RefAwbModel_t *pModel, uint32_t windows);
+void RefAwbDestroy(RefAwb_t *pAwb);
+
+/* forget the damped state, for a new sequence */
+void RefAwbReset(RefAwb_t *pAwb);
+
+/*
+ * Run one frame of window means. Windows with pG <= 0 are left out. When
+ * no window votes, the previous result is kept.
+ */
+void RefAwbProcess(RefAwb_t *pAwb, const float *pR, const float *pG, const float *pB,
+                   RefAwbResult_t *pResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,289 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "calib_xml.h"
+#include "ref_calib.h"
+
+#define REF_LSC_UNITY           1024.0
+
+static const char *RefLscSampleNames[REF_CH_MAX] = {
+    "LSC_SAMPLES_red", "LSC_SAMPLES_greenR", "LSC_SAMPLES_greenB", "LSC_SAMPLES_blue",
+};
+
+/* correlated colour temperatures of the standard illuminants */
+static const struct
+{
+    const char *name;
+    float ct;
+} RefIlluminantCt[] = {
+    { "A", 2856.0f },
+    { "HZ", 2300.0f },
+    { "U30", 3000.0f },
+    { "F12", 3000.0f },
+    { "F11", 4000.0f },
+    { "TL84", 4000.0f },
+    { "F2", 4230.0f },
+    { "CWF", 4230.0f },
+    { "D50", 5003.0f },
+    { "D55", 5503.0f },
+    { "D65", 6504.0f },
+    { "D75", 7504.0f },
+};
+
+float RefCalibIlluminantCt(const char *illumination)
+{
+    size_t len = strcspn(illumination, " (");
+    size_t i;
+
+    for (i = 0; i < sizeof(RefIlluminantCt) / sizeof(RefIlluminantCt[0]); i++) {
+        if (strlen(RefIlluminantCt[i].name) == len &&
+            strncmp(RefIlluminantCt[i].name, illumination, len) == 0)
+            return RefIlluminantCt[i].ct;
+    }
+    return 0.0f;
+}
+
+void RefCalibFirstName(char *pDst, size_t size, const char *list)
+{
+    size_t len = strcspn(list, " \t\n");
+
+    if (len >= size)
+        len = size - 1;
+    memcpy(pDst, list, len);
+    pDst[len] = '\0';
+}
+
+CalibXmlNode_t *RefCalibFindCell(const CalibXmlNode_t *pList, const char *field,
+                                 const char *value)
+{
+    CalibXmlNode_t *pCell;
+
+    for (pCell = CalibXmlChild(pList, "cell"); pCell; pCell = CalibXmlNext(pCell)) {
+        if (strcmp(CalibXmlChildText(pCell, field), value) == 0)
+            return pCell;
+    }
+    return NULL;
+}
+
+int RefCalibArray(const CalibXmlNode_t *pCell, const char *name,
+                  double *pValues, int count)
+{
+    if (CalibXmlDoubles(CalibXmlChild(pCell, name), pValues, count) != count) {
+        fprintf(stderr, "%s: expected %d values\n", name, count);
+        return -1;
+    }
+    return 0;
+}
+
+static int RefCalibLoadLsc(RefLscProfile_t *pLsc, const CalibXmlNode_t *pCell)
+{
+    double values[REF_LSC_GRID * REF_LSC_GRID];
+    int ch, i;
+
+    snprintf(pLsc->name, sizeof(pLsc->name), "%s", CalibXmlChildText(pCell, "name"));
+
+    if (RefCalibArray(pCell, "LSC_SECT_SIZE_X", values, REF_LSC_SECTORS_HALF) != 0)
+        return -1;
+    for (i = 0; i < REF_LSC_SECTORS_HALF; i++)
+        pLsc->sectSizeX[i] = (uint32_t)values[i];
+    if (RefCalibArray(pCell, "LSC_SECT_SIZE_Y", values, REF_LSC_SECTORS_HALF) != 0)
+        return -1;
+    for (i = 0; i < REF_LSC_SECTORS_HALF; i++)
+        pLsc->sectSizeY[i] = (uint32_t)values[i];
+
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        if (RefCalibArray(pCell, RefLscSampleNames[ch], values,
+                          REF_LSC_GRID * REF_LSC_GRID) != 0)
+            return -1;
+        for (i = 0; i < REF_LSC_GRID * REF_LSC_GRID; i++)
+            pLsc->samples[ch][i] = (float)(values[i] / REF_LSC_UNITY);
+    }
+    return 0;
+}
+
+static int RefCalibLoadCc(RefCcProfile_t *pCc, const CalibXmlNode_t *pCell)
+{
+    double values[9];
+    int i;
+
+    snprintf(pCc->name, sizeof(pCc->name), "%s", CalibXmlChildText(pCell, "name"));
+
+    if (RefCalibArray(pCell, "ccMatrix", values, 9) != 0)
+        return -1;
+    for (i = 0; i < 9; i++)
+        pCc->ccMatrix[i] = (float)values[i];
+    if (RefCalibArray(pCell, "ccOffsets", values, 3) != 0)
+        return -1;
+    for (i = 0; i < 3; i++)
+        pCc->ccOffsets[i] = (float)values[i];
+    if (RefCalibArray(pCell, "wb", values, REF_CH_MAX) != 0)
+        return -1;
+    for (i = 0; i < REF_CH_MAX; i++)
+        pCc->wb[i] = (float)values[i];
+    return 0;
+}
+
+/* the LSC profile an illumination lists for the resolution, 0 if it has none */
+static int RefCalibLoadIllumLsc(RefLscProfile_t *pLsc, const CalibXmlNode_t *pRoot,
+                                const CalibXmlNode_t *pIllum, const char *resolution,
+                                const char *path)
+{
+    CalibXmlNode_t *pCell;
+    char profile[64];
+
+    pCell = RefCalibFindCell(CalibXmlChild(pIllum, "aLSC"), "resolution", resolution);
+    if (!pCell)
+        return 0;
+
+    RefCalibFirstName(profile, sizeof(profile), CalibXmlChildText(pCell, "LSC_PROFILE_LIST"));
+    pCell = RefCalibFindCell(CalibXmlPath(pRoot, "matfile/sensor/LSC"), "name", profile);
+    if (!pCell) {
+        fprintf(stderr, "%s: no LSC profile %s\n", path, profile);
+        return -1;
+    }
+    if (RefCalibLoadLsc(pLsc, pCell) != 0)
+        return -1;
+    pLsc->ct = RefCalibIlluminantCt(CalibXmlChildText(pIllum, "name"));
+    return 1;
+}
+
+/* every illumination's profile with a known temperature, sorted by it */
+static int RefCalibLoadLscProfiles(RefCalib_t *pCalib, const CalibXmlNode_t *pRoot,
+                                   const CalibXmlNode_t *pIllums, const char *path)
+{
+    RefLscProfile_t *pProfiles = pCalib->lscProfiles;
+    CalibXmlNode_t *pIllum;
+    uint32_t i;
+    int ret;
+
+    for (pIllum = CalibXmlChild(pIllums, "cell"); pIllum; pIllum = CalibXmlNext(pIllum)) {
+        RefLscProfile_t *pLsc = &pProfiles[pCalib->numLscProfiles];
+
+        if (pCalib->numLscProfiles == REF_LSC_MAX_PROFILES)
+            break;
+        ret = RefCalibLoadIllumLsc(pLsc, pRoot, pIllum, pCalib->resolution, path);
+        if (ret <= 0) {
+            if (ret < 0)
+                return -1;
+            continue;
+        }
+        if (pLsc->ct == 0.0f) {
+            fprintf(stderr, "%s: temperature of illumination %s unknown, not blended\n",
+                    path, CalibXmlChildText(pIllum, "name"));
+            continue;
+        }
+
+        /* insertion sort by ct */
+        for (i = pCalib->numLscProfiles; i > 0 && pProfiles[i - 1].ct > pProfiles[i].ct; i--) {
+            RefLscProfile_t tmp = pProfiles[i - 1];
+
+            pProfiles[i - 1] = pProfiles[i];
+            pProfiles[i] = tmp;
+        }
+        pCalib->numLscProfiles++;
+    }
+    return 0;
+}
+
+static void RefCalibListIlluminations(const CalibXmlNode_t *pList)
+{
+    CalibXmlNode_t *pCell;
+
+    fprintf(stderr, "illuminations:");
+    for (pCell = CalibXmlChild(pList, "cell"); pCell; pCell = CalibXmlNext(pCell))
+        fprintf(stderr, " \"%s\"", CalibXmlChildText(pCell, "name"));
+    fprintf(stderr, "\n");
+}
+
+int RefCalibLoad(RefCalib_t *pCalib, const char *path,
+                 const char *illumination, const char *resolution)
+{
+    CalibXmlNode_t *pRoot, *pRes, *pIllums, *pIllum, *pCell;
+    char profile[64];
+    double values[REF_CH_MAX];
+    int ret = -1, i;
+
+    memset(pCalib, 0, sizeof(*pCalib));
+
+    pRoot = CalibXmlLoad(path);
+    if (!pRoot)
+        return -1;
+
+    snprintf(pCalib->sensorName, sizeof(pCalib->sensorName), "%s",
+             CalibXmlText(CalibXmlPath(pRoot, "matfile/header/sensor_name")));
+
+    pRes = CalibXmlPath(pRoot, "matfile/header/resolution");
+    pCell = resolution ? RefCalibFindCell(pRes, "name", resolution) :
+                         CalibXmlChild(pRes, "cell");
+    if (!pCell) {
+        fprintf(stderr, "%s: no resolution %s\n", path, resolution ? resolution : "");
+        goto out;
+    }
+    snprintf(pCalib->resolution, sizeof(pCalib->resolution), "%s",
+             CalibXmlChildText(pCell, "name"));
+    if (RefCalibArray(pCell, "width", values, 1) != 0)
+        goto out;
+    pCalib->width = (uint32_t)values[0];
+    if (RefCalibArray(pCell, "height", values, 1) != 0)
+        goto out;
+    pCalib->height = (uint32_t)values[0];
+
+    pCell = RefCalibFindCell(CalibXmlPath(pRoot, "matfile/sensor/BLS"),
+                             "resolution", pCalib->resolution);
+    if (pCell) {
+        if (RefCalibArray(pCell, "blsData", values, REF_CH_MAX) != 0)
+            goto out;
+        for (i = 0; i < REF_CH_MAX; i++)
+            pCalib->bls[i] = (float)values[i];
+    }
+
+    pIllums = CalibXmlPath(pRoot, "matfile/sensor/AWB/illumination");
+    if (illumination) {
+        pIllum = RefCalibFindCell(pIllums, "name", illumination);
+    } else {
+        pIllum = RefCalibFindCell(pIllums, "name", "D65");
+        if (!pIllum)
+            pIllum = CalibXmlChild(pIllums, "cell");
+    }
+    if (!pIllum) {
+        fprintf(stderr, "%s: no illumination %s, ", path, illumination ? illumination : "");
+        RefCalibListIlluminations(pIllums);
+        goto out;
+    }
+    snprintf(pCalib->illumination, sizeof(pCalib->illumination), "%s",
+             CalibXmlChildText(pIllum, "name"));
+
+    ret = RefCalibLoadIllumLsc(&pCalib->lsc, pRoot, pIllum, pCalib->resolution, path);
+    if (ret < 0)
+        goto out;
+    pCalib->hasLsc = ret;
+    ret = -1;
+    if (RefCalibLoadLscProfiles(pCalib, pRoot, pIllums, path) != 0)
+        goto out;
+
+    RefCalibFirstName(profile, sizeof(profile),
+                      CalibXmlText(CalibXmlPath(pIllum, "aCC/CC_PROFILE_LIST")));
+    if (profile[0]) {
+        pCell = RefCalibFindCell(CalibXmlPath(pRoot, "matfile/sensor/CC"),
+                                 "name", profile);
+        if (!pCell) {
+            fprintf(stderr, "%s: no CC profile %s\n", path, profile);
+            goto out;
+        }
+        if (RefCalibLoadCc(&pCalib->cc, pCell) != 0)
+            goto out;
+        pCalib->hasCc = 1;
+    }
+    ret = 0;
+out:
+    CalibXmlFree(pRoot);
+    return ret;
+}
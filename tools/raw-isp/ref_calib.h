@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * The parameters of one illumination of a calibration XML that the host
+ * reference pipeline applies: black level, lens shading grids, colour
+ * correction and white balance gains. The LSC profiles of every
+ * illumination are kept as well, for blending by colour temperature.
+ */
+
+#ifndef __REF_CALIB_H__
+#define __REF_CALIB_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "calib_xml.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define REF_LSC_GRID            17      /* samples per grid row and column */
+#define REF_LSC_SECTORS_HALF    8       /* sector sizes given for one half */
+#define REF_LSC_MAX_PROFILES    8
+
+/* Bayer channels, in the order of blsData, wb and LSC_SAMPLES_* */
+typedef enum RefChannel_e
+{
+    REF_CH_R = 0,
+    REF_CH_GR,
+    REF_CH_GB,
+    REF_CH_B,
+    REF_CH_MAX
+} RefChannel_t;
+
+typedef struct RefLscProfile_s
+{
+    char name[64];
+    float ct;                           /* of its illumination in kelvin, 0 if unknown */
+    /* sector widths and heights of the left and top half, mirrored */
+    uint32_t sectSizeX[REF_LSC_SECTORS_HALF];
+    uint32_t sectSizeY[REF_LSC_SECTORS_HALF];
+    /* gains per channel, row by row, 1.0 where the XML has 1024 */
+    float samples[REF_CH_MAX][REF_LSC_GRID * REF_LSC_GRID];
+} RefLscProfile_t;
+
+typedef struct RefCcProfile_s
+{
+    char name[64];
+    float ccMatrix[9];                  /* row major, applied to R G B */
+    float ccOffsets[3];
+    float wb[REF_CH_MAX];
+} RefCcProfile_t;
+
+typedef struct RefCalib_s
+{
+    char sensorName[32];
+    char resolution[32];                /* e.g. "1920x1080" */
+    uint32_t width;
+    uint32_t height;
+    char illumination[32];
+    float bls[REF_CH_MAX];
+    int hasLsc;
+    RefLscProfile_t lsc;
+    /* the LSC profile of every illumination with a known temperature,
+     * coolest (lowest ct) first */
+    uint32_t numLscProfiles;
+    RefLscProfile_t lscProfiles[REF_LSC_MAX_PROFILES];
+    int hasCc;
+    RefCcProfile_t cc;
+} RefCalib_t;
+
+/*
+ * Load the profiles of one illumination (the AWB illumination cell name,
+ * e.g. "D65", or NULL for D65 or else the first one) at one resolution
+ * (NULL for the first of the header). Returns -1 with a message on stderr,
+ * listing the illuminations when the one asked for is not there.
+ */
+int RefCalibLoad(RefCalib_t *pCalib, const char *path,
+                 const char *illumination, const char *resolution);
+
+/*
+ * Helpers for the loaders of other parts of the calibration.
+ */
+
+/* kelvin of a standard illuminant name, matched on the first word so that
+ * "F11 (TL84)" is F11; 0 if unknown */
+float RefCalibIlluminantCt(const char *illumination);
+
+/* profile lists may name several profiles, the first one is used */
+void RefCalibFirstName(char *pDst, size_t size, const char *list);
+
+/* the <cell> of pList whose child field has text value, NULL if none */
+CalibXmlNode_t *RefCalibFindCell(const CalibXmlNode_t *pList, const char *field,
+                                 const char *value);
+
+/* exactly count values of the named child array, -1 with a message if not */
+int RefCalibArray(const CalibXmlNode_t *pCell, const char *name,
+                  double *pValues, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,414 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ref_isp.h"
+#include "ref_lsc.h"
+
+#define REF_BAND_ROWS           16
+#define REF_GAMMA_LUT_SIZE      4096
+#define REF_LSC_CT_THRESHOLD    50.0f   /* kelvin */
+
+typedef struct RefIspWorker_s
+{
+    struct RefIsp_s *pIsp;
+    pthread_t thread;
+    /* black level, LSC and WB corrected rows y - 1, y, y + 1 of the band,
+     * with one mirrored sample on each side */
+    float *pRows[3];
+    float *pScale;                      /* per column gain of the current row */
+    float *pPlane[3];                   /* demosaiced R G B of one row */
+    float *pRgb;                        /* colour corrected row, interleaved */
+} RefIspWorker_t;
+
+struct RefIsp_s
+{
+    RefIspConfig_t config;
+    uint8_t chan[2][2];                 /* RefChannel_t at (y & 1, x & 1) */
+    float *pOffset[2];                  /* per column black level, by row parity */
+    float gain[REF_CH_MAX];             /* white balance and normalization */
+    RefLscMap_t *pLscMap;               /* a gain per pixel */
+    float ccMatrix[9];
+    float ccOffsets[3];
+    uint8_t gamma[REF_GAMMA_LUT_SIZE];
+
+    uint32_t numWorkers;
+    RefIspWorker_t *pWorkers;
+    const uint16_t *pIn;
+    void *pOut;
+    uint32_t nextBand;
+};
+
+/* channels of the top left 2x2 of each pattern */
+static const uint8_t RefBayerChannels[REF_BAYER_MONO + 1][2][2] = {
+    [REF_BAYER_RGGB] = { { REF_CH_R, REF_CH_GR }, { REF_CH_GB, REF_CH_B } },
+    [REF_BAYER_GRBG] = { { REF_CH_GR, REF_CH_R }, { REF_CH_B, REF_CH_GB } },
+    [REF_BAYER_GBRG] = { { REF_CH_GB, REF_CH_B }, { REF_CH_R, REF_CH_GR } },
+    [REF_BAYER_BGGR] = { { REF_CH_B, REF_CH_GB }, { REF_CH_GR, REF_CH_R } },
+    /* a mono sensor is shaded and calibrated as if it had the RGGB layout */
+    [REF_BAYER_MONO] = { { REF_CH_R, REF_CH_GR }, { REF_CH_GB, REF_CH_B } },
+};
+
+static void RefIspInitGamma(RefIsp_t *pIsp)
+{
+    float v;
+    int i;
+
+    for (i = 0; i < REF_GAMMA_LUT_SIZE; i++) {
+        v = (float)i / (REF_GAMMA_LUT_SIZE - 1);
+        v = v <= 0.0031308f ? 12.92f * v : 1.055f * powf(v, 1.0f / 2.4f) - 0.055f;
+        pIsp->gamma[i] = (uint8_t)(v * 255.0f + 0.5f);
+    }
+}
+
+/* per column gain of row y: white balance times the LSC map */
+static void RefIspRowScale(const RefIsp_t *pIsp, uint32_t y, float *pScale)
+{
+    const RefIspConfig_t *pConfig = &pIsp->config;
+    const uint8_t *pChan = pIsp->chan[y & 1];
+    const float gEven = pIsp->gain[pChan[0]], gOdd = pIsp->gain[pChan[1]];
+    const float *pEven, *pOdd;
+    uint32_t x;
+
+    if (!(pConfig->stages & REF_STAGE_LSC)) {
+        for (x = 0; x < pConfig->width; x++)
+            pScale[x] = pIsp->gain[pChan[x & 1]];
+        return;
+    }
+
+    pEven = RefLscMapRow(pIsp->pLscMap, (RefChannel_t)pChan[0], y / 2);
+    pOdd = RefLscMapRow(pIsp->pLscMap, (RefChannel_t)pChan[1], y / 2);
+    for (x = 0; x < pConfig->width / 2; x++) {
+        pScale[2 * x] = pEven[x] * gEven;
+        pScale[2 * x + 1] = pOdd[x] * gOdd;
+    }
+}
+
+/* black level, LSC and WB of input row y, mirrored at the frame edges */
+static void RefIspCorrectRow(RefIsp_t *pIsp, RefIspWorker_t *pWorker,
+                             int32_t y, float *pRow)
+{
+    const uint32_t width = pIsp->config.width;
+    const int32_t height = (int32_t)pIsp->config.height;
+    const uint16_t *pIn;
+    const float *pOffset, *pScale = pWorker->pScale;
+    float *pDst = pRow + 1;
+    uint32_t x;
+
+    if (y < 0)
+        y = -y;
+    else if (y >= height)
+        y = 2 * height - 2 - y;
+
+    pIn = pIsp->pIn + (size_t)y * width;
+    pOffset = pIsp->pOffset[y & 1];
+    RefIspRowScale(pIsp, y, pWorker->pScale);
+
+    for (x = 0; x < width; x++) {
+        float v = ((float)pIn[x] - pOffset[x]) * pScale[x];
+
+        /* a compare rather than fmaxf() so that it vectorizes */
+        pDst[x] = v > 0.0f ? v : 0.0f;
+    }
+
+    pRow[0] = pRow[2];
+    pRow[width + 1] = pRow[width - 1];
+}
+
+/*
+ * Bilinear demosaic of the middle row. On a colour site the centre is the
+ * site colour X, the cross the green and the corners the other colour Y;
+ * on a green site the row neighbours are X and the column neighbours Y.
+ */
+static void RefIspDemosaicRow(const RefIsp_t *pIsp, RefIspWorker_t *pWorker,
+                              uint32_t y, float *const pRows[3])
+{
+    const uint32_t width = pIsp->config.width;
+    /* column x of the frame is at index x + 1 of the padded rows */
+    const float *pUp = pRows[0], *pMid = pRows[1], *pDown = pRows[2];
+    uint32_t colorPhase, x;
+    RefChannel_t color;
+    float *pX, *pG, *pY;
+
+    colorPhase = (pIsp->chan[y & 1][0] == REF_CH_R || pIsp->chan[y & 1][0] == REF_CH_B) ? 0 : 1;
+    color = (RefChannel_t)pIsp->chan[y & 1][colorPhase];
+    pX = pWorker->pPlane[color == REF_CH_R ? 0 : 2];
+    pY = pWorker->pPlane[color == REF_CH_R ? 2 : 0];
+    pG = pWorker->pPlane[1];
+
+    for (x = colorPhase; x < width; x += 2) {
+        pX[x] = pMid[x + 1];
+        pG[x] = 0.25f * (pMid[x] + pMid[x + 2] + pUp[x + 1] + pDown[x + 1]);
+        pY[x] = 0.25f * (pUp[x] + pUp[x + 2] + pDown[x] + pDown[x + 2]);
+    }
+    for (x = colorPhase ^ 1; x < width; x += 2) {
+        pG[x] = pMid[x + 1];
+        pX[x] = 0.5f * (pMid[x] + pMid[x + 2]);
+        pY[x] = 0.5f * (pUp[x + 1] + pDown[x + 1]);
+    }
+}
+
+/* clamp to [0, 1] and scale, with compares and a signed conversion that vectorize */
+static inline int32_t RefIspQuantize(float v, float scale)
+{
+    v = v > 0.0f ? v : 0.0f;
+    v = v < 1.0f ? v : 1.0f;
+    return (int32_t)(v * scale + 0.5f);
+}
+
+static void RefIspOutputRow(const RefIsp_t *pIsp, RefIspWorker_t *pWorker,
+                            uint32_t y, const float *pMono)
+{
+    const RefIspConfig_t *pConfig = &pIsp->config;
+    const uint32_t width = pConfig->width;
+    const uint32_t channels = pConfig->bayer == REF_BAYER_MONO ? 1 : 3;
+    const float *m = pIsp->ccMatrix, *o = pIsp->ccOffsets;
+    const float *pR = pWorker->pPlane[0], *pG = pWorker->pPlane[1], *pB = pWorker->pPlane[2];
+    float *pRgb = pWorker->pRgb;
+    const float *pOut = pRgb;
+    size_t offset = (size_t)y * width * channels;
+    uint32_t x, n = width * channels;
+    float r, g, b;
+
+    if (pConfig->bayer == REF_BAYER_MONO) {
+        pOut = pMono;
+    } else {
+        for (x = 0; x < width; x++) {
+            r = pR[x];
+            g = pG[x];
+            b = pB[x];
+            pRgb[3 * x + 0] = m[0] * r + m[1] * g + m[2] * b + o[0];
+            pRgb[3 * x + 1] = m[3] * r + m[4] * g + m[5] * b + o[1];
+            pRgb[3 * x + 2] = m[6] * r + m[7] * g + m[8] * b + o[2];
+        }
+    }
+
+    if (pConfig->output16) {
+        uint16_t *pDst = (uint16_t *)pIsp->pOut + offset;
+
+        for (x = 0; x < n; x++)
+            pDst[x] = (uint16_t)RefIspQuantize(pOut[x], 65535.0f);
+    } else {
+        uint8_t *pDst = (uint8_t *)pIsp->pOut + offset;
+
+        for (x = 0; x < n; x++)
+            pDst[x] = pIsp->gamma[RefIspQuantize(pOut[x], REF_GAMMA_LUT_SIZE - 1)];
+    }
+}
+
+static void *RefIspWorker(void *arg)
+{
+    RefIspWorker_t *pWorker = (RefIspWorker_t *)arg;
+    RefIsp_t *pIsp = pWorker->pIsp;
+    const uint32_t height = pIsp->config.height;
+    float *pRows[3];
+    uint32_t band, y, y0, y1;
+    float *pTmp;
+
+    for (;;) {
+        band = __atomic_fetch_add(&pIsp->nextBand, 1, __ATOMIC_RELAXED);
+        y0 = band * REF_BAND_ROWS;
+        if (y0 >= height)
+            break;
+        y1 = y0 + REF_BAND_ROWS < height ? y0 + REF_BAND_ROWS : height;
+
+        memcpy(pRows, pWorker->pRows, sizeof(pRows));
+        RefIspCorrectRow(pIsp, pWorker, (int32_t)y0 - 1, pRows[0]);
+        RefIspCorrectRow(pIsp, pWorker, (int32_t)y0, pRows[1]);
+        for (y = y0; y < y1; y++) {
+            RefIspCorrectRow(pIsp, pWorker, (int32_t)y + 1, pRows[2]);
+            if (pIsp->config.bayer != REF_BAYER_MONO)
+                RefIspDemosaicRow(pIsp, pWorker, y, pRows);
+            RefIspOutputRow(pIsp, pWorker, y, pRows[1] + 1);
+
+            pTmp = pRows[0];
+            pRows[0] = pRows[1];
+            pRows[1] = pRows[2];
+            pRows[2] = pTmp;
+        }
+    }
+    return NULL;
+}
+
+static int RefIspInitWorker(RefIsp_t *pIsp, RefIspWorker_t *pWorker)
+{
+    const uint32_t width = pIsp->config.width;
+    int i;
+
+    pWorker->pIsp = pIsp;
+    for (i = 0; i < 3; i++) {
+        pWorker->pRows[i] = malloc((width + 2) * sizeof(float));
+        pWorker->pPlane[i] = malloc(width * sizeof(float));
+        if (!pWorker->pRows[i] || !pWorker->pPlane[i])
+            return -1;
+    }
+    pWorker->pScale = malloc(width * sizeof(float));
+    pWorker->pRgb = malloc(3 * width * sizeof(float));
+    return pWorker->pScale && pWorker->pRgb ? 0 : -1;
+}
+
+void RefIspBayerChannels(RefBayer_t bayer, uint8_t chan[2][2])
+{
+    memcpy(chan, RefBayerChannels[bayer], sizeof(RefBayerChannels[bayer]));
+}
+
+RefIsp_t *RefIspCreate(const RefIspConfig_t *pConfig)
+{
+    const RefCalib_t *pCalib = pConfig->pCalib;
+    float norm, calibScale, identity[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+    const float *pWb;
+    RefIsp_t *pIsp;
+    uint32_t i, x, p;
+
+    if (pConfig->width < 2 || pConfig->width % 2 || pConfig->height < 2 ||
+        pConfig->bitDepth < 8 || pConfig->bitDepth > 16 || pConfig->bayer > REF_BAYER_MONO) {
+        fprintf(stderr, "unsupported frame %ux%u, %u bit\n",
+                pConfig->width, pConfig->height, pConfig->bitDepth);
+        return NULL;
+    }
+    if (((pConfig->stages & REF_STAGE_LSC) && !pCalib->hasLsc) ||
+        ((pConfig->stages & (REF_STAGE_CC | REF_STAGE_AWB)) && !pCalib->hasCc &&
+         !((pConfig->stages & REF_STAGE_AWB) && pConfig->pWbGains))) {
+        fprintf(stderr, "the calibration has no profile for a requested stage\n");
+        return NULL;
+    }
+
+    pIsp = calloc(1, sizeof(*pIsp));
+    if (!pIsp)
+        return NULL;
+    pIsp->config = *pConfig;
+    memcpy(pIsp->chan, RefBayerChannels[pConfig->bayer], sizeof(pIsp->chan));
+
+    /* samples are normalized to 1.0 at the input white level */
+    norm = 1.0f / (float)((1u << pConfig->bitDepth) - 1);
+    calibScale = (float)(1u << pConfig->bitDepth) / (float)(1u << pConfig->calibBitDepth);
+
+    pWb = pConfig->pWbGains ? pConfig->pWbGains : pCalib->cc.wb;
+    for (i = 0; i < REF_CH_MAX; i++) {
+        pIsp->gain[i] = norm;
+        if ((pConfig->stages & REF_STAGE_AWB) && pConfig->bayer != REF_BAYER_MONO)
+            pIsp->gain[i] *= pWb[i];
+    }
+
+    if ((pConfig->stages & REF_STAGE_CC) && pConfig->bayer != REF_BAYER_MONO) {
+        memcpy(pIsp->ccMatrix, pCalib->cc.ccMatrix, sizeof(pIsp->ccMatrix));
+        for (i = 0; i < 3; i++)
+            pIsp->ccOffsets[i] = pCalib->cc.ccOffsets[i] /
+                                 (float)((1u << pConfig->calibBitDepth) - 1);
+    } else {
+        memcpy(pIsp->ccMatrix, identity, sizeof(pIsp->ccMatrix));
+    }
+
+    for (p = 0; p < 2; p++) {
+        pIsp->pOffset[p] = malloc(pConfig->width * sizeof(float));
+        if (!pIsp->pOffset[p])
+            goto error;
+        for (x = 0; x < pConfig->width; x++)
+            pIsp->pOffset[p][x] = (pConfig->stages & REF_STAGE_BLS) ?
+                                  pCalib->bls[pIsp->chan[p][x & 1]] * calibScale : 0.0f;
+    }
+
+    if (pConfig->stages & REF_STAGE_LSC) {
+        RefLscMapConfig_t LscConfig = {
+            .width = pConfig->width,
+            .height = pConfig->height,
+            .block = 2,
+            .ctThreshold = REF_LSC_CT_THRESHOLD,
+        };
+        int blend = pConfig->ct > 0.0f && pCalib->numLscProfiles > 0;
+
+        memcpy(LscConfig.chan, pIsp->chan, sizeof(LscConfig.chan));
+        pIsp->pLscMap = RefLscMapCreate(&LscConfig,
+                                        blend ? pCalib->lscProfiles : &pCalib->lsc,
+                                        blend ? pCalib->numLscProfiles : 1);
+        if (!pIsp->pLscMap) {
+            RefIspDestroy(pIsp);
+            return NULL;
+        }
+        RefLscMapUpdate(pIsp->pLscMap, pConfig->ct);
+    }
+
+    RefIspInitGamma(pIsp);
+
+    pIsp->numWorkers = pConfig->threads;
+    if (!pIsp->numWorkers) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        pIsp->numWorkers = cpus > 0 ? (uint32_t)cpus : 1;
+    }
+    pIsp->pWorkers = calloc(pIsp->numWorkers, sizeof(RefIspWorker_t));
+    if (!pIsp->pWorkers)
+        goto error;
+    for (i = 0; i < pIsp->numWorkers; i++) {
+        if (RefIspInitWorker(pIsp, &pIsp->pWorkers[i]) != 0)
+            goto error;
+    }
+    return pIsp;
+
+error:
+    fprintf(stderr, "out of memory\n");
+    RefIspDestroy(pIsp);
+    return NULL;
+}
+
+void RefIspDestroy(RefIsp_t *pIsp)
+{
+    uint32_t i;
+    int j;
+
+    if (!pIsp)
+        return;
+    if (pIsp->pWorkers) {
+        for (i = 0; i < pIsp->numWorkers; i++) {
+            for (j = 0; j < 3; j++) {
+                free(pIsp->pWorkers[i].pRows[j]);
+                free(pIsp->pWorkers[i].pPlane[j]);
+            }
+            free(pIsp->pWorkers[i].pScale);
+            free(pIsp->pWorkers[i].pRgb);
+        }
+        free(pIsp->pWorkers);
+    }
+    RefLscMapDestroy(pIsp->pLscMap);
+    free(pIsp->pOffset[1]);
+    free(pIsp->pOffset[0]);
+    free(pIsp);
+}
+
+int RefIspSetCt(RefIsp_t *pIsp, float ct)
+{
+    return pIsp->pLscMap ? RefLscMapUpdate(pIsp->pLscMap, ct) : 0;
+}
+
+int RefIspProcess(RefIsp_t *pIsp, const uint16_t *pIn, void *pOut)
+{
+    uint32_t i, started;
+    int ret = 0;
+
+    pIsp->pIn = pIn;
+    pIsp->pOut = pOut;
+    pIsp->nextBand = 0;
+
+    /* the calling thread is the first worker */
+    for (started = 1; started < pIsp->numWorkers; started++) {
+        if (pthread_create(&pIsp->pWorkers[started].thread, NULL, RefIspWorker,
+                           &pIsp->pWorkers[started]) != 0) {
+            ret = -1;
+            break;
+        }
+    }
+    RefIspWorker(&pIsp->pWorkers[0]);
+    for (i = 1; i < started; i++)
+        pthread_join(pIsp->pWorkers[i].thread, NULL);
+    return ret;
+}
@@ -0,0 +1,90 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Host reference of the ISP stages the calibration XML parameterizes:
+ * black level subtraction, lens shading correction, white balance gains,
+ * bilinear demosaic and the colour correction matrix with its offsets.
+ *
+ * Frames are split in bands of rows processed by a pool of threads; each
+ * stage runs over whole rows of float samples so that the compiler can
+ * vectorize it.
+ */
+
+#ifndef __REF_ISP_H__
+#define __REF_ISP_H__
+
+#include <stdint.h>
+
+#include "ref_calib.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum RefBayer_e
+{
+    REF_BAYER_RGGB = 0,
+    REF_BAYER_GRBG,
+    REF_BAYER_GBRG,
+    REF_BAYER_BGGR,
+    REF_BAYER_MONO,                     /* no demosaic, CC or white balance */
+} RefBayer_t;
+
+#define REF_STAGE_BLS           (1u << 0)
+#define REF_STAGE_LSC           (1u << 1)
+#define REF_STAGE_AWB           (1u << 2)
+#define REF_STAGE_CC            (1u << 3)
+#define REF_STAGE_ALL           (REF_STAGE_BLS | REF_STAGE_LSC | REF_STAGE_AWB | REF_STAGE_CC)
+
+typedef struct RefIspConfig_s
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t bitDepth;                  /* of the input samples */
+    /* bit depth blsData and ccOffsets are expressed in */
+    uint32_t calibBitDepth;
+    RefBayer_t bayer;
+    uint32_t stages;                    /* REF_STAGE_* to apply */
+    const RefCalib_t *pCalib;
+    const float *pWbGains;              /* R Gr Gb B, NULL for the CC profile's */
+    /* colour temperature to blend the LSC profiles of all illuminations
+     * at, 0 for the LSC profile of the calibration's illumination */
+    float ct;
+    uint32_t threads;                   /* 0 for one per CPU */
+    int output16;                       /* linear uint16_t instead of sRGB bytes */
+} RefIspConfig_t;
+
+typedef struct RefIsp_s RefIsp_t;
+
+/* RefChannel_t at (y & 1, x & 1) of a pattern, RGGB's for REF_BAYER_MONO */
+void RefIspBayerChannels(RefBayer_t bayer, uint8_t chan[2][2]);
+
+RefIsp_t *RefIspCreate(const RefIspConfig_t *pConfig);
+void RefIspDestroy(RefIsp_t *pIsp);
+
+/*
+ * Move the LSC blend to another colour temperature, for an AWB that changes
+ * between frames; the gain map is only recomputed when ct moved far enough
+ * from the last one. Returns 1 if it was recomputed.
+ */
+int RefIspSetCt(RefIsp_t *pIsp, float ct);
+
+/*
+ * Process one frame of right aligned samples, width * height of them.
+ * The output is interleaved RGB, or one channel for REF_BAYER_MONO, of
+ * bytes or of uint16_t with output16.
+ */
+int RefIspProcess(RefIsp_t *pIsp, const uint16_t *pIn, void *pOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,261 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ref_lsc.h"
+
+#define REF_LSC_SECTORS         (2 * REF_LSC_SECTORS_HALF)
+
+/* where the samples of one axis fall in a profile's sectors */
+typedef struct RefLscAxis_s
+{
+    /* per block and sample parity: sector and position inside it, 0 to 1 */
+    uint16_t *pSect[2];
+    float *pFrac[2];
+    /* first block of each sector, and the block count: the runs of blocks
+     * that interpolate between the same two grid samples */
+    uint32_t runStart[2][REF_LSC_SECTORS + 1];
+} RefLscAxis_t;
+
+typedef struct RefLscGeometry_s
+{
+    RefLscAxis_t x;
+    RefLscAxis_t y;
+} RefLscGeometry_t;
+
+struct RefLscMap_s
+{
+    RefLscMapConfig_t config;
+    uint32_t mapWidth;
+    uint32_t mapHeight;
+    uint8_t parity[REF_CH_MAX][2];      /* y & 1, x & 1 of each channel */
+
+    uint32_t count;
+    RefLscProfile_t *pProfiles;
+    RefLscGeometry_t *pGeometry;        /* of each profile */
+
+    float *pGain[REF_CH_MAX];           /* mapWidth * mapHeight each */
+    float *pBlend;                      /* row of the second blended profile */
+    float ct;                           /* of the current map */
+    int valid;
+};
+
+static int RefLscAxisInit(RefLscAxis_t *pAxis, const uint32_t *pHalfSizes,
+                          uint32_t length, uint32_t blocks, uint32_t block)
+{
+    float start[REF_LSC_SECTORS + 1], size[REF_LSC_SECTORS];
+    float total = 0.0f, pos;
+    uint32_t i, k, p, s, pixel;
+
+    for (i = 0; i < REF_LSC_SECTORS_HALF; i++) {
+        size[i] = (float)pHalfSizes[i];
+        size[REF_LSC_SECTORS - 1 - i] = (float)pHalfSizes[i];
+        total += 2.0f * pHalfSizes[i];
+    }
+    start[0] = 0.0f;
+    for (i = 0; i < REF_LSC_SECTORS; i++)
+        start[i + 1] = start[i] + size[i];
+
+    for (p = 0; p < 2; p++) {
+        pAxis->pSect[p] = malloc(blocks * sizeof(uint16_t));
+        pAxis->pFrac[p] = malloc(blocks * sizeof(float));
+        if (!pAxis->pSect[p] || !pAxis->pFrac[p])
+            return -1;
+
+        /* the sample of a block is the pixel of its parity nearest the
+         * centre, which for 2 pixel blocks is every pixel */
+        s = 0;
+        for (k = 0; k < blocks; k++) {
+            pixel = k * block + block / 2 - 1 + p;
+            if (pixel >= length)
+                pixel = length - 1;
+            /* sectors of the calibration resolution, scaled to the frame */
+            pos = (float)pixel * total / (float)length;
+            while (s < REF_LSC_SECTORS - 1 && pos >= start[s + 1])
+                s++;
+            pAxis->pSect[p][k] = s;
+            pAxis->pFrac[p][k] = (pos - start[s]) / size[s];
+        }
+
+        for (s = 0, k = 0; s <= REF_LSC_SECTORS; s++) {
+            while (k < blocks && pAxis->pSect[p][k] < s)
+                k++;
+            pAxis->runStart[p][s] = s == REF_LSC_SECTORS ? blocks : k;
+        }
+    }
+    return 0;
+}
+
+static void RefLscAxisFree(RefLscAxis_t *pAxis)
+{
+    int p;
+
+    for (p = 0; p < 2; p++) {
+        free(pAxis->pSect[p]);
+        free(pAxis->pFrac[p]);
+    }
+}
+
+/*
+ * Gains of one channel of a profile for block row j. The grid is first
+ * interpolated vertically into one row of samples, then each sector's run
+ * of blocks is a linear ramp between two of them.
+ */
+static void RefLscExpandRow(const RefLscMap_t *pMap, uint32_t profile,
+                            RefChannel_t ch, uint32_t j, float *pDst)
+{
+    const RefLscGeometry_t *pGeometry = &pMap->pGeometry[profile];
+    const float *pSamples = pMap->pProfiles[profile].samples[ch];
+    const uint32_t py = pMap->parity[ch][0], px = pMap->parity[ch][1];
+    const uint32_t *pRun = pGeometry->x.runStart[px];
+    const float *pFrac = pGeometry->x.pFrac[px];
+    const float *pTop, *pBottom;
+    float row[REF_LSC_GRID], fy, g0, d;
+    uint32_t i, k, s;
+
+    fy = pGeometry->y.pFrac[py][j];
+    pTop = &pSamples[pGeometry->y.pSect[py][j] * REF_LSC_GRID];
+    pBottom = pTop + REF_LSC_GRID;
+    for (i = 0; i < REF_LSC_GRID; i++)
+        row[i] = pTop[i] + (pBottom[i] - pTop[i]) * fy;
+
+    for (s = 0; s < REF_LSC_SECTORS; s++) {
+        g0 = row[s];
+        d = row[s + 1] - row[s];
+        for (k = pRun[s]; k < pRun[s + 1]; k++)
+            pDst[k] = g0 + d * pFrac[k];
+    }
+}
+
+RefLscMap_t *RefLscMapCreate(const RefLscMapConfig_t *pConfig,
+                             const RefLscProfile_t *pProfiles, uint32_t count)
+{
+    RefLscMap_t *pMap;
+    uint32_t i, ch, p;
+
+    if (!count || pConfig->block < 2 || pConfig->block % 2 ||
+        pConfig->width < 2 || pConfig->height < 2) {
+        fprintf(stderr, "unsupported LSC map of %ux%u in %u pixel blocks\n",
+                pConfig->width, pConfig->height, pConfig->block);
+        return NULL;
+    }
+
+    pMap = calloc(1, sizeof(*pMap));
+    if (!pMap)
+        return NULL;
+    pMap->config = *pConfig;
+    pMap->mapWidth = (pConfig->width + pConfig->block - 1) / pConfig->block;
+    pMap->mapHeight = (pConfig->height + pConfig->block - 1) / pConfig->block;
+    for (p = 0; p < 4; p++) {
+        pMap->parity[pConfig->chan[p >> 1][p & 1]][0] = p >> 1;
+        pMap->parity[pConfig->chan[p >> 1][p & 1]][1] = p & 1;
+    }
+
+    pMap->count = count;
+    pMap->pProfiles = malloc(count * sizeof(RefLscProfile_t));
+    pMap->pGeometry = calloc(count, sizeof(RefLscGeometry_t));
+    if (!pMap->pProfiles || !pMap->pGeometry)
+        goto error;
+    memcpy(pMap->pProfiles, pProfiles, count * sizeof(RefLscProfile_t));
+
+    /* profiles of one calibration have sectors of their own */
+    for (i = 0; i < count; i++) {
+        if (RefLscAxisInit(&pMap->pGeometry[i].x, pProfiles[i].sectSizeX, pConfig->width,
+                           pMap->mapWidth, pConfig->block) != 0 ||
+            RefLscAxisInit(&pMap->pGeometry[i].y, pProfiles[i].sectSizeY, pConfig->height,
+                           pMap->mapHeight, pConfig->block) != 0)
+            goto error;
+    }
+
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        pMap->pGain[ch] = malloc((size_t)pMap->mapWidth * pMap->mapHeight * sizeof(float));
+        if (!pMap->pGain[ch])
+            goto error;
+    }
+    pMap->pBlend = malloc(pMap->mapWidth * sizeof(float));
+    if (!pMap->pBlend)
+        goto error;
+    return pMap;
+
+error:
+    fprintf(stderr, "out of memory\n");
+    RefLscMapDestroy(pMap);
+    return NULL;
+}
+
+void RefLscMapDestroy(RefLscMap_t *pMap)
+{
+    uint32_t i;
+
+    if (!pMap)
+        return;
+    free(pMap->pBlend);
+    for (i = 0; i < REF_CH_MAX; i++)
+        free(pMap->pGain[i]);
+    if (pMap->pGeometry) {
+        for (i = 0; i < pMap->count; i++) {
+            RefLscAxisFree(&pMap->pGeometry[i].x);
+            RefLscAxisFree(&pMap->pGeometry[i].y);
+        }
+        free(pMap->pGeometry);
+    }
+    free(pMap->pProfiles);
+    free(pMap);
+}
+
+int RefLscMapUpdate(RefLscMap_t *pMap, float ct)
+{
+    const RefLscProfile_t *pProfiles = pMap->pProfiles;
+    uint32_t a = 0, ch, j, k, last = pMap->count - 1;
+    float w = 0.0f, *pDst;
+
+    if (pMap->valid &&
+        (pMap->count == 1 || fabsf(ct - pMap->ct) < pMap->config.ctThreshold))
+        return 0;
+
+    /* blend weight in mired, in which temperatures are perceptually even */
+    if (ct >= pProfiles[last].ct) {
+        a = last;
+    } else if (ct > pProfiles[0].ct) {
+        while (pProfiles[a + 1].ct <= ct)
+            a++;
+        w = (1.0f / ct - 1.0f / pProfiles[a].ct) /
+            (1.0f / pProfiles[a + 1].ct - 1.0f / pProfiles[a].ct);
+    }
+
+    for (ch = 0; ch < REF_CH_MAX; ch++) {
+        for (j = 0; j < pMap->mapHeight; j++) {
+            pDst = pMap->pGain[ch] + (size_t)j * pMap->mapWidth;
+            RefLscExpandRow(pMap, a, (RefChannel_t)ch, j, pDst);
+            if (w > 0.0f) {
+                RefLscExpandRow(pMap, a + 1, (RefChannel_t)ch, j, pMap->pBlend);
+                for (k = 0; k < pMap->mapWidth; k++)
+                    pDst[k] += (pMap->pBlend[k] - pDst[k]) * w;
+            }
+        }
+    }
+
+    pMap->ct = ct;
+    pMap->valid = 1;
+    return 1;
+}
+
+void RefLscMapSize(const RefLscMap_t *pMap, uint32_t *pWidth, uint32_t *pHeight)
+{
+    *pWidth = pMap->mapWidth;
+    *pHeight = pMap->mapHeight;
+}
+
+const float *RefLscMapRow(const RefLscMap_t *pMap, RefChannel_t ch, uint32_t row)
+{
+    return pMap->pGain[ch] + (size_t)row * pMap->mapWidth;
+}
@@ -0,0 +1,66 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Lens shading gain map of a frame, blended between the LSC profiles of a
+ * calibration by colour temperature.
+ *
+ * The sector geometry of every profile is mapped to the map's blocks once,
+ * at creation. An update blends the two profiles around the temperature,
+ * linearly in mired, and expands them to one gain per block and channel
+ * with bilinear interpolation run sector by sector, so that the inner loops
+ * are contiguous and vectorize. Updates within a threshold of the
+ * temperature of the current map are skipped.
+ */
+
+#ifndef __REF_LSC_H__
+#define __REF_LSC_H__
+
+#include <stdint.h>
+
+#include "ref_calib.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct RefLscMapConfig_s
+{
+    uint32_t width;                     /* of the frame */
+    uint32_t height;
+    /* pixels per gain in each direction, even; 2 for a gain per pixel */
+    uint32_t block;
+    uint8_t chan[2][2];                 /* RefChannel_t at (y & 1, x & 1) */
+    float ctThreshold;                  /* kelvin */
+} RefLscMapConfig_t;
+
+typedef struct RefLscMap_s RefLscMap_t;
+
+/*
+ * Profiles must be sorted by ct, as RefCalib_t lscProfiles are; a single
+ * profile gives a map that does not depend on the temperature.
+ */
+RefLscMap_t *RefLscMapCreate(const RefLscMapConfig_t *pConfig,
+                             const RefLscProfile_t *pProfiles, uint32_t count);
+void RefLscMapDestroy(RefLscMap_t *pMap);
+
+/* 1 if the map was recomputed for ct, 0 if it was within the threshold */
+int RefLscMapUpdate(RefLscMap_t *pMap, float ct);
+
+/* map size in blocks, (width + block - 1) / block by the same for height */
+void RefLscMapSize(const RefLscMap_t *pMap, uint32_t *pWidth, uint32_t *pHeight);
+
+/* gains of one channel for block row row, 1.0 for no correction */
+const float *RefLscMapRow(const RefLscMap_t *pMap, RefChannel_t ch, uint32_t row);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#include "raw_pack_priv.h"
+
+void RawUnpack8Scalar(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i < pixels; i++)
+        pDst[i] = pSrc[i];
+}
+
+void RawUnpack10Scalar(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i < pixels; i += 4, pSrc += 5, pDst += 4) {
+        pDst[0] = (pSrc[0] << 2) | (pSrc[4] & 0x3);
+        pDst[1] = (pSrc[1] << 2) | ((pSrc[4] >> 2) & 0x3);
+        pDst[2] = (pSrc[2] << 2) | ((pSrc[4] >> 4) & 0x3);
+        pDst[3] = (pSrc[3] << 2) | (pSrc[4] >> 6);
+    }
+}
+
+void RawUnpack12Scalar(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i < pixels; i += 2, pSrc += 3, pDst += 2) {
+        pDst[0] = (pSrc[0] << 4) | (pSrc[2] & 0xf);
+        pDst[1] = (pSrc[1] << 4) | (pSrc[2] >> 4);
+    }
+}
+
+void RawPack8Scalar(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i < pixels; i++)
+        pDst[i] = (uint8_t)pSrc[i];
+}
+
+void RawPack10Scalar(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i < pixels; i += 4, pSrc += 4, pDst += 5) {
+        pDst[0] = (pSrc[0] >> 2) & 0xff;
+        pDst[1] = (pSrc[1] >> 2) & 0xff;
+        pDst[2] = (pSrc[2] >> 2) & 0xff;
+        pDst[3] = (pSrc[3] >> 2) & 0xff;
+        pDst[4] = (pSrc[0] & 0x3) | ((pSrc[1] & 0x3) << 2) |
+                  ((pSrc[2] & 0x3) << 4) | ((pSrc[3] & 0x3) << 6);
+    }
+}
+
+void RawPack12Scalar(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i < pixels; i += 2, pSrc += 2, pDst += 3) {
+        pDst[0] = (pSrc[0] >> 4) & 0xff;
+        pDst[1] = (pSrc[1] >> 4) & 0xff;
+        pDst[2] = (pSrc[0] & 0xf) | ((pSrc[1] & 0xf) << 4);
+    }
+}
+
+void RawConvertDepthScalar(uint16_t *pDst, const uint16_t *pSrc, size_t pixels,
+                           uint32_t fromBits, uint32_t toBits)
+{
+    uint32_t shift, max, value;
+    size_t i;
+
+    if (toBits >= fromBits) {
+        shift = toBits - fromBits;
+        for (i = 0; i < pixels; i++)
+            pDst[i] = pSrc[i] << shift;
+        return;
+    }
+
+    shift = fromBits - toBits;
+    max = (1u << toBits) - 1;
+    for (i = 0; i < pixels; i++) {
+        value = (pSrc[i] + (1u << (shift - 1))) >> shift;
+        pDst[i] = value > max ? max : value;
+    }
+}
+
+static const RawPackOps_t RawPackOpsScalar = {
+    .name = "scalar",
+    .unpack8 = RawUnpack8Scalar,
+    .unpack10 = RawUnpack10Scalar,
+    .unpack12 = RawUnpack12Scalar,
+    .pack8 = RawPack8Scalar,
+    .pack10 = RawPack10Scalar,
+    .pack12 = RawPack12Scalar,
+    .convertDepth = RawConvertDepthScalar,
+};
+
+const RawPackOps_t *RawPackGetOps(RawPackImpl_t impl)
+{
+    switch (impl) {
+    case RAW_PACK_IMPL_SCALAR:
+        return &RawPackOpsScalar;
+#ifdef RAW_PACK_HAVE_AVX2
+    case RAW_PACK_IMPL_AVX2:
+        return __builtin_cpu_supports("avx2") ? &RawPackOpsAvx2 : NULL;
+#endif
+#ifdef RAW_PACK_HAVE_NEON
+    case RAW_PACK_IMPL_NEON:
+        return &RawPackOpsNeon;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+const RawPackOps_t *RawPackBestOps(void)
+{
+    static const RawPackOps_t *pBest;
+    int impl;
+
+    if (pBest)
+        return pBest;
+    for (impl = RAW_PACK_IMPL_MAX - 1; impl >= RAW_PACK_IMPL_SCALAR; impl--) {
+        pBest = RawPackGetOps((RawPackImpl_t)impl);
+        if (pBest)
+            break;
+    }
+    return pBest;
+}
+
+size_t RawPackedBytes(uint32_t bitDepth, size_t pixels)
+{
+    switch (bitDepth) {
+    case 8:
+        return pixels;
+    case 10:
+        return pixels * 5 / 4;
+    case 12:
+        return pixels * 3 / 2;
+    default:
+        return 0;
+    }
+}
+
+int RawUnpackLine(uint16_t *pDst, const uint8_t *pSrc, uint32_t bitDepth,
+                  size_t pixels)
+{
+    const RawPackOps_t *pOps = RawPackBestOps();
+
+    switch (bitDepth) {
+    case 8:
+        pOps->unpack8(pDst, pSrc, pixels);
+        return 0;
+    case 10:
+        if (pixels % 4)
+            return -1;
+        pOps->unpack10(pDst, pSrc, pixels);
+        return 0;
+    case 12:
+        if (pixels % 2)
+            return -1;
+        pOps->unpack12(pDst, pSrc, pixels);
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+int RawPackLine(uint8_t *pDst, const uint16_t *pSrc, uint32_t bitDepth,
+                size_t pixels)
+{
+    const RawPackOps_t *pOps = RawPackBestOps();
+
+    switch (bitDepth) {
+    case 8:
+        pOps->pack8(pDst, pSrc, pixels);
+        return 0;
+    case 10:
+        if (pixels % 4)
+            return -1;
+        pOps->pack10(pDst, pSrc, pixels);
+        return 0;
+    case 12:
+        if (pixels % 2)
+            return -1;
+        pOps->pack12(pDst, pSrc, pixels);
+        return 0;
+    default:
+        return -1;
+    }
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Conversion between MIPI CSI-2 packed RAW8/10/12 lines and 16 bit samples.
+ *
+ * RAW10 packs 4 samples in 5 bytes (the 8 MSBs of each sample, then a byte
+ * of the 2 LSBs, first sample in bits 1:0). RAW12 packs 2 samples in 3
+ * bytes (the 8 MSBs of each, then the 4 LSBs, first sample in bits 3:0).
+ * Unpacked samples are right aligned in uint16_t.
+ */
+
+#ifndef __RAW_PACK_H__
+#define __RAW_PACK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * One implementation of the kernels. pixels must be a multiple of 4 for
+ * RAW10 and of 2 for RAW12, as every CSI-2 line is. Packing drops the bits
+ * above the packed depth.
+ */
+typedef struct RawPackOps_s
+{
+    const char *name;
+    void (*unpack8)(uint16_t *pDst, const uint8_t *pSrc, size_t pixels);
+    void (*unpack10)(uint16_t *pDst, const uint8_t *pSrc, size_t pixels);
+    void (*unpack12)(uint16_t *pDst, const uint8_t *pSrc, size_t pixels);
+    void (*pack8)(uint8_t *pDst, const uint16_t *pSrc, size_t pixels);
+    void (*pack10)(uint8_t *pDst, const uint16_t *pSrc, size_t pixels);
+    void (*pack12)(uint8_t *pDst, const uint16_t *pSrc, size_t pixels);
+    /*
+     * Rescale samples from fromBits to toBits (1 to 16): a left shift when
+     * widening, a rounded and clamped right shift when narrowing. pDst may
+     * equal pSrc.
+     */
+    void (*convertDepth)(uint16_t *pDst, const uint16_t *pSrc, size_t pixels,
+                         uint32_t fromBits, uint32_t toBits);
+} RawPackOps_t;
+
+typedef enum RawPackImpl_e
+{
+    RAW_PACK_IMPL_SCALAR = 0,
+    RAW_PACK_IMPL_AVX2,
+    RAW_PACK_IMPL_NEON,
+    RAW_PACK_IMPL_MAX
+} RawPackImpl_t;
+
+/* NULL when the implementation is not built in or the CPU lacks it */
+const RawPackOps_t *RawPackGetOps(RawPackImpl_t impl);
+
+/* fastest implementation the CPU supports */
+const RawPackOps_t *RawPackBestOps(void);
+
+/* bytes of a packed line of bitDepth 8, 10 or 12, 0 for other depths */
+size_t RawPackedBytes(uint32_t bitDepth, size_t pixels);
+
+/*
+ * Unpack or pack one line with RawPackBestOps(). Return -1 for a depth
+ * other than 8, 10 or 12 or a pixel count the packing cannot hold.
+ */
+int RawUnpackLine(uint16_t *pDst, const uint8_t *pSrc, uint32_t bitDepth,
+                  size_t pixels);
+int RawPackLine(uint8_t *pDst, const uint16_t *pSrc, uint32_t bitDepth,
+                size_t pixels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * AVX2 kernels. Each 128 bit lane handles one run of 8 samples, so the
+ * packed side is loaded and stored with unaligned 16 byte accesses that
+ * overlap the next run; the loops stop early enough for those accesses to
+ * stay inside the line and the scalar code finishes it.
+ */
+
+#include <immintrin.h>
+
+#include "raw_pack_priv.h"
+
+static inline __m256i RawLoadRuns(const uint8_t *pSrc, size_t runBytes)
+{
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)pSrc)),
+        _mm_loadu_si128((const __m128i *)(pSrc + runBytes)), 1);
+}
+
+static inline void RawStoreRuns(uint8_t *pDst, __m256i v, size_t runBytes)
+{
+    _mm_storeu_si128((__m128i *)pDst, _mm256_castsi256_si128(v));
+    _mm_storeu_si128((__m128i *)(pDst + runBytes), _mm256_extracti128_si256(v, 1));
+}
+
+static void RawUnpack8Avx2(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i + 16 <= pixels; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(pSrc + i));
+        _mm256_storeu_si256((__m256i *)(pDst + i), _mm256_cvtepu8_epi16(v));
+    }
+    RawUnpack8Scalar(pDst + i, pSrc + i, pixels - i);
+}
+
+static void RawUnpack10Avx2(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    /* word k = MSB byte << 8 | LSB byte of its group */
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(4, 0, 4, 1, 4, 2, 4, 3, 9, 5, 9, 6, 9, 7, 9, 8));
+    /* moves the 2 LSBs of sample k to bits 7:6 */
+    const __m256i lsbShift = _mm256_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1,
+                                               64, 16, 4, 1, 64, 16, 4, 1);
+    const __m256i msbMask = _mm256_set1_epi16(0x3fc);
+    const __m256i lsbMask = _mm256_set1_epi16(0x3);
+    size_t i;
+
+    /* 16 samples from 20 bytes, loads reach 26 bytes */
+    for (i = 0; i + 24 <= pixels; i += 16, pSrc += 20) {
+        __m256i w = _mm256_shuffle_epi8(RawLoadRuns(pSrc, 10), shuffle);
+        __m256i msb = _mm256_and_si256(_mm256_srli_epi16(w, 6), msbMask);
+        __m256i lsb = _mm256_and_si256(
+            _mm256_srli_epi16(_mm256_mullo_epi16(w, lsbShift), 6), lsbMask);
+        _mm256_storeu_si256((__m256i *)(pDst + i), _mm256_or_si256(msb, lsb));
+    }
+    RawUnpack10Scalar(pDst + i, pSrc, pixels - i);
+}
+
+static void RawUnpack12Avx2(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    /* word k = MSB byte << 8 | LSB byte of its pair */
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(2, 0, 2, 1, 5, 3, 5, 4, 8, 6, 8, 7, 11, 9, 11, 10));
+    /* moves the 4 LSBs of even samples up, odd ones are in place */
+    const __m256i lsbShift = _mm256_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1,
+                                               16, 1, 16, 1, 16, 1, 16, 1);
+    const __m256i msbMask = _mm256_set1_epi16(0xff0);
+    const __m256i lsbMask = _mm256_set1_epi16(0xf);
+    size_t i;
+
+    /* 16 samples from 24 bytes, loads reach 28 bytes */
+    for (i = 0; i + 24 <= pixels; i += 16, pSrc += 24) {
+        __m256i w = _mm256_shuffle_epi8(RawLoadRuns(pSrc, 12), shuffle);
+        __m256i msb = _mm256_and_si256(_mm256_srli_epi16(w, 4), msbMask);
+        __m256i lsb = _mm256_and_si256(
+            _mm256_srli_epi16(_mm256_mullo_epi16(w, lsbShift), 4), lsbMask);
+        _mm256_storeu_si256((__m256i *)(pDst + i), _mm256_or_si256(msb, lsb));
+    }
+    RawUnpack12Scalar(pDst + i, pSrc, pixels - i);
+}
+
+static void RawPack8Avx2(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    const __m256i mask = _mm256_set1_epi16(0xff);
+    size_t i;
+
+    for (i = 0; i + 32 <= pixels; i += 32) {
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(pSrc + i)), mask);
+        __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(pSrc + i + 16)), mask);
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256((__m256i *)(pDst + i), v);
+    }
+    RawPack8Scalar(pDst + i, pSrc + i, pixels - i);
+}
+
+static void RawPack10Avx2(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    /* after merging: m0 L0 m1 . m2 . m3 . m4 L1 m5 . m6 . m7 . */
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 2, 4, 6, 1, 8, 10, 12, 14, 9, -1, -1, -1, -1, -1, -1));
+    const __m256i lsbWeight = _mm256_setr_epi16(1, 4, 16, 64, 1, 4, 16, 64,
+                                                1, 4, 16, 64, 1, 4, 16, 64);
+    const __m256i msbMask = _mm256_set1_epi16(0xff);
+    const __m256i lsbMask = _mm256_set1_epi16(0x3);
+    size_t i;
+
+    /* 16 samples to 20 bytes, stores reach 26 bytes */
+    for (i = 0; i + 24 <= pixels; i += 16, pDst += 20) {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(pSrc + i));
+        __m256i msb = _mm256_and_si256(_mm256_srli_epi16(p, 2), msbMask);
+        /* one LSB byte per group of 4 in the low byte of each qword */
+        __m256i lsb = _mm256_madd_epi16(_mm256_and_si256(p, lsbMask), lsbWeight);
+        lsb = _mm256_or_si256(lsb, _mm256_srli_epi64(lsb, 32));
+        lsb = _mm256_and_si256(lsb, _mm256_set1_epi64x(0xff));
+        __m256i v = _mm256_or_si256(msb, _mm256_bslli_epi128(lsb, 1));
+        RawStoreRuns(pDst, _mm256_shuffle_epi8(v, shuffle), 10);
+    }
+    RawPack10Scalar(pDst, pSrc + i, pixels - i);
+}
+
+static void RawPack12Avx2(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    /* after merging: m0 L0 m1 . m2 L1 m3 . m4 L2 m5 . m6 L3 m7 . */
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 2, 1, 4, 6, 5, 8, 10, 9, 12, 14, 13, -1, -1, -1, -1));
+    const __m256i lsbWeight = _mm256_setr_epi16(1, 16, 1, 16, 1, 16, 1, 16,
+                                                1, 16, 1, 16, 1, 16, 1, 16);
+    const __m256i msbMask = _mm256_set1_epi16(0xff);
+    const __m256i lsbMask = _mm256_set1_epi16(0xf);
+    size_t i;
+
+    /* 16 samples to 24 bytes, stores reach 28 bytes */
+    for (i = 0; i + 24 <= pixels; i += 16, pDst += 24) {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(pSrc + i));
+        __m256i msb = _mm256_and_si256(_mm256_srli_epi16(p, 4), msbMask);
+        /* one LSB byte per pair in the low byte of each dword */
+        __m256i lsb = _mm256_madd_epi16(_mm256_and_si256(p, lsbMask), lsbWeight);
+        __m256i v = _mm256_or_si256(msb, _mm256_bslli_epi128(lsb, 1));
+        RawStoreRuns(pDst, _mm256_shuffle_epi8(v, shuffle), 12);
+    }
+    RawPack12Scalar(pDst, pSrc + i, pixels - i);
+}
+
+static void RawConvertDepthAvx2(uint16_t *pDst, const uint16_t *pSrc, size_t pixels,
+                                uint32_t fromBits, uint32_t toBits)
+{
+    size_t i = 0;
+
+    if (toBits >= fromBits) {
+        const __m128i shift = _mm_cvtsi32_si128(toBits - fromBits);
+
+        for (; i + 16 <= pixels; i += 16) {
+            __m256i p = _mm256_loadu_si256((const __m256i *)(pSrc + i));
+            _mm256_storeu_si256((__m256i *)(pDst + i), _mm256_sll_epi16(p, shift));
+        }
+    } else {
+        const __m128i shift = _mm_cvtsi32_si128(fromBits - toBits);
+        const __m256i round = _mm256_set1_epi16(1 << (fromBits - toBits - 1));
+        const __m256i max = _mm256_set1_epi16((1 << toBits) - 1);
+
+        for (; i + 16 <= pixels; i += 16) {
+            __m256i p = _mm256_loadu_si256((const __m256i *)(pSrc + i));
+            p = _mm256_srl_epi16(_mm256_adds_epu16(p, round), shift);
+            _mm256_storeu_si256((__m256i *)(pDst + i), _mm256_min_epu16(p, max));
+        }
+    }
+    RawConvertDepthScalar(pDst + i, pSrc + i, pixels - i, fromBits, toBits);
+}
+
+const RawPackOps_t RawPackOpsAvx2 = {
+    .name = "avx2",
+    .unpack8 = RawUnpack8Avx2,
+    .unpack10 = RawUnpack10Avx2,
+    .unpack12 = RawUnpack12Avx2,
+    .pack8 = RawPack8Avx2,
+    .pack10 = RawPack10Avx2,
+    .pack12 = RawPack12Avx2,
+    .convertDepth = RawConvertDepthAvx2,
+};
@@ -0,0 +1,250 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * Benchmark of the RAW pack and unpack kernels.
+ *
+ * Runs every kernel of every implementation the CPU supports over a frame of
+ * random samples, line by line, checks the output against the scalar
+ * reference and reports GB/s of 16 bit samples and the speedup over scalar.
+ *
+ *   raw-pack-bench [-W width] [-H height] [-n frames]
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "raw_pack.h"
+
+#define BENCH_WIDTH_DEFAULT     1920
+#define BENCH_HEIGHT_DEFAULT    1080
+#define BENCH_FRAMES_DEFAULT    100
+
+typedef enum BenchKernel_e
+{
+    BENCH_UNPACK8 = 0,
+    BENCH_UNPACK10,
+    BENCH_UNPACK12,
+    BENCH_PACK8,
+    BENCH_PACK10,
+    BENCH_PACK12,
+    BENCH_DEPTH_12_TO_16,
+    BENCH_DEPTH_12_TO_10,
+    BENCH_KERNEL_MAX
+} BenchKernel_t;
+
+static const char *BenchKernelNames[BENCH_KERNEL_MAX] = {
+    "unpack8", "unpack10", "unpack12", "pack8", "pack10", "pack12",
+    "depth12to16", "depth12to10",
+};
+
+typedef struct PackBench_s
+{
+    uint32_t width;
+    uint32_t height;
+    uint8_t *pPacked;           /* one frame for every depth */
+    uint16_t *pSamples;
+    uint8_t *pPackedOut;
+    uint16_t *pSamplesOut;
+} PackBench_t;
+
+static uint64_t PackBenchNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t PackBenchDepth(BenchKernel_t kernel)
+{
+    switch (kernel) {
+    case BENCH_UNPACK8:
+    case BENCH_PACK8:
+        return 8;
+    case BENCH_UNPACK10:
+    case BENCH_PACK10:
+        return 10;
+    default:
+        return 12;
+    }
+}
+
+static void PackBenchFill(PackBench_t *pBench, BenchKernel_t kernel)
+{
+    size_t pixels = (size_t)pBench->width * pBench->height;
+    uint32_t mask = (1u << PackBenchDepth(kernel)) - 1;
+    size_t i;
+
+    srand(1);
+    for (i = 0; i < pixels; i++)
+        pBench->pSamples[i] = rand() & mask;
+    for (i = 0; i < RawPackedBytes(12, pixels); i++)
+        pBench->pPacked[i] = rand() & 0xff;
+}
+
+/* one pass over the frame, output in pPackedOut or pSamplesOut */
+static void PackBenchFrame(const PackBench_t *pBench, const RawPackOps_t *pOps,
+                           BenchKernel_t kernel)
+{
+    uint32_t depth = PackBenchDepth(kernel);
+    size_t lineBytes = RawPackedBytes(depth, pBench->width);
+    uint32_t y;
+
+    for (y = 0; y < pBench->height; y++) {
+        const uint8_t *pIn = pBench->pPacked + y * lineBytes;
+        const uint16_t *pSamples = pBench->pSamples + (size_t)y * pBench->width;
+        uint8_t *pOut = pBench->pPackedOut + y * lineBytes;
+        uint16_t *pSamplesOut = pBench->pSamplesOut + (size_t)y * pBench->width;
+
+        switch (kernel) {
+        case BENCH_UNPACK8:
+            pOps->unpack8(pSamplesOut, pIn, pBench->width);
+            break;
+        case BENCH_UNPACK10:
+            pOps->unpack10(pSamplesOut, pIn, pBench->width);
+            break;
+        case BENCH_UNPACK12:
+            pOps->unpack12(pSamplesOut, pIn, pBench->width);
+            break;
+        case BENCH_PACK8:
+            pOps->pack8(pOut, pSamples, pBench->width);
+            break;
+        case BENCH_PACK10:
+            pOps->pack10(pOut, pSamples, pBench->width);
+            break;
+        case BENCH_PACK12:
+            pOps->pack12(pOut, pSamples, pBench->width);
+            break;
+        case BENCH_DEPTH_12_TO_16:
+            pOps->convertDepth(pSamplesOut, pSamples, pBench->width, 12, 16);
+            break;
+        default:
+            pOps->convertDepth(pSamplesOut, pSamples, pBench->width, 12, 10);
+            break;
+        }
+    }
+}
+
+static int PackBenchOutputIsPacked(BenchKernel_t kernel)
+{
+    return kernel == BENCH_PACK8 || kernel == BENCH_PACK10 || kernel == BENCH_PACK12;
+}
+
+static void PackBenchUsage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-W width] [-H height] [-n frames]\n"
+            "  -W  line width in pixels, a multiple of 4 (default %d)\n"
+            "  -H  lines per frame (default %d)\n"
+            "  -n  frames per kernel (default %d)\n",
+            prog, BENCH_WIDTH_DEFAULT, BENCH_HEIGHT_DEFAULT, BENCH_FRAMES_DEFAULT);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t frames = BENCH_FRAMES_DEFAULT;
+    const RawPackOps_t *pScalar = RawPackGetOps(RAW_PACK_IMPL_SCALAR);
+    uint8_t *pRefPacked;
+    uint16_t *pRefSamples;
+    double scalarGbps[BENCH_KERNEL_MAX];
+    PackBench_t Bench;
+    size_t pixels;
+    int opt, impl, ret = 0;
+    uint32_t k, n;
+
+    Bench.width = BENCH_WIDTH_DEFAULT;
+    Bench.height = BENCH_HEIGHT_DEFAULT;
+
+    while ((opt = getopt(argc, argv, "W:H:n:h")) != -1) {
+        switch (opt) {
+        case 'W':
+            Bench.width = strtoul(optarg, NULL, 0);
+            break;
+        case 'H':
+            Bench.height = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            frames = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            PackBenchUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (!Bench.width || Bench.width % 4 || !Bench.height || !frames) {
+        PackBenchUsage(argv[0]);
+        return 1;
+    }
+
+    pixels = (size_t)Bench.width * Bench.height;
+    Bench.pPacked = malloc(RawPackedBytes(12, pixels));
+    Bench.pPackedOut = malloc(RawPackedBytes(12, pixels));
+    Bench.pSamples = malloc(pixels * sizeof(uint16_t));
+    Bench.pSamplesOut = malloc(pixels * sizeof(uint16_t));
+    pRefPacked = malloc(RawPackedBytes(12, pixels));
+    pRefSamples = malloc(pixels * sizeof(uint16_t));
+    if (!Bench.pPacked || !Bench.pPackedOut || !Bench.pSamples ||
+        !Bench.pSamplesOut || !pRefPacked || !pRefSamples) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("%ux%u, %u frames per kernel, GB/s of 16 bit samples\n",
+           Bench.width, Bench.height, frames);
+    printf("%-8s %-12s %10s %8s\n", "impl", "kernel", "GB/s", "speedup");
+
+    for (impl = RAW_PACK_IMPL_SCALAR; impl < RAW_PACK_IMPL_MAX; impl++) {
+        const RawPackOps_t *pOps = RawPackGetOps((RawPackImpl_t)impl);
+
+        if (!pOps)
+            continue;
+
+        for (k = 0; k < BENCH_KERNEL_MAX; k++) {
+            uint64_t startNs, elapsedNs;
+            double gbps;
+
+            PackBenchFill(&Bench, (BenchKernel_t)k);
+            PackBenchFrame(&Bench, pScalar, (BenchKernel_t)k);
+            memcpy(pRefPacked, Bench.pPackedOut, RawPackedBytes(12, pixels));
+            memcpy(pRefSamples, Bench.pSamplesOut, pixels * sizeof(uint16_t));
+
+            startNs = PackBenchNowNs();
+            for (n = 0; n < frames; n++)
+                PackBenchFrame(&Bench, pOps, (BenchKernel_t)k);
+            elapsedNs = PackBenchNowNs() - startNs;
+
+            if (PackBenchOutputIsPacked((BenchKernel_t)k) ?
+                memcmp(pRefPacked, Bench.pPackedOut,
+                       RawPackedBytes(PackBenchDepth((BenchKernel_t)k), pixels)) :
+                memcmp(pRefSamples, Bench.pSamplesOut, pixels * sizeof(uint16_t))) {
+                printf("%-8s %-12s   MISMATCH against scalar\n",
+                       pOps->name, BenchKernelNames[k]);
+                ret = 1;
+                continue;
+            }
+
+            gbps = (double)pixels * sizeof(uint16_t) * frames / elapsedNs;
+            if (impl == RAW_PACK_IMPL_SCALAR)
+                scalarGbps[k] = gbps;
+            printf("%-8s %-12s %10.2f %7.1fx\n", pOps->name, BenchKernelNames[k],
+                   gbps, gbps / scalarGbps[k]);
+        }
+    }
+
+    free(pRefSamples);
+    free(pRefPacked);
+    free(Bench.pSamplesOut);
+    free(Bench.pSamples);
+    free(Bench.pPackedOut);
+    free(Bench.pPacked);
+    return ret;
+}
@@ -0,0 +1,147 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+/*
+ * AArch64 NEON kernels. RAW12 maps onto the 3 way structure loads and
+ * stores; RAW10 has no 5 way form and goes through a table lookup of one
+ * 8 sample run per iteration.
+ */
+
+#include <arm_neon.h>
+
+#include "raw_pack_priv.h"
+
+static void RawUnpack8Neon(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i + 16 <= pixels; i += 16) {
+        uint8x16_t v = vld1q_u8(pSrc + i);
+        vst1q_u16(pDst + i, vmovl_u8(vget_low_u8(v)));
+        vst1q_u16(pDst + i + 8, vmovl_u8(vget_high_u8(v)));
+    }
+    RawUnpack8Scalar(pDst + i, pSrc + i, pixels - i);
+}
+
+static void RawUnpack10Neon(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    /* word k = MSB byte << 8 | LSB byte of its group */
+    static const uint8_t shuffle[16] = { 4, 0, 4, 1, 4, 2, 4, 3, 9, 5, 9, 6, 9, 7, 9, 8 };
+    static const int16_t lsbShift[8] = { 0, -2, -4, -6, 0, -2, -4, -6 };
+    const uint8x16_t tbl = vld1q_u8(shuffle);
+    const int16x8_t shift = vld1q_s16(lsbShift);
+    const uint16x8_t msbMask = vdupq_n_u16(0x3fc);
+    const uint16x8_t lsbMask = vdupq_n_u16(0x3);
+    size_t i;
+
+    /* 8 samples from 10 bytes, loads reach 16 bytes */
+    for (i = 0; i + 16 <= pixels; i += 8, pSrc += 10) {
+        uint16x8_t w = vreinterpretq_u16_u8(vqtbl1q_u8(vld1q_u8(pSrc), tbl));
+        uint16x8_t msb = vandq_u16(vshrq_n_u16(w, 6), msbMask);
+        uint16x8_t lsb = vandq_u16(vshlq_u16(w, shift), lsbMask);
+        vst1q_u16(pDst + i, vorrq_u16(msb, lsb));
+    }
+    RawUnpack10Scalar(pDst + i, pSrc, pixels - i);
+}
+
+static void RawUnpack12Neon(uint16_t *pDst, const uint8_t *pSrc, size_t pixels)
+{
+    const uint8x8_t lsbMask = vdup_n_u8(0xf);
+    size_t i;
+
+    for (i = 0; i + 16 <= pixels; i += 16, pSrc += 24) {
+        uint8x8x3_t b = vld3_u8(pSrc);
+        uint16x8x2_t p;
+
+        p.val[0] = vorrq_u16(vshll_n_u8(b.val[0], 4), vmovl_u8(vand_u8(b.val[2], lsbMask)));
+        p.val[1] = vorrq_u16(vshll_n_u8(b.val[1], 4), vmovl_u8(vshr_n_u8(b.val[2], 4)));
+        vst2q_u16(pDst + i, p);
+    }
+    RawUnpack12Scalar(pDst + i, pSrc, pixels - i);
+}
+
+static void RawPack8Neon(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    size_t i;
+
+    for (i = 0; i + 16 <= pixels; i += 16) {
+        uint8x8_t lo = vmovn_u16(vld1q_u16(pSrc + i));
+        uint8x8_t hi = vmovn_u16(vld1q_u16(pSrc + i + 8));
+        vst1q_u8(pDst + i, vcombine_u8(lo, hi));
+    }
+    RawPack8Scalar(pDst + i, pSrc + i, pixels - i);
+}
+
+static void RawPack10Neon(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    /* m0..m7 L0 L1 to m0 m1 m2 m3 L0 m4 m5 m6 m7 L1 */
+    static const uint8_t shuffle[16] = { 0, 1, 2, 3, 8, 4, 5, 6, 7, 9, 255, 255, 255, 255, 255, 255 };
+    static const int16_t lsbShift[8] = { 0, 2, 4, 6, 0, 2, 4, 6 };
+    const uint8x16_t tbl = vld1q_u8(shuffle);
+    const int16x8_t shift = vld1q_s16(lsbShift);
+    const uint16x8_t lsbMask = vdupq_n_u16(0x3);
+    size_t i;
+
+    for (i = 0; i + 8 <= pixels; i += 8, pDst += 10) {
+        uint16x8_t p = vld1q_u16(pSrc + i);
+        uint16x8_t lsb = vshlq_u16(vandq_u16(p, lsbMask), shift);
+        uint8x16_t v;
+
+        /* fields do not overlap, so adding them merges them */
+        lsb = vpaddq_u16(lsb, lsb);
+        lsb = vpaddq_u16(lsb, lsb);
+        v = vqtbl1q_u8(vcombine_u8(vshrn_n_u16(p, 2), vmovn_u16(lsb)), tbl);
+        vst1_u8(pDst, vget_low_u8(v));
+        vst1q_lane_u16((uint16_t *)(pDst + 8), vreinterpretq_u16_u8(v), 4);
+    }
+    RawPack10Scalar(pDst, pSrc + i, pixels - i);
+}
+
+static void RawPack12Neon(uint8_t *pDst, const uint16_t *pSrc, size_t pixels)
+{
+    const uint16x8_t lsbMask = vdupq_n_u16(0xf);
+    size_t i;
+
+    for (i = 0; i + 16 <= pixels; i += 16, pDst += 24) {
+        uint16x8x2_t p = vld2q_u16(pSrc + i);
+        uint8x8x3_t b;
+
+        b.val[0] = vshrn_n_u16(p.val[0], 4);
+        b.val[1] = vshrn_n_u16(p.val[1], 4);
+        b.val[2] = vmovn_u16(vorrq_u16(vandq_u16(p.val[0], lsbMask),
+                                       vshlq_n_u16(vandq_u16(p.val[1], lsbMask), 4)));
+        vst3_u8(pDst, b);
+    }
+    RawPack12Scalar(pDst, pSrc + i, pixels - i);
+}
+
+static void RawConvertDepthNeon(uint16_t *pDst, const uint16_t *pSrc, size_t pixels,
+                                uint32_t fromBits, uint32_t toBits)
+{
+    /* rounding shift, negative counts shift right */
+    const int16x8_t shift = vdupq_n_s16((int16_t)toBits - (int16_t)fromBits);
+    const uint16x8_t max = vdupq_n_u16((1u << toBits) - 1);
+    size_t i;
+
+    for (i = 0; i + 8 <= pixels; i += 8) {
+        uint16x8_t p = vrshlq_u16(vld1q_u16(pSrc + i), shift);
+        vst1q_u16(pDst + i, toBits < fromBits ? vminq_u16(p, max) : p);
+    }
+    RawConvertDepthScalar(pDst + i, pSrc + i, pixels - i, fromBits, toBits);
+}
+
+const RawPackOps_t RawPackOpsNeon = {
+    .name = "neon",
+    .unpack8 = RawUnpack8Neon,
+    .unpack10 = RawUnpack10Neon,
+    .unpack12 = RawUnpack12Neon,
+    .pack8 = RawPack8Neon,
+    .pack10 = RawPack10Neon,
+    .pack12 = RawPack12Neon,
+    .convertDepth = RawConvertDepthNeon,
+};
@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * Copyright 2024 NXP
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *****************************************************************************/
+
+#ifndef __RAW_PACK_PRIV_H__
+#define __RAW_PACK_PRIV_H__
+
+#include "raw_pack.h"
+
+/* scalar reference, also used by the SIMD kernels for the line tails */
+void RawUnpack8Scalar(uint16_t *pDst, const uint8_t *pSrc, size_t pixels);
+void RawUnpack10Scalar(uint16_t *pDst, const uint8_t *pSrc, size_t pixels);
+void RawUnpack12Scalar(uint16_t *pDst, const uint8_t *pSrc, size_t pixels);
+void RawPack8Scalar(uint8_t *pDst, const uint16_t *pSrc, size_t pixels);
+void RawPack10Scalar(uint8_t *pDst, const uint16_t *pSrc, size_t pixels);
+void RawPack12Scalar(uint8_t *pDst, const uint16_t *pSrc, size_t pixels);
+void RawConvertDepthScalar(uint16_t *pDst, const uint16_t *pSrc, size_t pixels,
+                           uint32_t fromBits, uint32_t toBits);
+
+#ifdef RAW_PACK_HAVE_AVX2
+extern const RawPackOps_t RawPackOpsAvx2;
+#endif
+#ifdef RAW_PACK_HAVE_NEON
+extern const RawPackOps_t RawPackOpsNeon;
+#endif
+
+#endif
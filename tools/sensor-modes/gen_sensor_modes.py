@@ -0,0 +1,595 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 NXP
+#
+# SPDX-License-Identifier: GPL-2.0-only
+#
+"""Generate sensor mode tables, mode files and run.sh configs.
+
+Every camera pack describes its sensor modes once, in
+<pack>/modes/<sensor>.json.  From that description this script emits:
+
+  * the kernel register tables and vvcam_mode_info_s array
+    (isp-vvcam/v4l2/sensor/<sensor>/<sensor>_modes.h),
+  * the ISI sensor entry files (Sensor<N>_Entry_<sensor>.cfg),
+  * the run.sh hunks of the isp-imx patch (usage lines, the
+    write_default_mode_files() block and the configuration case branches).
+
+While generating it checks every mode against the CSI pixel clock and lane
+rate limits and against the resolution recorded in the calibration XML.
+
+Usage:
+  gen_sensor_modes.py <pack>/modes/<sensor>.json [...]
+  gen_sensor_modes.py --check <pack>/modes/<sensor>.json [...]
+"""
+
+import argparse
+import copy
+import glob
+import json
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+SENSOR_FIX = "(1 << SENSOR_FIX_FRACBITS)"
+
+# Fields of vvcam_sensor_ae_info_s that are gain or rate values expressed
+# in SENSOR_FIX_FRACBITS fixed point.
+FIX_FIELDS = (
+    "max_again", "min_again", "max_dgain", "min_dgain",
+    "start_exposure", "cur_fps", "max_fps", "min_fps", "min_afps",
+)
+
+AE_ORDER = (
+    "def_frm_len_lines", "curr_frm_len_lines", "one_line_exp_time_ns",
+    "max_integration_line", "min_integration_line",
+    "max_again", "min_again", "max_dgain", "min_dgain", "gain_step",
+    "start_exposure", "cur_fps", "max_fps", "min_fps", "min_afps",
+    "int_update_delay_frm", "gain_update_delay_frm",
+)
+
+LINE_FIELDS = ("def_frm_len_lines", "curr_frm_len_lines",
+               "max_integration_line")
+
+
+class ModeError(Exception):
+    pass
+
+
+def c_eval(expr, env):
+    """Evaluate a register value or C arithmetic expression."""
+    if isinstance(expr, (int, float)):
+        return expr
+    try:
+        return eval(expr, {"__builtins__": {}}, env)
+    except Exception as e:
+        raise ModeError("cannot evaluate '%s': %s" % (expr, e))
+
+
+def resolve_bases(modes):
+    """Expand the modes described as changes to another mode.
+
+    A mode with "base": <index> starts from a copy of that mode. Its other
+    keys replace the base ones, sections are merged one level deep and
+    "register_overrides" rewrites every base register of the same address.
+    """
+    by_index = {m["index"]: m for m in modes}
+    out = []
+    for m in modes:
+        if "base" not in m:
+            out.append(m)
+            continue
+        base = by_index.get(m["base"])
+        if base is None or "base" in base:
+            raise ModeError("mode %d: base mode %s is missing or derived"
+                            % (m["index"], m["base"]))
+        merged = copy.deepcopy(base)
+        for k, v in m.items():
+            if k in ("base", "register_overrides"):
+                continue
+            if isinstance(v, dict) and isinstance(merged.get(k), dict):
+                merged[k].update(v)
+            else:
+                merged[k] = v
+        for reg in m.get("register_overrides", []):
+            hits = [r for r in merged["registers"]
+                    if int(r[0], 16) == int(reg[0], 16)]
+            if not hits:
+                raise ModeError("mode %d: base mode does not write %s"
+                                % (m["index"], reg[0]))
+            for r in hits:
+                r[1:] = reg[1:] if len(reg) > 2 else [reg[1]] + r[2:]
+        out.append(merged)
+    return out
+
+
+def hexfmt(value, digits, upper):
+    s = "%0*x" % (digits, value)
+    return "0x" + (s.upper() if upper else s)
+
+
+class Mode:
+    def __init__(self, sensor, desc):
+        self.sensor = sensor
+        self.desc = desc
+        self.index = desc["index"]
+        self.table = desc["table"]
+        self.size = desc["size"]
+        self.width = self.size["width"]
+        self.height = self.size["height"]
+        self.bit_width = desc["bit_width"]
+        self.lanes = desc["lanes"]
+        self.timing = desc["timing"]
+        self.fps = self.timing["fps"]
+        self.env = self._build_env()
+        self.line_time_ns = self._line_time_ns()
+        self.ae = self._build_ae()
+
+    def _build_env(self):
+        env = {
+            "width": self.width,
+            "height": self.height,
+            "bit_width": self.bit_width,
+            "lanes": self.lanes,
+            "fps": self.fps,
+        }
+        for section in ("timing", "crop", "binning", "pll"):
+            for k, v in self.desc.get(section, {}).items():
+                env.setdefault(k, v)
+        crop = self.desc.get("crop")
+        if crop:
+            # the analog crop may be larger than the output size
+            env["crop_width"] = crop["width"]
+            env["crop_height"] = crop["height"]
+            env["x_end"] = crop["x_start"] + crop["width"] - 1
+            env["y_end"] = crop["y_start"] + crop["height"] - 1
+        return env
+
+    def pixel_clk_hz(self):
+        pll = self.desc.get("pll")
+        if not pll:
+            return None
+        clk = pll["ext_clk_hz"] * pll["mult"]
+        clk /= pll["pre_div"] * pll.get("vt_sys_div", 1) * pll["vt_pix_div"]
+        return clk * pll.get("pixels_per_clock", 1)
+
+    def _line_time_ns(self):
+        if "line_time_ns" in self.timing:
+            return self.timing["line_time_ns"]
+        pclk = self.pixel_clk_hz()
+        if pclk is None:
+            raise ModeError("mode %d: neither pll nor line_time_ns given"
+                            % self.index)
+        return int(self.timing["line_length_pck"] * 1e9 / pclk)
+
+    def _build_ae(self):
+        src = self.desc.get("ae", {})
+        fll = self.timing["frame_length_lines"]
+        ae = {
+            "def_frm_len_lines": fll,
+            "curr_frm_len_lines": fll,
+            "one_line_exp_time_ns": self.line_time_ns,
+            "max_integration_line":
+                fll - src.get("integration_margin", 0),
+            "cur_fps": self.fps,
+            "max_fps": self.fps,
+        }
+        for k, v in src.items():
+            if k != "integration_margin":
+                ae[k] = v
+        return ae
+
+    def ae_value(self, key):
+        return c_eval(self.ae[key], {})
+
+    def check(self, limits):
+        """Raise ModeError when the mode exceeds the CSI/ISP limits."""
+        errors = []
+        line_s = self.line_time_ns * 1e-9
+        fll = self.timing["frame_length_lines"]
+
+        fps = 1.0 / (line_s * fll)
+        if abs(fps - self.fps) / self.fps > 0.02:
+            errors.append("frame timing gives %.2f fps, mode declares %d"
+                          % (fps, self.fps))
+
+        pixel_rate = self.width / line_s
+        if pixel_rate > limits["csi_max_pixel_clk"]:
+            errors.append("active pixel rate %.1f MP/s exceeds "
+                          "csi_max_pixel_clk %.1f MHz"
+                          % (pixel_rate / 1e6,
+                             limits["csi_max_pixel_clk"] / 1e6))
+
+        lane_mbps = self.width * self.bit_width / line_s / self.lanes / 1e6
+        link_mbps = self.desc.get("lane_rate_mbps")
+        if link_mbps is not None and lane_mbps > link_mbps:
+            errors.append("line needs %.0f Mbps/lane, link runs at %d Mbps"
+                          % (lane_mbps, link_mbps))
+        max_lane = limits["max_lane_rate_mbps"]
+        if (link_mbps or lane_mbps) > max_lane:
+            errors.append("lane rate %.0f Mbps exceeds CSI limit %d Mbps"
+                          % (link_mbps or lane_mbps, max_lane))
+
+        if self.ae_value("max_integration_line") >= fll + 1:
+            errors.append("max_integration_line beyond frame length")
+
+        if errors:
+            raise ModeError("%s mode %d: %s"
+                            % (self.sensor, self.index, "; ".join(errors)))
+
+
+class Sensor:
+    def __init__(self, path):
+        self.path = os.path.abspath(path)
+        self.pack = os.path.dirname(os.path.dirname(self.path))
+        with open(self.path) as f:
+            self.desc = json.load(f)
+        self.name = self.desc["sensor"]
+        self.NAME = self.name.upper()
+        self.limits = self.desc["limits"]
+        fmt = self.desc.get("reg_format", {})
+        self.data_digits = fmt.get("data_digits", 4)
+        self.hex_upper = fmt.get("upper", True)
+        self.modes = [Mode(self.name, m)
+                      for m in resolve_bases(self.desc["modes"])]
+        if len({m.index for m in self.modes}) != len(self.modes):
+            raise ModeError("%s: duplicated mode index" % self.name)
+
+    def out(self, key):
+        return os.path.join(self.pack, self.desc["outputs"][key])
+
+    def hex(self, value, digits):
+        return hexfmt(value, digits, self.hex_upper)
+
+    # ------------------------------------------------------------------
+    # checks
+
+    def calib_resolution(self, xml_name):
+        pattern = os.path.join(self.out("isi_dir"), "calib", "**", xml_name)
+        hits = glob.glob(pattern, recursive=True)
+        if not hits:
+            raise ModeError("%s: calibration %s not found" %
+                            (self.name, xml_name))
+        root = ET.parse(hits[0]).getroot()
+        res = []
+        for cell in root.iter("resolution"):
+            w, h = cell.find(".//width"), cell.find(".//height")
+            if w is not None and h is not None:
+                res.append((int(float(w.text.strip("[] \n\t"))),
+                            int(float(h.text.strip("[] \n\t")))))
+        return res
+
+    def check(self):
+        for m in self.modes:
+            m.check(self.limits)
+            res = self.calib_resolution(m.desc["calib"]["xml"])
+            want = (m.size["bounds_width"], m.size["bounds_height"])
+            if want not in res:
+                raise ModeError("%s mode %d: %s has no %dx%d resolution"
+                                % (self.name, m.index,
+                                   m.desc["calib"]["xml"], want[0], want[1]))
+
+    # ------------------------------------------------------------------
+    # kernel header
+
+    def reg_lines(self, mode):
+        lines = []
+        for reg in mode.desc["registers"]:
+            addr = int(reg[0], 16)
+            value = c_eval(reg[1], mode.env)
+            if value < 0 or value >= (1 << (4 * self.data_digits)):
+                raise ModeError("%s: register %s value %s out of range"
+                                % (mode.table, reg[0], reg[1]))
+            line = "\t{%s, %s}," % (self.hex(addr, 4),
+                                    self.hex(value, self.data_digits))
+            if len(reg) > 2:
+                line += " // %s" % reg[2]
+            lines.append(line)
+        return lines
+
+    def ae_lines(self, mode):
+        lines = []
+        for key in AE_ORDER:
+            if key not in mode.ae:
+                continue
+            value = mode.ae[key]
+            if isinstance(value, str):
+                text = value
+            elif key in FIX_FIELDS:
+                text = "%s * %s" % (value, SENSOR_FIX)
+            elif key in LINE_FIELDS:
+                text = self.hex(value, 1)
+            else:
+                text = str(value)
+            lines.append("\t\t\t.%-22s= %s," % (key, text))
+        return lines
+
+    def timing_comment(self, mode):
+        pll = mode.desc.get("pll")
+        t = mode.timing
+        lines = ["\t\t\t/*"]
+        if pll and "line_time_ns" not in t:
+            lines.append("\t\t\tPIX_CLK = %d * %d / (%d * %d * %d) = %.1f MHz"
+                         % (pll["ext_clk_hz"], pll["mult"], pll["pre_div"],
+                            pll.get("vt_sys_div", 1), pll["vt_pix_div"],
+                            mode.pixel_clk_hz()
+                            / pll.get("pixels_per_clock", 1) / 1e6))
+            lines.append("\t\t\tline time = %d / (%d * PIX_CLK) = %d ns"
+                         % (t["line_length_pck"],
+                            pll.get("pixels_per_clock", 1),
+                            mode.line_time_ns))
+        else:
+            lines.append("\t\t\tline time = %d ns" % mode.line_time_ns)
+        lines.append("\t\t\tframe time = %d lines * %d ns -> %d fps"
+                     % (t["frame_length_lines"], mode.line_time_ns, t["fps"]))
+        lines.append("\t\t\t*/")
+        return lines
+
+    def mode_lines(self, mode):
+        s, d = mode.size, mode.desc
+        out = [
+            "\t{",
+            "\t\t.index          = %d," % mode.index,
+            "\t\t.size           = {",
+            "\t\t\t.bounds_width  = %d," % s["bounds_width"],
+            "\t\t\t.bounds_height = %d," % s["bounds_height"],
+            "\t\t\t.top           = %d," % s.get("top", 0),
+            "\t\t\t.left          = %d," % s.get("left", 0),
+            "\t\t\t.width         = %d," % s["width"],
+            "\t\t\t.height        = %d," % s["height"],
+            "\t\t},",
+            "\t\t.hdr_mode       = %s," % d.get("hdr_mode",
+                                              "SENSOR_MODE_LINEAR"),
+            "\t\t.bit_width      = %d," % mode.bit_width,
+            "\t\t.data_compress  = {",
+        ]
+        comp = d.get("data_compress", {"enable": 0})
+        for k in ("enable", "x_bit", "y_bit"):
+            if k in comp:
+                out.append("\t\t\t.%s = %d," % (k, comp[k]))
+        out += [
+            "\t\t},",
+            "\t\t.bayer_pattern  = %s," % d["bayer_pattern"],
+            "\t\t.ae_info = {",
+        ]
+        out += self.timing_comment(mode)
+        out += self.ae_lines(mode)
+        out += [
+            "\t\t},",
+            "\t\t.mipi_info = {",
+            "\t\t\t.mipi_lane = %d," % mode.lanes,
+            "\t\t},",
+            "\t\t.preg_data      = %s," % mode.table,
+            "\t\t.reg_data_count = ARRAY_SIZE(%s)," % mode.table,
+            "\t},",
+        ]
+        return out
+
+    def kernel_header(self):
+        guard = "_VVCAM_%s_MODES_H_" % self.NAME
+        rel = os.path.relpath(self.path, self.pack)
+        out = [
+            "/*",
+            " * Copyright 2024 NXP",
+            " *",
+            " * SPDX-License-Identifier: (GPL-2.0-only OR MIT)",
+            " */",
+            "",
+            "/*",
+            " * Generated by tools/sensor-modes/gen_sensor_modes.py from",
+            " * %s. Do not edit." % rel,
+            " */",
+            "",
+            "#ifndef %s" % guard,
+            "#define %s" % guard,
+            "",
+            '#include "vvsensor.h"',
+            "",
+            "#define %s_CSI_MAX_PIXEL_CLK\t%d"
+            % (self.NAME, self.limits["csi_max_pixel_clk"]),
+            "",
+        ]
+        for m in self.modes:
+            out.append("/* %s */" % m.desc["description"])
+            out.append("static struct vvcam_sccb_data_s %s[] = {" % m.table)
+            out += self.reg_lines(m)
+            out += ["};", ""]
+        out.append("static struct vvcam_mode_info_s p%s_mode_info[] = {"
+                   % self.name)
+        for m in self.modes:
+            out += self.mode_lines(m)
+        out += ["};", "", "#endif", ""]
+        return "\n".join(out)
+
+    # ------------------------------------------------------------------
+    # ISI mode and entry files
+
+    def modes_file(self):
+        return "%s_MODES.txt" % self.NAME
+
+    def mode_entries(self):
+        out = []
+        for m in self.modes:
+            out.append("[mode.%d]" % m.index)
+            out.append('xml = "%s"' % m.desc["calib"]["xml"])
+            out.append('dwe = "%s"' % m.desc["calib"]["dwe"])
+        return out
+
+    def entry_cfg(self):
+        head = [
+            'name="%s"' % self.name,
+            'drv = "%s.drv"' % self.name,
+            "mode= %d" % self.modes[0].index,
+            "",
+        ]
+        return "\n".join(head + self.mode_entries()) + "\n"
+
+    # ------------------------------------------------------------------
+    # run.sh hunks of the isp-imx patch
+
+    def run_usage(self):
+        return ['USAGE+="\\t%-22s - %s\\n"' % (m.desc["config"],
+                                                m.desc["description"])
+                for m in self.modes] + [""]
+
+    def run_mode_file(self):
+        f = self.modes_file()
+        out = ["", "\t# %s modes file" % self.NAME,
+               '\techo -n "" > %s' % f]
+        for line in self.mode_entries():
+            out.append("\techo %s >> %s" % (json.dumps(line), f))
+        return out
+
+    def run_case(self):
+        # "run_entries" selects which entry files a run.sh configuration
+        # writes; packs shipping spare entry files keep a single camera.
+        entries = self.desc.get("run_entries", self.desc.get("entries", [0]))
+        out = []
+        for m in self.modes:
+            out += [
+                "\t\t%s )" % m.desc["config"],
+                '\t\t\tMODULES=("%s" "${MODULES[@]}")' % self.name,
+                '\t\t\tRUN_OPTION="%s"' % ("DUAL_CAMERA" if len(entries) > 1
+                                           else "CAMERA0"),
+                '\t\t\tCAM_NAME="%s"' % self.name,
+                '\t\t\tDRV_FILE="%s.drv"' % self.name,
+                '\t\t\tMODE_FILE="%s"' % self.modes_file(),
+                '\t\t\tMODE="%d"' % m.index,
+            ]
+            for e in entries:
+                out.append('\t\t\twrite_sensor_cfg_file "Sensor%d_Entry.cfg" '
+                           "$CAM_NAME $DRV_FILE $MODE_FILE $MODE" % e)
+            out.append("\t\t\t;;")
+        return out
+
+    def update_patch(self, text):
+        return rewrite_file_hunks(text, "imx/run.sh", [
+            (lambda added: any(l.startswith("USAGE+=") for l in added),
+             self.run_usage()),
+            (lambda added: any("_MODES.txt" in l for l in added),
+             self.run_mode_file()),
+            (lambda added: any(l.strip().startswith('MODULES=("%s"'
+                                                    % self.name)
+                               for l in added),
+             self.run_case()),
+        ])
+
+    # ------------------------------------------------------------------
+
+    def outputs(self):
+        files = {self.out("kernel_header"): self.kernel_header()}
+        isi = self.out("isi_dir")
+        for e in self.desc.get("entries", [0]):
+            files[os.path.join(isi, "Sensor%d_Entry_%s.cfg"
+                               % (e, self.name))] = self.entry_cfg()
+        patch = self.out("isp_patch")
+        with open(patch) as f:
+            files[patch] = self.update_patch(f.read())
+        return files
+
+
+HUNK_RE = re.compile(r"^@@ -(\d+)(?:,(\d+))? \+(\d+)(?:,(\d+))? @@(.*)$")
+
+
+def rewrite_file_hunks(text, filename, rules):
+    """Replace the added lines of selected hunks of one file in a patch.
+
+    Each rule is (predicate, new_lines): the first hunk whose added lines
+    satisfy the predicate gets its '+' lines replaced by new_lines, placed
+    where the first '+' line was.  Hunk headers of the file are rewritten
+    so that the patch still applies.
+    """
+    lines = text.split("\n")
+    start = None
+    for i, l in enumerate(lines):
+        if l.startswith("diff --git") and l.endswith(" b/" + filename):
+            start = i
+        elif start is not None and l.startswith("diff --git"):
+            end = i
+            break
+    else:
+        end = len(lines)
+    if start is None:
+        raise ModeError("patch has no %s section" % filename)
+
+    head, hunks, cur = [], [], None
+    for l in lines[start:end]:
+        if HUNK_RE.match(l):
+            cur = [l]
+            hunks.append(cur)
+        elif cur is None:
+            head.append(l)
+        else:
+            cur.append(l)
+
+    # a trailing empty string belongs to the next section / end of file
+    tail = []
+    if hunks and hunks[-1][-1] == "" and end == len(lines):
+        tail = [hunks[-1].pop()]
+
+    pending = list(rules)
+    offset = 0
+    out = list(head)
+    for h in hunks:
+        m = HUNK_RE.match(h[0])
+        body = h[1:]
+        added = [l[1:] for l in body if l.startswith("+")]
+        for rule in pending:
+            if rule[0](added):
+                pending.remove(rule)
+                first = next(i for i, l in enumerate(body)
+                             if l.startswith("+"))
+                body = ([l for l in body[:first]] +
+                        ["+" + l for l in rule[1]] +
+                        [l for l in body[first:] if not l.startswith("+")])
+                break
+        old_start = int(m.group(1))
+        old_len = sum(1 for l in body if not l.startswith("+"))
+        new_len = sum(1 for l in body if not l.startswith("-"))
+        out.append("@@ -%d,%d +%d,%d @@%s" % (old_start, old_len,
+                                              old_start + offset, new_len,
+                                              m.group(5)))
+        offset += new_len - old_len
+        out += body
+    if pending:
+        raise ModeError("patch %s: %d hunk(s) not found"
+                        % (filename, len(pending)))
+    return "\n".join(lines[:start] + out + tail + lines[end:])
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("--check", action="store_true",
+                    help="only verify that the generated files are current")
+    ap.add_argument("descriptions", nargs="+")
+    args = ap.parse_args()
+
+    stale = 0
+    for path in args.descriptions:
+        try:
+            sensor = Sensor(path)
+            sensor.check()
+            files = sensor.outputs()
+        except (ModeError, KeyError) as e:
+            print("%s: %s" % (path, e), file=sys.stderr)
+            return 1
+        for name, content in sorted(files.items()):
+            old = None
+            if os.path.exists(name):
+                with open(name) as f:
+                    old = f.read()
+            if old == content:
+                continue
+            if args.check:
+                print("stale: %s" % os.path.relpath(name), file=sys.stderr)
+                stale += 1
+            else:
+                with open(name, "w") as f:
+                    f.write(content)
+                print("wrote %s" % os.path.relpath(name))
+    return 1 if stale else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 NXP
+#
+# SPDX-License-Identifier: GPL-2.0-only
+#
+"""Keep the sources shared by the camera packs identical.
+
+Each camera pack carries its own copy of the sources the sensors share, so
+that a pack can be overlaid on its own:
+
+  * the ISI sensor core, isp-imx/units/isi/drv/VVSENSOR/, which has to be
+    the same in every pack since overlaying several packs keeps one copy,
+  * the vvsensor_*.h headers next to the kernel drivers
+    (isp-vvcam/v4l2/sensor/<sensor>/), vvsensor_ext.h also being the one
+    in VVSENSOR/include.
+
+VVSENSOR files are matched by their path inside VVSENSOR/ and are required
+in every pack with a VVSENSOR directory. Kernel headers are matched by file
+name, a header only some sensors use is only compared between the packs
+that have it.
+
+Usage:
+  sync_shared.py --check <pack> [...]
+  sync_shared.py --from <pack> <pack> [...]
+"""
+
+import argparse
+import filecmp
+import glob
+import os
+import shutil
+import sys
+
+ISI_CORE = "isp-imx/units/isi/drv/VVSENSOR"
+KERNEL_HEADERS = "isp-vvcam/v4l2/sensor/*/vvsensor_*.h"
+
+
+def shared_files(pack):
+    """Map of shared file key to its paths in pack."""
+    files = {}
+    core = os.path.join(pack, ISI_CORE)
+    for root, _, names in os.walk(core):
+        for name in names:
+            path = os.path.join(root, name)
+            key = "VVSENSOR/" + os.path.relpath(path, core)
+            files.setdefault(key, []).append(path)
+            # vvsensor_ext.h, also one of the kernel headers
+            if glob.glob(os.path.join(pack, os.path.dirname(KERNEL_HEADERS),
+                                      name)):
+                files.setdefault(name, []).append(path)
+    for path in glob.glob(os.path.join(pack, KERNEL_HEADERS)):
+        files.setdefault(os.path.basename(path), []).append(path)
+    return files
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("--check", action="store_true",
+                    help="only verify that the copies are identical")
+    ap.add_argument("--from", dest="source", metavar="PACK",
+                    help="pack whose copies are written to the others")
+    ap.add_argument("packs", nargs="+")
+    args = ap.parse_args()
+
+    if args.check == bool(args.source):
+        ap.error("give either --check or --from")
+
+    packs = {p: shared_files(p) for p in args.packs}
+    if args.source:
+        if args.source not in packs:
+            packs[args.source] = shared_files(args.source)
+        ref = {k: v[0] for k, v in packs[args.source].items()}
+    else:
+        ref = {}
+        for files in packs.values():
+            for key, paths in files.items():
+                ref.setdefault(key, paths[0])
+    cores = [p for p in packs if os.path.isdir(os.path.join(p, ISI_CORE))]
+
+    bad = 0
+    for key, src in sorted(ref.items()):
+        copies = [path for files in packs.values()
+                  for path in files.get(key, [])]
+        if key.startswith("VVSENSOR/"):
+            for p in cores:
+                if key not in packs[p]:
+                    path = os.path.join(p, ISI_CORE,
+                                        key[len("VVSENSOR/"):])
+                    if args.check:
+                        print("missing: %s" % os.path.relpath(path),
+                              file=sys.stderr)
+                        bad += 1
+                    else:
+                        copies.append(path)
+        for path in copies:
+            if os.path.exists(path) and filecmp.cmp(src, path, shallow=False):
+                continue
+            if args.check:
+                print("differs: %s (from %s)" % (os.path.relpath(path),
+                                                 os.path.relpath(src)),
+                      file=sys.stderr)
+                bad += 1
+            else:
+                os.makedirs(os.path.dirname(path), exist_ok=True)
+                shutil.copyfile(src, path)
+                print("wrote %s" % os.path.relpath(path))
+    return 1 if bad else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())